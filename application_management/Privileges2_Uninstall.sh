@@ -124,6 +124,7 @@ if [[ "$(/usr/bin/id -u)" -eq 0 ]]; then
 		/bin/rm -rf "/Library/LaunchDaemons/corp.sap.privileges"* \
 					"/Library/LaunchAgents/corp.sap.privileges"* \
 					"/Library/Application Support/Privileges" \
+					"/private/var/root/Library/Preferences/corp.sap.privileges.watcher.plist" \
 					"/Applications/Privileges.app" \
 					"/private/etc/paths.d/PrivilegesCLI" \
 					"/Library/Scripts/VoiceOver/Privileges Time Left.scpt" \
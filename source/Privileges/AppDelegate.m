@@ -17,6 +17,7 @@
 
 #import "AppDelegate.h"
 #import "MTPrivileges.h"
+#import "MTGroupMembershipCache.h"
 #import "MTReasonAccessoryController.h"
 #import "MTLocalNotification.h"
 #import "Constants.h"
@@ -121,6 +122,7 @@ extern void CoreDockSendNotification(CFStringRef, void*);
                                                                                                 queue:nil
                                                                                            usingBlock:^(NSNotification *notification) {
                 
+                [[MTGroupMembershipCache sharedCache] invalidate];
                 if ([self->_alert window]) { [NSApp endSheet:[self->_alert window]]; }
                 [self showMainWindow];
             }];
@@ -382,7 +384,7 @@ extern void CoreDockSendNotification(CFStringRef, void*);
                 // remove privileges if the user is admin…
                 if (hasAdminRights && !renewAdminPrivileges) {
                     
-                    [[self->_privilegesApp currentUser] revokeAdminPrivilegesWithCompletionHandler:^(BOOL success) {
+                    [[self->_privilegesApp currentUser] revokeAdminPrivilegesWithCompletionHandler:^(BOOL success, NSError *error) {
                         
                         dispatch_async(dispatch_get_main_queue(), ^{
                             [NSApp terminate:self];
@@ -450,7 +452,7 @@ extern void CoreDockSendNotification(CFStringRef, void*);
                                     }
                                     
                                     [[self->_privilegesApp currentUser] requestAdminPrivilegesWithReason:reason
-                                                                                       completionHandler:^(BOOL success) {
+                                                                                       completionHandler:^(BOOL success, NSError *error) {
                                         
                                         dispatch_async(dispatch_get_main_queue(), ^{
                                             [NSApp terminate:self];
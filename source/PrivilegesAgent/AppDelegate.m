@@ -17,27 +17,34 @@
 
 #import "AppDelegate.h"
 #import "MTPrivileges.h"
+#import "MTConnectionRequirement.h"
 #import "MTCodeSigning.h"
 #import "MTDaemonConnection.h"
 #import "MTSystemExtension.h"
 #import "MTSystemInfo.h"
 #import "Constants.h"
 #import "MTIdentity.h"
+#import "MTGroupMembershipCache.h"
 #import "PrivilegesAgentProtocol.h"
 #import "MTSyslog.h"
 #import "MTWebhook.h"
 #import "MTStatusItemMenu.h"
 #import "MTRemoteLoggingManager.h"
+#import "MTRateLimiter.h"
+#import "MTStatePage.h"
+#import "MTDeadlineScheduler.h"
 #import <os/log.h>
 
+#define kMTDeadlineExpiration               @"expiration"
+#define kMTDeadlineStatusItemUpdate         @"statusitem.update"
+#define kMTDeadlineStatusItemAnimation      @"statusitem.animation"
+#define kMTDeadlineSystemExtensionConfig    @"systemextension.config"
+
 @interface AppDelegate ()
 @property (nonatomic, strong, readwrite) MTPrivileges *privilegesApp;
 @property (nonatomic, strong, readwrite) NSArray *keysToObserve;
 @property (nonatomic, strong, readwrite) NSArray *appGroupToObserve;
-@property (nonatomic, strong, readwrite) NSTimer *expirationTimer;
-@property (nonatomic, strong, readwrite) NSTimer *statusItemTimer;
-@property (nonatomic, strong, readwrite) NSTimer *animationTimer;
-@property (nonatomic, strong, readwrite) NSTimer *fixTimeoutObserverTimer;
+@property (nonatomic, strong, readwrite) MTDeadlineScheduler *scheduler;
 @property (nonatomic, strong, readwrite) NSDate *timerExpirationDate;
 @property (nonatomic, strong, readwrite) NSUserDefaults *userDefaults;
 @property (nonatomic, strong, readwrite) NSUserDefaults *appGroupDefaults;
@@ -48,6 +55,10 @@
 @property (nonatomic, strong, readwrite) MTStatusItemMenu *statusMenu;
 @property (nonatomic, strong, readwrite) MTRemoteLoggingManager *logManager;
 @property (atomic, strong, readwrite) NSXPCListener *listener;
+@property (atomic, strong, readwrite) MTRateLimiter *rateLimiter;
+@property (nonatomic, strong, readwrite) MTConnectionRequirement *connectionRequirement;
+@property (assign) mt_state_page_t *statePage;
+@property (assign) uint64_t configGeneration;
 @property (retain) id adminGroupObserver;
 @property (retain) id lockScreenObserver;
 @property (assign) BOOL observingStatusItem;
@@ -59,8 +70,6 @@
 @property audit_token_t auditToken;
 @end
 
-OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement);
-
 @implementation AppDelegate
 
 - (void)applicationDidFinishLaunching:(NSNotification *)aNotification 
@@ -75,6 +84,36 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
         
         os_log(OS_LOG_DEFAULT, "SAPCorp: Launched for user %{public}@", [[_privilegesApp currentUser] userName]);
         
+        // limit the rate of privilege change requests if configured
+        _rateLimiter = [[MTRateLimiter alloc] initWithConfiguration:[_privilegesApp requestRateLimits]];
+        
+        // all timed tasks share a single timer
+        _scheduler = [MTDeadlineScheduler sharedScheduler];
+        
+        // publish the privilege state in shared memory, so other components
+        // can read it without having to connect to the agent
+        char statePageName[32];
+        snprintf(statePageName, sizeof(statePageName), kMTStatePageNameFormat, getuid());
+        _statePage = mt_state_page_open(statePageName, getuid(), true);
+        
+        if (_statePage) {
+            [self publishPrivilegeState];
+        } else {
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to open state page: %{public}s", strerror(errno));
+        }
+        
+        // only Privileges components are allowed to connect. They must be signed by the same
+        // signing authority and must have the same version number as this agent
+        NSError *error = nil;
+        _connectionRequirement = [[MTConnectionRequirement alloc] initWithBundleIdentifiers:[NSArray arrayWithObject:@"corp.sap.privileges*"]
+                                                                              versionString:[[NSBundle bundleForClass:[self class]] objectForInfoDictionaryKey:@"CFBundleShortVersionString"]
+                                                                                      error:&error
+        ];
+        
+        if (!_connectionRequirement) {
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to get code signature: %{public}@", error);
+        }
+        
         _listener = [[NSXPCListener alloc] initWithMachServiceName:kMTAgentMachServiceName];
         [_listener setDelegate:self];
         [_listener resume];
@@ -110,7 +149,7 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
             if ([_privilegesApp revokePrivilegesAtLogin] &&
                 [[NSDate date] timeIntervalSinceDate:[MTSystemInfo sessionStartDate]] < kMTRevokeAtLoginThreshold) {
                 
-                [self revokeAdminRightsWithCompletionHandler:^(BOOL success) {
+                [self revokeAdminRightsWithCompletionHandler:^(BOOL success, NSError *error) {
                     if (success) { self->_adminRightsExpected = NO; }
                 }];
                 
@@ -131,7 +170,7 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
                         
                     } else {
                         
-                        [self revokeAdminRightsWithCompletionHandler:^(BOOL success) {
+                        [self revokeAdminRightsWithCompletionHandler:^(BOOL success, NSError *error) {
                             if (success) { self->_adminRightsExpected = NO; }
                         }];
                     }
@@ -159,6 +198,7 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
                               kMTDefaultsShowInMenuBarKey,
                               kMTDefaultsShowRemainingTimeInMenuBarKey,
                               kMTDefaultsRemoteLoggingKey,
+                              kMTDefaultsRequestRateLimitsKey,
                               kMTDefaultsEnableSystemExtensionKey,
                               nil
         ];
@@ -199,6 +239,13 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
                                                                  object:nil
         ];
         
+        // warm up the remote logging connection after wake from sleep
+        [[[NSWorkspace sharedWorkspace] notificationCenter] addObserver:self
+                                                               selector:@selector(warmUpRemoteLoggingConnection)
+                                                                   name:NSWorkspaceDidWakeNotification
+                                                                 object:nil
+        ];
+        
         // add an observer to detect changes to the system time
         [[NSNotificationCenter defaultCenter] addObserver:self
                                                  selector:@selector(systemTimeChanged:)
@@ -217,7 +264,7 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
                 os_log(OS_LOG_DEFAULT, "SAPCorp: Revoking administrator privileges for user %{public}@ because the screen has been locked", [[self->_privilegesApp currentUser] userName]);
                 
                 // remove admin rights
-                [self revokeAdminRightsWithCompletionHandler:^(BOOL success) { return; }];
+                [self revokeAdminRightsWithCompletionHandler:^(BOOL success, NSError *error) { return; }];
             }
         }];
         
@@ -228,7 +275,23 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
                                                                                             queue:nil
                                                                                        usingBlock:^(NSNotification *notification) {
             
-            if (!self->_ignoreAdminGroupChanges && [self userHasAdminPrivileges] != self->_adminRightsExpected) {
+            // the order in which observers are called is undefined, so
+            // make sure we don't get a cached group membership here
+            [[MTGroupMembershipCache sharedCache] invalidate];
+            
+            // if the watcher tells us which users have been added or removed,
+            // we only have to check the privileges if our user is one of them
+            NSArray *addedUsers = [[notification userInfo] objectForKey:kMTNotificationKeyAddedUsers];
+            NSArray *removedUsers = [[notification userInfo] objectForKey:kMTNotificationKeyRemovedUsers];
+            BOOL userMayHaveChanged = YES;
+            
+            if ([addedUsers isKindOfClass:[NSArray class]] && [removedUsers isKindOfClass:[NSArray class]]) {
+                
+                NSString *userName = [[self->_privilegesApp currentUser] userName];
+                userMayHaveChanged = ([addedUsers containsObject:userName] || [removedUsers containsObject:userName]);
+            }
+            
+            if (!self->_ignoreAdminGroupChanges && userMayHaveChanged && [self userHasAdminPrivileges] != self->_adminRightsExpected) {
                 
                 os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Administrator privileges for user %{public}@ have been changed by another process", [[self->_privilegesApp currentUser] userName]);
                 [[self->_privilegesApp currentUser] setUnexpectedPrivilegeState:YES];
@@ -268,63 +331,40 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
 {
     BOOL acceptConnection = NO;
     
-    // see how we have been signed and make sure only processes with the same signing authority can connect.
-    // additionally the calling application must have the same version number as this xpc service and must be
-    // one of the components using a bundle identifier starting with "corp.sap.privileges"
+    // make sure only processes matching our (precompiled) code signing requirement can connect
     NSError *error = nil;
-    NSString *signingAuth = [MTCodeSigning getSigningAuthorityWithError:&error];
-    NSString *requiredVersion = [[NSBundle bundleForClass:[self class]] objectForInfoDictionaryKey:@"CFBundleShortVersionString"];
     
-    if (signingAuth) {
-        
-        NSString *reqString = [MTCodeSigning codeSigningRequirementsWithCommonName:signingAuth
-                                                                  bundleIdentifier:@"corp.sap.privileges*" 
-                                                                     versionString:requiredVersion
-        ];
-        SecTaskRef taskRef = SecTaskCreateWithAuditToken(NULL, ((ExtendedNSXPCConnection*)newConnection).auditToken);
-       
-        if (taskRef) {
-            
-            OSStatus result = SecTaskValidateForRequirement(taskRef, (__bridge CFStringRef)(reqString));
-            
-            if (result == errSecSuccess) {
+    if ([_connectionRequirement validateAuditToken:((ExtendedNSXPCConnection*)newConnection).auditToken error:&error]) {
 
-                acceptConnection = YES;
-                   
-                [newConnection setExportedInterface:[NSXPCInterface interfaceWithProtocol:@protocol(PrivilegesAgentProtocol)]];
-                [newConnection setExportedObject:self];
-                
+        acceptConnection = YES;
+           
+        [newConnection setExportedInterface:[NSXPCInterface interfaceWithProtocol:@protocol(PrivilegesAgentProtocol)]];
+        [newConnection setExportedObject:self];
+        
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Warc-retain-cycles"
-                [newConnection setInvalidationHandler:^{
-                              
-                    [newConnection setInvalidationHandler:nil];
-                    os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ invalidated", newConnection);
-                }];
+        [newConnection setInvalidationHandler:^{
+                      
+            [newConnection setInvalidationHandler:nil];
+            os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ invalidated", newConnection);
+        }];
 #pragma clang diagnostic pop
-                
-                [newConnection resume];
+        
+        [newConnection resume];
+
+        os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ established", newConnection);
 
-                os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ established", newConnection);
-    
-            } else {
-                
-                os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Code signature verification failed (error %d)", result);
-            }
-                
-            CFRelease(taskRef);
-        }
-            
     } else {
-        os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to get code signature: %{public}@", error);
-    }
         
+        os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Code signature verification failed (error %ld)", (long)[error code]);
+    }
+
     return acceptConnection;
 }
 
 - (void)scheduleExpirationTimerWithInterval:(NSUInteger)interval isSavedTimer:(BOOL)savedTimer
 {
-    if (_expirationTimer) {
+    if (_timerExpirationDate) {
         
         if (!savedTimer) {
             
@@ -347,73 +387,94 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
 
     // post a notification to update the Dock tile
     [self postAutoRevokeIntervalUpdateNotificationWithInterval:interval];
+    
+    [self scheduleExpirationDeadline];
+}
+
+- (void)scheduleExpirationDeadline
+{
+    NSDate *expirationDate = _timerExpirationDate;
+    
+    if (expirationDate) {
+        
+        // instead of checking every minute, we wake up exactly when the number of minutes
+        // left changes. This is also when the renewal notification is due and, for the
+        // last minute, when the privileges expire. Only the expiration must not be late.
+        NSTimeInterval nextTimeLeft = (ceil([expirationDate timeIntervalSinceNow] / 60.0) - 1) * 60;
+        if (nextTimeLeft < 0) { nextTimeLeft = 0; }
+        
+        [_scheduler scheduleDeadlineWithIdentifier:kMTDeadlineExpiration
+                                          fireDate:[expirationDate dateByAddingTimeInterval:-nextTimeLeft]
+                                         tolerance:(nextTimeLeft > 0) ? kMTExpirationUpdateTolerance : 0
+                                           handler:^{
+            [self expirationDeadlineReached];
+        }];
+    }
+}
+
+- (void)expirationDeadlineReached
+{
+    NSInteger minutesLeft = [self privilegesTimeLeft];
+
+    if (minutesLeft > 0) {
         
-    dispatch_async(dispatch_get_main_queue(), ^{
+        [self scheduleExpirationDeadline];
         
-        NSInteger renewalNotificationTime = [self->_privilegesApp renewalNotificationInterval];
+        // post a notification to update the Dock tile
+        [self postAutoRevokeIntervalUpdateNotificationWithInterval:minutesLeft];
         
-        self->_expirationTimer = [NSTimer scheduledTimerWithTimeInterval:60
-                                                                 repeats:YES
-                                                                   block:^(NSTimer *timer) {
+        // update the status item's tooltip
+        if ([_privilegesApp showInMenuBar]) { [self showStatusItem:YES]; }
+        
+        // if the administrator privileges are about to expire and privilege renewal
+        // is allowed, we post a notification and ask the user to renew the privileges.
+        // if a custom renewal workflow has been configured, we run the configured
+        // executable instead of posting the user notification.
+        NSInteger renewalNotificationTime = [_privilegesApp renewalNotificationInterval];
+        
+        if (minutesLeft == renewalNotificationTime &&
+            [_privilegesApp expirationInterval] > renewalNotificationTime &&
+            [_privilegesApp privilegeRenewalAllowed]) {
             
-            NSInteger minutesLeft = [self privilegesTimeLeft];
-
-            if (minutesLeft > 0) {
-                
-                // post a notification to update the Dock tile
-                [self postAutoRevokeIntervalUpdateNotificationWithInterval:minutesLeft];
-                
-                // update the status item's tooltip
-                if ([self->_privilegesApp showInMenuBar]) {
-                    
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        [self showStatusItem:YES];
-                    });
-                }
+            NSDictionary *renewalCustomAction = [_privilegesApp renewalCustomAction];
+            NSString *actionPath = [renewalCustomAction objectForKey:kMTDefaultsRenewalCustomActionPathKey];
+            
+            if ([actionPath length] > 0) {
                 
-                // if the administrator privileges are about to expire and privilege renewal
-                // is allowed, we post a notification and ask the user to renew the privileges.
-                // if a custom renewal workflow has been configured, we run the configured
-                // executable instead of posting the user notification.
-                if (minutesLeft == renewalNotificationTime &&
-                    [self->_privilegesApp expirationInterval] > renewalNotificationTime &&
-                    [self->_privilegesApp privilegeRenewalAllowed]) {
-                    
-                    NSDictionary *renewalCustomAction = [self->_privilegesApp renewalCustomAction];
-                    NSString *actionPath = [renewalCustomAction objectForKey:kMTDefaultsRenewalCustomActionPathKey];
-                    
-                    if ([actionPath length] > 0) {
-                        
-                        [self launchExecutableAtPath:actionPath
-                                           arguments:[NSArray arrayWithObject:[NSString stringWithFormat:@"%ld", renewalNotificationTime]]
-                        ];
-                        
-                    } else {
-                        
-                        [self displayNotificationOfType:MTLocalNotificationTypeRenew];
-                    }
-                }
+                [self launchExecutableAtPath:actionPath
+                                   arguments:[NSArray arrayWithObject:[NSString stringWithFormat:@"%ld", renewalNotificationTime]]
+                ];
                 
-            }  else {
+            } else {
                 
-                dispatch_async(dispatch_get_main_queue(), ^{
-                    
-                    [self revokeAdminRightsWithCompletionHandler:^(BOOL success) {
-                        
-                        os_log(OS_LOG_DEFAULT, "SAPCorp: Administrator privileges for user %{public}@ have expired", [[self->_privilegesApp currentUser] userName]);
-                    }];
-                });
+                [self displayNotificationOfType:MTLocalNotificationTypeRenew];
             }
+        }
+        
+    } else {
+        
+        // check again in a minute, in case the privileges cannot be revoked right now.
+        // this also replaces a deadline that became due while the computer was asleep,
+        // so the privileges are not revoked twice. Revoking them cancels the deadline.
+        [_scheduler scheduleDeadlineWithIdentifier:kMTDeadlineExpiration
+                                          fireDate:[NSDate dateWithTimeIntervalSinceNow:60]
+                                         tolerance:kMTExpirationUpdateTolerance
+                                           handler:^{
+            [self expirationDeadlineReached];
         }];
         
-    });
+        [self revokeAdminRightsWithCompletionHandler:^(BOOL success, NSError *error) {
+            
+            os_log(OS_LOG_DEFAULT, "SAPCorp: Administrator privileges for user %{public}@ have expired", [[self->_privilegesApp currentUser] userName]);
+        }];
+    }
 }
 
 - (void)checkExpirationTimer
 {
-    if ([[NSDate date] compare:_timerExpirationDate] == NSOrderedDescending) {
+    if (_timerExpirationDate && [[NSDate date] compare:_timerExpirationDate] == NSOrderedDescending) {
                 
-        [_expirationTimer fire];
+        [self expirationDeadlineReached];
                 
     } else {
                 
@@ -424,10 +485,9 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
 
 - (void)invalidateExpirationTimer
 {
-    if (_expirationTimer) {
+    if (_timerExpirationDate) {
         
-        [_expirationTimer invalidate];
-        _expirationTimer = nil;
+        [_scheduler cancelDeadlineWithIdentifier:kMTDeadlineExpiration];
         _timerExpirationDate = nil;
         
         [self postAutoRevokeIntervalUpdateNotificationWithInterval:0];
@@ -451,7 +511,7 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
             
         } else if ([enforcedPrivileges isEqualToString:kMTEnforcedPrivilegeTypeUser] && userHasAdminPrivileges) {
             
-            [self revokeAdminRightsWithCompletionHandler:^(BOOL success) { return; }];
+            [self revokeAdminRightsWithCompletionHandler:^(BOOL success, NSError *error) { return; }];
         }
         
     } else {
@@ -519,7 +579,7 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
 {
     if (_logManager) {
         
-        [_logManager cancelRetries];
+        [_logManager invalidate];
         _logManager = nil;
     }
         
@@ -532,13 +592,24 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
         BOOL success = [_logManager start];
     
         if (success) {
+            
             os_log(OS_LOG_DEFAULT, "SAPCorp: Successfully initialized remote logging manager");
+            
+            // connect to the logging server now, so the first
+            // event does not have to wait for the connection
+            [_logManager warmUpConnection];
+            
         } else {
             os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to initialize remote logging manager");
         }
     }
 }
 
+- (void)warmUpRemoteLoggingConnection
+{
+    if (_logManager) { [_logManager warmUpConnection]; }
+}
+
 - (void)remoteLoggingTaskWithReason:(NSString*)reason
 {
     if (!_logManager) { [self initializeLogManager]; }
@@ -708,12 +779,12 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
             // workaround for bug that is causing observeValueForKeyPath to be called multiple times.
             // so every notification resets the timer and if we got no new notifications for 5 seconds,
             // we evaluate the changes.
-            if (_fixTimeoutObserverTimer) { [_fixTimeoutObserverTimer invalidate]; };
-            _fixTimeoutObserverTimer = [NSTimer scheduledTimerWithTimeInterval:5.0
-                                                                       repeats:NO
-                                                                         block:^(NSTimer *timer) {
+            [_scheduler scheduleDeadlineWithIdentifier:kMTDeadlineSystemExtensionConfig
+                                              fireDate:[NSDate dateWithTimeIntervalSinceNow:5.0]
+                                             tolerance:1.0
+                                               handler:^{
                 [self handleSystemExtensionConfigChange];
-             }];
+            }];
             
         } else {
             
@@ -740,6 +811,10 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
             } else if ([keyPath isEqualToString:kMTDefaultsRemoteLoggingKey]) {
                 
                 [self initializeLogManager];
+                
+            } else if ([keyPath isEqualToString:kMTDefaultsRequestRateLimitsKey]) {
+                
+                self.rateLimiter = [[MTRateLimiter alloc] initWithConfiguration:[_privilegesApp requestRateLimits]];
             }
             
             // update the status item if needed
@@ -778,6 +853,17 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     return ([[_privilegesApp currentUser] hasAdminPrivileges]);
 }
 
+- (BOOL)userIsKnownStandardUser
+{
+    // the membership is checked without the membership cache, so an outdated
+    // entry cannot keep us from revoking privileges. If the membership cannot
+    // be determined, we don't know whether the user is a standard user
+    NSError *error = nil;
+    BOOL isMember = [MTIdentity groupMembershipForUser:[[_privilegesApp currentUser] userName] groupID:kMTAdminGroupID error:&error];
+    
+    return (!error && !isMember);
+}
+
 #pragma mark - NSStatusItem
 
 - (void)showStatusItem:(BOOL)status
@@ -882,10 +968,7 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
 
 - (void)updateRemainingTimeForStatusItem
 {
-    if (_statusItemTimer) {
-        [_statusItemTimer invalidate];
-        _statusItemTimer = nil;
-    }
+    [_scheduler cancelDeadlineWithIdentifier:kMTDeadlineStatusItemUpdate];
     
     if ([_privilegesApp showRemainingTimeInMenuBar]) {
         
@@ -894,16 +977,7 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
         if ([self privilegesTimeLeft] > 0) {
             
             [self updateStatusItemTimerWithAttributedString:[self timeStringForStatusItem]];
-            
-            _statusItemTimer = [NSTimer scheduledTimerWithTimeInterval:.5
-                                                               repeats:YES
-                                                                 block:^(NSTimer *timer) {
-                
-                    [self updateStatusItemTimerWithAttributedString:[self timeStringForStatusItem]];
-            }];
-            
-            // make sure the timer is updating even if the status item's menu is open
-            [[NSRunLoop currentRunLoop] addTimer:_statusItemTimer forMode:NSEventTrackingRunLoopMode];
+            [self scheduleStatusItemUpdate];
             
         } else {
             
@@ -921,6 +995,26 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     }
 }
 
+- (void)scheduleStatusItemUpdate
+{
+    NSDate *expirationDate = _timerExpirationDate;
+    NSTimeInterval timeLeft = [expirationDate timeIntervalSinceNow];
+    
+    if (timeLeft > 0) {
+        
+        // the remaining time is shown in full seconds, so we
+        // update the status item when the next second begins
+        [_scheduler scheduleDeadlineWithIdentifier:kMTDeadlineStatusItemUpdate
+                                          fireDate:[expirationDate dateByAddingTimeInterval:-(ceil(timeLeft) - 1)]
+                                         tolerance:kMTStatusItemUpdateTolerance
+                                           handler:^{
+            
+            [self updateStatusItemTimerWithAttributedString:[self timeStringForStatusItem]];
+            [self scheduleStatusItemUpdate];
+        }];
+    }
+}
+
 - (void)updateImageForStatusItem
 {
     NSString *iconName = ([self userHasAdminPrivileges]) ? @"unlocked" : @"locked";
@@ -946,7 +1040,7 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
                                                                    forKey:NSFontAttributeName
         ];
         
-        timeString = [[NSAttributedString alloc] initWithString:[formatter stringFromTimeInterval:interval]
+        timeString = [[NSAttributedString alloc] initWithString:[formatter stringFromTimeInterval:ceil(interval)]
                                                      attributes:textAttributes
         ];
     }
@@ -956,10 +1050,7 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
 
 - (void)updateStatusItemTimerWithAttributedString:(NSAttributedString*)timerString
 {
-    if (_animationTimer) {
-        [_animationTimer invalidate];
-        _animationTimer = nil;
-    }
+    [_scheduler cancelDeadlineWithIdentifier:kMTDeadlineStatusItemAnimation];
     
     if (timerString) {
         
@@ -972,28 +1063,11 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
         
         if (canBeAnimated) {
 
-            __block NSInteger i = (showTimer) ? 0 : timerStringLength;
-            if (!showTimer) { i = currentStringLength; }
-            
-            _animationTimer = [NSTimer scheduledTimerWithTimeInterval:.03
-                                                              repeats:YES
-                                                                block:^(NSTimer *timer) {
-                
-                if (showTimer && i < timerStringLength) {
-                    
-                    [[self->_statusItem button] setAttributedTitle:[timerString attributedSubstringFromRange:NSMakeRange(0, ++i)]];
-                    
-                } else if (!showTimer && i > 0) {
-                    
-                    [[self->_statusItem button] setAttributedTitle:[currentString attributedSubstringFromRange:NSMakeRange(0, i--)]];
-                    
-                } else {
-                    
-                    if (!showTimer) { [[self->_statusItem button] setTitle:@""]; }
-                    [timer invalidate];
-                    timer = nil;
-                }
-            }];
+            // type the timer string in or delete the current string character by character
+            [self scheduleStatusItemAnimationWithTitle:(showTimer) ? timerString : currentString
+                                                length:(showTimer) ? 1 : currentStringLength - 1
+                                                  step:(showTimer) ? 1 : -1
+            ];
                         
         } else {
             
@@ -1006,6 +1080,28 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     }
 }
 
+- (void)scheduleStatusItemAnimationWithTitle:(NSAttributedString*)title length:(NSInteger)length step:(NSInteger)step
+{
+    [_scheduler scheduleDeadlineWithIdentifier:kMTDeadlineStatusItemAnimation
+                                      fireDate:[NSDate dateWithTimeIntervalSinceNow:kMTStatusItemAnimationInterval]
+                                     tolerance:kMTStatusItemAnimationTolerance
+                                       handler:^{
+        
+        if (length > 0) {
+            
+            [[self->_statusItem button] setAttributedTitle:[title attributedSubstringFromRange:NSMakeRange(0, length)]];
+            
+            if (length + step <= (NSInteger)[title length]) {
+                [self scheduleStatusItemAnimationWithTitle:title length:length + step step:step];
+            }
+            
+        } else {
+            
+            [[self->_statusItem button] setTitle:@""];
+        }
+    }];
+}
+
 - (void)changePrivilegesFromStatusItem
 {
     if ([self userHasAdminPrivileges]) {
@@ -1013,7 +1109,9 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
         // we provide dummy completion handlers here instead of nil,
         // to make sure the script or application runs after privileges
         // changed (if configured)
-        [self revokeAdminRightsWithCompletionHandler:^(BOOL success) { return; }];
+        [self revokeAdminRightsWithCallerClass:MTRateLimiterCallerClassGUI
+                             completionHandler:^(BOOL success, NSError *error) { return; }
+        ];
         
     } else {
         
@@ -1031,14 +1129,20 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
                 if (success) {
                     
                     dispatch_async(dispatch_get_main_queue(), ^{
-                        [self requestAdminRightsWithReason:nil completionHandler:^(BOOL success) { return; }];
+                        [self requestAdminRightsWithReason:nil
+                                               callerClass:MTRateLimiterCallerClassGUI
+                                         completionHandler:^(BOOL success, NSError *error) { return; }
+                        ];
                     });
                 }
             }];
             
         } else {
             
-            [self requestAdminRightsWithReason:nil completionHandler:^(BOOL success) { return; }];
+            [self requestAdminRightsWithReason:nil
+                                   callerClass:MTRateLimiterCallerClassGUI
+                             completionHandler:^(BOOL success, NSError *error) { return; }
+            ];
         }
     }
 }
@@ -1081,8 +1185,44 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
 
 #pragma mark - Notifications
 
+- (void)publishPrivilegeState
+{
+    if (_statePage) {
+        
+        NSString *enforcedPrivileges = [_privilegesApp enforcedPrivilegeType];
+        MTStateEnforcement enforcement = MTStateEnforcementNotEnforced;
+        
+        if ([enforcedPrivileges isEqualToString:kMTEnforcedPrivilegeTypeNone]) {
+            enforcement = MTStateEnforcementNone;
+        } else if ([enforcedPrivileges isEqualToString:kMTEnforcedPrivilegeTypeAdmin]) {
+            enforcement = MTStateEnforcementAdmin;
+        } else if ([enforcedPrivileges isEqualToString:kMTEnforcedPrivilegeTypeUser]) {
+            enforcement = MTStateEnforcementUser;
+        }
+        
+        NSDate *expirationDate = _timerExpirationDate;
+        
+        mt_state_t state = {
+            .hasAdminPrivileges = [self userHasAdminPrivileges],
+            .expirationTime = (expirationDate) ? llround([expirationDate timeIntervalSince1970]) : 0,
+            .enforcement = enforcement
+        };
+        
+        // the page must only have one writer at a time
+        @synchronized (self) {
+            
+            state.configGeneration = _configGeneration;
+            mt_state_page_write(_statePage, &state);
+        }
+    }
+}
+
 - (void)postPrivilegesChangedNotification
 {
+    // make sure we publish the new group membership
+    [[MTGroupMembershipCache sharedCache] invalidate];
+    [self publishPrivilegeState];
+    
     [[NSDistributedNotificationCenter defaultCenter] postNotificationName:kMTNotificationNamePrivilegesDidChange
                                                                    object:nil
                                                                  userInfo:nil
@@ -1092,6 +1232,8 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
 
 - (void)postAutoRevokeIntervalUpdateNotificationWithInterval:(NSUInteger)interval
 {
+    [self publishPrivilegeState];
+    
     [[NSDistributedNotificationCenter defaultCenter] postNotificationName:kMTNotificationNameExpirationTimeLeft
                                                                    object:nil
                                                                  userInfo:[NSDictionary dictionaryWithObject:[NSNumber numberWithInteger:interval] forKey:kMTNotificationKeyTimeLeft]
@@ -1101,6 +1243,9 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
 
 - (void)postConfigurationChangeNotificationForKeyPath:(NSString*)keyPath
 {
+    @synchronized (self) { _configGeneration++; }
+    [self publishPrivilegeState];
+    
     [[NSDistributedNotificationCenter defaultCenter] postNotificationName:kMTNotificationNameConfigDidChange
                                                                    object:nil
                                                                  userInfo:[NSDictionary dictionaryWithObject:keyPath forKey:kMTNotificationKeyPreferencesChanged]
@@ -1118,8 +1263,62 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
         os_log(OS_LOG_DEFAULT, "SAPCorp: Revoking administrator privileges for user %{public}@ because system time changed", [[self->_privilegesApp currentUser] userName]);
         
         // remove admin rights
-        [self revokeAdminRightsWithCompletionHandler:^(BOOL success) { return; }];
+        [self revokeAdminRightsWithCompletionHandler:^(BOOL success, NSError *error) { return; }];
+    }
+}
+
+#pragma mark - Rate limiting
+
+- (MTRateLimiterCallerClass)callerClassOfCurrentConnection
+{
+    // requests that are not sent via xpc are triggered by the agent itself
+    MTRateLimiterCallerClass callerClass = MTRateLimiterCallerClassTimer;
+    NSXPCConnection *connection = [NSXPCConnection currentConnection];
+    
+    if (connection) {
+        
+        // unlike the process name, the signing identifier cannot be changed
+        // without breaking the code signature the connection was validated with
+        NSString *signingIdentifier = [MTCodeSigning signingIdentifierOfProcessWithAuditToken:((ExtendedNSXPCConnection*)connection).auditToken];
+        callerClass = ([signingIdentifier isEqualToString:kMTCLIBundleIdentifier]) ? MTRateLimiterCallerClassCLI : MTRateLimiterCallerClassGUI;
+    }
+    
+    return callerClass;
+}
+
+- (BOOL)admitPrivilegeRequestFromCallerClass:(MTRateLimiterCallerClass)callerClass grantAdminPrivileges:(BOOL)grant error:(NSError**)error
+{
+    BOOL admitted = YES;
+    MTRateLimiter *rateLimiter = self.rateLimiter;
+    
+    if (!grant) {
+        
+        // revocations are never rejected, no matter who requested them
+        [rateLimiter accountRequestFromCallerClass:callerClass];
+        
+    } else {
+        
+        NSTimeInterval retryAfter = 0;
+        
+        if (rateLimiter && ![rateLimiter admitRequestFromCallerClass:callerClass retryAfter:&retryAfter]) {
+            
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Privilege change request rejected because the rate limit for %{public}@ requests has been exceeded (retry in %.1f seconds)", [MTRateLimiter nameOfCallerClass:callerClass], retryAfter);
+            admitted = NO;
+            
+            if (error) {
+                
+                NSDictionary *errorDetail = [NSDictionary dictionaryWithObjectsAndKeys:
+                                             @"Too many privilege change requests", NSLocalizedDescriptionKey,
+                                             [NSNumber numberWithDouble:retryAfter], kMTErrorRetryAfterKey,
+                                             nil
+                ];
+                
+                *error = [NSError errorWithDomain:kMTErrorDomain code:kMTErrorCodeRateLimitExceeded userInfo:errorDetail];
+            }
+        }
     }
+    
+    return admitted;
 }
 
 #pragma mark - Exported methods
@@ -1129,12 +1328,32 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     if (reply) { reply([_listener endpoint]); }
 }
 
-- (void)requestAdminRightsWithReason:(NSString*)reason completionHandler:(void(^)(BOOL success))completionHandler
+- (void)rateLimiterStatisticsWithReply:(void(^)(NSDictionary *statistics))reply
+{
+    if (reply) { reply([self.rateLimiter statistics]); }
+}
+
+- (void)requestAdminRightsWithReason:(NSString*)reason completionHandler:(void(^)(BOOL success, NSError *error))completionHandler
+{
+    [self requestAdminRightsWithReason:reason
+                           callerClass:[self callerClassOfCurrentConnection]
+                     completionHandler:completionHandler
+    ];
+}
+
+- (void)requestAdminRightsWithReason:(NSString*)reason
+                         callerClass:(MTRateLimiterCallerClass)callerClass
+                   completionHandler:(void(^)(BOOL success, NSError *error))completionHandler
 {
     BOOL isRestricted = [[_privilegesApp currentUser] useIsRestricted];
     BOOL adminEnforced = [[_privilegesApp enforcedPrivilegeType] isEqualToString:kMTEnforcedPrivilegeTypeAdmin];
+    NSError *rateLimitError = nil;
     
-    if (!isRestricted || adminEnforced) {
+    if (![self admitPrivilegeRequestFromCallerClass:callerClass grantAdminPrivileges:YES error:&rateLimitError]) {
+        
+        if (completionHandler) { completionHandler(NO, rateLimitError); }
+        
+    } else if (!isRestricted || adminEnforced) {
         
         _ignoreAdminGroupChanges = YES;
         
@@ -1144,12 +1363,14 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
                 
                 os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to connect to daemon: %{public}@", error);
                 self->_ignoreAdminGroupChanges = NO;
-                if (completionHandler) { completionHandler(NO); }
+                if (completionHandler) { completionHandler(NO, error); }
                 
             }] grantAdminRightsToUser:[[self->_privilegesApp currentUser] userName]
                                reason:reason
+                            component:[MTRateLimiter nameOfCallerClass:callerClass]
                     completionHandler:^(BOOL success) {
                                 
+                [[MTGroupMembershipCache sharedCache] invalidate];
                 self->_adminRightsExpected = success;
                 
                 if (!isRestricted && !adminEnforced) {
@@ -1202,24 +1423,45 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
                 
                 self->_ignoreAdminGroupChanges = NO;
                 
-                if (completionHandler) { completionHandler(success); }
+                if (completionHandler) { completionHandler(success, nil); }
                 
             }];
         }];
         
     } else {
         
-        if (completionHandler) { completionHandler(NO); }
+        if (completionHandler) { completionHandler(NO, nil); }
     }
 }
 
-- (void)revokeAdminRightsWithCompletionHandler:(void(^)(BOOL success))completionHandler
+- (void)revokeAdminRightsWithCompletionHandler:(void(^)(BOOL success, NSError *error))completionHandler
+{
+    [self revokeAdminRightsWithCallerClass:[self callerClassOfCurrentConnection]
+                         completionHandler:completionHandler
+    ];
+}
+
+- (void)revokeAdminRightsWithCallerClass:(MTRateLimiterCallerClass)callerClass
+                       completionHandler:(void(^)(BOOL success, NSError *error))completionHandler
 {
     BOOL isRestricted = [[_privilegesApp currentUser] useIsRestricted];
     BOOL userEnforced = [[_privilegesApp enforcedPrivilegeType] isEqualToString:kMTEnforcedPrivilegeTypeUser];
     NSString *reason = ([self privilegesTimeLeft] > 0) ? @"requested by user" : @"privileges expired";
     
-    if (!isRestricted || userEnforced) {
+    // revocations are never rejected, so requests for users that don't have administrator
+    // privileges anymore are answered right away, without changing the group record again
+    [self admitPrivilegeRequestFromCallerClass:callerClass grantAdminPrivileges:NO error:nil];
+    
+    if ((!isRestricted || userEnforced) && [self userIsKnownStandardUser]) {
+        
+        os_log(OS_LOG_DEFAULT, "SAPCorp: User %{public}@ already has standard user privileges", [[self->_privilegesApp currentUser] userName]);
+        
+        [self invalidateExpirationTimer];
+        _adminRightsExpected = NO;
+        
+        if (completionHandler) { completionHandler(YES, nil); }
+        
+    } else if (!isRestricted || userEnforced) {
         
         [self invalidateExpirationTimer];
         _ignoreAdminGroupChanges = YES;
@@ -1230,12 +1472,14 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
                 
                 os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to connect to daemon: %{public}@", error);
                 self->_ignoreAdminGroupChanges = NO;
-                if (completionHandler) { completionHandler(NO); }
+                if (completionHandler) { completionHandler(NO, error); }
                 
             }] removeAdminRightsFromUser:[[self->_privilegesApp currentUser] userName]
                                   reason:reason
+                               component:[MTRateLimiter nameOfCallerClass:callerClass]
                        completionHandler:^(BOOL success) {
                 
+                [[MTGroupMembershipCache sharedCache] invalidate];
                 self->_adminRightsExpected = !success;
                 
                 if (!isRestricted && !userEnforced) {
@@ -1283,22 +1527,26 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
                 
                 self->_ignoreAdminGroupChanges = NO;
                 
-                if (completionHandler) { completionHandler(success); }
+                if (completionHandler) { completionHandler(success, nil); }
                 
             }];
         }];
         
     } else {
         
-        if (completionHandler) { completionHandler(NO); }
+        if (completionHandler) { completionHandler(NO, nil); }
     }
 }
 
-- (void)renewAdminRightsWithCompletionHandler:(void(^)(BOOL success))completionHandler
+- (void)renewAdminRightsWithCompletionHandler:(void(^)(BOOL success, NSError *error))completionHandler
 {
     BOOL success = NO;
+    NSError *rateLimitError = nil;
     
-    if ([self userHasAdminPrivileges] && [_expirationTimer isValid]) {
+    // check the preconditions first, so renewals that would not change
+    // anything do not use up the rate limit
+    if ([self userHasAdminPrivileges] && self->_timerExpirationDate &&
+        [self admitPrivilegeRequestFromCallerClass:MTRateLimiterCallerClassRenewal grantAdminPrivileges:YES error:&rateLimitError]) {
             
         [self scheduleExpirationTimerWithInterval:[_privilegesApp expirationInterval] isSavedTimer:NO];
         success = YES;
@@ -1306,7 +1554,7 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     
     [self displayNotificationOfType:(success) ? MTLocalNotificationTypeRenewSuccess : MTLocalNotificationTypeError];
     
-    if (completionHandler) { completionHandler(success); }
+    if (completionHandler) { completionHandler(success, rateLimitError); }
     
 }
 
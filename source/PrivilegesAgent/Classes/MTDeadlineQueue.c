@@ -0,0 +1,213 @@
+/*
+    MTDeadlineQueue.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTDeadlineQueue.h"
+#include <errno.h>
+#include <stdlib.h>
+
+typedef struct {
+    uint64_t deadline;
+    uint64_t latest;                // deadline plus tolerance
+    uint32_t key;
+} mt_deadline_t;
+
+struct mt_deadline_queue {
+    mt_deadline_t *heap;
+    uint32_t *positions;            // heap index + 1 per key (0 = not scheduled)
+    uint32_t count;
+    uint32_t capacity;
+};
+
+static inline void mt_deadline_queue_place(mt_deadline_queue_t *queue, uint32_t index, mt_deadline_t deadline)
+{
+    queue->heap[index] = deadline;
+    queue->positions[deadline.key] = index + 1;
+}
+
+static void mt_deadline_queue_sift_up(mt_deadline_queue_t *queue, uint32_t index)
+{
+    mt_deadline_t deadline = queue->heap[index];
+    
+    while (index > 0 && queue->heap[(index - 1) / 2].deadline > deadline.deadline) {
+        
+        mt_deadline_queue_place(queue, index, queue->heap[(index - 1) / 2]);
+        index = (index - 1) / 2;
+    }
+    
+    mt_deadline_queue_place(queue, index, deadline);
+}
+
+static void mt_deadline_queue_sift_down(mt_deadline_queue_t *queue, uint32_t index)
+{
+    mt_deadline_t deadline = queue->heap[index];
+    
+    for (;;) {
+        
+        uint32_t child = index * 2 + 1;
+        if (child >= queue->count) { break; }
+        if (child + 1 < queue->count && queue->heap[child + 1].deadline < queue->heap[child].deadline) { child++; }
+        if (queue->heap[child].deadline >= deadline.deadline) { break; }
+        
+        mt_deadline_queue_place(queue, index, queue->heap[child]);
+        index = child;
+    }
+    
+    mt_deadline_queue_place(queue, index, deadline);
+}
+
+// removes the entry at the given heap index by moving the last entry into its place
+static void mt_deadline_queue_remove(mt_deadline_queue_t *queue, uint32_t index)
+{
+    queue->positions[queue->heap[index].key] = 0;
+    queue->count--;
+    
+    if (index < queue->count) {
+        
+        mt_deadline_t last = queue->heap[queue->count];
+        queue->heap[index] = last;
+        mt_deadline_queue_sift_down(queue, index);
+        mt_deadline_queue_sift_up(queue, queue->positions[last.key] - 1);
+    }
+}
+
+// returns the smallest deadline plus tolerance in the subtree at the given index. Subtrees
+// whose root is not due before the current result cannot contain a smaller one, so most
+// of the heap is skipped
+static uint64_t mt_deadline_queue_min_latest(const mt_deadline_queue_t *queue, uint32_t index, uint64_t result)
+{
+    if (index < queue->count && queue->heap[index].deadline < result) {
+        
+        if (queue->heap[index].latest < result) { result = queue->heap[index].latest; }
+        result = mt_deadline_queue_min_latest(queue, index * 2 + 1, result);
+        result = mt_deadline_queue_min_latest(queue, index * 2 + 2, result);
+    }
+    
+    return result;
+}
+
+#pragma mark - Public functions
+
+mt_deadline_queue_t *mt_deadline_queue_create(uint32_t capacity)
+{
+    mt_deadline_queue_t *queue = calloc(1, sizeof(mt_deadline_queue_t));
+    
+    if (queue) {
+        
+        queue->capacity = capacity;
+        queue->heap = calloc((capacity > 0) ? capacity : 1, sizeof(mt_deadline_t));
+        queue->positions = calloc((capacity > 0) ? capacity : 1, sizeof(uint32_t));
+        
+        if (!queue->heap || !queue->positions) {
+            
+            mt_deadline_queue_destroy(queue);
+            queue = NULL;
+        }
+    }
+    
+    return queue;
+}
+
+void mt_deadline_queue_destroy(mt_deadline_queue_t *queue)
+{
+    if (queue) {
+        
+        free(queue->heap);
+        free(queue->positions);
+        free(queue);
+    }
+}
+
+bool mt_deadline_queue_schedule(mt_deadline_queue_t *queue, uint32_t key, uint64_t deadline, uint64_t tolerance)
+{
+    bool success = false;
+    
+    if (key < queue->capacity) {
+        
+        mt_deadline_t entry = {
+            .deadline = deadline,
+            .latest = (deadline > UINT64_MAX - tolerance) ? UINT64_MAX : deadline + tolerance,
+            .key = key
+        };
+        
+        uint32_t index = queue->positions[key];
+        
+        if (index > 0) {
+            
+            // move the existing deadline in whatever direction it changed
+            queue->heap[index - 1] = entry;
+            mt_deadline_queue_sift_up(queue, index - 1);
+            mt_deadline_queue_sift_down(queue, queue->positions[key] - 1);
+            
+        } else {
+            
+            queue->heap[queue->count] = entry;
+            mt_deadline_queue_sift_up(queue, queue->count++);
+        }
+        
+        success = true;
+        
+    } else {
+        
+        errno = EINVAL;
+    }
+    
+    return success;
+}
+
+bool mt_deadline_queue_cancel(mt_deadline_queue_t *queue, uint32_t key)
+{
+    bool scheduled = mt_deadline_queue_is_scheduled(queue, key);
+    if (scheduled) { mt_deadline_queue_remove(queue, queue->positions[key] - 1); }
+    
+    return scheduled;
+}
+
+bool mt_deadline_queue_is_scheduled(const mt_deadline_queue_t *queue, uint32_t key)
+{
+    return (key < queue->capacity && queue->positions[key] > 0);
+}
+
+size_t mt_deadline_queue_count(const mt_deadline_queue_t *queue)
+{
+    return queue->count;
+}
+
+bool mt_deadline_queue_next_wakeup(const mt_deadline_queue_t *queue, uint64_t *earliest, uint64_t *latest)
+{
+    bool scheduled = (queue->count > 0);
+    
+    if (scheduled) {
+        
+        if (earliest) { *earliest = queue->heap[0].deadline; }
+        if (latest) { *latest = mt_deadline_queue_min_latest(queue, 0, UINT64_MAX); }
+    }
+    
+    return scheduled;
+}
+
+bool mt_deadline_queue_pop(mt_deadline_queue_t *queue, uint64_t now, uint32_t *key)
+{
+    bool due = (queue->count > 0 && queue->heap[0].deadline <= now);
+    
+    if (due) {
+        
+        if (key) { *key = queue->heap[0].key; }
+        mt_deadline_queue_remove(queue, 0);
+    }
+    
+    return due;
+}
@@ -0,0 +1,114 @@
+/*
+    MTDeadlineQueue.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTDeadlineQueue_h
+#define MTDeadlineQueue_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    A min-heap of deadlines, so a single timer can serve any number of deadlines. Every deadline
+    is identified by a small key (0 to capacity - 1), and scheduling a key again just moves its
+    deadline. Each deadline has a tolerance, the time it may be delivered late. The queue uses
+    the tolerances to coalesce deadlines: instead of waking up for every deadline, the caller
+    arms its timer for the window returned by mt_deadline_queue_next_wakeup, which ends at the
+    latest time no deadline is delivered later than allowed, and then delivers all deadlines
+    that are due at once. Deadlines are never delivered early.
+ 
+    All times are in nanoseconds of a clock chosen by the caller. The queue is not thread-safe.
+*/
+
+typedef struct mt_deadline_queue mt_deadline_queue_t;
+
+/*!
+ @function      mt_deadline_queue_create
+ @abstract      Creates an empty queue.
+ @param         capacity The number of keys.
+ @discussion    Returns the queue or NULL if an error occurred (errno is set). The caller is responsible
+                for releasing the queue using mt_deadline_queue_destroy.
+*/
+mt_deadline_queue_t *mt_deadline_queue_create(uint32_t capacity);
+
+/*!
+ @function      mt_deadline_queue_destroy
+ @abstract      Releases the given queue.
+ @param         queue A pointer to the queue. May be NULL.
+*/
+void mt_deadline_queue_destroy(mt_deadline_queue_t *queue);
+
+/*!
+ @function      mt_deadline_queue_schedule
+ @abstract      Schedules a deadline for the given key.
+ @param         queue A pointer to the queue.
+ @param         key The key of the deadline.
+ @param         deadline The time the deadline is due.
+ @param         tolerance The time the deadline may be delivered after it's due.
+ @discussion    Replaces a deadline that is already scheduled for the key. Returns false if the key is
+                out of range (errno is set to EINVAL).
+*/
+bool mt_deadline_queue_schedule(mt_deadline_queue_t *queue, uint32_t key, uint64_t deadline, uint64_t tolerance);
+
+/*!
+ @function      mt_deadline_queue_cancel
+ @abstract      Cancels the deadline for the given key.
+ @param         queue A pointer to the queue.
+ @param         key The key of the deadline.
+ @discussion    Returns true if a deadline was scheduled for the key.
+*/
+bool mt_deadline_queue_cancel(mt_deadline_queue_t *queue, uint32_t key);
+
+/*!
+ @function      mt_deadline_queue_is_scheduled
+ @abstract      Returns whether a deadline is scheduled for the given key.
+ @param         queue A pointer to the queue.
+ @param         key The key of the deadline.
+*/
+bool mt_deadline_queue_is_scheduled(const mt_deadline_queue_t *queue, uint32_t key);
+
+/*!
+ @function      mt_deadline_queue_count
+ @abstract      Returns the number of scheduled deadlines.
+ @param         queue A pointer to the queue.
+*/
+size_t mt_deadline_queue_count(const mt_deadline_queue_t *queue);
+
+/*!
+ @function      mt_deadline_queue_next_wakeup
+ @abstract      Returns the window for the next wakeup.
+ @param         queue A pointer to the queue.
+ @param         earliest A pointer to a variable that receives the earliest deadline.
+ @param         latest A pointer to a variable that receives the earliest time a deadline plus its
+                tolerance ends. It's not before earliest.
+ @discussion    Returns false if no deadline is scheduled. Waking up anywhere in the window delivers
+                every deadline that is due in time.
+*/
+bool mt_deadline_queue_next_wakeup(const mt_deadline_queue_t *queue, uint64_t *earliest, uint64_t *latest);
+
+/*!
+ @function      mt_deadline_queue_pop
+ @abstract      Removes the earliest deadline if it's due.
+ @param         queue A pointer to the queue.
+ @param         now The current time.
+ @param         key A pointer to a variable that receives the key of the deadline.
+ @discussion    Returns false if no deadline is due at the given time. Call this function until it returns
+                false to get all deadlines that are due, earliest first.
+*/
+bool mt_deadline_queue_pop(mt_deadline_queue_t *queue, uint64_t now, uint32_t *key);
+
+#endif /* MTDeadlineQueue_h */
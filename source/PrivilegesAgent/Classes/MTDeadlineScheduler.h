@@ -0,0 +1,77 @@
+/*
+    MTDeadlineScheduler.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @class         MTDeadlineScheduler
+ @abstract      A class that runs blocks at given dates, using a single timer for all of them.
+ @discussion    Instead of a timer per task, every task schedules a one-shot deadline at the date
+                something actually has to happen. The scheduler arms one wall clock timer for the
+                earliest deadline and uses the deadlines' tolerances to deliver as many deadlines
+                as possible with a single wakeup. As the timer is based on the wall clock, deadlines
+                that passed while the computer was asleep are delivered right after waking up.
+ 
+                The methods of this class are thread-safe. Handlers are always called on the main
+                queue, which is also served while a menu is open.
+*/
+
+@interface MTDeadlineScheduler : NSObject
+
+/*!
+ @method        init
+ @discussion    The init method is not available. Please use sharedScheduler instead.
+*/
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        sharedScheduler
+ @abstract      Returns the shared scheduler.
+*/
++ (instancetype)sharedScheduler;
+
+/*!
+ @method        scheduleDeadlineWithIdentifier:fireDate:tolerance:handler:
+ @abstract      Schedules a block to run at the given date.
+ @param         identifier A string identifying the deadline.
+ @param         fireDate The date the block should run at. A date in the past runs the block as soon as possible.
+ @param         tolerance The number of seconds the block may run after the given date.
+ @param         handler The block to run.
+ @discussion    A deadline that is already scheduled with the same identifier is replaced. Deadlines only run
+                once, so repeating tasks have to schedule their next deadline from the handler. Returns NO if
+                the deadline could not be scheduled, because too many deadlines are pending.
+*/
+- (BOOL)scheduleDeadlineWithIdentifier:(NSString*)identifier
+                              fireDate:(NSDate*)fireDate
+                             tolerance:(NSTimeInterval)tolerance
+                               handler:(void (^)(void))handler;
+
+/*!
+ @method        cancelDeadlineWithIdentifier:
+ @abstract      Cancels the deadline with the given identifier.
+ @param         identifier A string identifying the deadline.
+*/
+- (void)cancelDeadlineWithIdentifier:(NSString*)identifier;
+
+/*!
+ @method        hasDeadlineWithIdentifier:
+ @abstract      Returns whether a deadline with the given identifier is scheduled.
+ @param         identifier A string identifying the deadline.
+*/
+- (BOOL)hasDeadlineWithIdentifier:(NSString*)identifier;
+
+@end
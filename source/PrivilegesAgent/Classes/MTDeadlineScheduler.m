@@ -0,0 +1,257 @@
+/*
+    MTDeadlineScheduler.m
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTDeadlineScheduler.h"
+#import "MTDeadlineQueue.h"
+#import <os/log.h>
+
+#define kMTDeadlineSchedulerCapacity            32
+#define kMTDeadlineSchedulerStatisticsInterval  3600
+
+@interface MTDeadlineScheduler ()
+@property (nonatomic, strong, readwrite) NSMutableDictionary<NSString*, NSNumber*> *keys;
+@property (nonatomic, strong, readwrite) NSMutableDictionary<NSNumber*, NSString*> *identifiers;
+@property (nonatomic, strong, readwrite) NSMutableDictionary<NSNumber*, id> *handlers;
+@property (nonatomic, strong, readwrite) NSMutableIndexSet *freeKeys;
+@property (nonatomic, strong, readwrite) dispatch_source_t timer;
+@property (assign) mt_deadline_queue_t *queue;
+@property (assign) uint64_t armedDeadline;
+@property (assign) uint64_t armedLeeway;
+@property (assign) NSUInteger wakeups;
+@property (assign) NSUInteger deliveredDeadlines;
+@property (assign) uint64_t statisticsStartTime;
+- (instancetype)initPrivate;
+@end
+
+@implementation MTDeadlineScheduler
+
++ (instancetype)sharedScheduler
+{
+    static MTDeadlineScheduler *sharedScheduler = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        sharedScheduler = [[self alloc] initPrivate];
+    });
+    
+    return sharedScheduler;
+}
+
+- (instancetype)initPrivate
+{
+    self = [super init];
+    
+    if (self) {
+        
+        _queue = mt_deadline_queue_create(kMTDeadlineSchedulerCapacity);
+        
+        if (_queue) {
+            
+            _keys = [[NSMutableDictionary alloc] init];
+            _identifiers = [[NSMutableDictionary alloc] init];
+            _handlers = [[NSMutableDictionary alloc] init];
+            _freeKeys = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(0, kMTDeadlineSchedulerCapacity)];
+            _armedDeadline = UINT64_MAX;
+            _statisticsStartTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+            
+            _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+            dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+            dispatch_source_set_event_handler(_timer, ^{ [self timerFired]; });
+            dispatch_resume(_timer);
+            
+        } else {
+            
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to create deadline queue: %{public}s", strerror(errno));
+            self = nil;
+        }
+    }
+    
+    return self;
+}
+
+- (BOOL)scheduleDeadlineWithIdentifier:(NSString*)identifier
+                              fireDate:(NSDate*)fireDate
+                             tolerance:(NSTimeInterval)tolerance
+                               handler:(void (^)(void))handler
+{
+    BOOL success = NO;
+    
+    if (identifier && fireDate && handler) {
+        
+        NSTimeInterval fireTime = [fireDate timeIntervalSince1970];
+        uint64_t deadline = (fireTime > 0) ? (uint64_t)(fireTime * NSEC_PER_SEC) : 0;
+        uint64_t leeway = (tolerance > 0) ? (uint64_t)(tolerance * NSEC_PER_SEC) : 0;
+        
+        @synchronized (self) {
+            
+            NSNumber *key = [_keys objectForKey:identifier];
+            
+            if (!key && [_freeKeys count] > 0) {
+                
+                key = [NSNumber numberWithUnsignedInteger:[_freeKeys firstIndex]];
+                [_freeKeys removeIndex:[key unsignedIntegerValue]];
+                [_keys setObject:key forKey:identifier];
+                [_identifiers setObject:identifier forKey:key];
+            }
+            
+            if (key && mt_deadline_queue_schedule(_queue, [key unsignedIntValue], deadline, leeway)) {
+                
+                [_handlers setObject:[handler copy] forKey:key];
+                [self updateTimer];
+                success = YES;
+                
+            } else if (key && !mt_deadline_queue_is_scheduled(_queue, [key unsignedIntValue])) {
+                
+                [self releaseKey:key];
+            }
+        }
+        
+        if (!success) {
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to schedule deadline %{public}@", identifier);
+        }
+    }
+    
+    return success;
+}
+
+- (void)cancelDeadlineWithIdentifier:(NSString*)identifier
+{
+    if (identifier) {
+        
+        @synchronized (self) {
+            
+            NSNumber *key = [_keys objectForKey:identifier];
+            
+            if (key) {
+                
+                if (mt_deadline_queue_cancel(_queue, [key unsignedIntValue])) { [self updateTimer]; }
+                [self releaseKey:key];
+            }
+        }
+    }
+}
+
+- (BOOL)hasDeadlineWithIdentifier:(NSString*)identifier
+{
+    BOOL scheduled = NO;
+    
+    if (identifier) {
+        
+        @synchronized (self) {
+            
+            NSNumber *key = [_keys objectForKey:identifier];
+            scheduled = (key && mt_deadline_queue_is_scheduled(_queue, [key unsignedIntValue]));
+        }
+    }
+    
+    return scheduled;
+}
+
+- (void)releaseKey:(NSNumber*)key
+{
+    // must be called while synchronized. Identifiers only keep a key while their
+    // deadline is scheduled, so the queue's capacity limits the number of pending
+    // deadlines, not the number of identifiers ever used
+    NSString *identifier = [_identifiers objectForKey:key];
+    if (identifier) { [_keys removeObjectForKey:identifier]; }
+    
+    [_identifiers removeObjectForKey:key];
+    [_handlers removeObjectForKey:key];
+    [_freeKeys addIndex:[key unsignedIntegerValue]];
+}
+
+- (void)updateTimer
+{
+    // must be called while synchronized
+    uint64_t earliest = UINT64_MAX, latest = UINT64_MAX;
+    
+    if (mt_deadline_queue_next_wakeup(_queue, &earliest, &latest)) {
+        
+        // only reprogram the timer if the wakeup window changed
+        if (earliest != _armedDeadline || latest - earliest != _armedLeeway) {
+            
+            struct timespec fireTime = { .tv_sec = (time_t)(earliest / NSEC_PER_SEC), .tv_nsec = (long)(earliest % NSEC_PER_SEC) };
+            dispatch_source_set_timer(_timer, dispatch_walltime(&fireTime, 0), DISPATCH_TIME_FOREVER, latest - earliest);
+            
+            _armedDeadline = earliest;
+            _armedLeeway = latest - earliest;
+        }
+        
+    } else if (_armedDeadline != UINT64_MAX) {
+        
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        _armedDeadline = UINT64_MAX;
+    }
+}
+
+- (void)timerFired
+{
+    NSMutableArray *dueHandlers = [[NSMutableArray alloc] init];
+    
+    @synchronized (self) {
+        
+        // deliver every deadline that is due, not just
+        // the one the timer has been armed for
+        uint64_t now = clock_gettime_nsec_np(CLOCK_REALTIME);
+        uint32_t key = 0;
+        
+        while (mt_deadline_queue_pop(_queue, now, &key)) {
+            
+            NSNumber *keyNumber = [NSNumber numberWithUnsignedInt:key];
+            id handler = [_handlers objectForKey:keyNumber];
+            
+            if (handler) { [dueHandlers addObject:handler]; }
+            [self releaseKey:keyNumber];
+        }
+        
+        // the timer does not repeat, so it has to be armed again
+        _armedDeadline = UINT64_MAX;
+        [self updateTimer];
+        
+        _wakeups++;
+        _deliveredDeadlines += [dueHandlers count];
+        [self logStatisticsIfNeeded];
+    }
+    
+    // handlers may schedule new deadlines, so
+    // they must be called while not synchronized
+    for (void (^handler)(void) in dueHandlers) { handler(); }
+}
+
+- (void)logStatisticsIfNeeded
+{
+    // log the number of wakeups once per hour, so the
+    // effect of coalescing deadlines can be measured
+    uint64_t elapsedTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - _statisticsStartTime;
+    
+    if (elapsedTime >= kMTDeadlineSchedulerStatisticsInterval * NSEC_PER_SEC) {
+        
+        os_log_debug(OS_LOG_DEFAULT, "SAPCorp: Deadline scheduler: %lu wakeups for %lu deadlines in the last %llu seconds", (unsigned long)_wakeups, (unsigned long)_deliveredDeadlines, elapsedTime / NSEC_PER_SEC);
+        
+        _wakeups = 0;
+        _deliveredDeadlines = 0;
+        _statisticsStartTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    }
+}
+
+- (void)dealloc
+{
+    if (_timer) { dispatch_source_cancel(_timer); }
+    mt_deadline_queue_destroy(_queue);
+}
+
+@end
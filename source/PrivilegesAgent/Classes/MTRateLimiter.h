@@ -0,0 +1,95 @@
+/*
+    MTRateLimiter.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @enum          MTRateLimiterCallerClass
+ @abstract      Specifies the class of a caller requesting a privilege change.
+ @constant      MTRateLimiterCallerClassCLI Requests sent by PrivilegesCLI.
+ @constant      MTRateLimiterCallerClassGUI Requests sent by the Privileges app, the Dock tile or the status item.
+ @constant      MTRateLimiterCallerClassRenewal Requests to renew administrator privileges.
+ @constant      MTRateLimiterCallerClassTimer Requests triggered automatically by the agent (e.g. expiration,
+                screen lock or enforced privileges).
+*/
+typedef enum {
+    MTRateLimiterCallerClassCLI     = 0,
+    MTRateLimiterCallerClassGUI     = 1,
+    MTRateLimiterCallerClassRenewal = 2,
+    MTRateLimiterCallerClassTimer   = 3
+} MTRateLimiterCallerClass;
+
+/*!
+ @class         MTRateLimiter
+ @abstract      A class that limits the rate of privilege change requests per caller class.
+ @discussion    Every caller class has its own token bucket. The buckets are lock-free, so checking a request
+                neither blocks nor allocates memory. Caller classes without a configured limit admit every
+                request, but their requests are still counted.
+*/
+
+@interface MTRateLimiter : NSObject
+
+/*!
+ @method        init
+ @discussion    The init method is not available. Please use initWithConfiguration: instead.
+ */
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        initWithConfiguration:
+ @abstract      Initialize a MTRateLimiter object with the given configuration.
+ @param         configuration A dictionary containing the keys "CLI", "GUI", "Renewal" and/or "Timer". The value
+                of each key is a dictionary containing the "Capacity" (the maximum number of requests in a burst)
+                and the "RefillInterval" (the number of seconds after which another request is allowed). May be nil.
+ @discussion    Returns an initialized MTRateLimiter object.
+*/
+- (instancetype)initWithConfiguration:(NSDictionary*)configuration NS_DESIGNATED_INITIALIZER;
+
+/*!
+ @method        nameOfCallerClass:
+ @abstract      Returns the name of the given caller class, as used in the configuration.
+ @param         callerClass The class of the caller.
+*/
++ (NSString*)nameOfCallerClass:(MTRateLimiterCallerClass)callerClass;
+
+/*!
+ @method        admitRequestFromCallerClass:retryAfter:
+ @abstract      Checks whether a request of the given caller class is admitted.
+ @param         callerClass The class of the caller.
+ @param         retryAfter A reference to a NSTimeInterval that receives the number of seconds until the next request
+                of this class would be admitted, if the request has been rejected. May be NULL.
+ @discussion    Returns YES if the request has been admitted, otherwise returns NO.
+*/
+- (BOOL)admitRequestFromCallerClass:(MTRateLimiterCallerClass)callerClass retryAfter:(NSTimeInterval*)retryAfter;
+
+/*!
+ @method        accountRequestFromCallerClass:
+ @abstract      Counts a request of the given caller class that must not be rejected.
+ @param         callerClass The class of the caller.
+ @discussion    The request uses up a token, so it is taken into account for subsequent requests.
+*/
+- (void)accountRequestFromCallerClass:(MTRateLimiterCallerClass)callerClass;
+
+/*!
+ @method        statistics
+ @abstract      Returns the limits and counters of all caller classes.
+ @discussion    Returns a dictionary containing the caller class names ("CLI", "GUI", "Renewal" and "Timer") as keys
+                and dictionaries with the keys "Capacity", "RefillInterval", "Admitted" and "Rejected" as values.
+*/
+- (NSDictionary*)statistics;
+
+@end
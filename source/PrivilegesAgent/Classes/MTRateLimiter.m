@@ -0,0 +1,126 @@
+/*
+    MTRateLimiter.m
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTRateLimiter.h"
+#import "MTTokenBucket.h"
+#import "Constants.h"
+
+#define kMTRateLimiterCallerClassCount  4
+
+@implementation MTRateLimiter
+{
+    mt_token_bucket_t _buckets[kMTRateLimiterCallerClassCount];
+}
+
++ (NSArray*)callerClassNames
+{
+    // must match the order of MTRateLimiterCallerClass
+    return [NSArray arrayWithObjects:
+                kMTDefaultsRequestRateLimitCLIKey,
+                kMTDefaultsRequestRateLimitGUIKey,
+                kMTDefaultsRequestRateLimitRenewalKey,
+                kMTDefaultsRequestRateLimitTimerKey,
+                nil
+    ];
+}
+
++ (NSString*)nameOfCallerClass:(MTRateLimiterCallerClass)callerClass
+{
+    NSString *name = nil;
+    if (callerClass < kMTRateLimiterCallerClassCount) { name = [[self callerClassNames] objectAtIndex:callerClass]; }
+    
+    return name;
+}
+
+- (instancetype)initWithConfiguration:(NSDictionary*)configuration
+{
+    self = [super init];
+    
+    if (self) {
+        
+        NSArray *callerClassNames = [[self class] callerClassNames];
+        
+        for (NSUInteger i = 0; i < kMTRateLimiterCallerClassCount; i++) {
+            
+            uint32_t capacity = 0;
+            uint64_t refillInterval = 0;
+            id classConfiguration = [configuration objectForKey:[callerClassNames objectAtIndex:i]];
+            
+            if ([classConfiguration isKindOfClass:[NSDictionary class]]) {
+                
+                NSInteger configuredCapacity = [[classConfiguration objectForKey:kMTDefaultsRequestRateLimitCapacityKey] integerValue];
+                double configuredInterval = [[classConfiguration objectForKey:kMTDefaultsRequestRateLimitRefillIntervalKey] doubleValue];
+                
+                if (configuredCapacity > 0 && configuredCapacity <= UINT32_MAX && configuredInterval > 0) {
+                    
+                    capacity = (uint32_t)configuredCapacity;
+                    refillInterval = (uint64_t)(configuredInterval * NSEC_PER_SEC);
+                }
+            }
+            
+            mt_token_bucket_init(&_buckets[i], capacity, refillInterval);
+        }
+    }
+    
+    return self;
+}
+
+- (BOOL)admitRequestFromCallerClass:(MTRateLimiterCallerClass)callerClass retryAfter:(NSTimeInterval*)retryAfter
+{
+    BOOL admitted = YES;
+    
+    if (callerClass < kMTRateLimiterCallerClassCount) {
+        
+        uint64_t retryTime = 0;
+        admitted = mt_token_bucket_try_acquire(&_buckets[callerClass], clock_gettime_nsec_np(CLOCK_UPTIME_RAW), &retryTime);
+        
+        if (!admitted && retryAfter) { *retryAfter = (double)retryTime / NSEC_PER_SEC; }
+    }
+    
+    return admitted;
+}
+
+- (void)accountRequestFromCallerClass:(MTRateLimiterCallerClass)callerClass
+{
+    if (callerClass < kMTRateLimiterCallerClassCount) {
+        
+        mt_token_bucket_force_acquire(&_buckets[callerClass], clock_gettime_nsec_np(CLOCK_UPTIME_RAW));
+    }
+}
+
+- (NSDictionary*)statistics
+{
+    NSMutableDictionary *statistics = [[NSMutableDictionary alloc] init];
+    NSArray *callerClassNames = [[self class] callerClassNames];
+    
+    for (NSUInteger i = 0; i < kMTRateLimiterCallerClassCount; i++) {
+        
+        NSDictionary *classStatistics = [NSDictionary dictionaryWithObjectsAndKeys:
+                                         [NSNumber numberWithUnsignedInt:_buckets[i].capacity], kMTRateLimiterStatisticsCapacityKey,
+                                         [NSNumber numberWithDouble:(double)_buckets[i].refillInterval / NSEC_PER_SEC], kMTRateLimiterStatisticsRefillIntervalKey,
+                                         [NSNumber numberWithUnsignedLongLong:atomic_load(&_buckets[i].admitted)], kMTRateLimiterStatisticsAdmittedKey,
+                                         [NSNumber numberWithUnsignedLongLong:atomic_load(&_buckets[i].rejected)], kMTRateLimiterStatisticsRejectedKey,
+                                         nil
+        ];
+        
+        [statistics setObject:classStatistics forKey:[callerClassNames objectAtIndex:i]];
+    }
+    
+    return statistics;
+}
+
+@end
@@ -64,11 +64,28 @@
 */
 - (void)sendEvent:(NSDictionary*)event completionHandler:(void (^) (BOOL success, NSError *error))completionHandler;
 
+/*!
+ @method        warmUpConnection
+ @abstract      Establishes the connection to the remote logging server ahead of time, so the next event can
+                be sent on an established connection.
+ @discussion    If no event is sent within kMTRemoteLoggingWarmUpIdleTimeout seconds, the connection is closed
+                again. Calling this method while events are being sent has no effect.
+*/
+- (void)warmUpConnection;
+
 /*!
  @method        cancelRetries
  @abstract      Cancels all pending retries.
 */
 - (void)cancelRetries;
 
+/*!
+ @method        invalidate
+ @abstract      Stops the Remote Logging Manager and cancels all of its pending deadlines.
+ @discussion    Call this method before the object is replaced by another one. Events that
+                are sent afterwards are rejected.
+*/
+- (void)invalidate;
+
 @end
 
@@ -20,16 +20,23 @@
 #import "MTSyslog.h"
 #import "MTWebhook.h"
 #import "MTPrivileges.h"
+#import "MTDeadlineScheduler.h"
 #import "Constants.h"
 
+#define kMTDeadlineRemoteLoggingRetry   @"remotelogging.retry"
+#define kMTDeadlineRemoteLoggingIdle    @"remotelogging.idle"
+
 @interface MTRemoteLoggingManager ()
 @property (nonatomic, strong, readwrite) NSArray<NSNumber*> *retryIntervals;
 @property (nonatomic, strong, readwrite) NSMutableArray<NSDictionary*> *pendingDataQueue;
 @property (nonatomic, strong, readwrite) MTPrivileges *privilegesApp;
 @property (nonatomic, strong, readwrite) MTDaemonConnection *daemonConnection;
-@property (nonatomic, strong, readwrite) NSBackgroundActivityScheduler *retryActivity;
 @property (nonatomic, strong, readwrite) NSString *serverType;
 @property (nonatomic, strong, readwrite) id loggingObject;
+@property (nonatomic, strong, readwrite) NSString *retryDeadlineIdentifier;
+@property (nonatomic, strong, readwrite) NSString *idleDeadlineIdentifier;
+@property (assign) uint64_t eventSubmitTime;
+@property (assign) BOOL connectionIsWarm;
 @property (assign) NSUInteger currentRetryIndex;
 @property (assign) BOOL isSending;
 @property (assign) BOOL isRunning;
@@ -50,6 +57,12 @@
         _privilegesApp = [[MTPrivileges alloc] init];
         _daemonConnection = [[MTDaemonConnection alloc] init];
         _pendingDataQueue = [[NSMutableArray alloc] init];
+        
+        // the scheduler is shared, so the deadlines of a manager must
+        // not collide with the ones of a manager that replaced it
+        NSString *instanceIdentifier = [[NSUUID UUID] UUIDString];
+        _retryDeadlineIdentifier = [NSString stringWithFormat:@"%@.%@", kMTDeadlineRemoteLoggingRetry, instanceIdentifier];
+        _idleDeadlineIdentifier = [NSString stringWithFormat:@"%@.%@", kMTDeadlineRemoteLoggingIdle, instanceIdentifier];
                 
         MTPrivilegesLoggingConfiguration *remoteLoggingConfiguration = [_privilegesApp remoteLoggingConfiguration];
         
@@ -78,6 +91,7 @@
                 if (webhookURLString) { webhookURL = [NSURL URLWithString:webhookURLString]; }
                     
                 MTWebhook *webhookObject = [[MTWebhook alloc] initWithURL:webhookURL];
+                [webhookObject setOptions:[remoteLoggingConfiguration webhookOptions]];
                 _loggingObject = webhookObject;
                 
                 _serverType = kMTRemoteLoggingServerTypeWebhook;
@@ -145,7 +159,11 @@
         dispatch_async(dispatch_get_main_queue(), ^{
 
             // add the current event
-            if (event) { [self->_pendingDataQueue addObject:event]; }
+            if (event) {
+                
+                [self->_pendingDataQueue addObject:event];
+                if (self->_eventSubmitTime == 0) { self->_eventSubmitTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW); }
+            }
         
             // store all unsent data
             if (self->_queueUnsentEvents) {
@@ -184,6 +202,37 @@
     }
 }
 
+- (void)warmUpConnection
+{
+    dispatch_async(dispatch_get_main_queue(), ^{
+        
+        // the connection is only marked as warm if this call opened it, so
+        // the idle deadline never closes a connection that is in use
+        if (self->_isRunning && !self->_isSending && self->_loggingObject && [self->_loggingObject warmUpConnection]) {
+            
+            self->_connectionIsWarm = YES;
+            
+            // close the connection again if it has not been used
+            // within the given time
+            __weak MTRemoteLoggingManager *weakSelf = self;
+            
+            [[MTDeadlineScheduler sharedScheduler] scheduleDeadlineWithIdentifier:self->_idleDeadlineIdentifier
+                                                                         fireDate:[NSDate dateWithTimeIntervalSinceNow:kMTRemoteLoggingWarmUpIdleTimeout]
+                                                                        tolerance:kMTRemoteLoggingDeadlineTolerance
+                                                                          handler:^{
+                
+                MTRemoteLoggingManager *strongSelf = weakSelf;
+                
+                if (strongSelf && strongSelf->_connectionIsWarm && !strongSelf->_isSending) {
+                    
+                    [strongSelf->_loggingObject closeConnection];
+                    strongSelf->_connectionIsWarm = NO;
+                }
+            }];
+        }
+    });
+}
+
 - (void)sendNextEventWithCompletionHandler:(void (^) (BOOL success, NSError *error))completionHandler
 {
     dispatch_async(dispatch_get_main_queue(), ^{
@@ -310,6 +359,10 @@
     _isSending = NO;
 
     if (completionError) {
+        
+        // the event has not been delivered, so the latency of the
+        // next submission must not be measured from this one
+        _eventSubmitTime = 0;
 
         if (completionHandler) {
 
@@ -335,6 +388,20 @@
         // update queue after successful send
         dispatch_async(dispatch_get_main_queue(), ^{
             
+            // log the time it took to deliver the event, so the effect of
+            // warming up the connection can be measured
+            if (self->_eventSubmitTime > 0) {
+                
+                uint64_t elapsedTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - self->_eventSubmitTime;
+                os_log_debug(OS_LOG_DEFAULT, "SAPCorp: Remote logging event delivered after %llu ms (connection warmed up: %{public}@)", elapsedTime / NSEC_PER_MSEC, (self->_connectionIsWarm) ? @"yes" : @"no");
+                
+                self->_eventSubmitTime = 0;
+            }
+            
+            // the connection is now in regular use
+            [[MTDeadlineScheduler sharedScheduler] cancelDeadlineWithIdentifier:self->_idleDeadlineIdentifier];
+            self->_connectionIsWarm = NO;
+            
             if ([self->_pendingDataQueue count] > 0) { [self->_pendingDataQueue removeObjectAtIndex:0]; }
             
             if (self->_queueUnsentEvents) {
@@ -384,11 +451,15 @@
 
 - (void)cancelRetries
 {
-    if (_retryActivity) {
-        
-        [_retryActivity invalidate];
-        _retryActivity = nil;
-    }
+    [[MTDeadlineScheduler sharedScheduler] cancelDeadlineWithIdentifier:_retryDeadlineIdentifier];
+}
+
+- (void)invalidate
+{
+    _isRunning = NO;
+    
+    [self cancelRetries];
+    [[MTDeadlineScheduler sharedScheduler] cancelDeadlineWithIdentifier:_idleDeadlineIdentifier];
 }
 
 - (void)scheduleRetry
@@ -397,21 +468,18 @@
         
         NSInteger intervalIndex = MIN(self->_currentRetryIndex, [self->_retryIntervals count] - 1);
         NSTimeInterval interval = [[self->_retryIntervals objectAtIndex:intervalIndex] doubleValue];
+        __weak MTRemoteLoggingManager *weakSelf = self;
         
-        [self cancelRetries];
-    
-        self->_retryActivity = [[NSBackgroundActivityScheduler alloc] initWithIdentifier:@"corp.sap.privileges.remotelogging"];
-        if (interval >= 1) { [self->_retryActivity setInterval:interval]; }
-        if (interval > 10) { [self->_retryActivity setTolerance:10]; }
-        [self->_retryActivity scheduleWithBlock:^(NSBackgroundActivityCompletionHandler completionHandler) {
+        [[MTDeadlineScheduler sharedScheduler] scheduleDeadlineWithIdentifier:self->_retryDeadlineIdentifier
+                                                                     fireDate:[NSDate dateWithTimeIntervalSinceNow:interval]
+                                                                    tolerance:(interval > kMTRemoteLoggingDeadlineTolerance) ? kMTRemoteLoggingDeadlineTolerance : 0
+                                                                      handler:^{
             
-            [self sendNextEventWithCompletionHandler:^(BOOL success, NSError *error) {
+            [weakSelf sendNextEventWithCompletionHandler:^(BOOL success, NSError *error) {
                 
                 if (error) {
                     os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Remote logging failed: %{public}@", error);
                 }
-                
-                completionHandler(NSBackgroundActivityResultFinished);
             }];
         }];
     
@@ -464,7 +532,7 @@
 
 - (void)dealloc
 {
-    [self cancelRetries];
+    [self invalidate];
     _loggingObject = nil;
 }
 
@@ -53,4 +53,20 @@
 */
 - (void)writeData:(NSData*)data completionHandler:(void (^) (NSError *error))completionHandler;
 
+/*!
+@method        warmUpConnection
+@abstract      Connects to the syslog server (including the tls handshake, if tls is enabled)
+               without sending any data, so the next message can be sent on an established connection.
+@discussion    Must be called on the main queue. Returns YES if a new connection has been opened or NO
+               if the connection was already open.
+*/
+- (BOOL)warmUpConnection;
+
+/*!
+@method        closeConnection
+@abstract      Closes the connection to the syslog server. The connection is re-established
+               automatically when data is written the next time.
+*/
+- (void)closeConnection;
+
 @end
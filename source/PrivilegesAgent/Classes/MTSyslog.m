@@ -47,11 +47,11 @@
     return self;
 }
 
-- (void)ensureConnected
+- (BOOL)ensureConnected
 {
     if (_isConnected && _syslogTask && [_syslogTask state] == NSURLSessionTaskStateRunning) {
         
-        return;
+        return NO;
         
     } else {
         
@@ -71,6 +71,8 @@
         
         
         _isConnected = YES;
+        
+        return YES;
     }
 }
 
@@ -93,6 +95,25 @@
     });
 }
 
+- (BOOL)warmUpConnection
+{
+    return [self ensureConnected];
+}
+
+- (void)closeConnection
+{
+    dispatch_async(dispatch_get_main_queue(), ^{
+        
+        self->_isConnected = NO;
+        
+        if (self->_syslogTask) {
+            
+            [self->_syslogTask cancel];
+            self->_syslogTask = nil;
+        }
+    });
+}
+
 #pragma mark - NSURLSessionTaskDelegate
 
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error
@@ -0,0 +1,79 @@
+/*
+    MTTokenBucket.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTTokenBucket.h"
+
+void mt_token_bucket_init(mt_token_bucket_t *bucket, uint32_t capacity, uint64_t refillInterval)
+{
+    bucket->capacity = capacity;
+    bucket->refillInterval = refillInterval;
+    bucket->burstTolerance = (capacity > 0) ? refillInterval * (capacity - 1) : 0;
+    
+    atomic_init(&bucket->arrivalTime, 0);
+    atomic_init(&bucket->admitted, 0);
+    atomic_init(&bucket->rejected, 0);
+}
+
+int mt_token_bucket_try_acquire(mt_token_bucket_t *bucket, uint64_t now, uint64_t *retryAfter)
+{
+    int admitted = 1;
+    
+    if (bucket->capacity > 0) {
+        
+        uint64_t arrivalTime = atomic_load_explicit(&bucket->arrivalTime, memory_order_relaxed);
+        
+        for (;;) {
+            
+            uint64_t start = (arrivalTime > now) ? arrivalTime : now;
+            
+            if (start - now > bucket->burstTolerance) {
+                
+                if (retryAfter) { *retryAfter = start - now - bucket->burstTolerance; }
+                admitted = 0;
+                break;
+            }
+            
+            // on failure, arrivalTime is updated with the current value and we try again
+            if (atomic_compare_exchange_weak_explicit(&bucket->arrivalTime, &arrivalTime, start + bucket->refillInterval,
+                                                      memory_order_relaxed, memory_order_relaxed)) { break; }
+        }
+    }
+    
+    atomic_fetch_add_explicit((admitted) ? &bucket->admitted : &bucket->rejected, 1, memory_order_relaxed);
+    
+    return admitted;
+}
+
+void mt_token_bucket_force_acquire(mt_token_bucket_t *bucket, uint64_t now)
+{
+    if (bucket->capacity > 0) {
+        
+        uint64_t arrivalTime = atomic_load_explicit(&bucket->arrivalTime, memory_order_relaxed);
+        uint64_t limit = now + bucket->burstTolerance + bucket->refillInterval;
+        uint64_t nextArrival;
+        
+        // never move the arrival time further ahead than a full burst would, so
+        // forced requests cannot lock out other requests of the class indefinitely
+        do {
+            nextArrival = ((arrivalTime > now) ? arrivalTime : now) + bucket->refillInterval;
+            if (nextArrival > limit) { nextArrival = limit; }
+        } while (!atomic_compare_exchange_weak_explicit(&bucket->arrivalTime, &arrivalTime, nextArrival,
+                                                        memory_order_relaxed, memory_order_relaxed));
+    }
+    
+    atomic_fetch_add_explicit(&bucket->admitted, 1, memory_order_relaxed);
+}
@@ -0,0 +1,75 @@
+/*
+    MTTokenBucket.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTTokenBucket_h
+#define MTTokenBucket_h
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/*
+    A lock-free token bucket. Instead of a token counter that has to be refilled, the bucket
+    stores the "theoretical arrival time" of the next request (generic cell rate algorithm).
+    A request is admitted if this time is not more than the burst tolerance ahead of the
+    current time, and admitting it moves the time forward by one refill interval. This is
+    equivalent to a bucket holding up to "capacity" tokens that gets one new token per refill
+    interval, but only needs a single compare-and-swap per request.
+ 
+    All times are in nanoseconds of a monotonic clock.
+*/
+
+typedef struct {
+    _Atomic uint64_t arrivalTime;
+    _Atomic uint64_t admitted;
+    _Atomic uint64_t rejected;
+    uint64_t refillInterval;
+    uint64_t burstTolerance;
+    uint32_t capacity;
+} mt_token_bucket_t;
+
+/*!
+ @function      mt_token_bucket_init
+ @abstract      Initializes a full token bucket.
+ @param         bucket A pointer to the bucket.
+ @param         capacity The maximum number of tokens. Pass 0 for a bucket that admits every request.
+ @param         refillInterval The time (in nanoseconds) after which a new token is added.
+*/
+void mt_token_bucket_init(mt_token_bucket_t *bucket, uint32_t capacity, uint64_t refillInterval);
+
+/*!
+ @function      mt_token_bucket_try_acquire
+ @abstract      Takes a token from the bucket, if available.
+ @param         bucket A pointer to the bucket.
+ @param         now The current time (in nanoseconds).
+ @param         retryAfter A pointer to a variable that receives the time (in nanoseconds) until the next token
+                becomes available, if the request has been rejected. May be NULL.
+ @discussion    Returns 1 if the request has been admitted or 0 if it has been rejected.
+*/
+int mt_token_bucket_try_acquire(mt_token_bucket_t *bucket, uint64_t now, uint64_t *retryAfter);
+
+/*!
+ @function      mt_token_bucket_force_acquire
+ @abstract      Takes a token from the bucket, even if none is available.
+ @param         bucket A pointer to the bucket.
+ @param         now The current time (in nanoseconds).
+ @discussion    Use this function for requests that must never be rejected but should still be accounted for.
+                An empty bucket stays empty for at most one refill interval, no matter how many tokens
+                are forced out of it.
+*/
+void mt_token_bucket_force_acquire(mt_token_bucket_t *bucket, uint64_t now);
+
+#endif /* MTTokenBucket_h */
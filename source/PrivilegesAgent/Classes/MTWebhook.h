@@ -17,6 +17,7 @@
 
 #import <Foundation/Foundation.h>
 #import "MTPrivilegesUser.h"
+#import "MTWebhookOptions.h"
 
 /*!
  @class         MTWebhook
@@ -48,6 +49,15 @@
 @property (nonatomic, strong, readonly) NSDate *timeStamp;
 @property (assign) BOOL delayed;
 
+/*!
+ @property      options
+ @abstract      Specifies the webhook options.
+ @discussion    The value of this property is MTWebhookOptions. If set and a content encoding
+                is configured, request bodies exceeding the compression threshold are compressed
+                before they are posted.
+*/
+@property (nonatomic, strong, readwrite) MTWebhookOptions *options;
+
 /*!
  @method        init
  @discussion    The init method is not available. Please use initWithURL: instead.
@@ -83,6 +93,24 @@
 */
 - (void)postData:(NSData*)data completionHandler:(void (^) (NSError *error))completionHandler;
 
+/*!
+ @method        warmUpConnection
+ @abstract      Sends a HEAD request to the webhook to resolve the host name, establish the connection
+                and complete the tls handshake (including client certificate authentication) ahead of time.
+ @discussion    The response is ignored. The connection is then kept alive by the url session so the
+                next event can be posted without paying the connection setup costs. As the webhook
+                receives a request, the connection is only warmed up if this has been enabled in the
+                webhook options. Returns YES if the request has been sent or NO if warming up is not
+                enabled or data is currently being posted, so the connection is already in use.
+*/
+- (BOOL)warmUpConnection;
+
+/*!
+ @method        closeConnection
+ @abstract      Closes idle connections to the webhook. Future requests will use a new connection.
+*/
+- (void)closeConnection;
+
 /*!
  @method        composedDataWithDictionary:
  @abstract      Returns the composed webhook data from a given dictionary.
@@ -91,5 +119,16 @@
 */
 + (NSData*)composedDataWithDictionary:(NSDictionary*)dict;
 
+/*!
+ @method        compressedData:encoding:level:
+ @abstract      Returns the given data compressed with the given content encoding.
+ @param         data The data to compress.
+ @param         encoding The content encoding to use.
+ @param         level The compression level (1-9).
+ @discussion    Returns an NSData object or nil if an error occurred or no (or an unsupported)
+                content encoding has been specified.
+*/
++ (NSData*)compressedData:(NSData*)data encoding:(MTWebhookContentEncoding)encoding level:(NSInteger)level;
+
 @end
 
@@ -20,11 +20,13 @@
 #import "Constants.h"
 #import "MTClientCertificate.h"
 #import <os/log.h>
+#import <zlib.h>
 
 @interface MTWebhook ()
 @property (nonatomic, strong, readwrite) NSURL *url;
 @property (nonatomic, strong, readwrite) NSURLSession *session;
 @property (nonatomic, strong, readwrite) NSDate *timeStamp;
+@property (assign) NSUInteger activeRequests;
 @end
 
 @implementation MTWebhook
@@ -86,6 +88,42 @@
     return jsonData;
 }
 
++ (NSData*)compressedData:(NSData*)data encoding:(MTWebhookContentEncoding)encoding level:(NSInteger)level
+{
+    NSData *compressedData = nil;
+    
+    if ([data length] > 0 && encoding != MTWebhookContentEncodingNone) {
+        
+        // a window size of 15 produces zlib formatted data, adding
+        // 16 makes zlib write a gzip header and trailer instead
+        int windowBits = (encoding == MTWebhookContentEncodingGzip) ? 15 + 16 : 15;
+        
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        
+        if (deflateInit2(&stream, (int)level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+            
+            uLong bound = deflateBound(&stream, (uLong)[data length]);
+            NSMutableData *outputData = [NSMutableData dataWithLength:bound];
+            
+            stream.next_in = (Bytef*)[data bytes];
+            stream.avail_in = (uInt)[data length];
+            stream.next_out = (Bytef*)[outputData mutableBytes];
+            stream.avail_out = (uInt)bound;
+            
+            if (deflate(&stream, Z_FINISH) == Z_STREAM_END) {
+                
+                [outputData setLength:stream.total_out];
+                compressedData = outputData;
+            }
+            
+            deflateEnd(&stream);
+        }
+    }
+    
+    return compressedData;
+}
+
 - (NSData*)composedData
 {
     NSData *jsonData = [MTWebhook composedDataWithDictionary:[self dictionaryRepresentation]];
@@ -98,17 +136,76 @@
     NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:_url];
     [request setHTTPMethod:@"POST"];
     [request setValue:@"application/json;charset=utf-8" forHTTPHeaderField:@"Content-Type"];
+    
+    MTWebhookContentEncoding encoding = [_options contentEncoding];
+    
+    if (encoding != MTWebhookContentEncodingNone && [data length] >= [_options compressionThreshold]) {
+        
+        uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+        NSData *compressedData = [MTWebhook compressedData:data encoding:encoding level:[_options compressionLevel]];
+        uint64_t elapsedTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - startTime;
+        
+        // only use the compressed data if we actually saved some bytes
+        if (compressedData && [compressedData length] < [data length]) {
+            
+            os_log_debug(OS_LOG_DEFAULT, "SAPCorp: Compressed webhook data from %lu to %lu bytes (saved %lu bytes) in %llu µs", (unsigned long)[data length], (unsigned long)[compressedData length], (unsigned long)([data length] - [compressedData length]), elapsedTime / 1000);
+            
+            [request setValue:(encoding == MTWebhookContentEncodingGzip) ? @"gzip" : @"deflate" forHTTPHeaderField:@"Content-Encoding"];
+            data = compressedData;
+        }
+    }
+    
     [request setHTTPBody:data];
     
+    @synchronized (self) { _activeRequests++; }
+    
     NSURLSessionDataTask *dataTask = [_session dataTaskWithRequest:request
                                                  completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
-            
+        
+        @synchronized (self) { self->_activeRequests--; }
         if (completionHandler) { completionHandler(error); }
     }];
     
     [dataTask resume];
 }
 
+- (BOOL)warmUpConnection
+{
+    BOOL isIdle = NO;
+    @synchronized (self) { isIdle = (_activeRequests == 0); }
+    
+    // the HEAD request reaches the webhook like any other request (and
+    // might be logged there), so it's only sent if enabled. A connection
+    // that is currently used to post data is already warm
+    if (isIdle && [_options warmUpConnection]) {
+        
+        NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:_url];
+        [request setHTTPMethod:@"HEAD"];
+        [request setTimeoutInterval:10];
+        
+        NSURLSessionDataTask *dataTask = [_session dataTaskWithRequest:request
+                                                     completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+            
+            if (error) {
+                os_log_debug(OS_LOG_DEFAULT, "SAPCorp: Failed to warm up webhook connection: %{public}@", error);
+            }
+        }];
+        
+        [dataTask resume];
+        
+    } else {
+        
+        isIdle = NO;
+    }
+    
+    return isIdle;
+}
+
+- (void)closeConnection
+{
+    [_session flushWithCompletionHandler:^{ }];
+}
+
 - (void)URLSession:(NSURLSession *)session didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge completionHandler:(void (^)(NSURLSessionAuthChallengeDisposition, NSURLCredential *))completionHandler
 {
     NSURLProtectionSpace *protectionSpace = [challenge protectionSpace];
@@ -37,25 +37,32 @@
  @abstract      Request administrator privileges for the current user.
  @param         reason A string containing the reason the user requests administrator privileges. May be nil.
  @param         completionHandler The handler to call when the request is complete.
- @discussion    Returns YES if the operation was successful, otherwise returns NO.
+ @discussion    Returns YES if the operation was successful, otherwise returns NO. If the request has been rejected
+                because too many requests have been sent, the error object has the code kMTErrorCodeRateLimitExceeded
+                and its user info contains the number of seconds after which the request may be sent again
+                (kMTErrorRetryAfterKey).
 */
-- (void)requestAdminRightsWithReason:(NSString*)reason completionHandler:(void(^)(BOOL success))completionHandler;
+- (void)requestAdminRightsWithReason:(NSString*)reason completionHandler:(void(^)(BOOL success, NSError *error))completionHandler;
 
 /*!
  @method        revokeAdminPrivilegesWithCompletionHandler:
  @abstract      Revoke administrator privileges for the current user.
  @param         completionHandler The handler to call when the request is complete.
- @discussion    Returns YES if the operation was successful, otherwise returns NO.
+ @discussion    Returns YES if the operation was successful, otherwise returns NO. Revocations are never rate
+                limited, but if the user does not have administrator privileges, YES is returned without
+                changing the admin group again.
 */
-- (void)revokeAdminRightsWithCompletionHandler:(void(^)(BOOL success))completionHandler;
+- (void)revokeAdminRightsWithCompletionHandler:(void(^)(BOOL success, NSError *error))completionHandler;
 
 /*!
  @method        renewAdminRightsWithCompletionHandler:
  @abstract      Renew expiring administrator privileges for the current user.
  @param         completionHandler The handler to call when the request is complete.
- @discussion    Returns YES if the operation was successful, otherwise returns NO.
+ @discussion    Returns YES if the operation was successful, otherwise returns NO. If the request has been rejected
+                because too many requests have been sent, the error object is set as described for
+                requestAdminRightsWithReason:completionHandler:.
 */
-- (void)renewAdminRightsWithCompletionHandler:(void(^)(BOOL success))completionHandler;
+- (void)renewAdminRightsWithCompletionHandler:(void(^)(BOOL success, NSError *error))completionHandler;
 
 /*!
  @method        authenticateUserWithCompletionHandler:
@@ -80,4 +87,14 @@
 */
 - (void)isExecutableFileAtURL:(NSURL*)url reply:(void(^)(BOOL isExecutable))reply;
 
+/*!
+ @method        rateLimiterStatisticsWithReply:
+ @abstract      Get the rate limits and counters for privilege change requests.
+ @param         reply The reply block to call when the request is complete.
+ @discussion    Returns a dictionary containing the caller classes ("CLI", "GUI", "Renewal" and "Timer") as keys and
+                dictionaries with the configured "Capacity" and "RefillInterval" and the number of "Admitted" and
+                "Rejected" requests as values.
+*/
+- (void)rateLimiterStatisticsWithReply:(void(^)(NSDictionary *statistics))reply;
+
 @end
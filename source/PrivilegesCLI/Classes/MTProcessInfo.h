@@ -81,4 +81,28 @@
  */
 - (MTExtensionRequestType)extensionRequestType;
 
+/*!
+ @method        showHistory
+ @abstract      Get whether the privilege change history should be displayed.
+ @discussion    Returns YES if the history should be displayed, otherwise returns NO.
+ */
+- (BOOL)showHistory;
+
+/*!
+ @method        historyUser
+ @abstract      Get the user whose privilege change history should be displayed.
+ @discussion    Returns a NSString object containing the user name. Returns nil if no user has been provided.
+ */
+- (NSString*)historyUser;
+
+/*!
+ @method        historySinceIsValid:
+ @abstract      Get the date of the oldest privilege change that should be displayed.
+ @param         isValid A reference to a boolean that is set to NO if the --since argument has been provided without a date
+                or with a date that could not be parsed. May be NULL.
+ @discussion    Returns a NSDate object. Returns nil if no (valid) date has been provided. The date may be specified
+                as ISO 8601 date (e.g. 2025-03-01) or date and time (e.g. 2025-03-01T08:00:00Z).
+ */
+- (NSDate*)historySinceIsValid:(BOOL*)isValid;
+
 @end
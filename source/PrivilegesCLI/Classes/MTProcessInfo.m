@@ -101,4 +101,55 @@
     return type;
 }
 
+- (BOOL)showHistory
+{
+    BOOL show = [[self arguments] containsObject:@"--history"];
+    return show;
+}
+
+- (NSString*)valueForArgument:(NSString*)argument
+{
+    NSString *value = nil;
+    NSInteger index = [[self arguments] indexOfObject:argument];
+    
+    if (index != NSNotFound && index + 1 < [[self arguments] count]) {
+        
+        value = [[self arguments] objectAtIndex:index + 1];
+    }
+    
+    return value;
+}
+
+- (NSString*)historyUser
+{
+    return [self valueForArgument:@"--user"];
+}
+
+- (NSDate*)historySinceIsValid:(BOOL*)isValid
+{
+    NSDate *date = nil;
+    BOOL hasArgument = [[self arguments] containsObject:@"--since"];
+    NSString *dateString = [self valueForArgument:@"--since"];
+    
+    if ([dateString hasPrefix:@"-"]) { dateString = nil; }
+    
+    if (dateString) {
+        
+        NSISO8601DateFormatter *dateFormatter = [[NSISO8601DateFormatter alloc] init];
+        date = [dateFormatter dateFromString:dateString];
+        
+        if (!date) {
+            
+            // just a date, so we use the local time zone
+            [dateFormatter setFormatOptions:NSISO8601DateFormatWithFullDate | NSISO8601DateFormatWithDashSeparatorInDate];
+            [dateFormatter setTimeZone:[NSTimeZone localTimeZone]];
+            date = [dateFormatter dateFromString:dateString];
+        }
+    }
+    
+    if (isValid) { *isValid = (!hasArgument || date); }
+    
+    return date;
+}
+
 @end
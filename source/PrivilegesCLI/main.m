@@ -19,6 +19,7 @@
 #import "MTPrivileges.h"
 #import "MTProcessInfo.h"
 #import "MTSystemExtension.h"
+#import "MTAuditLog.h"
 #import "Constants.h"
 
 @interface Main : NSObject
@@ -34,7 +35,7 @@
     _shouldTerminate = YES;
     
     MTProcessInfo *appArguments = [[MTProcessInfo alloc] init];
-    BOOL rootAllowed = ([appArguments systemExtension] || [appArguments showVersion]);
+    BOOL rootAllowed = ([appArguments systemExtension] || [appArguments showVersion] || [appArguments showHistory]);
     
     // don't run this as root
     if (getuid() != 0 || rootAllowed) {
@@ -248,6 +249,97 @@
                     
                     [self writeConsole:[NSString stringWithFormat:@"User %@ has standard user privileges", [[privilegesApp currentUser] userName]]];
                 }
+                
+                // display the counters of the rate limits, if configured
+                if ([privilegesApp requestRateLimits]) {
+                    
+                    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+                    
+                    [[privilegesApp currentUser] rateLimiterStatisticsWithReply:^(NSDictionary *statistics) {
+                        
+                        for (NSString *callerClass in [[statistics allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+                            
+                            NSDictionary *classStatistics = [statistics objectForKey:callerClass];
+                            NSUInteger capacity = [[classStatistics objectForKey:kMTRateLimiterStatisticsCapacityKey] unsignedIntegerValue];
+                            
+                            if (capacity > 0) {
+                                
+                                [self writeConsole:[NSString stringWithFormat:@"%@ requests: %@ admitted, %@ rejected (limit: %lu requests, one more every %g seconds)",
+                                                    callerClass,
+                                                    [classStatistics objectForKey:kMTRateLimiterStatisticsAdmittedKey],
+                                                    [classStatistics objectForKey:kMTRateLimiterStatisticsRejectedKey],
+                                                    (unsigned long)capacity,
+                                                    [[classStatistics objectForKey:kMTRateLimiterStatisticsRefillIntervalKey] doubleValue]
+                                                   ]
+                                ];
+                            }
+                        }
+                        
+                        dispatch_semaphore_signal(semaphore);
+                    }];
+                    
+                    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+                }
+            }
+
+#pragma mark - Argument "--history"
+        
+        } else if ([appArguments showHistory]) {
+            
+            BOOL isValidDate = NO;
+            NSDate *sinceDate = [appArguments historySinceIsValid:&isValidDate];
+            
+            if (isValidDate) {
+                
+                NSISO8601DateFormatter *dateFormatter = [[NSISO8601DateFormatter alloc] init];
+                [dateFormatter setFormatOptions:NSISO8601DateFormatWithInternetDateTime | NSISO8601DateFormatWithSpaceBetweenDateAndTime];
+                [dateFormatter setTimeZone:[NSTimeZone localTimeZone]];
+                
+                __block NSUInteger eventCount = 0;
+                NSError *error = nil;
+                
+                MTAuditLog *auditLog = [[MTAuditLog alloc] initWithPath:[MTAuditLog defaultPath]];
+                BOOL success = [auditLog enumerateEventsForUser:[appArguments historyUser]
+                                                          since:sinceDate
+                                                     usingBlock:^(NSDictionary *event, BOOL *stop) {
+                    
+                    BOOL isGrant = ([[event objectForKey:kMTAuditLogKeyAction] intValue] == MTAuditLogActionGrant);
+                    NSString *eventString = [NSString stringWithFormat:@"%@  %@  %@",
+                                             [dateFormatter stringFromDate:[event objectForKey:kMTAuditLogKeyDate]],
+                                             [event objectForKey:kMTAuditLogKeyUser],
+                                             (isGrant) ? @"granted" : @"revoked"
+                    ];
+                    
+                    NSUInteger duration = [[event objectForKey:kMTAuditLogKeyDuration] unsignedIntegerValue];
+                    if (!isGrant && duration > 0) { eventString = [eventString stringByAppendingFormat:@" after %@", [MTPrivileges stringForDuration:duration / 60.0 localized:NO naturalScale:YES]]; }
+                    
+                    NSString *component = [event objectForKey:kMTAuditLogKeyComponent];
+                    if (component) { eventString = [eventString stringByAppendingFormat:@"  [%@]", component]; }
+                    
+                    NSString *reason = [event objectForKey:kMTAuditLogKeyReason];
+                    if (reason) { eventString = [eventString stringByAppendingFormat:@"  \"%@\"", reason]; }
+                    
+                    [self writeConsole:eventString];
+                    eventCount++;
+                }
+                                                          error:&error
+                ];
+                
+                if (!success) {
+                    
+                    [self writeConsole:[NSString stringWithFormat:@"Failed to read audit log: %@", error]];
+                    exitCode = 1;
+                    
+                } else if (eventCount == 0) {
+                    
+                    [self writeConsole:@"No privilege changes found"];
+                }
+                
+            } else {
+                
+                [self writeConsole:@"Invalid date!"];
+                [self printUsage];
+                exitCode = 1;
             }
 
 #pragma mark - Argument "--version"
@@ -426,9 +518,14 @@
                                 
                                 if (renewAdminPrivileges) {
                                     
-                                    [[privilegesApp currentUser] renewAdminPrivilegesWithCompletionHandler:^(BOOL success) {
+                                    [[privilegesApp currentUser] renewAdminPrivilegesWithCompletionHandler:^(BOOL success, NSError *error) {
                                         
-                                        if (success) {
+                                        if ([self errorIsRateLimitError:error]) {
+                                            
+                                            [self writeConsole:[self messageForRateLimitError:error]];
+                                            exitCode = 6;
+                                            
+                                        } else if (success) {
                                             
                                             [self writeConsole:[NSString stringWithFormat:@"Administrator privileges have been renewed and will expire in %@", [MTPrivileges stringForDuration:[privilegesApp expirationInterval]
                                                                                                                                                                                      localized:NO
@@ -449,9 +546,14 @@
                                 } else {
                                     
                                     [[privilegesApp currentUser] requestAdminPrivilegesWithReason:privilegesReason
-                                                                                completionHandler:^(BOOL success) {
+                                                                                completionHandler:^(BOOL success, NSError *error) {
                                         
-                                        if (success) {
+                                        if ([self errorIsRateLimitError:error]) {
+                                            
+                                            [self writeConsole:[self messageForRateLimitError:error]];
+                                            exitCode = 6;
+                                            
+                                        } else if (success) {
                                             
                                             [self writeConsole:[NSString stringWithFormat:@"User %@ now has administrator privileges", [[privilegesApp currentUser] userName]]];
                                             
@@ -480,7 +582,7 @@
                             
                         } else {
                             
-                            [[privilegesApp currentUser] revokeAdminPrivilegesWithCompletionHandler:^(BOOL success) {
+                            [[privilegesApp currentUser] revokeAdminPrivilegesWithCompletionHandler:^(BOOL success, NSError *error) {
                                 
                                 if (success) {
                                     [self writeConsole:[NSString stringWithFormat:@"User %@ now has standard user privileges", [[privilegesApp currentUser] userName]]];
@@ -518,6 +620,18 @@
     return exitCode;
 }
 
+- (BOOL)errorIsRateLimitError:(NSError*)error
+{
+    return ([[error domain] isEqualToString:kMTErrorDomain] && [error code] == kMTErrorCodeRateLimitExceeded);
+}
+
+- (NSString*)messageForRateLimitError:(NSError*)error
+{
+    NSInteger retryAfter = ceil([[[error userInfo] objectForKey:kMTErrorRetryAfterKey] doubleValue]);
+    
+    return [NSString stringWithFormat:@"Too many privilege change requests. Please try again in %ld second%@", (long)retryAfter, (retryAfter == 1) ? @"" : @"s"];
+}
+
 - (void)writeConsole:(NSString*)consoleMessage
 {
     fprintf(stderr, "%s\n", [consoleMessage UTF8String]);
@@ -531,7 +645,12 @@
     fprintf(stderr, "                               specified. This is optional. If a reason is required\n");
     fprintf(stderr, "                               but not specified, the tool will prompt for a reason.\n\n");
     fprintf(stderr, "  -r, --remove                 Removes the current user from the admin group.\n\n");
-    fprintf(stderr, "  -s, --status                 Displays the current user's privileges.\n\n");
+    fprintf(stderr, "  -s, --status                 Displays the current user's privileges and, if\n");
+    fprintf(stderr, "                               configured, the request rate limits.\n\n");
+    fprintf(stderr, "  --history [--user name]      Displays the privilege changes recorded on this\n");
+    fprintf(stderr, "  [--since date]               machine. The output may be limited to the given user\n");
+    fprintf(stderr, "                               and to changes since the given date (YYYY-MM-DD or\n");
+    fprintf(stderr, "                               ISO 8601 date and time).\n\n");
     
     if (@available(macOS 13.0, *)) {
         
@@ -0,0 +1,63 @@
+/*
+    MTPrebootUpdater.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @class         MTPrebootUpdater
+ @abstract      A class that updates the preboot volume and coalesces overlapping update requests.
+ @discussion    Requests that arrive within the debounce interval are coalesced into a single update. At most
+                one update runs at a time. Requests that arrive while an update is running result in exactly one
+                trailing update after the running update has finished.
+*/
+
+@interface MTPrebootUpdater : NSObject
+
+/*!
+ @method        init
+ @discussion    The init method is not available. Please use initWithExecutablePath:arguments:debounceInterval: instead.
+ */
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        initWithExecutablePath:arguments:debounceInterval:
+ @abstract      Initialize a MTPrebootUpdater object with the given executable, arguments and debounce interval.
+ @param         path The path to the executable that updates the preboot volume.
+ @param         arguments An array of strings containing the arguments passed to the executable. May be nil.
+ @param         interval The time interval (in seconds) to wait for further requests before an update is started.
+ @discussion    Returns an initialized MTPrebootUpdater object.
+*/
+- (instancetype)initWithExecutablePath:(NSString*)path
+                             arguments:(NSArray<NSString*>*)arguments
+                      debounceInterval:(NSTimeInterval)interval NS_DESIGNATED_INITIALIZER;
+
+/*!
+ @method        requestUpdate
+ @abstract      Requests an update of the preboot volume.
+ @discussion    The update is started after the debounce interval has passed without any further requests. If an
+                update is currently running, a trailing update is scheduled.
+*/
+- (void)requestUpdate;
+
+/*!
+ @method        isBusy
+ @abstract      Get whether an update is pending or running.
+ @discussion    Returns YES if an update is pending or running, otherwise returns NO.
+*/
+- (BOOL)isBusy;
+
+@end
@@ -0,0 +1,145 @@
+/*
+    MTPrebootUpdater.m
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTPrebootUpdater.h"
+#import <os/log.h>
+
+@interface MTPrebootUpdater ()
+@property (nonatomic, strong, readwrite) NSString *executablePath;
+@property (nonatomic, strong, readwrite) NSArray<NSString*> *arguments;
+@property (nonatomic, strong, readwrite) dispatch_queue_t updateQueue;
+@property (assign) NSTimeInterval debounceInterval;
+@property (assign) NSUInteger debounceGeneration;
+@property (assign) NSUInteger coalescedRequests;
+@property (assign) uint64_t firstRequestTime;
+@property (assign) BOOL isPending;
+@property (assign) BOOL isRunning;
+@property (assign) BOOL trailingUpdateRequested;
+@end
+
+@implementation MTPrebootUpdater
+
+- (instancetype)initWithExecutablePath:(NSString*)path arguments:(NSArray<NSString*>*)arguments debounceInterval:(NSTimeInterval)interval
+{
+    self = [super init];
+    
+    if (self) {
+        
+        _executablePath = path;
+        _arguments = (arguments) ? arguments : [NSArray array];
+        _debounceInterval = (interval > 0) ? interval : 0;
+        _updateQueue = dispatch_queue_create("corp.sap.privileges.preboot", DISPATCH_QUEUE_SERIAL);
+    }
+    
+    return self;
+}
+
+- (void)requestUpdate
+{
+    dispatch_async(_updateQueue, ^{
+        
+        if (self->_coalescedRequests == 0) { self->_firstRequestTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW); }
+        self->_coalescedRequests++;
+        
+        if (self->_isRunning) {
+            
+            // the request is handled by a trailing update
+            // once the current update has finished
+            self->_trailingUpdateRequested = YES;
+            
+        } else {
+            
+            [self scheduleUpdate];
+        }
+    });
+}
+
+- (BOOL)isBusy
+{
+    __block BOOL busy = NO;
+    dispatch_sync(_updateQueue, ^{ busy = (self->_isPending || self->_isRunning); });
+    
+    return busy;
+}
+
+// must be called on the update queue
+- (void)scheduleUpdate
+{
+    // restart the debounce interval
+    NSUInteger generation = ++_debounceGeneration;
+    _isPending = YES;
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_debounceInterval * NSEC_PER_SEC)), _updateQueue, ^{
+        
+        // another request arrived in the meantime
+        if (generation == self->_debounceGeneration) { [self runUpdate]; }
+    });
+}
+
+// must be called on the update queue
+- (void)runUpdate
+{
+    uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    uint64_t queueTime = startTime - _firstRequestTime;
+    NSUInteger requestCount = _coalescedRequests;
+    
+    _isPending = NO;
+    _isRunning = YES;
+    _coalescedRequests = 0;
+    
+    os_log(OS_LOG_DEFAULT, "SAPCorp: Updating preboot volume (%lu request(s) coalesced, queued for %llu ms)", (unsigned long)requestCount, queueTime / NSEC_PER_MSEC);
+    
+    NSError *error = nil;
+    NSTask *task = [NSTask launchedTaskWithExecutableURL:[NSURL fileURLWithPath:_executablePath]
+                                               arguments:_arguments
+                                                   error:&error
+                                      terminationHandler:^(NSTask *task) {
+        
+        dispatch_async(self->_updateQueue, ^{
+            
+            uint64_t runTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - startTime;
+            
+            if ([task terminationStatus] == 0) {
+                os_log(OS_LOG_DEFAULT, "SAPCorp: Preboot volume has been updated (took %llu ms)", runTime / NSEC_PER_MSEC);
+            } else {
+                os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to update preboot volume (took %llu ms)", runTime / NSEC_PER_MSEC);
+            }
+            
+            [self finishUpdate];
+        });
+    }];
+    
+    if (!task) {
+        
+        os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to update preboot volume: %{public}@", error);
+        [self finishUpdate];
+    }
+}
+
+// must be called on the update queue
+- (void)finishUpdate
+{
+    _isRunning = NO;
+    
+    if (_trailingUpdateRequested) {
+        
+        _trailingUpdateRequested = NO;
+        [self scheduleUpdate];
+    }
+}
+
+@end
@@ -0,0 +1,96 @@
+/*
+    MTPrivilegeChangeExecutor.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @enum          MTPrivilegeChangeResult
+ @abstract      Specifies the result of a privilege change request.
+ @constant      MTPrivilegeChangeResultSuccess The requested privileges have been applied.
+ @constant      MTPrivilegeChangeResultFailed The requested privileges could not be applied.
+ @constant      MTPrivilegeChangeResultSuperseded The request has been replaced by a later request for the same user
+                that requested other privileges, so the requested privileges have not been applied.
+ @constant      MTPrivilegeChangeResultTimedOut The request has not been applied within its timeout.
+ @constant      MTPrivilegeChangeResultCoalesced The request has been replaced by a later request for the same user
+                that requested the same privileges, and these privileges have been applied.
+*/
+typedef enum {
+    MTPrivilegeChangeResultSuccess    = 0,
+    MTPrivilegeChangeResultFailed     = 1,
+    MTPrivilegeChangeResultSuperseded = 2,
+    MTPrivilegeChangeResultTimedOut   = 3,
+    MTPrivilegeChangeResultCoalesced  = 4
+} MTPrivilegeChangeResult;
+
+/*!
+ @typedef       MTPrivilegeChangeHandler
+ @abstract      The block that applies a batch of privilege changes.
+ @discussion    The block gets a dictionary containing user names as keys and the requested privileges (YES for
+                administrator privileges) as values. It must return a dictionary with the same keys and a boolean
+                value indicating whether the change has been applied successfully.
+*/
+typedef NSDictionary<NSString*, NSNumber*>* (^MTPrivilegeChangeHandler)(NSDictionary<NSString*, NSNumber*> *changes);
+
+/*!
+ @class         MTPrivilegeChangeExecutor
+ @abstract      A class that serializes and coalesces privilege change requests.
+ @discussion    Requests are queued per user and applied in batches, one batch at a time. If multiple requests for
+                the same user are waiting, only the most recent one is applied (e.g. grant, revoke, grant results
+                in a single grant). The others are completed together with the most recent one and share its
+                outcome if they requested the same privileges, otherwise they are reported as superseded. Requests
+                that could not be started within their timeout are reported as timed out. The time requests spent
+                in the queue and the time needed to apply the changes are logged.
+*/
+
+@interface MTPrivilegeChangeExecutor : NSObject
+
+/*!
+ @method        init
+ @discussion    The init method is not available. Please use initWithChangeHandler: instead.
+ */
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        initWithChangeHandler:
+ @abstract      Initialize a MTPrivilegeChangeExecutor object with the given change handler.
+ @param         handler The block that applies the privilege changes. The block is always called on the
+                same serial queue.
+ @discussion    Returns an initialized MTPrivilegeChangeExecutor object.
+*/
+- (instancetype)initWithChangeHandler:(MTPrivilegeChangeHandler)handler NS_DESIGNATED_INITIALIZER;
+
+/*!
+ @method        submitChangeForUser:grantAdminPrivileges:timeout:completionHandler:
+ @abstract      Submits a privilege change request.
+ @param         userName The short name of the user.
+ @param         grant A boolean specifying whether administrator privileges should be granted (YES) or revoked (NO).
+ @param         timeout The time (in seconds) the request may wait in the queue. Pass 0 to wait without limit.
+ @param         completionHandler The completion handler to call when the request has been handled.
+*/
+- (void)submitChangeForUser:(NSString*)userName
+       grantAdminPrivileges:(BOOL)grant
+                    timeout:(NSTimeInterval)timeout
+          completionHandler:(void (^)(MTPrivilegeChangeResult result))completionHandler;
+
+/*!
+ @method        isBusy
+ @abstract      Get whether requests are waiting or being applied.
+ @discussion    Returns YES if requests are waiting or being applied, otherwise returns NO.
+*/
+- (BOOL)isBusy;
+
+@end
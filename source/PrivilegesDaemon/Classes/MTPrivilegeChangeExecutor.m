@@ -0,0 +1,192 @@
+/*
+    MTPrivilegeChangeExecutor.m
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTPrivilegeChangeExecutor.h"
+#import <os/log.h>
+
+@interface MTPrivilegeChangeRequest : NSObject
+@property (assign) BOOL grant;
+@property (assign) uint64_t submitTime;
+@property (assign) BOOL isFinished;
+@property (nonatomic, copy) void (^completionHandler)(MTPrivilegeChangeResult result);
+@property (nonatomic, strong, readwrite) NSMutableArray<MTPrivilegeChangeRequest*> *supersededRequests;
+@end
+
+@implementation MTPrivilegeChangeRequest
+
+- (void)supersedeRequest:(MTPrivilegeChangeRequest*)request
+{
+    if (!_supersededRequests) { _supersededRequests = [[NSMutableArray alloc] init]; }
+    
+    // take over the requests the given request replaced, so they are
+    // all compared with the request that is actually applied
+    if ([request supersededRequests]) { [_supersededRequests addObjectsFromArray:[request supersededRequests]]; }
+    [request setSupersededRequests:nil];
+    [_supersededRequests addObject:request];
+}
+
+- (void)finishWithResult:(MTPrivilegeChangeResult)result
+{
+    if (!_isFinished) {
+        
+        _isFinished = YES;
+        if (_completionHandler) { _completionHandler(result); }
+        _completionHandler = nil;
+        
+        // the requests we replaced share our outcome, if they requested the same privileges
+        for (MTPrivilegeChangeRequest *supersededRequest in _supersededRequests) {
+            
+            MTPrivilegeChangeResult supersededResult = MTPrivilegeChangeResultSuperseded;
+            
+            if ([supersededRequest grant] == _grant) {
+                supersededResult = (result == MTPrivilegeChangeResultSuccess) ? MTPrivilegeChangeResultCoalesced : result;
+            }
+            
+            [supersededRequest finishWithResult:supersededResult];
+        }
+        
+        _supersededRequests = nil;
+    }
+}
+
+@end
+
+@interface MTPrivilegeChangeExecutor ()
+@property (nonatomic, copy) MTPrivilegeChangeHandler changeHandler;
+@property (nonatomic, strong, readwrite) dispatch_queue_t stateQueue;
+@property (nonatomic, strong, readwrite) dispatch_queue_t commitQueue;
+@property (nonatomic, strong, readwrite) NSMutableDictionary<NSString*, MTPrivilegeChangeRequest*> *pendingRequests;
+@property (assign) BOOL isRunning;
+@end
+
+@implementation MTPrivilegeChangeExecutor
+
+- (instancetype)initWithChangeHandler:(MTPrivilegeChangeHandler)handler
+{
+    self = [super init];
+    
+    if (self) {
+        
+        _changeHandler = handler;
+        _pendingRequests = [[NSMutableDictionary alloc] init];
+        _stateQueue = dispatch_queue_create("corp.sap.privileges.changes.state", DISPATCH_QUEUE_SERIAL);
+        _commitQueue = dispatch_queue_create("corp.sap.privileges.changes.commit", DISPATCH_QUEUE_SERIAL);
+    }
+    
+    return self;
+}
+
+- (void)submitChangeForUser:(NSString*)userName
+       grantAdminPrivileges:(BOOL)grant
+                    timeout:(NSTimeInterval)timeout
+          completionHandler:(void (^)(MTPrivilegeChangeResult result))completionHandler
+{
+    MTPrivilegeChangeRequest *request = [[MTPrivilegeChangeRequest alloc] init];
+    [request setGrant:grant];
+    [request setSubmitTime:clock_gettime_nsec_np(CLOCK_UPTIME_RAW)];
+    [request setCompletionHandler:completionHandler];
+    
+    dispatch_async(_stateQueue, ^{
+        
+        // a request that is still waiting for the same user is replaced, because
+        // only the final state matters. It is completed with the new request
+        MTPrivilegeChangeRequest *previousRequest = [self->_pendingRequests objectForKey:userName];
+        
+        if (previousRequest) {
+            
+            os_log(OS_LOG_DEFAULT, "SAPCorp: Privilege change request for user %{public}@ superseded", userName);
+            [request supersedeRequest:previousRequest];
+        }
+        
+        [self->_pendingRequests setObject:request forKey:userName];
+        
+        if (timeout > 0) {
+            
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(timeout * NSEC_PER_SEC)), self->_stateQueue, ^{
+                
+                // only requests that have not been started yet can time out
+                if ([self->_pendingRequests objectForKey:userName] == request) {
+                    
+                    os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Privilege change request for user %{public}@ timed out", userName);
+                    
+                    [self->_pendingRequests removeObjectForKey:userName];
+                    [request finishWithResult:MTPrivilegeChangeResultTimedOut];
+                }
+            });
+        }
+        
+        [self runNextBatch];
+    });
+}
+
+- (BOOL)isBusy
+{
+    __block BOOL busy = NO;
+    dispatch_sync(_stateQueue, ^{ busy = (self->_isRunning || [self->_pendingRequests count] > 0); });
+    
+    return busy;
+}
+
+// must be called on the state queue
+- (void)runNextBatch
+{
+    if (!_isRunning && [_pendingRequests count] > 0) {
+        
+        NSDictionary<NSString*, MTPrivilegeChangeRequest*> *batch = [_pendingRequests copy];
+        NSMutableDictionary<NSString*, NSNumber*> *changes = [[NSMutableDictionary alloc] init];
+        uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+        uint64_t maxQueueTime = 0;
+        
+        for (NSString *userName in batch) {
+            
+            MTPrivilegeChangeRequest *request = [batch objectForKey:userName];
+            [changes setObject:[NSNumber numberWithBool:[request grant]] forKey:userName];
+            
+            uint64_t queueTime = startTime - [request submitTime];
+            if (queueTime > maxQueueTime) { maxQueueTime = queueTime; }
+        }
+        
+        [_pendingRequests removeAllObjects];
+        _isRunning = YES;
+        
+        dispatch_async(_commitQueue, ^{
+            
+            NSDictionary<NSString*, NSNumber*> *results = (self->_changeHandler) ? self->_changeHandler(changes) : nil;
+            uint64_t commitTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - startTime;
+            
+            os_log(OS_LOG_DEFAULT, "SAPCorp: Applied privilege changes for %lu user(s) (queued for up to %llu ms, took %llu ms)",
+                   (unsigned long)[changes count],
+                   maxQueueTime / NSEC_PER_MSEC,
+                   commitTime / NSEC_PER_MSEC
+            );
+            
+            dispatch_async(self->_stateQueue, ^{
+                
+                for (NSString *userName in batch) {
+                    
+                    BOOL success = [[results objectForKey:userName] boolValue];
+                    [[batch objectForKey:userName] finishWithResult:(success) ? MTPrivilegeChangeResultSuccess : MTPrivilegeChangeResultFailed];
+                }
+                
+                self->_isRunning = NO;
+                [self runNextBatch];
+            });
+        });
+    }
+}
+
+@end
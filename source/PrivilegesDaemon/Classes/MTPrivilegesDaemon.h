@@ -32,4 +32,11 @@
 */
 - (NSInteger)numberOfActiveXPCConnections;
 
+/*!
+ @method        hasPendingOperations
+ @abstract      Get whether the daemon has operations that are pending or still running (like preboot volume updates).
+ @discussion    Returns YES if there are pending operations, otherwise returns NO.
+*/
+- (BOOL)hasPendingOperations;
+
 @end
@@ -16,22 +16,28 @@
 */
 
 #import "MTPrivilegesDaemon.h"
-#import "MTCodeSigning.h"
+#import "MTConnectionRequirement.h"
 #import "Constants.h"
 #import "MTIdentity.h"
+#import "MTLocalGroupRecord.h"
+#import "MTPrebootUpdater.h"
+#import "MTPrivilegeChangeExecutor.h"
+#import "MTAuditLog.h"
 #import <os/log.h>
 
 @interface MTPrivilegesDaemon ()
 @property (nonatomic, strong, readwrite) NSMutableSet *activeConnections;
 @property (atomic, strong, readwrite) NSXPCListener *listener;
+@property (nonatomic, strong, readwrite) MTPrebootUpdater *prebootUpdater;
+@property (nonatomic, strong, readwrite) MTPrivilegeChangeExecutor *changeExecutor;
+@property (nonatomic, strong, readwrite) MTAuditLog *auditLog;
+@property (nonatomic, strong, readwrite) MTConnectionRequirement *connectionRequirement;
 @end
 
 @interface ExtendedNSXPCConnection : NSXPCConnection
 @property audit_token_t auditToken;
 @end
 
-OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement);
-
 @implementation MTPrivilegesDaemon
 
 - (instancetype)init
@@ -41,6 +47,36 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     if (self) {
         
         _activeConnections = [[NSMutableSet alloc] init];
+        _prebootUpdater = [[MTPrebootUpdater alloc] initWithExecutablePath:kMTDiskutilPath
+                                                                 arguments:[NSArray arrayWithObjects:
+                                                                                @"apfs",
+                                                                                @"updatePreboot",
+                                                                                @"/",
+                                                                                nil
+                                                                           ]
+                                                          debounceInterval:kMTPrebootUpdateDebounceInterval
+        ];
+        
+        // all privilege changes go through the executor, so changes
+        // for the same user are applied in order and never overlap
+        _changeExecutor = [[MTPrivilegeChangeExecutor alloc] initWithChangeHandler:^NSDictionary<NSString*, NSNumber*>*(NSDictionary<NSString*, NSNumber*> *changes) {
+            return [self changePrivilegesForUsers:changes];
+        }];
+        
+        NSString *auditLogPath = [MTAuditLog defaultPath];
+        if (auditLogPath) { _auditLog = [[MTAuditLog alloc] initWithPath:auditLogPath]; }
+        
+        // we only allow the Privileges agent to connect. It must be signed by the same signing
+        // authority and must have the same version number as this daemon
+        NSError *error = nil;
+        _connectionRequirement = [[MTConnectionRequirement alloc] initWithBundleIdentifiers:[NSArray arrayWithObject:kMTAgentBundleIdentifier]
+                                                                              versionString:[[NSBundle bundleForClass:[self class]] objectForInfoDictionaryKey:@"CFBundleShortVersionString"]
+                                                                                      error:&error
+        ];
+        
+        if (!_connectionRequirement) {
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to get code signature: %{public}@", error);
+        }
                 
         _listener = [[NSXPCListener alloc] initWithMachServiceName:kMTDaemonMachServiceName];
         [_listener setDelegate:self];
@@ -62,62 +98,38 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     
     if (listener == _listener && newConnection != nil) {
         
-        // see how we have been signed and make sure only processes with the same signing authority can connect.
-        // additionally the calling application must have the same version number as this xpc service and must
-        // use the bundle identifier "corp.sap.privileges.agent"
+        // make sure only processes matching our (precompiled) code signing requirement can connect
         NSError *error = nil;
-        NSString *signingAuth = [MTCodeSigning getSigningAuthorityWithError:&error];
-        NSString *requiredVersion = [[NSBundle bundleForClass:[self class]] objectForInfoDictionaryKey:@"CFBundleShortVersionString"];
         
-        if (signingAuth) {
-
-            // we only allow the Privileges agent to connect
-            NSString *reqString = [MTCodeSigning codeSigningRequirementsWithCommonName:signingAuth
-                                                                      bundleIdentifier:kMTAgentBundleIdentifier
-                                                                         versionString:requiredVersion
-            ];
-            SecTaskRef taskRef = SecTaskCreateWithAuditToken(NULL, ((ExtendedNSXPCConnection*)newConnection).auditToken);
-                       
-            if (taskRef) {
-
-                OSStatus result = SecTaskValidateForRequirement(taskRef, (__bridge CFStringRef)(reqString));
-                
-                if (result == errSecSuccess) {
+        if ([_connectionRequirement validateAuditToken:((ExtendedNSXPCConnection*)newConnection).auditToken error:&error]) {
 
-                    acceptConnection = YES;
-                       
-                    [newConnection setExportedInterface:[NSXPCInterface interfaceWithProtocol:@protocol(PrivilegesDaemonProtocol)]];
-                    [newConnection setExportedObject:self];
-                    
+            acceptConnection = YES;
+               
+            [newConnection setExportedInterface:[NSXPCInterface interfaceWithProtocol:@protocol(PrivilegesDaemonProtocol)]];
+            [newConnection setExportedObject:self];
+            
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Warc-retain-cycles"
-                    [newConnection setInvalidationHandler:^{
-                                  
-                        [newConnection setInvalidationHandler:nil];
-                        dispatch_async(dispatch_get_main_queue(), ^{
-                            [self.activeConnections removeObject:newConnection];
-                            os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ invalidated", newConnection);
-                        });
-                    }];
+            [newConnection setInvalidationHandler:^{
+                          
+                [newConnection setInvalidationHandler:nil];
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    [self.activeConnections removeObject:newConnection];
+                    os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ invalidated", newConnection);
+                });
+            }];
 #pragma clang diagnostic pop
-                    
-                    [newConnection resume];
-                    
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        [self.activeConnections addObject:newConnection];
-                        os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ established", newConnection);
-                    });
-        
-                } else {
-                    
-                    os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Code signature verification failed (error %d)", result);
-                }
-                    
-                CFRelease(taskRef);
-            }
-                
+            
+            [newConnection resume];
+            
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [self.activeConnections addObject:newConnection];
+                os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ established", newConnection);
+            });
+
         } else {
-            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to get code signature: %{public}@", error);
+            
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Code signature verification failed (error %ld)", (long)[error code]);
         }
     }
 
@@ -129,9 +141,17 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     return [_activeConnections count];
 }
 
-- (BOOL)changePrivilegesForUser:(NSString*)userName grantAdminPrivileges:(BOOL)grant
+- (BOOL)hasPendingOperations
 {
-    BOOL success = NO;
+    return ([_changeExecutor isBusy] || [_prebootUpdater isBusy]);
+}
+
+- (NSDictionary<NSString*, NSNumber*>*)changePrivilegesForUsers:(NSDictionary<NSString*, NSNumber*>*)changes
+{
+    NSMutableDictionary *results = [[NSMutableDictionary alloc] init];
+    NSMutableArray *changedUsers = [[NSMutableArray alloc] init];
+    
+    for (NSString *userName in changes) { [results setObject:[NSNumber numberWithBool:NO] forKey:userName]; }
         
     // get the group identity
     CBGroupIdentity *groupIdentity = [CBGroupIdentity groupIdentityWithPosixGID:kMTAdminGroupID
@@ -140,25 +160,38 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     
     if (groupIdentity) {
         
-        CBIdentity *userIdentity = [CBIdentity identityWithName:userName
-                                                      authority:[CBIdentityAuthority defaultIdentityAuthority]
-        ];
+        CSIdentityRef csGroupIdentity = [groupIdentity CSIdentity];
         
-        if (userIdentity) {
+        for (NSString *userName in changes) {
             
-            CSIdentityRef csUserIdentity = [userIdentity CSIdentity];
-            CSIdentityRef csGroupIdentity = [groupIdentity CSIdentity];
+            CBIdentity *userIdentity = [CBIdentity identityWithName:userName
+                                                          authority:[CBIdentityAuthority defaultIdentityAuthority]
+            ];
             
-            // add or remove the user to/from the group
-            if (grant) {
-                CSIdentityAddMember(csGroupIdentity, csUserIdentity);
+            if (userIdentity) {
+                
+                CSIdentityRef csUserIdentity = [userIdentity CSIdentity];
+                
+                // add or remove the user to/from the group
+                if ([[changes objectForKey:userName] boolValue]) {
+                    CSIdentityAddMember(csGroupIdentity, csUserIdentity);
+                } else {
+                    CSIdentityRemoveMember(csGroupIdentity, csUserIdentity);
+                }
+                
+                [changedUsers addObject:userName];
+                
             } else {
-                CSIdentityRemoveMember(csGroupIdentity, csUserIdentity);
+                
+                os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Unable to get user identity for user %{public}@", userName);
             }
+        }
+        
+        if ([changedUsers count] > 0) {
             
-            // commit changes to the identity store to update the group
+            // commit all changes to the identity store at once to update the group
             CFErrorRef commitError = NULL;
-            success = CSIdentityCommit(csGroupIdentity, NULL, &commitError);
+            BOOL success = CSIdentityCommit(csGroupIdentity, NULL, &commitError);
             
             // because of some issues that have been reported by users,
             // we check if the group membership is correct
@@ -170,33 +203,34 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
                 if ([userDefaults objectIsForcedForKey:kMTDefaultsForceUpdatePrebootVolumeKey] &&
                     [userDefaults boolForKey:kMTDefaultsForceUpdatePrebootVolumeKey]) {
                     
-                    [NSTask launchedTaskWithExecutableURL:[NSURL fileURLWithPath:kMTDiskutilPath]
-                                                arguments:[NSArray arrayWithObjects:
-                                                               @"apfs",
-                                                               @"updatePreboot",
-                                                               @"/",
-                                                               nil
-                                                          ]
-                                                    error:nil
-                                       terminationHandler:^(NSTask *task) {
-                        
-                        if ([task terminationStatus] == 0) {
-                            os_log(OS_LOG_DEFAULT, "SAPCorp: Preboot volume has been updated");
-                        } else {
-                            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to update preboot volume");
-                        }
-                    }];
+                    [_prebootUpdater requestUpdate];
                 }
                 
-                success = (grant == [MTIdentity groupMembershipForUser:userName
-                                                               groupID:kMTAdminGroupID
-                                                                 error:nil
-                                    ]
-                           );
+                // read the admin group record directly from the local node first and only
+                // fall back to the identity services if the membership cannot be determined
+                // from the record (nested groups) or if the record does not match (yet)
+                MTLocalGroupRecord *adminGroupRecord = [[MTLocalGroupRecord alloc] initWithContentsOfFile:kMTAdminGroupRecordPath];
                 
-                if (!success) {
+                for (NSString *userName in changedUsers) {
+                    
+                    BOOL grant = [[changes objectForKey:userName] boolValue];
+                    MTLocalGroupMembership membership = (adminGroupRecord) ? [adminGroupRecord membershipForUser:userName] : MTLocalGroupMembershipUnknown;
+                    BOOL verified = (membership != MTLocalGroupMembershipUnknown && grant == (membership == MTLocalGroupMembershipMember));
                     
-                    os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to verify group membership");
+                    if (!verified) {
+                        
+                        verified = (grant == [MTIdentity groupMembershipForUser:userName
+                                                                        groupID:kMTAdminGroupID
+                                                                          error:nil
+                                             ]
+                                    );
+                    }
+                    
+                    if (verified) {
+                        [results setObject:[NSNumber numberWithBool:YES] forKey:userName];
+                    } else {
+                        os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to verify group membership for user %{public}@", userName);
+                    }
                 }
                 
             } else {
@@ -214,67 +248,123 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
         }
     }
     
-    return success;
+    return results;
 }
 
-#pragma mark - Exported methods
-
-- (void)grantAdminRightsToUser:(NSString*)userName
-                        reason:(NSString*)reason
-             completionHandler:(void(^)(BOOL success))completionHandler
+- (void)logPrivilegeChangeForUser:(NSString*)userName
+             grantAdminPrivileges:(BOOL)grant
+                           reason:(NSString*)reason
+                        component:(NSString*)component
+                           result:(MTPrivilegeChangeResult)result
 {
-    BOOL success = NO;
-
-    if (userName) {
+    os_log_t log = os_log_create("corp.sap.privileges.daemon", "privchange");
+    
+    if (result == MTPrivilegeChangeResultSuccess) {
         
-        os_log_t log = os_log_create("corp.sap.privileges.daemon", "privchange");
-                
-        success = [self changePrivilegesForUser:userName grantAdminPrivileges:YES];
-                
-        if (success) {
+        // log the privilege change
+        NSString *logMessage = nil;
+        
+        if (grant) {
             
-            // log the privilege change
-            NSString *logMessage = [NSString stringWithFormat:@"SAPCorp: User %@ now has administrator privileges", userName];
+            logMessage = [NSString stringWithFormat:@"SAPCorp: User %@ now has administrator privileges", userName];
             if ([reason length] > 0) { logMessage = [logMessage stringByAppendingFormat:@" for the following reason: \"%@\"", reason]; }
-            os_log(log, "%{public}@", logMessage);
             
         } else {
             
-            NSString *logMessage = [NSString stringWithFormat:@"SAPCorp: Failed to change privileges for user %@", userName];
-            os_log_with_type(log, OS_LOG_TYPE_FAULT, "%{public}@", logMessage);
+            logMessage = [NSString stringWithFormat:@"SAPCorp: User %@ now has standard user privileges", userName];
+            if ([reason length] > 0) { logMessage = [logMessage stringByAppendingFormat:@" (%@)", reason]; }
         }
+        
+        os_log(log, "%{public}@", logMessage);
+        
+        // add the privilege change to the local audit log
+        NSError *error = nil;
+        
+        if (![_auditLog appendEventForUser:userName
+                                    action:(grant) ? MTAuditLogActionGrant : MTAuditLogActionRevoke
+                                    reason:reason
+                                 component:component
+                                     error:&error
+             ]) {
+            
+            os_log_with_type(log, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to write audit log: %{public}@", error);
+        }
+        
+    } else if (result == MTPrivilegeChangeResultSuperseded) {
+        
+        NSString *logMessage = [NSString stringWithFormat:@"SAPCorp: Privilege change for user %@ has been superseded by a later request", userName];
+        os_log(log, "%{public}@", logMessage);
+        
+    } else if (result == MTPrivilegeChangeResultCoalesced) {
+        
+        // the change has been logged (and audited) for the later request already
+        NSString *logMessage = [NSString stringWithFormat:@"SAPCorp: Privilege change for user %@ has been applied together with a later request", userName];
+        os_log(log, "%{public}@", logMessage);
+        
+    } else {
+        
+        NSString *logMessage = [NSString stringWithFormat:@"SAPCorp: Failed to change privileges for user %@", userName];
+        os_log_with_type(log, OS_LOG_TYPE_FAULT, "%{public}@", logMessage);
     }
-    
-    if (completionHandler) { completionHandler(success); }
 }
 
-- (void)removeAdminRightsFromUser:(NSString*)userName
-                           reason:(NSString*)reason
-                completionHandler:(void(^)(BOOL success))completionHandler
+// requests of all clients are submitted to the change executor, which
+// applies the requests that are waiting at the same time in one batch
+- (void)submitChangeForUser:(NSString*)userName
+       grantAdminPrivileges:(BOOL)grant
+                     reason:(NSString*)reason
+                  component:(NSString*)component
+          completionHandler:(void(^)(BOOL success))completionHandler
 {
-    BOOL success = NO;
-
-    if (userName) {
+    if ([userName length] > 0) {
         
-        os_log_t log = os_log_create("corp.sap.privileges.daemon", "privchange");
-        
-        success = [self changePrivilegesForUser:userName grantAdminPrivileges:NO];
-                
-        if (success) {
+        [_changeExecutor submitChangeForUser:userName
+                        grantAdminPrivileges:grant
+                                     timeout:kMTPrivilegeChangeTimeout
+                           completionHandler:^(MTPrivilegeChangeResult result) {
             
-            // log the privilege change
-            NSString *logMessage = [NSString stringWithFormat:@"SAPCorp: User %@ now has standard user privileges", userName];
-            if ([reason length] > 0) { logMessage = [logMessage stringByAppendingFormat:@" (%@)", reason]; }
-            os_log(log, "%{public}@", logMessage);
-        
-        } else {
+            [self logPrivilegeChangeForUser:userName
+                       grantAdminPrivileges:grant
+                                     reason:reason
+                                  component:component
+                                     result:result
+            ];
             
-            NSString *logMessage = [NSString stringWithFormat:@"SAPCorp: Failed to change privileges for user %@", userName];
-            os_log_with_type(log, OS_LOG_TYPE_FAULT, "%{public}@", logMessage);
-        }
+            if (completionHandler) { completionHandler(result == MTPrivilegeChangeResultSuccess || result == MTPrivilegeChangeResultCoalesced); }
+        }];
+        
+    } else {
+        
+        if (completionHandler) { completionHandler(NO); }
     }
-    
-    if (completionHandler) { completionHandler(success); }
+}
+
+#pragma mark - Exported methods
+
+- (void)grantAdminRightsToUser:(NSString*)userName
+                        reason:(NSString*)reason
+                     component:(NSString*)component
+             completionHandler:(void(^)(BOOL success))completionHandler
+{
+    [self submitChangeForUser:userName
+         grantAdminPrivileges:YES
+                       reason:reason
+                    component:component
+            completionHandler:completionHandler
+    ];
+}
+
+- (void)removeAdminRightsFromUser:(NSString*)userName
+                           reason:(NSString*)reason
+                        component:(NSString*)component
+                completionHandler:(void(^)(BOOL success))completionHandler
+{
+    [self submitChangeForUser:userName
+         grantAdminPrivileges:NO
+                       reason:reason
+                    component:component
+            completionHandler:completionHandler
+    ];
 }
 
 - (void)queuedEventsWithReply:(void (^)(NSArray *queuedEvents, NSError *error))reply
@@ -26,27 +26,31 @@
 @protocol PrivilegesDaemonProtocol
 
 /*!
- @method        grantAdminRightsToUser:reason:completionHandler:
+ @method        grantAdminRightsToUser:reason:component:completionHandler:
  @abstract      Grant administrator privileges to the given user.
  @param         userName A string containing the user name.
  @param         reason A string containing the reason the user requests administrator privileges. May be nil.
+ @param         component A string containing the name of the client that originated the request (e.g. CLI). May be nil.
  @param         completionHandler The handler to call when the request is complete.
  @discussion    Returns YES if adminstrator privileges were successfully granted, otherwise returns NO.
 */
 - (void)grantAdminRightsToUser:(NSString*)userName
                         reason:(NSString*)reason
+                     component:(NSString*)component
              completionHandler:(void(^)(BOOL success))completionHandler;
 
 /*!
- @method        removeAdminRightsFromUser:reason:completionHandler:
+ @method        removeAdminRightsFromUser:reason:component:completionHandler:
  @abstract      Remove administrator privileges from the current user.
  @param         userName A string containing the user name.
  @param         reason A string containing the reason the user requests administrator privileges. May be nil.
+ @param         component A string containing the name of the client that originated the request (e.g. CLI). May be nil.
  @param         completionHandler The handler to call when the request is complete.
  @discussion    Returns YES if adminstrator privileges were successfully removed, otherwise returns NO.
 */
 - (void)removeAdminRightsFromUser:(NSString*)userName
                            reason:(NSString*)reason
+                        component:(NSString*)component
                 completionHandler:(void(^)(BOOL success))completionHandler;
 
 /*!
@@ -35,7 +35,7 @@
         self->_shouldTerminate = YES;
     });
     
-    while (!_shouldTerminate || [_privilegesDaemon numberOfActiveXPCConnections] > 0) {
+    while (!_shouldTerminate || [_privilegesDaemon numberOfActiveXPCConnections] > 0 || [_privilegesDaemon hasPendingOperations]) {
         
         [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:60]];
     }
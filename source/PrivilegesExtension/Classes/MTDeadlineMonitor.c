@@ -0,0 +1,60 @@
+/*
+    MTDeadlineMonitor.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTDeadlineMonitor.h"
+
+void mt_deadline_monitor_init(mt_deadline_monitor_t *monitor, uint64_t safetyMargin)
+{
+    atomic_init(&monitor->events, 0);
+    atomic_init(&monitor->nearMisses, 0);
+    atomic_init(&monitor->totalSlack, 0);
+    atomic_init(&monitor->minimumSlack, UINT64_MAX);
+    monitor->safetyMargin = safetyMargin;
+}
+
+bool mt_deadline_monitor_admit(mt_deadline_monitor_t *monitor, uint64_t slack, uint64_t budget)
+{
+    uint64_t threshold = (budget / 4 < monitor->safetyMargin) ? budget / 4 : monitor->safetyMargin;
+    bool admitted = (slack >= threshold);
+    
+    atomic_fetch_add_explicit(&monitor->events, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&monitor->totalSlack, slack, memory_order_relaxed);
+    if (!admitted) { atomic_fetch_add_explicit(&monitor->nearMisses, 1, memory_order_relaxed); }
+    
+    uint64_t minimumSlack = atomic_load_explicit(&monitor->minimumSlack, memory_order_relaxed);
+    
+    // on failure, minimumSlack is updated with the current value and we try again
+    while (slack < minimumSlack &&
+           !atomic_compare_exchange_weak_explicit(&monitor->minimumSlack, &minimumSlack, slack, memory_order_relaxed, memory_order_relaxed)) {}
+    
+    return admitted;
+}
+
+uint64_t mt_deadline_monitor_average_slack(mt_deadline_monitor_t *monitor)
+{
+    uint64_t events = atomic_load_explicit(&monitor->events, memory_order_relaxed);
+    uint64_t totalSlack = atomic_load_explicit(&monitor->totalSlack, memory_order_relaxed);
+    
+    return (events > 0) ? totalSlack / events : 0;
+}
+
+uint64_t mt_deadline_monitor_minimum_slack(mt_deadline_monitor_t *monitor)
+{
+    uint64_t minimumSlack = atomic_load_explicit(&monitor->minimumSlack, memory_order_relaxed);
+    
+    return (minimumSlack == UINT64_MAX) ? 0 : minimumSlack;
+}
@@ -0,0 +1,78 @@
+/*
+    MTDeadlineMonitor.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTDeadlineMonitor_h
+#define MTDeadlineMonitor_h
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+    Keeps track of how much time is left until the deadline of Endpoint Security authorization
+    events when a worker starts handling them. If the remaining time (the slack) drops below a
+    threshold, the worker should not evaluate the event but respond with a safe verdict right
+    away. The threshold is the safety margin, but at most a quarter of the event's total budget,
+    so events with short deadlines are not always answered with the safe verdict. Events without
+    a safe verdict (exec events) are still evaluated, but are counted as near misses as well.
+ 
+    The counters may be read from any thread while a worker updates them. All times are in
+    nanoseconds.
+*/
+
+typedef struct {
+    _Atomic uint64_t events;
+    _Atomic uint64_t nearMisses;
+    _Atomic uint64_t totalSlack;
+    _Atomic uint64_t minimumSlack;
+    uint64_t safetyMargin;
+} mt_deadline_monitor_t;
+
+/*!
+ @function      mt_deadline_monitor_init
+ @abstract      Initializes a monitor.
+ @param         monitor A pointer to the monitor.
+ @param         safetyMargin The minimum slack (in nanoseconds) an event must have to be evaluated.
+*/
+void mt_deadline_monitor_init(mt_deadline_monitor_t *monitor, uint64_t safetyMargin);
+
+/*!
+ @function      mt_deadline_monitor_admit
+ @abstract      Records the slack of an event and returns whether there's enough time left to evaluate it.
+ @param         monitor A pointer to the monitor.
+ @param         slack The time (in nanoseconds) until the event's deadline. Pass 0 if the deadline has passed.
+ @param         budget The time (in nanoseconds) between the creation of the event and its deadline.
+ @discussion    Returns true if the event should be evaluated or false if it should be answered with the
+                safe verdict. In the latter case, the event is counted as a near miss.
+*/
+bool mt_deadline_monitor_admit(mt_deadline_monitor_t *monitor, uint64_t slack, uint64_t budget);
+
+/*!
+ @function      mt_deadline_monitor_average_slack
+ @abstract      Returns the average slack (in nanoseconds) of all recorded events or 0 if no events have been recorded.
+ @param         monitor A pointer to the monitor.
+*/
+uint64_t mt_deadline_monitor_average_slack(mt_deadline_monitor_t *monitor);
+
+/*!
+ @function      mt_deadline_monitor_minimum_slack
+ @abstract      Returns the smallest slack (in nanoseconds) of all recorded events or 0 if no events have been recorded.
+ @param         monitor A pointer to the monitor.
+*/
+uint64_t mt_deadline_monitor_minimum_slack(mt_deadline_monitor_t *monitor);
+
+#endif /* MTDeadlineMonitor_h */
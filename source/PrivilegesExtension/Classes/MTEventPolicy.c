@@ -0,0 +1,159 @@
+/*
+    MTEventPolicy.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTEventPolicy.h"
+#include <limits.h>
+#include <string.h>
+
+static const char kLaunchctlSigningID[] = "com.apple.xpc.launchctl";
+
+static inline bool mt_event_string_equals(mt_event_string_t string, const char *other, size_t length)
+{
+    return (string.length == length && memcmp(string.data, other, length) == 0);
+}
+
+static inline bool mt_event_path_is_protected(const mt_path_trie_t *trie, mt_event_string_t path)
+{
+    return (!trie || mt_path_trie_matches(trie, path.data, path.length));
+}
+
+static bool mt_event_destination_is_protected(const mt_path_trie_t *trie, mt_event_string_t destination, mt_event_string_t name)
+{
+    bool isProtected = mt_event_path_is_protected(trie, destination);
+    
+    if (!isProtected && name.length > 0) {
+        
+        char path[PATH_MAX + NAME_MAX + 2];
+        
+        if (destination.length + name.length + 1 < sizeof(path)) {
+            
+            memcpy(path, destination.data, destination.length);
+            path[destination.length] = '/';
+            memcpy(path + destination.length + 1, name.data, name.length);
+            isProtected = mt_path_trie_matches(trie, path, destination.length + name.length + 1);
+        }
+    }
+    
+    return isProtected;
+}
+
+// the key of a cached exec verdict consists of the executable's identity and its arguments
+static uint64_t mt_event_exec_hash(const mt_verdict_cache_t *cache, const mt_event_t *event)
+{
+    mt_verdict_hash_t hash;
+    mt_verdict_hash_begin(cache, &hash);
+    mt_verdict_hash_update(&hash, event->source.data, event->source.length);
+    mt_verdict_hash_update(&hash, event->signingID.data, event->signingID.length);
+    
+    for (uint32_t i = 1; i < event->argumentCount; i++) {
+        
+        mt_event_string_t argument = event->argument(event->argumentContext, i);
+        mt_verdict_hash_update(&hash, argument.data, argument.length);
+    }
+    
+    return mt_verdict_hash_end(&hash);
+}
+
+static MTEventVerdict mt_event_evaluate_exec_arguments(const mt_event_policy_t *policy, const mt_event_t *event, uint32_t *deniedArgument)
+{
+    MTEventVerdict verdict = MTEventVerdictAllow;
+    
+    for (uint32_t i = 2; i < event->argumentCount; i++) {
+        
+        mt_event_string_t argument = event->argument(event->argumentContext, i);
+        
+        if (argument.length > 0 && mt_glob_match(policy->protectedPlists, argument.data, argument.length)) {
+            
+            verdict = MTEventVerdictDeny;
+            *deniedArgument = i;
+            break;
+        }
+    }
+    
+    return verdict;
+}
+
+// the exec client only receives events for launchctl. We deny unloading
+// (or booting out) any of our launchd plists
+static MTEventVerdict mt_event_evaluate_exec(const mt_event_policy_t *policy, const mt_event_t *event, mt_event_string_t *loggedPath)
+{
+    MTEventVerdict verdict = MTEventVerdictAllow;
+    
+    if (event->isPlatformBinary && event->argumentCount > 2 && mt_event_path_is_protected(policy->protectedExecutables, event->source) &&
+        mt_event_string_equals(event->signingID, kLaunchctlSigningID, sizeof(kLaunchctlSigningID) - 1)) {
+        
+        mt_event_string_t verb = event->argument(event->argumentContext, 1);
+        
+        if (mt_event_string_equals(verb, "unload", 6) || mt_event_string_equals(verb, "bootout", 7)) {
+            
+            uint32_t deniedArgument = 0;
+            
+            if (policy->execVerdicts) {
+                
+                uint64_t hash = mt_event_exec_hash(policy->execVerdicts, event);
+                int cachedVerdict = 0;
+                
+                if (mt_verdict_cache_lookup(policy->execVerdicts, hash, policy->execVerdictGeneration, &cachedVerdict, &deniedArgument)) {
+                    
+                    verdict = (cachedVerdict) ? MTEventVerdictDeny : MTEventVerdictAllow;
+                    
+                } else {
+                    
+                    verdict = mt_event_evaluate_exec_arguments(policy, event, &deniedArgument);
+                    mt_verdict_cache_insert(policy->execVerdicts, hash, policy->execVerdictGeneration, verdict, deniedArgument);
+                }
+                
+            } else {
+                
+                verdict = mt_event_evaluate_exec_arguments(policy, event, &deniedArgument);
+            }
+            
+            if (verdict == MTEventVerdictDeny) { *loggedPath = event->argument(event->argumentContext, deniedArgument); }
+        }
+    }
+    
+    return verdict;
+}
+
+MTEventVerdict mt_event_policy_evaluate(const mt_event_policy_t *policy, const mt_event_t *event, mt_event_string_t *loggedPath)
+{
+    MTEventVerdict verdict = MTEventVerdictAllow;
+    mt_event_string_t path = event->source;
+    
+    // Endpoint Security only delivers events for protected paths, but we check the
+    // paths again because the tries may have been updated after the event was created
+    switch (event->type) {
+            
+        case MTEventTypeUnlink:
+            if (mt_event_path_is_protected(policy->protectedFiles, event->source)) { verdict = MTEventVerdictDeny; }
+            break;
+            
+        case MTEventTypeRename:
+        case MTEventTypeClone:
+            if (mt_event_path_is_protected(policy->protectedFiles, event->source) ||
+                mt_event_destination_is_protected(policy->protectedFiles, event->destination, event->destinationName)) { verdict = MTEventVerdictDeny; }
+            break;
+            
+        case MTEventTypeExec:
+            verdict = mt_event_evaluate_exec(policy, event, &path);
+            break;
+    }
+    
+    if (loggedPath) { *loggedPath = path; }
+    
+    return verdict;
+}
@@ -0,0 +1,89 @@
+/*
+    MTEventPolicy.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTEventPolicy_h
+#define MTEventPolicy_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "MTGlobPattern.h"
+#include "MTPathTrie.h"
+#include "MTVerdictCache.h"
+
+/*
+    The decision logic of the system extension's event handlers. It works on a small view of
+    the fields of an Endpoint Security message the handlers need (mt_event_t) instead of the
+    message itself, so the very same logic can be fed with recorded or synthetic events (see
+    MTEventRecorder.h) on machines without Endpoint Security. Creating the view from a message
+    does not copy any strings.
+*/
+
+typedef enum {
+    MTEventTypeUnlink   = 0,
+    MTEventTypeRename   = 1,
+    MTEventTypeClone    = 2,
+    MTEventTypeExec     = 3
+} MTEventType;
+
+typedef enum {
+    MTEventVerdictAllow = 0,
+    MTEventVerdictDeny  = 1
+} MTEventVerdict;
+
+// same layout as es_string_token_t
+typedef struct {
+    size_t length;
+    const char *data;
+} mt_event_string_t;
+
+typedef mt_event_string_t (*mt_event_argument_function_t)(const void *context, uint32_t index);
+
+typedef struct {
+    MTEventType type;
+    mt_event_string_t source;           // the unlinked file, the renamed or cloned file or the executable
+    mt_event_string_t destination;      // the destination file or directory of a rename or clone
+    mt_event_string_t destinationName;  // the file name, if the destination is a directory
+    mt_event_string_t signingID;        // exec only
+    bool isPlatformBinary;              // exec only
+    uint32_t argumentCount;             // exec only
+    mt_event_argument_function_t argument;
+    const void *argumentContext;
+} mt_event_t;
+
+typedef struct {
+    const mt_path_trie_t *protectedFiles;
+    const mt_path_trie_t *protectedExecutables;
+    const mt_glob_t *protectedPlists;
+    mt_verdict_cache_t *execVerdicts;       // may be NULL
+    uint32_t execVerdictGeneration;         // the cache generation at the time the tries were loaded
+} mt_event_policy_t;
+
+/*!
+ @function      mt_event_policy_evaluate
+ @abstract      Decides whether the given event should be allowed or denied.
+ @param         policy A pointer to the policy. If one of its tries is NULL, every path is treated as protected.
+ @param         event A pointer to the event.
+ @param         loggedPath A pointer to a string that receives the path that should be logged if
+                the event is denied. May be NULL.
+ @discussion    Returns the verdict. The function does not allocate any memory. If the policy has a
+                verdict cache, the verdicts for launchctl invocations that unload or boot out services
+                are cached, because checking their arguments is the most expensive part of the policy.
+*/
+MTEventVerdict mt_event_policy_evaluate(const mt_event_policy_t *policy, const mt_event_t *event, mt_event_string_t *loggedPath);
+
+#endif /* MTEventPolicy_h */
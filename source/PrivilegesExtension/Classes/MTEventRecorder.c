@@ -0,0 +1,304 @@
+/*
+    MTEventRecorder.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTEventRecorder.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MT_EVENT_RECORDING_MAGIC            "PRVESR01"
+#define MT_EVENT_RECORDING_HEADER_LENGTH    8
+#define MT_EVENT_RECORD_LENGTH              20
+#define MT_EVENT_RECORD_FIXED_STRINGS       4
+
+struct mt_event_recorder {
+    int fd;
+    pthread_mutex_t lock;
+    uint8_t *buffer;
+    size_t bufferLength;
+};
+
+struct mt_event_player {
+    const uint8_t *map;
+    size_t length;
+    size_t offset;
+    mt_event_string_t *arguments;
+    uint32_t argumentCapacity;
+};
+
+#pragma mark - Encoding
+
+static void mt_event_put_uint(uint8_t *bytes, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; i++) { bytes[i] = (uint8_t)(value >> (8 * i)); }
+}
+
+static uint64_t mt_event_get_uint(const uint8_t *bytes, size_t size)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) { value |= (uint64_t)bytes[i] << (8 * i); }
+    
+    return value;
+}
+
+static uint8_t *mt_event_put_string(uint8_t *bytes, mt_event_string_t string)
+{
+    mt_event_put_uint(bytes, string.length, 4);
+    if (string.length > 0) { memcpy(bytes + 4, string.data, string.length); }
+    
+    return bytes + 4 + string.length;
+}
+
+// decodes the string at the given offset and makes sure it is
+// completely contained in the record ending at the given offset
+static int mt_event_get_string(const uint8_t *data, size_t *offset, size_t end, mt_event_string_t *string)
+{
+    if (end - *offset < 4) { return -1; }
+    
+    size_t length = (size_t)mt_event_get_uint(data + *offset, 4);
+    if (end - *offset - 4 < length) { return -1; }
+    
+    string->length = length;
+    string->data = (const char*)data + *offset + 4;
+    *offset += 4 + length;
+    
+    return 0;
+}
+
+static mt_event_string_t mt_event_player_argument(const void *context, uint32_t index)
+{
+    return ((const mt_event_string_t*)context)[index];
+}
+
+#pragma mark - Recording
+
+mt_event_recorder_t *mt_event_recorder_open(const char *path)
+{
+    mt_event_recorder_t *recorder = calloc(1, sizeof(mt_event_recorder_t));
+    
+    if (recorder) {
+        
+        recorder->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        
+        if (recorder->fd < 0 || write(recorder->fd, MT_EVENT_RECORDING_MAGIC, MT_EVENT_RECORDING_HEADER_LENGTH) != MT_EVENT_RECORDING_HEADER_LENGTH) {
+            
+            int savedErrno = errno;
+            if (recorder->fd >= 0) { close(recorder->fd); }
+            free(recorder);
+            recorder = NULL;
+            errno = savedErrno;
+            
+        } else {
+            
+            pthread_mutex_init(&recorder->lock, NULL);
+        }
+    }
+    
+    return recorder;
+}
+
+int mt_event_recorder_write(mt_event_recorder_t *recorder, const mt_event_t *event, MTEventVerdict verdict, uint64_t timestamp)
+{
+    int result = 0;
+    uint32_t argumentCount = (event->type == MTEventTypeExec) ? event->argumentCount : 0;
+    size_t recordLength = MT_EVENT_RECORD_LENGTH + 4 * (MT_EVENT_RECORD_FIXED_STRINGS + (size_t)argumentCount) +
+                          event->source.length + event->destination.length + event->destinationName.length + event->signingID.length;
+    
+    for (uint32_t i = 0; i < argumentCount; i++) { recordLength += event->argument(event->argumentContext, i).length; }
+    
+    if (recordLength > UINT32_MAX) {
+        
+        errno = EOVERFLOW;
+        return -1;
+    }
+    
+    pthread_mutex_lock(&recorder->lock);
+    
+    if (recorder->bufferLength < recordLength) {
+        
+        uint8_t *buffer = realloc(recorder->buffer, recordLength);
+        
+        if (buffer) {
+            recorder->buffer = buffer;
+            recorder->bufferLength = recordLength;
+        } else {
+            result = -1;
+        }
+    }
+    
+    if (result == 0) {
+        
+        uint8_t *bytes = recorder->buffer;
+        mt_event_put_uint(bytes, recordLength, 4);
+        mt_event_put_uint(bytes + 4, timestamp, 8);
+        bytes[12] = (uint8_t)event->type;
+        bytes[13] = (uint8_t)verdict;
+        bytes[14] = (event->isPlatformBinary) ? 1 : 0;
+        bytes[15] = 0;
+        mt_event_put_uint(bytes + 16, argumentCount, 4);
+        
+        bytes = mt_event_put_string(bytes + MT_EVENT_RECORD_LENGTH, event->source);
+        bytes = mt_event_put_string(bytes, event->destination);
+        bytes = mt_event_put_string(bytes, event->destinationName);
+        bytes = mt_event_put_string(bytes, event->signingID);
+        
+        for (uint32_t i = 0; i < argumentCount; i++) { bytes = mt_event_put_string(bytes, event->argument(event->argumentContext, i)); }
+        
+        size_t written = 0;
+        
+        while (written < recordLength) {
+            
+            ssize_t count = write(recorder->fd, recorder->buffer + written, recordLength - written);
+            
+            if (count < 0) {
+                
+                if (errno == EINTR) { continue; }
+                result = -1;
+                break;
+            }
+            
+            written += (size_t)count;
+        }
+    }
+    
+    pthread_mutex_unlock(&recorder->lock);
+    
+    return result;
+}
+
+void mt_event_recorder_close(mt_event_recorder_t *recorder)
+{
+    if (recorder) {
+        
+        close(recorder->fd);
+        pthread_mutex_destroy(&recorder->lock);
+        free(recorder->buffer);
+        free(recorder);
+    }
+}
+
+#pragma mark - Playback
+
+mt_event_player_t *mt_event_player_open(const char *path)
+{
+    mt_event_player_t *player = NULL;
+    struct stat fileInfo;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    
+    if (fd >= 0) {
+        
+        if (fstat(fd, &fileInfo) == 0 && fileInfo.st_size >= MT_EVENT_RECORDING_HEADER_LENGTH) {
+            
+            void *map = mmap(NULL, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            
+            if (map != MAP_FAILED) {
+                
+                if (memcmp(map, MT_EVENT_RECORDING_MAGIC, MT_EVENT_RECORDING_HEADER_LENGTH) == 0 &&
+                    (player = calloc(1, sizeof(mt_event_player_t)))) {
+                    
+                    player->map = map;
+                    player->length = (size_t)fileInfo.st_size;
+                    player->offset = MT_EVENT_RECORDING_HEADER_LENGTH;
+                    
+                } else {
+                    
+                    munmap(map, (size_t)fileInfo.st_size);
+                }
+            }
+        }
+        
+        // the mapping stays valid after closing the file
+        close(fd);
+    }
+    
+    return player;
+}
+
+int mt_event_player_next(mt_event_player_t *player, mt_event_t *event, MTEventVerdict *verdict, uint64_t *timestamp)
+{
+    if (player->offset == player->length) { return 0; }
+    if (player->length - player->offset < MT_EVENT_RECORD_LENGTH) { return -1; }
+    
+    const uint8_t *bytes = player->map + player->offset;
+    size_t recordLength = (size_t)mt_event_get_uint(bytes, 4);
+    uint8_t type = bytes[12];
+    uint32_t argumentCount = (uint32_t)mt_event_get_uint(bytes + 16, 4);
+    
+    if (recordLength < MT_EVENT_RECORD_LENGTH || recordLength > player->length - player->offset || type > MTEventTypeExec) { return -1; }
+    
+    // every argument takes at least 4 bytes, so this also rejects
+    // argument counts that would make us allocate huge amounts of memory
+    if (argumentCount > (recordLength - MT_EVENT_RECORD_LENGTH) / 4) { return -1; }
+    
+    if (argumentCount > player->argumentCapacity) {
+        
+        mt_event_string_t *arguments = realloc(player->arguments, argumentCount * sizeof(mt_event_string_t));
+        if (!arguments) { return -1; }
+        
+        player->arguments = arguments;
+        player->argumentCapacity = argumentCount;
+    }
+    
+    size_t offset = player->offset + MT_EVENT_RECORD_LENGTH;
+    size_t end = player->offset + recordLength;
+    
+    memset(event, 0, sizeof(mt_event_t));
+    event->type = (MTEventType)type;
+    event->isPlatformBinary = (bytes[14] != 0);
+    
+    if (mt_event_get_string(player->map, &offset, end, &event->source) != 0 ||
+        mt_event_get_string(player->map, &offset, end, &event->destination) != 0 ||
+        mt_event_get_string(player->map, &offset, end, &event->destinationName) != 0 ||
+        mt_event_get_string(player->map, &offset, end, &event->signingID) != 0) { return -1; }
+    
+    for (uint32_t i = 0; i < argumentCount; i++) {
+        if (mt_event_get_string(player->map, &offset, end, &player->arguments[i]) != 0) { return -1; }
+    }
+    
+    if (offset != end) { return -1; }
+    
+    event->argumentCount = argumentCount;
+    event->argument = mt_event_player_argument;
+    event->argumentContext = player->arguments;
+    
+    if (verdict) { *verdict = (bytes[13] == MTEventVerdictDeny) ? MTEventVerdictDeny : MTEventVerdictAllow; }
+    if (timestamp) { *timestamp = mt_event_get_uint(bytes + 4, 8); }
+    
+    player->offset = end;
+    
+    return 1;
+}
+
+void mt_event_player_rewind(mt_event_player_t *player)
+{
+    player->offset = MT_EVENT_RECORDING_HEADER_LENGTH;
+}
+
+void mt_event_player_close(mt_event_player_t *player)
+{
+    if (player) {
+        
+        munmap((void*)player->map, player->length);
+        free(player->arguments);
+        free(player);
+    }
+}
@@ -0,0 +1,106 @@
+/*
+    MTEventRecorder.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTEventRecorder_h
+#define MTEventRecorder_h
+
+#include <stdint.h>
+#include "MTEventPolicy.h"
+
+/*
+    Records events (as seen by mt_event_policy_evaluate) and the verdicts they received to a
+    file, and plays them back. Recorded (or synthetic) event streams can be fed into the same
+    decision logic the system extension uses, to test and benchmark it without a live
+    Endpoint Security client.
+ 
+    A recording starts with an 8 byte header ("PRVESR01") followed by variable length records.
+    Each record starts with a 20 byte fixed part (record length, timestamp, event type, verdict,
+    platform binary flag, one reserved byte and the number of arguments), followed by the
+    source, the destination, the destination name, the signing id and the arguments. Every
+    string is stored as a 4 byte length followed by its bytes (not null-terminated). All
+    integers are stored in little endian byte order.
+*/
+
+typedef struct mt_event_recorder mt_event_recorder_t;
+typedef struct mt_event_player mt_event_player_t;
+
+/*!
+ @function      mt_event_recorder_open
+ @abstract      Creates a new recording at the given path. An existing file is replaced.
+ @param         path A null-terminated string containing the path of the recording.
+ @discussion    Returns the recorder or NULL if an error occurred (errno is set). The caller is
+                responsible for closing the recorder using mt_event_recorder_close.
+*/
+mt_event_recorder_t *mt_event_recorder_open(const char *path);
+
+/*!
+ @function      mt_event_recorder_write
+ @abstract      Appends the given event to the recording.
+ @param         recorder A pointer to the recorder.
+ @param         event A pointer to the event.
+ @param         verdict The verdict the event received.
+ @param         timestamp The time of the event (in nanoseconds of a monotonic clock).
+ @discussion    Returns 0 on success, otherwise returns -1 and sets errno. May be called from
+                multiple threads.
+*/
+int mt_event_recorder_write(mt_event_recorder_t *recorder, const mt_event_t *event, MTEventVerdict verdict, uint64_t timestamp);
+
+/*!
+ @function      mt_event_recorder_close
+ @abstract      Closes the recording.
+ @param         recorder A pointer to the recorder. May be NULL.
+*/
+void mt_event_recorder_close(mt_event_recorder_t *recorder);
+
+/*!
+ @function      mt_event_player_open
+ @abstract      Opens the recording at the given path for playback.
+ @param         path A null-terminated string containing the path of the recording.
+ @discussion    Returns the player or NULL if the file could not be opened or is not a recording.
+                The caller is responsible for closing the player using mt_event_player_close.
+*/
+mt_event_player_t *mt_event_player_open(const char *path);
+
+/*!
+ @function      mt_event_player_next
+ @abstract      Returns the next event of the recording.
+ @param         player A pointer to the player.
+ @param         event A pointer to an event that receives the next event. Its strings point into
+                the recording and are valid until the player is closed, its arguments are valid
+                until the next call of this function.
+ @param         verdict A pointer to a variable that receives the recorded verdict. May be NULL.
+ @param         timestamp A pointer to a variable that receives the recorded timestamp. May be NULL.
+ @discussion    Returns 1 if an event has been returned, 0 at the end of the recording or -1 if
+                the recording is damaged.
+*/
+int mt_event_player_next(mt_event_player_t *player, mt_event_t *event, MTEventVerdict *verdict, uint64_t *timestamp);
+
+/*!
+ @function      mt_event_player_rewind
+ @abstract      Restarts the playback at the first event.
+ @param         player A pointer to the player.
+*/
+void mt_event_player_rewind(mt_event_player_t *player);
+
+/*!
+ @function      mt_event_player_close
+ @abstract      Closes the recording.
+ @param         player A pointer to the player. May be NULL.
+*/
+void mt_event_player_close(mt_event_player_t *player);
+
+#endif /* MTEventRecorder_h */
@@ -0,0 +1,112 @@
+/*
+    MTEventRing.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTEventRing.h"
+#include <string.h>
+
+#define MT_EVENT_RING_MASK  (MT_EVENT_RING_CAPACITY - 1)
+
+_Static_assert((MT_EVENT_RING_CAPACITY & MT_EVENT_RING_MASK) == 0, "The ring capacity must be a power of two");
+
+void mt_event_ring_init(mt_event_ring_t *ring)
+{
+    for (uint64_t i = 0; i < MT_EVENT_RING_CAPACITY; i++) {
+        atomic_init(&ring->slots[i].sequence, i);
+    }
+    
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->dropped, 0);
+    ring->tail = 0;
+}
+
+bool mt_event_ring_push(mt_event_ring_t *ring, MTEventType type, const char *path, size_t length)
+{
+    bool success = false;
+    mt_event_slot_t *slot = NULL;
+    uint64_t position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    
+    for (;;) {
+        
+        slot = &ring->slots[position & MT_EVENT_RING_MASK];
+        uint64_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int64_t difference = (int64_t)(sequence - position);
+        
+        if (difference == 0) {
+            
+            // the slot is free, try to claim it. On failure, position
+            // is updated with the current head and we try again
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                success = true;
+                break;
+            }
+            
+        } else if (difference < 0) {
+            
+            // the slot still holds a record of the previous lap, so the ring is full
+            break;
+            
+        } else {
+            
+            position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+    
+    if (success) {
+        
+        mt_event_record_t *record = &slot->record;
+        size_t copyLength = (length < MT_EVENT_RING_PATH_LENGTH) ? length : MT_EVENT_RING_PATH_LENGTH - 1;
+        
+        record->type = (uint8_t)type;
+        record->truncated = (copyLength < length);
+        record->pathLength = (uint16_t)copyLength;
+        memcpy(record->path, path, copyLength);
+        record->path[copyLength] = '\0';
+        
+        atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+        
+    } else {
+        
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+    }
+    
+    return success;
+}
+
+bool mt_event_ring_pop(mt_event_ring_t *ring, mt_event_record_t *record)
+{
+    bool success = false;
+    mt_event_slot_t *slot = &ring->slots[ring->tail & MT_EVENT_RING_MASK];
+    uint64_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    
+    if (sequence == ring->tail + 1) {
+        
+        memcpy(record, &slot->record, offsetof(mt_event_record_t, path) + slot->record.pathLength + 1);
+        
+        // hand the slot back to the producers for the next lap
+        atomic_store_explicit(&slot->sequence, ring->tail + MT_EVENT_RING_CAPACITY, memory_order_release);
+        ring->tail++;
+        success = true;
+    }
+    
+    return success;
+}
+
+uint64_t mt_event_ring_take_dropped(mt_event_ring_t *ring)
+{
+    return atomic_exchange_explicit(&ring->dropped, 0, memory_order_relaxed);
+}
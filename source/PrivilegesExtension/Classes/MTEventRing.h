@@ -0,0 +1,98 @@
+/*
+    MTEventRing.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTEventRing_h
+#define MTEventRing_h
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "MTEventPolicy.h"
+
+/*
+    A bounded, lock-free ring buffer of fixed-size event records. Any number of threads may
+    push records concurrently (the Endpoint Security clients call their handlers on different
+    queues), but only a single thread may pop them. Pushing never blocks and never allocates.
+    If the ring is full, the record is dropped and counted instead.
+ 
+    Every slot carries a sequence number that tells producers and the consumer whether the slot
+    is free or holds a record for the current lap. A producer claims a slot by advancing the
+    head with a compare-and-swap and publishes the record by updating the slot's sequence
+    number, so the consumer never sees a partially written record.
+*/
+
+#define MT_EVENT_RING_CAPACITY      256
+#define MT_EVENT_RING_PATH_LENGTH   1024
+
+typedef struct {
+    uint8_t type;
+    uint8_t truncated;
+    uint16_t pathLength;
+    char path[MT_EVENT_RING_PATH_LENGTH];
+} mt_event_record_t;
+
+typedef struct {
+    _Atomic uint64_t sequence;
+    mt_event_record_t record;
+} mt_event_slot_t;
+
+typedef struct {
+    mt_event_slot_t slots[MT_EVENT_RING_CAPACITY];
+    _Atomic uint64_t head;
+    _Atomic uint64_t dropped;
+    uint64_t tail;
+} mt_event_ring_t;
+
+/*!
+ @function      mt_event_ring_init
+ @abstract      Initializes an empty ring.
+ @param         ring A pointer to the ring.
+*/
+void mt_event_ring_init(mt_event_ring_t *ring);
+
+/*!
+ @function      mt_event_ring_push
+ @abstract      Adds a record to the ring.
+ @param         ring A pointer to the ring.
+ @param         type The event type.
+ @param         path The path the event refers to. Does not need to be null-terminated.
+ @param         length The length of the path (in bytes). Longer paths are truncated.
+ @discussion    Returns true if the record has been added or false if the ring was full and the
+                record has been dropped. May be called from any thread.
+*/
+bool mt_event_ring_push(mt_event_ring_t *ring, MTEventType type, const char *path, size_t length);
+
+/*!
+ @function      mt_event_ring_pop
+ @abstract      Removes the oldest record from the ring.
+ @param         ring A pointer to the ring.
+ @param         record A pointer to a record that receives a copy of the removed record. The
+                path is null-terminated.
+ @discussion    Returns true if a record has been removed or false if the ring was empty. Must
+                only be called from a single thread at a time.
+*/
+bool mt_event_ring_pop(mt_event_ring_t *ring, mt_event_record_t *record);
+
+/*!
+ @function      mt_event_ring_take_dropped
+ @abstract      Returns the number of records dropped since the last call and resets the counter.
+ @param         ring A pointer to the ring.
+*/
+uint64_t mt_event_ring_take_dropped(mt_event_ring_t *ring);
+
+#endif /* MTEventRing_h */
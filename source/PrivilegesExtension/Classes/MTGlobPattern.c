@@ -0,0 +1,148 @@
+/*
+    MTGlobPattern.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTGlobPattern.h"
+#include <string.h>
+
+static inline char mt_glob_lower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+static inline bool mt_glob_segment_matches(const mt_glob_t *glob, const mt_glob_segment_t *segment, const char *string)
+{
+    bool matches = true;
+    const char *pattern = glob->pattern + segment->offset;
+    
+    for (uint16_t i = 0; i < segment->length; i++) {
+        
+        if (pattern[i] != '?' && pattern[i] != mt_glob_lower(string[i])) {
+            matches = false;
+            break;
+        }
+    }
+    
+    return matches;
+}
+
+int mt_glob_compile(mt_glob_t *glob, const char *pattern)
+{
+    int result = -1;
+    size_t length = strlen(pattern);
+    
+    memset(glob, 0, sizeof(mt_glob_t));
+    
+    if (length < MT_GLOB_MAX_LENGTH) {
+        
+        result = 0;
+        glob->anchoredStart = (length == 0 || pattern[0] != '*');
+        glob->anchoredEnd = (length == 0 || pattern[length - 1] != '*');
+        
+        size_t segmentStart = 0;
+        
+        for (size_t i = 0; i <= length; i++) {
+            
+            if (i == length || pattern[i] == '*') {
+                
+                // consecutive wildcards do not produce empty segments
+                if (i > segmentStart) {
+                    
+                    if (glob->segmentCount == MT_GLOB_MAX_SEGMENTS) {
+                        result = -1;
+                        break;
+                    }
+                    
+                    glob->segments[glob->segmentCount].offset = (uint16_t)segmentStart;
+                    glob->segments[glob->segmentCount].length = (uint16_t)(i - segmentStart);
+                    glob->minLength += (uint16_t)(i - segmentStart);
+                    glob->segmentCount++;
+                }
+                
+                segmentStart = i + 1;
+                
+            } else {
+                
+                glob->pattern[i] = mt_glob_lower(pattern[i]);
+            }
+        }
+    }
+    
+    return result;
+}
+
+bool mt_glob_match(const mt_glob_t *glob, const char *string, size_t length)
+{
+    bool matches = (length >= glob->minLength);
+    
+    if (matches) {
+        
+        if (glob->segmentCount == 0) {
+            
+            // the pattern is either empty or consists of wildcards only
+            matches = (!glob->anchoredStart || length == 0);
+            
+        } else {
+            
+            uint8_t first = 0;
+            uint8_t last = glob->segmentCount;
+            size_t start = 0;
+            size_t end = length;
+            
+            if (glob->anchoredStart) {
+                
+                matches = mt_glob_segment_matches(glob, &glob->segments[0], string);
+                start = glob->segments[0].length;
+                first = 1;
+            }
+            
+            if (matches && glob->anchoredEnd && last > first) {
+                
+                const mt_glob_segment_t *segment = &glob->segments[last - 1];
+                end = length - segment->length;
+                matches = (end >= start && mt_glob_segment_matches(glob, segment, string + end));
+                last--;
+                
+            } else if (matches && glob->anchoredEnd && glob->segmentCount == 1) {
+                
+                // a pattern without any "*" must match the whole string
+                matches = (length == start);
+            }
+            
+            // the remaining segments are matched leftmost-first, which is
+            // sufficient because every gap between them matches anything
+            for (uint8_t i = first; matches && i < last; i++) {
+                
+                const mt_glob_segment_t *segment = &glob->segments[i];
+                bool found = false;
+                
+                while (!found && start + segment->length <= end) {
+                    
+                    if (mt_glob_segment_matches(glob, segment, string + start)) {
+                        found = true;
+                    } else {
+                        start++;
+                    }
+                }
+                
+                matches = found;
+                start += segment->length;
+            }
+        }
+    }
+    
+    return matches;
+}
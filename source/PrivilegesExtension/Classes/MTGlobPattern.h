@@ -0,0 +1,73 @@
+/*
+    MTGlobPattern.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTGlobPattern_h
+#define MTGlobPattern_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    A precompiled, case-insensitive glob pattern supporting the wildcards "*" (any number of
+    characters) and "?" (exactly one character). This matches the semantics of an NSPredicate
+    "LIKE[c]" comparison for ASCII strings, but works directly on the bytes of a (not necessarily
+    null-terminated) string and never allocates memory. So it can be used within the deadline
+    of an Endpoint Security authorization event.
+ 
+    The pattern is split at its "*" wildcards into literal segments once, at compile time. The
+    first and the last segment are anchored to the start and the end of the string (unless the
+    pattern starts or ends with "*"), all other segments are searched for from left to right.
+*/
+
+#define MT_GLOB_MAX_LENGTH      256
+#define MT_GLOB_MAX_SEGMENTS    16
+
+typedef struct {
+    uint16_t offset;
+    uint16_t length;
+} mt_glob_segment_t;
+
+typedef struct {
+    char pattern[MT_GLOB_MAX_LENGTH];
+    mt_glob_segment_t segments[MT_GLOB_MAX_SEGMENTS];
+    uint16_t minLength;
+    uint8_t segmentCount;
+    bool anchoredStart;
+    bool anchoredEnd;
+} mt_glob_t;
+
+/*!
+ @function      mt_glob_compile
+ @abstract      Compiles the given pattern.
+ @param         glob A pointer to the compiled pattern.
+ @param         pattern The null-terminated pattern.
+ @discussion    Returns 0 on success or -1 if the pattern is too long or contains too many wildcards.
+*/
+int mt_glob_compile(mt_glob_t *glob, const char *pattern);
+
+/*!
+ @function      mt_glob_match
+ @abstract      Returns whether the given string matches the compiled pattern.
+ @param         glob A pointer to the compiled pattern.
+ @param         string The string. Does not need to be null-terminated.
+ @param         length The length of the string (in bytes).
+ @discussion    Returns true if the whole string matches the pattern, otherwise returns false.
+*/
+bool mt_glob_match(const mt_glob_t *glob, const char *string, size_t length);
+
+#endif /* MTGlobPattern_h */
@@ -16,14 +16,17 @@
 */
 
 #import "MTParentProcess.h"
-#import <sys/sysctl.h>
-#import <libproc.h>
+#import "MTProcessTable.h"
+#import <os/log.h>
 
 @interface MTParentProcess ()
 @property pid_t childPID;
 @end
 
 @implementation MTParentProcess
+{
+    mt_process_table_t *_processTable;
+}
 
 - (instancetype)initWithChildPID:(pid_t)pid
 {
@@ -32,66 +35,52 @@
     if (self) {
         
         _childPID = pid;
-        if (_childPID <= 0) { self = nil; }
-    }
-    
-    return self;
-}
-
-- (MTProcess*)root
-{
-    pid_t pid = _childPID;
-    pid_t parentPID = 0;
-    
-    while (pid > 1) {
-
-        parentPID = pid;
-        MTProcess *directParent = [self directParentOfPID:pid];
-
-        if ([directParent pid] > 1) {
+        
+        if (_childPID > 0) {
+            
+            // take a single snapshot of the process table, so walking up
+            // the ancestry does not require any further system calls
+            _processTable = mt_process_table_create();
+            
+            if (!_processTable) {
+                
+                os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to get process table: %{public}s", strerror(errno));
+                self = nil;
+            }
             
-            pid = [directParent pid];
-
         } else {
             
-            break;
+            self = nil;
         }
     }
     
-    MTProcess *process = [[MTProcess alloc] initWithPID:parentPID];
-    
-    return process;
+    return self;
 }
 
-- (MTProcess*)parent
+- (void)dealloc
 {
-    return [self directParentOfPID:_childPID];
+    mt_process_table_destroy(_processTable);
 }
 
-- (MTProcess*)directParentOfPID:(pid_t)pid
+- (MTProcess*)root
 {
-    struct kinfo_proc proc;
-    pid_t parent = -1;
-    
-    if (pid > 1) {
-        
-        if ([self processInfoWithPID:pid proc:&proc]) {
-            
-            parent = proc.kp_eproc.e_ppid;
-        }
-    }
-    
-    MTProcess *process = [[MTProcess alloc] initWithPID:parent];
+    return [self processWithPID:mt_process_table_root(_processTable, _childPID)];
+}
+
+- (MTProcess*)parent
+{
+    pid_t parentPID = 0;
+    mt_process_table_ancestors(_processTable, _childPID, &parentPID, 1);
     
-    return process;
+    return [self processWithPID:parentPID];
 }
 
-- (BOOL)processInfoWithPID:(pid_t)pid proc:(struct kinfo_proc *)proc
+- (MTProcess*)processWithPID:(pid_t)pid
 {
-    int mib[4] = {CTL_KERN, KERN_PROC, KERN_PROC_PID, pid};
-    size_t size = sizeof(struct kinfo_proc);
+    const char *path = (pid > 1) ? mt_process_table_path(_processTable, pid) : NULL;
+    MTProcess *process = [[MTProcess alloc] initWithPID:pid executablePath:(path) ? [NSString stringWithUTF8String:path] : nil];
     
-    return sysctl(mib, 4, proc, &size, NULL, 0) == 0;
+    return process;
 }
 
 @end
@@ -0,0 +1,210 @@
+/*
+    MTPathTrie.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTPathTrie.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t labelOffset;
+    uint32_t labelLength;
+    uint32_t firstChild;
+    uint32_t childCount;
+    bool terminal;
+} mt_path_trie_node_t;
+
+struct mt_path_trie {
+    mt_path_trie_node_t *nodes;
+    const char *labels;
+    uint32_t nodeCount;
+};
+
+typedef struct {
+    mt_path_trie_t *trie;
+    const char **prefixes;
+    const uint32_t *offsets;
+} mt_path_trie_builder_t;
+
+static int mt_path_trie_compare(const void *a, const void *b)
+{
+    return strcmp(*(const char * const *)a, *(const char * const *)b);
+}
+
+static size_t mt_path_trie_common_length(const char *a, const char *b, size_t from)
+{
+    while (a[from] != '\0' && a[from] == b[from]) { from++; }
+    return from;
+}
+
+// fills in the node at the given index for the (sorted) prefixes [first, last), which
+// all share their first "depth" bytes, and recursively builds the node's children
+static void mt_path_trie_build(mt_path_trie_builder_t *builder, uint32_t index, size_t first, size_t last, size_t depth)
+{
+    mt_path_trie_node_t *node = &builder->trie->nodes[index];
+    
+    // a node that completes a prefix needs no children because every
+    // path reaching it matches, no matter what follows
+    if (builder->prefixes[first][depth] == '\0') {
+        
+        node->terminal = true;
+        
+    } else {
+        
+        // count the groups of prefixes that continue with the same byte
+        uint32_t childCount = 0;
+        
+        for (size_t i = first; i < last; i++) {
+            if (i == first || builder->prefixes[i][depth] != builder->prefixes[i - 1][depth]) { childCount++; }
+        }
+        
+        node->firstChild = builder->trie->nodeCount;
+        node->childCount = childCount;
+        builder->trie->nodeCount += childCount;
+        
+        uint32_t child = node->firstChild;
+        size_t groupStart = first;
+        
+        for (size_t i = first + 1; i <= last; i++) {
+            
+            if (i == last || builder->prefixes[i][depth] != builder->prefixes[groupStart][depth]) {
+                
+                // the prefixes are sorted, so the common prefix of the whole
+                // group is the common prefix of its first and its last member
+                size_t commonLength = mt_path_trie_common_length(builder->prefixes[groupStart], builder->prefixes[i - 1], depth);
+                
+                mt_path_trie_node_t *childNode = &builder->trie->nodes[child];
+                childNode->labelOffset = builder->offsets[groupStart] + (uint32_t)depth;
+                childNode->labelLength = (uint32_t)(commonLength - depth);
+                
+                mt_path_trie_build(builder, child, groupStart, i, commonLength);
+                
+                child++;
+                groupStart = i;
+            }
+        }
+    }
+}
+
+mt_path_trie_t *mt_path_trie_create(const char * const *prefixes, size_t count)
+{
+    mt_path_trie_t *trie = NULL;
+    const char **sortedPrefixes = calloc(count + 1, sizeof(char*));
+    uint32_t *offsets = calloc(count + 1, sizeof(uint32_t));
+    size_t labelsLength = 0;
+    
+    if (sortedPrefixes && offsets) {
+        
+        if (count > 0) { memcpy(sortedPrefixes, prefixes, count * sizeof(char*)); }
+        qsort(sortedPrefixes, count, sizeof(char*), mt_path_trie_compare);
+        
+        for (size_t i = 0; i < count; i++) { labelsLength += strlen(sortedPrefixes[i]) + 1; }
+        
+        // a radix trie with n leaves has less than 2n nodes
+        size_t maxNodes = 2 * count + 1;
+        trie = calloc(1, sizeof(mt_path_trie_t) + maxNodes * sizeof(mt_path_trie_node_t) + labelsLength);
+        
+        if (trie) {
+            
+            trie->nodes = (mt_path_trie_node_t *)(trie + 1);
+            trie->nodeCount = 1;
+            
+            // copy the prefixes into the trie's label storage, so the
+            // labels of the nodes can just point into the prefixes
+            char *labels = (char *)(trie->nodes + maxNodes);
+            size_t offset = 0;
+            
+            for (size_t i = 0; i < count; i++) {
+                
+                size_t length = strlen(sortedPrefixes[i]) + 1;
+                memcpy(labels + offset, sortedPrefixes[i], length);
+                sortedPrefixes[i] = labels + offset;
+                offsets[i] = (uint32_t)offset;
+                offset += length;
+            }
+            
+            trie->labels = labels;
+            
+            if (count > 0) {
+                
+                mt_path_trie_builder_t builder = { trie, sortedPrefixes, offsets };
+                mt_path_trie_build(&builder, 0, 0, count, 0);
+            }
+        }
+    }
+    
+    free(sortedPrefixes);
+    free(offsets);
+    
+    return trie;
+}
+
+void mt_path_trie_destroy(mt_path_trie_t *trie)
+{
+    free(trie);
+}
+
+bool mt_path_trie_matches(const mt_path_trie_t *trie, const char *path, size_t length)
+{
+    bool matches = false;
+    const mt_path_trie_node_t *node = &trie->nodes[0];
+    size_t position = 0;
+    
+    for (;;) {
+        
+        if (node->terminal) {
+            
+            matches = true;
+            break;
+        }
+        
+        if (position == length || node->childCount == 0) { break; }
+        
+        // binary search for the child starting with the next byte of the path
+        unsigned char nextByte = (unsigned char)path[position];
+        const mt_path_trie_node_t *child = NULL;
+        uint32_t low = node->firstChild;
+        uint32_t high = node->firstChild + node->childCount;
+        
+        while (low < high) {
+            
+            uint32_t middle = low + (high - low) / 2;
+            unsigned char firstByte = (unsigned char)trie->labels[trie->nodes[middle].labelOffset];
+            
+            if (firstByte == nextByte) {
+                
+                child = &trie->nodes[middle];
+                break;
+                
+            } else if (firstByte < nextByte) {
+                
+                low = middle + 1;
+                
+            } else {
+                
+                high = middle;
+            }
+        }
+        
+        if (!child || length - position < child->labelLength ||
+            memcmp(path + position, trie->labels + child->labelOffset, child->labelLength) != 0) { break; }
+        
+        position += child->labelLength;
+        node = child;
+    }
+    
+    return matches;
+}
@@ -0,0 +1,66 @@
+/*
+    MTPathTrie.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTPathTrie_h
+#define MTPathTrie_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    An immutable radix trie of path prefixes. It answers the same question as Endpoint
+    Security's ES_MUTE_PATH_TYPE_TARGET_PREFIX muting ("does the path start with any of the
+    given prefixes?") in time proportional to the length of the path, independent of the
+    number of prefixes. Prefixes are compared byte by byte, just like Endpoint Security does.
+ 
+    The trie is built once and then only read, so it can be shared between threads without
+    locking. Nodes and labels live in a single memory block, and the children of a node are
+    stored contiguously and sorted by their first byte, so a lookup never allocates and
+    finds the right child with a binary search.
+*/
+
+typedef struct mt_path_trie mt_path_trie_t;
+
+/*!
+ @function      mt_path_trie_create
+ @abstract      Builds a trie from the given path prefixes.
+ @param         prefixes An array of null-terminated path prefixes. Duplicates and prefixes
+                covered by shorter prefixes are ignored.
+ @param         count The number of prefixes.
+ @discussion    Returns the new trie or NULL if memory could not be allocated. The caller is
+                responsible for destroying the trie using mt_path_trie_destroy.
+*/
+mt_path_trie_t *mt_path_trie_create(const char * const *prefixes, size_t count);
+
+/*!
+ @function      mt_path_trie_destroy
+ @abstract      Frees the memory used by the given trie.
+ @param         trie A pointer to the trie. May be NULL.
+*/
+void mt_path_trie_destroy(mt_path_trie_t *trie);
+
+/*!
+ @function      mt_path_trie_matches
+ @abstract      Returns whether the given path starts with any of the prefixes of the trie.
+ @param         trie A pointer to the trie.
+ @param         path The path. Does not need to be null-terminated.
+ @param         length The length of the path (in bytes).
+*/
+bool mt_path_trie_matches(const mt_path_trie_t *trie, const char *path, size_t length);
+
+#endif /* MTPathTrie_h */
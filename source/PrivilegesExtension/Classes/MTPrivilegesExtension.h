@@ -16,7 +16,11 @@
 */
 
 #import <Cocoa/Cocoa.h>
+#import <stdatomic.h>
 #import "PrivilegesExtensionProtocol.h"
+#import "MTDeadlineMonitor.h"
+#import "MTVerdictCache.h"
+#import "MTProcessLineage.h"
 
 @interface MTPrivilegesExtension : NSObject <PrivilegesExtensionProtocol, NSXPCListenerDelegate>
 
@@ -39,6 +43,48 @@
 */
 @property (readonly) BOOL isPaused;
 
+/*!
+ @method        pausedFlag
+ @abstract      Returns a pointer to the atomic flag backing the isPaused property.
+ @discussion    Endpoint Security event handlers should read this flag (using atomic_load) instead of
+                calling isPaused, so no Objective-C message has to be sent while an authorization
+                deadline is running. The pointer is valid for the lifetime of the receiver.
+*/
+- (const atomic_bool*)pausedFlag;
+
+/*!
+ @method        fileDeadlineMonitor
+ @abstract      Returns a pointer to the deadline monitor for file events.
+ @discussion    The monitor's statistics are returned by statusWithReply:. The pointer is valid for
+                the lifetime of the receiver.
+*/
+- (mt_deadline_monitor_t*)fileDeadlineMonitor;
+
+/*!
+ @method        execDeadlineMonitor
+ @abstract      Returns a pointer to the deadline monitor for exec events.
+ @discussion    The monitor's statistics are returned by statusWithReply:. The pointer is valid for
+                the lifetime of the receiver.
+*/
+- (mt_deadline_monitor_t*)execDeadlineMonitor;
+
+/*!
+ @method        execVerdictCache
+ @abstract      Returns a pointer to the verdict cache for exec events.
+ @discussion    The cache is initialized with a random key. Its hit rate is returned by statusWithReply:.
+                The pointer is valid for the lifetime of the receiver.
+*/
+- (mt_verdict_cache_t*)execVerdictCache;
+
+/*!
+ @method        processLineage
+ @abstract      Returns a pointer to the process lineage table.
+ @discussion    The table should be fed with fork, exec and exit notifications and is used to validate
+                processes that ask to suspend the system extension. Returns NULL if the table could not
+                be created. The pointer is valid for the lifetime of the receiver.
+*/
+- (mt_process_lineage_t*)processLineage;
+
 /*!
  @property      isRunning
  @abstract      Returns wheter the system extension is running.
@@ -16,7 +16,7 @@
 */
 
 #import "MTPrivilegesExtension.h"
-#import "MTCodeSigning.h"
+#import "MTConnectionRequirement.h"
 #import "MTProcessValidation.h"
 #import "Constants.h"
 #import <os/log.h>
@@ -24,16 +24,21 @@
 @interface MTPrivilegesExtension ()
 @property (nonatomic, strong, readwrite) NSMutableSet *activeConnections;
 @property (atomic, strong, readwrite) NSXPCListener *listener;
-@property (assign) BOOL isPaused;
+@property (nonatomic, strong, readwrite) MTConnectionRequirement *connectionRequirement;
 @end
 
 @interface ExtendedNSXPCConnection : NSXPCConnection
 @property audit_token_t auditToken;
 @end
 
-OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement);
-
 @implementation MTPrivilegesExtension
+{
+    atomic_bool _paused;
+    mt_deadline_monitor_t _fileDeadlineMonitor;
+    mt_deadline_monitor_t _execDeadlineMonitor;
+    mt_verdict_cache_t _execVerdictCache;
+    mt_process_lineage_t *_processLineage;
+}
 
 - (instancetype)init
 {
@@ -41,8 +46,31 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     
     if (self) {
         
+        atomic_init(&_paused, false);
+        mt_deadline_monitor_init(&_fileDeadlineMonitor, kMTExtensionDeadlineSafetyMargin * NSEC_PER_SEC);
+        mt_deadline_monitor_init(&_execDeadlineMonitor, kMTExtensionDeadlineSafetyMargin * NSEC_PER_SEC);
+        
+        uint64_t cacheKey[2];
+        arc4random_buf(cacheKey, sizeof(cacheKey));
+        mt_verdict_cache_init(&_execVerdictCache, cacheKey[0], cacheKey[1]);
+        
+        _processLineage = mt_process_lineage_create(kMTProcessLineageCapacity);
+        if (!_processLineage) { os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to create process lineage table"); }
+        
         _activeConnections = [[NSMutableSet alloc] init];
                 
+        // we only allow the Privileges helper to connect. It must be signed by the same signing
+        // authority and must have the same version number as this extension
+        NSError *error = nil;
+        _connectionRequirement = [[MTConnectionRequirement alloc] initWithBundleIdentifiers:[NSArray arrayWithObject:kMTHelperBundleIdentifier]
+                                                                              versionString:[[NSBundle bundleForClass:[self class]] objectForInfoDictionaryKey:@"CFBundleShortVersionString"]
+                                                                                      error:&error
+        ];
+        
+        if (!_connectionRequirement) {
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to get code signature: %{public}@", error);
+        }
+                
         _listener = [[NSXPCListener alloc] initWithMachServiceName:kMTExtensionMachServiceName];
         [_listener setDelegate:self];
         [_listener resume];
@@ -51,6 +79,11 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     return self;
 }
 
+- (void)dealloc
+{
+    mt_process_lineage_destroy(_processLineage);
+}
+
 - (void)invalidateXPC
 {
     [_listener invalidate];
@@ -63,62 +96,38 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     
     if (listener == _listener && newConnection != nil) {
         
-        // see how we have been signed and make sure only processes with the same signing authority can connect.
-        // additionally the calling application must have the same version number as this xpc service and must
-        // use the bundle identifier "corp.sap.privileges.helper"
+        // make sure only processes matching our (precompiled) code signing requirement can connect
         NSError *error = nil;
-        NSString *signingAuth = [MTCodeSigning getSigningAuthorityWithError:&error];
-        NSString *requiredVersion = [[NSBundle bundleForClass:[self class]] objectForInfoDictionaryKey:@"CFBundleShortVersionString"];
         
-        if (signingAuth) {
+        if ([_connectionRequirement validateAuditToken:((ExtendedNSXPCConnection*)newConnection).auditToken error:&error]) {
 
-            // we only allow the Privileges helper to connect
-            NSString *reqString = [MTCodeSigning codeSigningRequirementsWithCommonName:signingAuth
-                                                                      bundleIdentifier:kMTHelperBundleIdentifier
-                                                                         versionString:requiredVersion
-            ];
-            SecTaskRef taskRef = SecTaskCreateWithAuditToken(NULL, ((ExtendedNSXPCConnection*)newConnection).auditToken);
+            acceptConnection = YES;
+            
+            [newConnection setExportedInterface:[NSXPCInterface interfaceWithProtocol:@protocol(PrivilegesExtensionProtocol)]];
+            [newConnection setExportedObject:self];
             
-            if (taskRef) {
-
-                OSStatus result = SecTaskValidateForRequirement(taskRef, (__bridge CFStringRef)(reqString));
-                
-                if (result == errSecSuccess) {
-
-                    acceptConnection = YES;
-                    
-                    [newConnection setExportedInterface:[NSXPCInterface interfaceWithProtocol:@protocol(PrivilegesExtensionProtocol)]];
-                    [newConnection setExportedObject:self];
-                    
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Warc-retain-cycles"
-                    [newConnection setInvalidationHandler:^{
-                                  
-                        [newConnection setInvalidationHandler:nil];
-                        dispatch_async(dispatch_get_main_queue(), ^{
-                            [self.activeConnections removeObject:newConnection];
-                            os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ invalidated", newConnection);
-                        });
-                    }];
+            [newConnection setInvalidationHandler:^{
+                          
+                [newConnection setInvalidationHandler:nil];
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    [self.activeConnections removeObject:newConnection];
+                    os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ invalidated", newConnection);
+                });
+            }];
 #pragma clang diagnostic pop
-                    
-                    [newConnection resume];
-                    
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        [self.activeConnections addObject:newConnection];
-                        os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ established", newConnection);
-                    });
-        
-                } else {
-                    
-                    os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Code signature verification failed (error %d)", result);
-                }
-                    
-                CFRelease(taskRef);
-            }
-                
+            
+            [newConnection resume];
+            
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [self.activeConnections addObject:newConnection];
+                os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ established", newConnection);
+            });
+
         } else {
-            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to get code signature: %{public}@", error);
+            
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Code signature verification failed (error %ld)", (long)[error code]);
         }
     }
 
@@ -130,6 +139,74 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     return [_activeConnections count];
 }
 
+- (BOOL)isPaused
+{
+    return atomic_load_explicit(&_paused, memory_order_acquire);
+}
+
+- (const atomic_bool*)pausedFlag
+{
+    return &_paused;
+}
+
+- (mt_deadline_monitor_t*)fileDeadlineMonitor
+{
+    return &_fileDeadlineMonitor;
+}
+
+- (mt_deadline_monitor_t*)execDeadlineMonitor
+{
+    return &_execDeadlineMonitor;
+}
+
+- (mt_verdict_cache_t*)execVerdictCache
+{
+    return &_execVerdictCache;
+}
+
+- (mt_process_lineage_t*)processLineage
+{
+    return _processLineage;
+}
+
+- (NSDictionary*)statisticsOfDeadlineMonitor:(mt_deadline_monitor_t*)monitor verdictCache:(mt_verdict_cache_t*)cache
+{
+    NSMutableDictionary *statistics = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+                                [NSNumber numberWithUnsignedLongLong:atomic_load_explicit(&monitor->events, memory_order_relaxed)], kMTExtensionStatisticsEventCountKey,
+                                [NSNumber numberWithUnsignedLongLong:atomic_load_explicit(&monitor->nearMisses, memory_order_relaxed)], kMTExtensionStatisticsNearMissesKey,
+                                [NSNumber numberWithDouble:(double)mt_deadline_monitor_average_slack(monitor) / NSEC_PER_SEC], kMTExtensionStatisticsAverageSlackKey,
+                                [NSNumber numberWithDouble:(double)mt_deadline_monitor_minimum_slack(monitor) / NSEC_PER_SEC], kMTExtensionStatisticsMinimumSlackKey,
+                                nil
+    ];
+    
+    if (cache) {
+        
+        uint64_t hits = atomic_load_explicit(&cache->hits, memory_order_relaxed);
+        uint64_t misses = atomic_load_explicit(&cache->misses, memory_order_relaxed);
+        
+        [statistics setObject:[NSNumber numberWithUnsignedLongLong:hits] forKey:kMTExtensionStatisticsCacheHitsKey];
+        [statistics setObject:[NSNumber numberWithUnsignedLongLong:misses] forKey:kMTExtensionStatisticsCacheMissesKey];
+        [statistics setObject:[NSNumber numberWithDouble:(hits + misses > 0) ? (double)hits / (hits + misses) : 0] forKey:kMTExtensionStatisticsCacheHitRateKey];
+    }
+    
+    return statistics;
+}
+
+- (NSDictionary*)statisticsOfProcessLineage:(mt_process_lineage_t*)lineage
+{
+    mt_process_lineage_statistics_t lineageStatistics = { 0 };
+    if (lineage) { mt_process_lineage_statistics(lineage, &lineageStatistics); }
+    
+    NSDictionary *statistics = [NSDictionary dictionaryWithObjectsAndKeys:
+                                [NSNumber numberWithUnsignedInteger:lineageStatistics.count], kMTExtensionStatisticsTrackedProcessesKey,
+                                [NSNumber numberWithUnsignedLongLong:lineageStatistics.evicted], kMTExtensionStatisticsEvictedProcessesKey,
+                                [NSNumber numberWithUnsignedLongLong:lineageStatistics.dropped], kMTExtensionStatisticsDroppedProcessesKey,
+                                nil
+    ];
+    
+    return statistics;
+}
+
 #pragma mark - Exported methods
 
 - (void)suspendExtensionUsingAuthorizedPID:(pid_t)pid completionHandler:(void(^)(BOOL success, NSError *error))completionHandler
@@ -139,13 +216,13 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     
     if (pid > 1) {
         
-        MTProcessValidation *upgradeProcess = [[MTProcessValidation alloc] initWithPID:pid];
-        _isPaused = [upgradeProcess isValid];
+        MTProcessValidation *upgradeProcess = [[MTProcessValidation alloc] initWithPID:pid processLineage:_processLineage];
+        atomic_store_explicit(&_paused, [upgradeProcess isValid], memory_order_release);
         errorMsg = @"Process is not authorized";
         
     } else {
         
-        _isPaused = NO;
+        atomic_store_explicit(&_paused, false, memory_order_release);
         errorMsg = @"Invalid process id";
     }
     
@@ -155,22 +232,22 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
         error = [NSError errorWithDomain:kMTErrorDomain code:100 userInfo:errorDetail];
     }
     
-    if (completionHandler) { completionHandler(_isPaused, error); }
+    if (completionHandler) { completionHandler([self isPaused], error); }
 }
 
 - (void)resumeExtensionWithCompletionHandler:(void(^)(BOOL success))completionHandler
 {
-    _isPaused = NO;
-    if (completionHandler) { completionHandler(!_isPaused); }
+    atomic_store_explicit(&_paused, false, memory_order_release);
+    if (completionHandler) { completionHandler(![self isPaused]); }
 }
 
-- (void)statusWithReply:(void(^)(NSString *status))reply
+- (void)statusWithReply:(void(^)(NSString *status, NSDictionary *statistics))reply
 {
     if (reply) {
         
         NSString *status = kMTExtensionStatusEnabled;
         
-        if (_isPaused) {
+        if ([self isPaused]) {
             
             status = kMTExtensionStatusSuspended;
             
@@ -179,7 +256,15 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
             status = kMTExtensionStatusWaiting;
         }
         
-        reply(status);
+        NSDictionary *statistics = [NSDictionary dictionaryWithObjectsAndKeys:
+                                    [self statisticsOfDeadlineMonitor:&_fileDeadlineMonitor verdictCache:NULL], kMTExtensionStatisticsFileEventsKey,
+                                    [self statisticsOfDeadlineMonitor:&_execDeadlineMonitor verdictCache:&_execVerdictCache], kMTExtensionStatisticsExecEventsKey,
+                                    [MTProcessValidation validationCacheStatistics], kMTExtensionStatisticsPackageValidationKey,
+                                    [self statisticsOfProcessLineage:_processLineage], kMTExtensionStatisticsProcessLineageKey,
+                                    nil
+        ];
+        
+        reply(status, statistics);
     }
 }
 
@@ -34,7 +34,17 @@
  @param         pid The id of the process.
  @discussion    Returns an initialized MTProcess object.
 */
-- (instancetype)initWithPID:(pid_t)pid NS_DESIGNATED_INITIALIZER;
+- (instancetype)initWithPID:(pid_t)pid;
+
+/*!
+ @method        initWithPID:executablePath:
+ @abstract      Initialize a MTProcess object with the given process id and executable path.
+ @param         pid The id of the process.
+ @param         path The path to the process's executable (e.g. from a process table snapshot). If nil,
+                the path is looked up when it's needed.
+ @discussion    Returns an initialized MTProcess object.
+*/
+- (instancetype)initWithPID:(pid_t)pid executablePath:(NSString*)path NS_DESIGNATED_INITIALIZER;
 
 /*!
  @method        name
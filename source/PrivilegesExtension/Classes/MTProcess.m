@@ -20,11 +20,17 @@
 
 @interface MTProcess ()
 @property (assign) pid_t pid;
+@property (nonatomic, strong, readwrite) NSString *executablePath;
 @end
 
 @implementation MTProcess
 
 - (instancetype)initWithPID:(pid_t)pid
+{
+    return [self initWithPID:pid executablePath:nil];
+}
+
+- (instancetype)initWithPID:(pid_t)pid executablePath:(NSString*)path
 {
     self = [super init];
     
@@ -33,6 +39,7 @@
         if (pid > 1) {
             
             _pid = pid;
+            _executablePath = path;
             
         } else {
             
@@ -45,19 +52,22 @@
 
 - (NSString*)name
 {
-    char pathBuffer[PROC_PIDPATHINFO_MAXSIZE];
-    
-    int retval = proc_pidpath(
-                              [self pid],
-                              pathBuffer,
-                              sizeof(pathBuffer)
-                              );
-     
-    if (retval <= 0) { return nil; }
+    if (!_executablePath) {
         
-    NSString *commandPath = [NSString stringWithUTF8String:pathBuffer];
+        char pathBuffer[PROC_PIDPATHINFO_MAXSIZE];
+        
+        int retval = proc_pidpath(
+                                  [self pid],
+                                  pathBuffer,
+                                  sizeof(pathBuffer)
+                                  );
+        
+        if (retval <= 0) { return nil; }
+        
+        _executablePath = [NSString stringWithUTF8String:pathBuffer];
+    }
     
-    return [commandPath lastPathComponent];
+    return [_executablePath lastPathComponent];
 }
 
 - (BOOL)isPlatformBinary
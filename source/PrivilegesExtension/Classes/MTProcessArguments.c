@@ -0,0 +1,237 @@
+/*
+    MTProcessArguments.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTProcessArguments.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#else
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+static int mt_process_arguments_reserve_buffer(mt_process_arguments_t *arguments, size_t size)
+{
+    int result = 0;
+    
+    if (size > arguments->bufferSize) {
+        
+        char *buffer = realloc(arguments->buffer, size);
+        
+        if (buffer) {
+            
+            arguments->buffer = buffer;
+            arguments->bufferSize = size;
+            
+        } else {
+            
+            result = -1;
+        }
+    }
+    
+    return result;
+}
+
+static int mt_process_arguments_add_span(mt_process_arguments_t *arguments, size_t count, const char *data, size_t length)
+{
+    if (count == arguments->spanCapacity) {
+        
+        size_t capacity = (arguments->spanCapacity) ? arguments->spanCapacity * 2 : 64;
+        mt_process_span_t *spans = realloc(arguments->spans, capacity * sizeof(mt_process_span_t));
+        if (!spans) { return -1; }
+        
+        arguments->spans = spans;
+        arguments->spanCapacity = capacity;
+    }
+    
+    arguments->spans[count] = (mt_process_span_t){ data, length };
+    
+    return 0;
+}
+
+#pragma mark - Platform specific
+
+#ifdef __APPLE__
+
+static int mt_process_arguments_read_raw(mt_process_arguments_t *arguments, pid_t pid, size_t *length)
+{
+    int mib[3] = { CTL_KERN, KERN_PROCARGS2, pid };
+    int result = -1;
+    
+    // without a buffer, sysctl returns the size of the process' arguments (plus
+    // some slack), so we only grow the buffer if it's too small for them
+    size_t size = 0;
+    if (sysctl(mib, 3, NULL, &size, NULL, 0) != 0) { return -1; }
+    if (size > ARG_MAX) { size = ARG_MAX; }
+    
+    while (mt_process_arguments_reserve_buffer(arguments, size) == 0) {
+        
+        *length = arguments->bufferSize;
+        result = sysctl(mib, 3, arguments->buffer, length, NULL, 0);
+        
+        // the arguments may have changed in the meantime
+        if (result == 0 || errno != ENOMEM || size == ARG_MAX) { break; }
+        size = (size * 2 > ARG_MAX) ? ARG_MAX : size * 2;
+    }
+    
+    return result;
+}
+
+#else
+
+// reads the given file and appends its contents to the buffer
+static int mt_process_arguments_append_file(mt_process_arguments_t *arguments, const char *path, size_t *length)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { return -1; }
+    
+    ssize_t bytesRead = 0;
+    
+    do {
+        
+        if (*length == arguments->bufferSize && mt_process_arguments_reserve_buffer(arguments, arguments->bufferSize * 2) != 0) { bytesRead = -1; break; }
+        
+        bytesRead = read(fd, arguments->buffer + *length, arguments->bufferSize - *length);
+        if (bytesRead > 0) { *length += (size_t)bytesRead; }
+        
+    } while (bytesRead > 0);
+    
+    close(fd);
+    
+    return (bytesRead < 0) ? -1 : 0;
+}
+
+// builds the layout sysctl(KERN_PROCARGS2) returns on macOS
+static int mt_process_arguments_read_raw(mt_process_arguments_t *arguments, pid_t pid, size_t *length)
+{
+    char path[64];
+    int result = -1;
+    
+    if (mt_process_arguments_reserve_buffer(arguments, 4096) == 0) {
+        
+        // the executable path
+        snprintf(path, sizeof(path), "/proc/%d/exe", (int)pid);
+        ssize_t pathLength = readlink(path, arguments->buffer + sizeof(int), arguments->bufferSize - sizeof(int) - 1);
+        
+        if (pathLength >= 0) {
+            
+            arguments->buffer[sizeof(int) + pathLength] = '\0';
+            *length = sizeof(int) + (size_t)pathLength + 1;
+            size_t argumentsStart = *length;
+            
+            snprintf(path, sizeof(path), "/proc/%d/cmdline", (int)pid);
+            
+            if (mt_process_arguments_append_file(arguments, path, length) == 0) {
+                
+                // count the arguments
+                int argc = 0;
+                for (size_t i = argumentsStart; i < *length; i++) { if (arguments->buffer[i] == '\0') { argc++; } }
+                memcpy(arguments->buffer, &argc, sizeof(argc));
+                
+                snprintf(path, sizeof(path), "/proc/%d/environ", (int)pid);
+                
+                // the environment of other users' processes may not be readable
+                if (mt_process_arguments_append_file(arguments, path, length) != 0 && errno != EACCES) { return -1; }
+                result = 0;
+            }
+        }
+    }
+    
+    return result;
+}
+
+#endif
+
+#pragma mark - Public functions
+
+void mt_process_arguments_init(mt_process_arguments_t *arguments)
+{
+    memset(arguments, 0, sizeof(mt_process_arguments_t));
+}
+
+void mt_process_arguments_free(mt_process_arguments_t *arguments)
+{
+    free(arguments->buffer);
+    free(arguments->spans);
+    mt_process_arguments_init(arguments);
+}
+
+int mt_process_arguments_parse(mt_process_arguments_t *arguments, const char *data, size_t length)
+{
+    const char *end = data + length;
+    int argc = 0;
+    
+    arguments->executablePath = (mt_process_span_t){ NULL, 0 };
+    arguments->argumentCount = 0;
+    arguments->environmentCount = 0;
+    
+    if (length < sizeof(argc)) { errno = EINVAL; return -1; }
+    
+    memcpy(&argc, data, sizeof(argc));
+    if (argc < 0 || (size_t)argc > length) { errno = EINVAL; return -1; }
+    
+    // the executable path, followed by padding. As the padding consists of null characters,
+    // an empty first argument cannot be told apart from it (and neither can ps)
+    const char *p = data + sizeof(argc);
+    const char *string = p;
+    
+    p = memchr(p, '\0', end - p);
+    if (!p) { errno = EINVAL; return -1; }
+    
+    arguments->executablePath = (mt_process_span_t){ string, p - string };
+    while (p < end && *p == '\0') { p++; }
+    
+    // the arguments. Unlike the padding, an empty
+    // argument is just a single null character
+    for (int i = 0; i < argc; i++) {
+        
+        const char *stringEnd = (p < end) ? memchr(p, '\0', end - p) : NULL;
+        if (!stringEnd) { errno = EINVAL; return -1; }
+        
+        if (mt_process_arguments_add_span(arguments, arguments->argumentCount, p, stringEnd - p) != 0) { return -1; }
+        arguments->argumentCount++;
+        p = stringEnd + 1;
+    }
+    
+    // the environment ends with an empty string or with the data
+    while (p < end && *p != '\0') {
+        
+        const char *stringEnd = memchr(p, '\0', end - p);
+        if (!stringEnd) { break; }
+        
+        if (mt_process_arguments_add_span(arguments, arguments->argumentCount + arguments->environmentCount, p, stringEnd - p) != 0) { return -1; }
+        arguments->environmentCount++;
+        p = stringEnd + 1;
+    }
+    
+    return 0;
+}
+
+int mt_process_arguments_read(mt_process_arguments_t *arguments, pid_t pid)
+{
+    size_t length = 0;
+    int result = mt_process_arguments_read_raw(arguments, pid, &length);
+    
+    if (result == 0) { result = mt_process_arguments_parse(arguments, arguments->buffer, length); }
+    
+    return result;
+}
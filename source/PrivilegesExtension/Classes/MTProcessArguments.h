@@ -0,0 +1,110 @@
+/*
+    MTProcessArguments.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTProcessArguments_h
+#define MTProcessArguments_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+    Reads the arguments and the environment of a process. On macOS they are read using
+    sysctl(KERN_PROCARGS2), which returns the number of arguments, followed by the executable
+    path, some padding and the null-terminated arguments and environment variables. On Linux,
+    /proc/<pid>/cmdline and /proc/<pid>/environ are read into the same layout, so the parser
+    can be tested there.
+ 
+    The arguments and environment variables are returned in their original order as spans
+    pointing into a single buffer. The buffer and the spans are kept and reused for the next
+    process, so reading many processes in a row does not allocate (once the buffers are large
+    enough). A mt_process_arguments_t must not be used from multiple threads at the same time.
+*/
+
+typedef struct {
+    const char *data;       // not null-terminated
+    size_t length;
+} mt_process_span_t;
+
+typedef struct {
+    char *buffer;
+    size_t bufferSize;
+    mt_process_span_t *spans;
+    size_t spanCapacity;
+    mt_process_span_t executablePath;
+    size_t argumentCount;
+    size_t environmentCount;
+} mt_process_arguments_t;
+
+/*!
+ @function      mt_process_arguments_init
+ @abstract      Initializes an empty mt_process_arguments_t structure.
+ @param         arguments A pointer to the structure.
+*/
+void mt_process_arguments_init(mt_process_arguments_t *arguments);
+
+/*!
+ @function      mt_process_arguments_free
+ @abstract      Releases the buffers of the given mt_process_arguments_t structure.
+ @param         arguments A pointer to the structure.
+*/
+void mt_process_arguments_free(mt_process_arguments_t *arguments);
+
+/*!
+ @function      mt_process_arguments_read
+ @abstract      Reads the arguments and environment of the process with the given id.
+ @param         arguments A pointer to an initialized mt_process_arguments_t structure.
+ @param         pid The process id.
+ @discussion    Returns 0 on success, otherwise returns -1 and sets errno. The spans of a previous
+                call become invalid.
+*/
+int mt_process_arguments_read(mt_process_arguments_t *arguments, pid_t pid);
+
+/*!
+ @function      mt_process_arguments_parse
+ @abstract      Parses the given data, which must have the layout returned by sysctl(KERN_PROCARGS2).
+ @param         arguments A pointer to an initialized mt_process_arguments_t structure.
+ @param         data The data. It's not copied, so the spans point into the data.
+ @param         length The length of the data (in bytes).
+ @discussion    Returns 0 on success, otherwise returns -1 and sets errno (EINVAL if the data is
+                malformed). Used by mt_process_arguments_read.
+*/
+int mt_process_arguments_parse(mt_process_arguments_t *arguments, const char *data, size_t length);
+
+/*!
+ @function      mt_process_arguments_argument
+ @abstract      Returns the argument at the given index (argv[index]).
+ @param         arguments A pointer to the structure.
+ @param         index The index. Must be less than argumentCount.
+*/
+static inline mt_process_span_t mt_process_arguments_argument(const mt_process_arguments_t *arguments, size_t index)
+{
+    return arguments->spans[index];
+}
+
+/*!
+ @function      mt_process_arguments_environment
+ @abstract      Returns the environment variable at the given index (as "name=value").
+ @param         arguments A pointer to the structure.
+ @param         index The index. Must be less than environmentCount.
+*/
+static inline mt_process_span_t mt_process_arguments_environment(const mt_process_arguments_t *arguments, size_t index)
+{
+    return arguments->spans[arguments->argumentCount + index];
+}
+
+#endif /* MTProcessArguments_h */
@@ -49,7 +49,8 @@
 /*!
  @method        argumentsForPID:
  @abstract      Returns the arguments passed to the given process.
- @discussion    Returns an NSArray containing the arguments, or nil if an error occurred.
+ @discussion    Returns an NSArray containing the arguments (in their original order, starting with
+                argv[0]), or nil if an error occurred.
 */
 + (NSArray*)argumentsForPID:(pid_t)pid;
 
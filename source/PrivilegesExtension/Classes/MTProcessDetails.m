@@ -16,7 +16,7 @@
 */
 
 #import "MTProcessDetails.h"
-#import <sys/sysctl.h>
+#import "MTProcessArguments.h"
 #import <libproc.h>
 
 @implementation MTProcessDetails : NSObject
@@ -25,35 +25,42 @@
 {
     NSMutableArray *processList = [[NSMutableArray alloc] init];
     
-    int numberOfProcesses = proc_listpids(PROC_ALL_PIDS, 0, NULL, 0);
-    pid_t pids[numberOfProcesses];
-    bzero(pids, sizeof(pids));
-    proc_listpids(PROC_ALL_PIDS, 0, pids, (int)sizeof(pids));
+    // proc_listpids returns the size of the buffer (in bytes), not
+    // the number of processes. The buffer may contain zero pids
+    int bufferSize = proc_listpids(PROC_ALL_PIDS, 0, NULL, 0);
+    pid_t *pids = (bufferSize > 0) ? malloc(bufferSize) : NULL;
     
-    for (int i = 0; i < numberOfProcesses; ++i) {
+    if (pids) {
         
-        if (pids[i] == 0) { continue; }
+        int numberOfProcesses = proc_listpids(PROC_ALL_PIDS, 0, pids, bufferSize) / (int)sizeof(pid_t);
+        
+        // one path buffer is used for all processes
         char pathBuffer[PROC_PIDPATHINFO_MAXSIZE];
-        bzero(pathBuffer, PROC_PIDPATHINFO_MAXSIZE);
-        proc_pidpath(pids[i], pathBuffer, sizeof(pathBuffer));
         
-        if (strlen(pathBuffer) > 0) {
-    
-            NSString *processPath = [NSString stringWithUTF8String:pathBuffer];
-            NSString *processName = [processPath lastPathComponent];
-            NSNumber *processID = [NSNumber numberWithInt:pids[i]];
+        for (int i = 0; i < numberOfProcesses; ++i) {
+            
+            if (pids[i] == 0) { continue; }
+            
+            int pathLength = proc_pidpath(pids[i], pathBuffer, sizeof(pathBuffer));
             
-            if (processPath && processName && processID) {
+            if (pathLength > 0) {
                 
-                NSDictionary *processDict = [NSDictionary dictionaryWithObjectsAndKeys:
-                                             processID, @"pid",
-                                             processName, @"name",
-                                             processPath, @"path",
-                                             nil
-                ];
-                [processList addObject:processDict];
+                NSString *processPath = [[NSString alloc] initWithBytes:pathBuffer length:pathLength encoding:NSUTF8StringEncoding];
+                
+                if (processPath) {
+                    
+                    NSDictionary *processDict = [NSDictionary dictionaryWithObjectsAndKeys:
+                                                 [NSNumber numberWithInt:pids[i]], @"pid",
+                                                 [processPath lastPathComponent], @"name",
+                                                 processPath, @"path",
+                                                 nil
+                    ];
+                    [processList addObject:processDict];
+                }
             }
         }
+        
+        free(pids);
     }
     
     return ([processList count] > 0) ? processList : nil;
@@ -138,44 +145,37 @@
 
 + (NSArray*)argumentsForPID:(pid_t)pid
 {
-    int mib[3] = { CTL_KERN, KERN_PROCARGS2, pid };
-    size_t size = 0;
+    __block NSMutableArray *arguments = nil;
     
-    if (sysctl(mib, 3, NULL, &size, NULL, 0) == -1) { return nil; }
-
-    char *buffer = malloc(size);
-    if (!buffer) { return nil; }
-
-    if (sysctl(mib, 3, buffer, &size, NULL, 0) == -1) {
-        
-        free(buffer);
-        return nil;
-    }
-
-    NSMutableSet *arguments = [NSMutableSet set];
-
-    int argc = 0;
-    memcpy(&argc, buffer, sizeof(argc));
-
-    char *p = buffer + sizeof(argc);
-    char *end = buffer + size;
-
-    while (p < end && *p != '\0') { p++; }
-    while (p < end && *p == '\0') { p++; }
-
-    for (int i = 0; i < argc && p < end; i++) {
+    // the buffers are kept and reused for all processes, so
+    // the arguments are read on a single serial queue
+    static mt_process_arguments_t processArguments;
+    static dispatch_queue_t argumentsQueue = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
         
-        NSString *arg = [NSString stringWithUTF8String:p];
+        mt_process_arguments_init(&processArguments);
+        argumentsQueue = dispatch_queue_create("corp.sap.privileges.processArguments", DISPATCH_QUEUE_SERIAL);
+    });
+    
+    dispatch_sync(argumentsQueue, ^{
         
-        if (arg) { [arguments addObject:arg]; }
-
-        while (p < end && *p != '\0') { p++; }
-        while (p < end && *p == '\0') { p++; }
-    }
-
-    free(buffer);
+        if (mt_process_arguments_read(&processArguments, pid) == 0) {
+            
+            arguments = [[NSMutableArray alloc] initWithCapacity:processArguments.argumentCount];
+            
+            for (size_t i = 0; i < processArguments.argumentCount; i++) {
+                
+                mt_process_span_t argument = mt_process_arguments_argument(&processArguments, i);
+                NSString *arg = [[NSString alloc] initWithBytes:argument.data length:argument.length encoding:NSUTF8StringEncoding];
+                
+                if (arg) { [arguments addObject:arg]; }
+            }
+        }
+    });
 
-    return [arguments allObjects];
+    return arguments;
 }
 
 @end
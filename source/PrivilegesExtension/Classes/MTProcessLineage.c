@@ -0,0 +1,486 @@
+/*
+    MTProcessLineage.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTProcessLineage.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// package paths are rare, so they are not kept in the entries but in a small
+// pool, whose slots are reused round-robin. A slot belongs to an entry as long
+// as its sequence number matches the entry's
+#define MT_PROCESS_LINEAGE_PACKAGE_SLOTS    128
+
+enum {
+    MTProcessLineageExited              = 1 << 0,
+    MTProcessLineagePlatformBinary      = 1 << 1,
+    MTProcessLineageRootPlatformBinary  = 1 << 2,
+    MTProcessLineageArgumentsKnown      = 1 << 3
+};
+
+typedef struct {
+    pid_t pid;
+    uint32_t pidVersion;
+    uint64_t sequence;              // 0 = unused
+    pid_t parentPID;
+    uint64_t parentSequence;        // 0 if the parent is unknown
+    pid_t rootPID;                  // 0 if the root is unknown
+    uint16_t flags;
+    uint16_t packageCount;
+    uint32_t packageSlot;           // slot index + 1 (0 = none)
+    char name[MT_PROCESS_LINEAGE_MAX_NAME];
+    char rootName[MT_PROCESS_LINEAGE_MAX_NAME];
+} mt_process_lineage_entry_t;
+
+typedef struct {
+    uint32_t entry;
+    uint64_t sequence;
+} mt_process_lineage_exit_t;
+
+typedef struct {
+    uint64_t sequence;
+    char path[MT_PROCESS_LINEAGE_MAX_PATH];
+} mt_process_lineage_package_t;
+
+struct mt_process_lineage {
+    pthread_mutex_t lock;
+    mt_process_lineage_entry_t *entries;
+    uint32_t *index;                        // open addressing, entry index + 1 (0 = empty slot)
+    size_t indexMask;
+    uint32_t *freeEntries;
+    size_t freeCount;
+    mt_process_lineage_exit_t *exits;       // ring buffer of exited entries, oldest first
+    size_t exitHead;
+    size_t exitCount;
+    mt_process_lineage_package_t *packages;
+    size_t nextPackage;
+    size_t capacity;
+    uint64_t nextSequence;
+    uint64_t evicted;
+    uint64_t dropped;
+};
+
+static inline size_t mt_process_lineage_hash(pid_t pid, size_t mask)
+{
+    return ((uint32_t)pid * 2654435761U) & mask;
+}
+
+#pragma mark - Table
+
+static size_t mt_process_lineage_find_slot(const mt_process_lineage_t *lineage, pid_t pid)
+{
+    size_t slot = mt_process_lineage_hash(pid, lineage->indexMask);
+    
+    while (lineage->index[slot] != 0 && lineage->entries[lineage->index[slot] - 1].pid != pid) {
+        slot = (slot + 1) & lineage->indexMask;
+    }
+    
+    return slot;
+}
+
+static mt_process_lineage_entry_t *mt_process_lineage_find(const mt_process_lineage_t *lineage, pid_t pid)
+{
+    uint32_t entry = lineage->index[mt_process_lineage_find_slot(lineage, pid)];
+    return (entry != 0) ? &lineage->entries[entry - 1] : NULL;
+}
+
+// removes the entry at the given index slot. The following entries of the
+// probe sequence are shifted back, so lookups never need tombstones
+static void mt_process_lineage_remove(mt_process_lineage_t *lineage, size_t slot)
+{
+    uint32_t entry = lineage->index[slot];
+    size_t hole = slot;
+    size_t next = (hole + 1) & lineage->indexMask;
+    
+    while (lineage->index[next] != 0) {
+        
+        size_t home = mt_process_lineage_hash(lineage->entries[lineage->index[next] - 1].pid, lineage->indexMask);
+        
+        if (((next - home) & lineage->indexMask) >= ((next - hole) & lineage->indexMask)) {
+            
+            lineage->index[hole] = lineage->index[next];
+            hole = next;
+        }
+        
+        next = (next + 1) & lineage->indexMask;
+    }
+    
+    lineage->index[hole] = 0;
+    lineage->entries[entry - 1].sequence = 0;
+    lineage->freeEntries[lineage->freeCount++] = entry - 1;
+}
+
+// evicts the entry that exited first. Returns false if no process in the table exited
+static bool mt_process_lineage_evict(mt_process_lineage_t *lineage)
+{
+    bool success = false;
+    
+    while (!success && lineage->exitCount > 0) {
+        
+        mt_process_lineage_exit_t exit = lineage->exits[lineage->exitHead];
+        lineage->exitHead = (lineage->exitHead + 1) % lineage->capacity;
+        lineage->exitCount--;
+        
+        // the entry may have been replaced by a process with the same id in the meantime
+        mt_process_lineage_entry_t *entry = &lineage->entries[exit.entry];
+        
+        if (entry->sequence == exit.sequence && (entry->flags & MTProcessLineageExited)) {
+            
+            mt_process_lineage_remove(lineage, mt_process_lineage_find_slot(lineage, entry->pid));
+            lineage->evicted++;
+            success = true;
+        }
+    }
+    
+    return success;
+}
+
+// removes the exits of entries that have been replaced by a process with the same id
+// in the meantime. The remaining exits keep their order
+static void mt_process_lineage_compact_exits(mt_process_lineage_t *lineage)
+{
+    size_t count = 0;
+    
+    for (size_t i = 0; i < lineage->exitCount; i++) {
+        
+        mt_process_lineage_exit_t exit = lineage->exits[(lineage->exitHead + i) % lineage->capacity];
+        const mt_process_lineage_entry_t *entry = &lineage->entries[exit.entry];
+        
+        if (entry->sequence == exit.sequence && (entry->flags & MTProcessLineageExited)) {
+            lineage->exits[(lineage->exitHead + count++) % lineage->capacity] = exit;
+        }
+    }
+    
+    lineage->exitCount = count;
+}
+
+static void mt_process_lineage_copy_name(char *name, mt_event_string_t path)
+{
+    const char *lastComponent = path.data;
+    
+    for (size_t i = 0; i < path.length; i++) {
+        if (path.data[i] == '/') { lastComponent = path.data + i + 1; }
+    }
+    
+    // truncated names must never match, so they are not stored at all
+    size_t length = (path.data) ? path.length - (size_t)(lastComponent - path.data) : 0;
+    if (length >= MT_PROCESS_LINEAGE_MAX_NAME) { length = 0; }
+    
+    if (length > 0) { memcpy(name, lastComponent, length); }
+    name[length] = '\0';
+}
+
+// adds a new entry for the given process and links it to its parent, if the
+// parent is in the table. Replaces the entry of a previous process with the same id
+static mt_process_lineage_entry_t *mt_process_lineage_add(mt_process_lineage_t *lineage, const mt_process_lineage_process_t *process, const mt_process_lineage_entry_t *parent)
+{
+    mt_process_lineage_entry_t *entry = NULL;
+    size_t slot = mt_process_lineage_find_slot(lineage, process->pid);
+    
+    if (lineage->index[slot] != 0) {
+        
+        mt_process_lineage_remove(lineage, slot);
+        slot = mt_process_lineage_find_slot(lineage, process->pid);
+    }
+    
+    if (lineage->freeCount > 0 || mt_process_lineage_evict(lineage)) {
+        
+        // evicting may have shifted the probe sequence of our process id
+        slot = mt_process_lineage_find_slot(lineage, process->pid);
+        uint32_t index = lineage->freeEntries[--lineage->freeCount];
+        
+        entry = &lineage->entries[index];
+        memset(entry, 0, sizeof(mt_process_lineage_entry_t));
+        entry->pid = process->pid;
+        entry->pidVersion = process->pidVersion;
+        entry->sequence = lineage->nextSequence++;
+        entry->parentPID = process->parentPID;
+        mt_process_lineage_copy_name(entry->name, process->executablePath);
+        if (process->isPlatformBinary) { entry->flags |= MTProcessLineagePlatformBinary; }
+        
+        if (process->parentPID == 1) {
+            
+            // started by launchd, so the process is a root itself
+            entry->rootPID = entry->pid;
+            memcpy(entry->rootName, entry->name, sizeof(entry->rootName));
+            if (process->isPlatformBinary) { entry->flags |= MTProcessLineageRootPlatformBinary; }
+            
+        } else if (parent) {
+            
+            entry->rootPID = parent->rootPID;
+            memcpy(entry->rootName, parent->rootName, sizeof(entry->rootName));
+            entry->flags |= (parent->flags & MTProcessLineageRootPlatformBinary);
+        }
+        
+        if (parent) { entry->parentSequence = parent->sequence; }
+        lineage->index[slot] = index + 1;
+        
+    } else {
+        
+        lineage->dropped++;
+    }
+    
+    return entry;
+}
+
+// returns the entry of a running process, adding it if it has not been seen before
+static mt_process_lineage_entry_t *mt_process_lineage_entry(mt_process_lineage_t *lineage, const mt_process_lineage_process_t *process)
+{
+    mt_process_lineage_entry_t *entry = mt_process_lineage_find(lineage, process->pid);
+    
+    if (!entry || entry->pidVersion != process->pidVersion || (entry->flags & MTProcessLineageExited)) {
+        
+        mt_process_lineage_entry_t *parent = mt_process_lineage_find(lineage, process->parentPID);
+        if (parent && (parent->flags & MTProcessLineageExited)) { parent = NULL; }
+        
+        entry = mt_process_lineage_add(lineage, process, parent);
+    }
+    
+    return entry;
+}
+
+static bool mt_process_lineage_is_package(mt_event_string_t argument)
+{
+    return (argument.data && argument.length >= 4 && strncasecmp(argument.data + argument.length - 4, ".pkg", 4) == 0);
+}
+
+#pragma mark - Public functions
+
+mt_process_lineage_t *mt_process_lineage_create(size_t capacity)
+{
+    mt_process_lineage_t *lineage = NULL;
+    
+    if (capacity > 0 && capacity < UINT32_MAX / 2) {
+        
+        lineage = calloc(1, sizeof(mt_process_lineage_t));
+        
+        if (lineage) {
+            
+            size_t slots = 16;
+            while (slots < capacity * 2) { slots <<= 1; }
+            
+            lineage->entries = calloc(capacity, sizeof(mt_process_lineage_entry_t));
+            lineage->index = calloc(slots, sizeof(uint32_t));
+            lineage->indexMask = slots - 1;
+            lineage->freeEntries = malloc(capacity * sizeof(uint32_t));
+            lineage->exits = malloc(capacity * sizeof(mt_process_lineage_exit_t));
+            lineage->packages = calloc(MT_PROCESS_LINEAGE_PACKAGE_SLOTS, sizeof(mt_process_lineage_package_t));
+            lineage->capacity = capacity;
+            lineage->nextSequence = 1;
+            
+            if (lineage->entries && lineage->index && lineage->freeEntries && lineage->exits && lineage->packages && pthread_mutex_init(&lineage->lock, NULL) == 0) {
+                
+                // hand out the entries in ascending order
+                for (size_t i = 0; i < capacity; i++) { lineage->freeEntries[i] = (uint32_t)(capacity - 1 - i); }
+                lineage->freeCount = capacity;
+                
+            } else {
+                
+                free(lineage->entries);
+                free(lineage->index);
+                free(lineage->freeEntries);
+                free(lineage->exits);
+                free(lineage->packages);
+                free(lineage);
+                lineage = NULL;
+            }
+        }
+    }
+    
+    return lineage;
+}
+
+void mt_process_lineage_destroy(mt_process_lineage_t *lineage)
+{
+    if (lineage) {
+        
+        pthread_mutex_destroy(&lineage->lock);
+        free(lineage->entries);
+        free(lineage->index);
+        free(lineage->freeEntries);
+        free(lineage->exits);
+        free(lineage->packages);
+        free(lineage);
+    }
+}
+
+void mt_process_lineage_fork(mt_process_lineage_t *lineage, const mt_process_lineage_process_t *parent, const mt_process_lineage_process_t *child)
+{
+    pthread_mutex_lock(&lineage->lock);
+    
+    // the parent is running, so it is never evicted to make room for the child
+    mt_process_lineage_entry_t *parentEntry = mt_process_lineage_entry(lineage, parent);
+    mt_process_lineage_process_t forkedChild = *child;
+    forkedChild.parentPID = parent->pid;
+    
+    mt_process_lineage_add(lineage, &forkedChild, parentEntry);
+    
+    pthread_mutex_unlock(&lineage->lock);
+}
+
+void mt_process_lineage_exec(mt_process_lineage_t *lineage, const mt_process_lineage_process_t *process, const mt_process_lineage_process_t *target, uint32_t argumentCount, mt_event_argument_function_t argument, const void *argumentContext)
+{
+    // look for package paths before taking the lock. We only need
+    // to know the first one and whether there are different ones
+    mt_event_string_t package = { 0, NULL };
+    uint16_t packageCount = 0;
+    
+    for (uint32_t i = 0; i < argumentCount && packageCount < 2; i++) {
+        
+        mt_event_string_t anArgument = argument(argumentContext, i);
+        
+        if (mt_process_lineage_is_package(anArgument)) {
+            
+            if (packageCount == 0) {
+                
+                package = anArgument;
+                packageCount = 1;
+                
+            } else if (anArgument.length != package.length || memcmp(anArgument.data, package.data, package.length) != 0) {
+                
+                packageCount = 2;
+            }
+        }
+    }
+    
+    pthread_mutex_lock(&lineage->lock);
+    
+    mt_process_lineage_entry_t *entry = mt_process_lineage_entry(lineage, process);
+    
+    if (entry) {
+        
+        entry->pidVersion = target->pidVersion;
+        mt_process_lineage_copy_name(entry->name, target->executablePath);
+        entry->flags &= ~(MTProcessLineagePlatformBinary | MTProcessLineageArgumentsKnown);
+        if (target->isPlatformBinary) { entry->flags |= MTProcessLineagePlatformBinary; }
+        
+        if (entry->rootPID == entry->pid) {
+            
+            memcpy(entry->rootName, entry->name, sizeof(entry->rootName));
+            entry->flags &= ~MTProcessLineageRootPlatformBinary;
+            if (target->isPlatformBinary) { entry->flags |= MTProcessLineageRootPlatformBinary; }
+        }
+        
+        entry->packageCount = packageCount;
+        entry->packageSlot = 0;
+        
+        if (packageCount == 1) {
+            
+            // a package path that does not fit is treated as unknown
+            if (package.length < MT_PROCESS_LINEAGE_MAX_PATH) {
+                
+                mt_process_lineage_package_t *slot = &lineage->packages[lineage->nextPackage];
+                slot->sequence = entry->sequence;
+                memcpy(slot->path, package.data, package.length);
+                slot->path[package.length] = '\0';
+                
+                entry->packageSlot = (uint32_t)lineage->nextPackage + 1;
+                entry->flags |= MTProcessLineageArgumentsKnown;
+                lineage->nextPackage = (lineage->nextPackage + 1) % MT_PROCESS_LINEAGE_PACKAGE_SLOTS;
+            }
+            
+        } else {
+            
+            entry->flags |= MTProcessLineageArgumentsKnown;
+        }
+    }
+    
+    pthread_mutex_unlock(&lineage->lock);
+}
+
+void mt_process_lineage_exit(mt_process_lineage_t *lineage, pid_t pid, uint32_t pidVersion)
+{
+    pthread_mutex_lock(&lineage->lock);
+    
+    mt_process_lineage_entry_t *entry = mt_process_lineage_find(lineage, pid);
+    
+    if (entry && entry->pidVersion == pidVersion && !(entry->flags & MTProcessLineageExited)) {
+        
+        // a full ring contains exits of replaced entries, because the process that exits
+        // now is in the table as well. Only if that fails, the oldest entry is evicted early
+        if (lineage->exitCount == lineage->capacity) { mt_process_lineage_compact_exits(lineage); }
+        if (lineage->exitCount == lineage->capacity) { mt_process_lineage_evict(lineage); }
+        
+        entry->flags |= MTProcessLineageExited;
+        
+        mt_process_lineage_exit_t *exit = &lineage->exits[(lineage->exitHead + lineage->exitCount) % lineage->capacity];
+        exit->entry = (uint32_t)(entry - lineage->entries);
+        exit->sequence = entry->sequence;
+        lineage->exitCount++;
+    }
+    
+    pthread_mutex_unlock(&lineage->lock);
+}
+
+bool mt_process_lineage_lookup(mt_process_lineage_t *lineage, pid_t pid, uint32_t pidVersion, mt_process_lineage_info_t *info)
+{
+    bool success = false;
+    memset(info, 0, sizeof(mt_process_lineage_info_t));
+    
+    pthread_mutex_lock(&lineage->lock);
+    
+    const mt_process_lineage_entry_t *entry = mt_process_lineage_find(lineage, pid);
+    
+    if (entry && !(entry->flags & MTProcessLineageExited) && (pidVersion == 0 || entry->pidVersion == pidVersion)) {
+        
+        info->pid = entry->pid;
+        info->pidVersion = entry->pidVersion;
+        info->rootPID = entry->rootPID;
+        info->rootIsPlatformBinary = ((entry->flags & MTProcessLineageRootPlatformBinary) != 0);
+        memcpy(info->rootName, entry->rootName, sizeof(info->rootName));
+        
+        // the parent's entry may have been evicted or replaced
+        const mt_process_lineage_entry_t *parent = mt_process_lineage_find(lineage, entry->parentPID);
+        
+        if (parent && entry->parentSequence != 0 && parent->sequence == entry->parentSequence) {
+            
+            info->parentPID = parent->pid;
+            info->parentPackageCount = parent->packageCount;
+            info->parentArgumentsKnown = ((parent->flags & MTProcessLineageArgumentsKnown) != 0);
+            
+            if (info->parentArgumentsKnown && parent->packageCount == 1) {
+                
+                const mt_process_lineage_package_t *slot = (parent->packageSlot > 0) ? &lineage->packages[parent->packageSlot - 1] : NULL;
+                
+                if (slot && slot->sequence == parent->sequence) {
+                    memcpy(info->parentPackagePath, slot->path, sizeof(info->parentPackagePath));
+                } else {
+                    info->parentArgumentsKnown = false;
+                }
+            }
+        }
+        
+        success = true;
+    }
+    
+    pthread_mutex_unlock(&lineage->lock);
+    
+    return success;
+}
+
+void mt_process_lineage_statistics(mt_process_lineage_t *lineage, mt_process_lineage_statistics_t *statistics)
+{
+    pthread_mutex_lock(&lineage->lock);
+    
+    statistics->count = lineage->capacity - lineage->freeCount;
+    statistics->capacity = lineage->capacity;
+    statistics->evicted = lineage->evicted;
+    statistics->dropped = lineage->dropped;
+    
+    pthread_mutex_unlock(&lineage->lock);
+}
@@ -0,0 +1,150 @@
+/*
+    MTProcessLineage.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTProcessLineage_h
+#define MTProcessLineage_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "MTEventPolicy.h"
+
+/*
+    An in-memory record of which process started which, fed by Endpoint Security fork, exec and
+    exit notifications. Unlike walking the process table when a process has to be validated, the
+    lineage is recorded while it happens, so it is neither affected by parents that exited in the
+    meantime nor by process ids that have been reused.
+ 
+    Processes are identified by their process id and process id version (as found in their audit
+    token). As the version changes with every exec, the links between processes use a sequence
+    number instead, which is assigned when a process is added and does not change until it goes
+    away. Every process also carries a copy of the name and platform binary flag of its root (the
+    topmost ancestor below launchd), so looking up a process's root and direct parent takes
+    constant time, even if the root exited long ago.
+ 
+    The table has a fixed capacity. Processes that exited are kept until their space is needed
+    and then evicted in the order they exited. If the table is full of running processes, new
+    processes are not recorded. Processes that were already running when the table was created
+    are added the first time they fork or exec, so their root is only known if they have been
+    started by launchd. The functions of this module may be called from multiple threads.
+*/
+
+#define MT_PROCESS_LINEAGE_MAX_NAME     64
+#define MT_PROCESS_LINEAGE_MAX_PATH     1024
+
+// a process as seen by an Endpoint Security message
+typedef struct {
+    pid_t pid;
+    uint32_t pidVersion;
+    pid_t parentPID;
+    mt_event_string_t executablePath;
+    bool isPlatformBinary;
+} mt_process_lineage_process_t;
+
+typedef struct {
+    pid_t pid;
+    uint32_t pidVersion;
+    pid_t parentPID;                    // 0 if the direct parent is not in the table (anymore)
+    pid_t rootPID;                      // 0 if the root is unknown
+    bool rootIsPlatformBinary;
+    char rootName[MT_PROCESS_LINEAGE_MAX_NAME];
+    bool parentArgumentsKnown;          // the direct parent's arguments have been recorded
+    size_t parentPackageCount;          // the number of different package paths in the direct parent's arguments (0, 1 or 2 for more than one)
+    char parentPackagePath[MT_PROCESS_LINEAGE_MAX_PATH];
+} mt_process_lineage_info_t;
+
+typedef struct {
+    size_t count;
+    size_t capacity;
+    uint64_t evicted;
+    uint64_t dropped;
+} mt_process_lineage_statistics_t;
+
+typedef struct mt_process_lineage mt_process_lineage_t;
+
+/*!
+ @function      mt_process_lineage_create
+ @abstract      Creates an empty lineage table.
+ @param         capacity The maximum number of processes in the table.
+ @discussion    All memory the table needs is allocated up front. Returns the table or NULL if an error
+                occurred. The caller is responsible for releasing the table using mt_process_lineage_destroy.
+*/
+mt_process_lineage_t *mt_process_lineage_create(size_t capacity);
+
+/*!
+ @function      mt_process_lineage_destroy
+ @abstract      Releases the given table.
+ @param         lineage A pointer to the table. May be NULL.
+*/
+void mt_process_lineage_destroy(mt_process_lineage_t *lineage);
+
+/*!
+ @function      mt_process_lineage_fork
+ @abstract      Records that a process has been forked.
+ @param         lineage A pointer to the table.
+ @param         parent A pointer to the forking process.
+ @param         child A pointer to the new process.
+ @discussion    An entry of a previous process with the same process id is replaced. If the parent is not
+                in the table yet, it is added as well.
+*/
+void mt_process_lineage_fork(mt_process_lineage_t *lineage, const mt_process_lineage_process_t *parent, const mt_process_lineage_process_t *child);
+
+/*!
+ @function      mt_process_lineage_exec
+ @abstract      Records that a process executed a new image.
+ @param         lineage A pointer to the table.
+ @param         process A pointer to the process before the exec.
+ @param         target A pointer to the process after the exec.
+ @param         argumentCount The number of arguments of the new image.
+ @param         argument A function that returns the argument with the given index.
+ @param         argumentContext The context passed to the argument function.
+ @discussion    Only the package paths (arguments ending in .pkg) are kept of the arguments.
+*/
+void mt_process_lineage_exec(mt_process_lineage_t *lineage, const mt_process_lineage_process_t *process, const mt_process_lineage_process_t *target, uint32_t argumentCount, mt_event_argument_function_t argument, const void *argumentContext);
+
+/*!
+ @function      mt_process_lineage_exit
+ @abstract      Records that a process exited.
+ @param         lineage A pointer to the table.
+ @param         pid The process id.
+ @param         pidVersion The process id version.
+ @discussion    The entry is kept (so its children can still be linked to it) until its space is needed.
+*/
+void mt_process_lineage_exit(mt_process_lineage_t *lineage, pid_t pid, uint32_t pidVersion);
+
+/*!
+ @function      mt_process_lineage_lookup
+ @abstract      Looks up a running process and its lineage.
+ @param         lineage A pointer to the table.
+ @param         pid The process id.
+ @param         pidVersion The process id version or 0 to match any version.
+ @param         info A pointer to a structure that receives the lineage of the process.
+ @discussion    Returns true if the process is in the table and has not exited, otherwise returns false.
+                Does not allocate any memory.
+*/
+bool mt_process_lineage_lookup(mt_process_lineage_t *lineage, pid_t pid, uint32_t pidVersion, mt_process_lineage_info_t *info);
+
+/*!
+ @function      mt_process_lineage_statistics
+ @abstract      Gets the number of processes in the table and the eviction counters.
+ @param         lineage A pointer to the table.
+ @param         statistics A pointer to a structure that receives the statistics.
+*/
+void mt_process_lineage_statistics(mt_process_lineage_t *lineage, mt_process_lineage_statistics_t *statistics);
+
+#endif /* MTProcessLineage_h */
@@ -0,0 +1,340 @@
+/*
+    MTProcessTable.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTProcessTable.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __APPLE__
+#include <libproc.h>
+#include <sys/sysctl.h>
+#else
+#include <dirent.h>
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+// the maximum number of ancestors we follow, to be safe
+// if the parent links of a snapshot should ever form a loop
+#define MT_PROCESS_TABLE_MAX_DEPTH  1024
+
+struct mt_process_table {
+    mt_process_entry_t *entries;
+    char **paths;                   // lazily filled, one per entry
+    uint32_t *index;                // open addressing, entry index + 1 (0 = empty slot)
+    size_t count;
+    size_t indexMask;
+};
+
+static inline size_t mt_process_table_hash(pid_t pid, size_t mask)
+{
+    return ((uint32_t)pid * 2654435761U) & mask;
+}
+
+static bool mt_process_table_build_index(mt_process_table_t *table)
+{
+    size_t slots = 16;
+    while (slots < table->count * 2) { slots <<= 1; }
+    
+    table->index = calloc(slots, sizeof(uint32_t));
+    table->indexMask = slots - 1;
+    
+    if (table->index) {
+        
+        for (size_t i = 0; i < table->count; i++) {
+            
+            size_t slot = mt_process_table_hash(table->entries[i].pid, table->indexMask);
+            while (table->index[slot] != 0) { slot = (slot + 1) & table->indexMask; }
+            table->index[slot] = (uint32_t)i + 1;
+        }
+    }
+    
+    return (table->index != NULL);
+}
+
+#pragma mark - Platform specific
+
+#ifdef __APPLE__
+
+static bool mt_process_table_read(mt_process_table_t *table)
+{
+    int mib[4] = { CTL_KERN, KERN_PROC, KERN_PROC_ALL, 0 };
+    struct kinfo_proc *processes = NULL;
+    size_t size = 0;
+    int result = -1;
+    
+    // the number of processes may change between asking for the
+    // size and getting the data, so we add some room and retry
+    for (int attempt = 0; attempt < 3 && result != 0; attempt++) {
+        
+        if (sysctl(mib, 4, NULL, &size, NULL, 0) != 0) { break; }
+        
+        size += size / 8 + sizeof(struct kinfo_proc) * 16;
+        free(processes);
+        processes = malloc(size);
+        if (!processes) { break; }
+        
+        result = sysctl(mib, 4, processes, &size, NULL, 0);
+        if (result != 0 && errno != ENOMEM) { break; }
+    }
+    
+    if (result == 0) {
+        
+        size_t count = size / sizeof(struct kinfo_proc);
+        table->entries = malloc((count > 0 ? count : 1) * sizeof(mt_process_entry_t));
+        
+        if (table->entries) {
+            
+            for (size_t i = 0; i < count; i++) {
+                
+                mt_process_entry_t *entry = &table->entries[table->count++];
+                entry->pid = processes[i].kp_proc.p_pid;
+                entry->parentPID = processes[i].kp_eproc.e_ppid;
+                entry->startTime = (uint64_t)processes[i].kp_proc.p_starttime.tv_sec * 1000000 + (uint64_t)processes[i].kp_proc.p_starttime.tv_usec;
+            }
+            
+        } else {
+            
+            result = -1;
+        }
+    }
+    
+    free(processes);
+    
+    return (result == 0);
+}
+
+static char *mt_process_table_copy_path(pid_t pid)
+{
+    char buffer[PROC_PIDPATHINFO_MAXSIZE];
+    int length = proc_pidpath(pid, buffer, sizeof(buffer));
+    
+    return (length > 0) ? strndup(buffer, (size_t)length) : NULL;
+}
+
+#else
+
+// parses /proc/<pid>/stat. The command name (field 2) may contain spaces and
+// parentheses, so the remaining fields start after its last closing parenthesis
+static bool mt_process_table_read_stat(pid_t pid, mt_process_entry_t *entry)
+{
+    bool success = false;
+    char path[64], buffer[1024];
+    
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    FILE *file = fopen(path, "r");
+    
+    if (file) {
+        
+        size_t length = fread(buffer, 1, sizeof(buffer) - 1, file);
+        buffer[length] = '\0';
+        fclose(file);
+        
+        char *fields = strrchr(buffer, ')');
+        int parentPID = 0;
+        unsigned long long startTime = 0;
+        
+        // state (3), ppid (4), ..., starttime (22)
+        if (fields && sscanf(fields + 1, " %*c %d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu", &parentPID, &startTime) == 2) {
+            
+            entry->pid = pid;
+            entry->parentPID = parentPID;
+            entry->startTime = startTime;
+            success = true;
+        }
+    }
+    
+    return success;
+}
+
+static bool mt_process_table_read(mt_process_table_t *table)
+{
+    bool success = false;
+    DIR *directory = opendir("/proc");
+    
+    if (directory) {
+        
+        size_t capacity = 256;
+        table->entries = malloc(capacity * sizeof(mt_process_entry_t));
+        success = (table->entries != NULL);
+        
+        struct dirent *item;
+        
+        while (success && (item = readdir(directory))) {
+            
+            char *end = NULL;
+            long pid = strtol(item->d_name, &end, 10);
+            if (*item->d_name == '\0' || *end != '\0' || pid <= 0) { continue; }
+            
+            if (table->count == capacity) {
+                
+                mt_process_entry_t *entries = realloc(table->entries, capacity * 2 * sizeof(mt_process_entry_t));
+                
+                if (entries) {
+                    
+                    table->entries = entries;
+                    capacity *= 2;
+                    
+                } else {
+                    
+                    success = false;
+                    break;
+                }
+            }
+            
+            // the process may have exited in the meantime
+            if (mt_process_table_read_stat((pid_t)pid, &table->entries[table->count])) { table->count++; }
+        }
+        
+        closedir(directory);
+    }
+    
+    return success;
+}
+
+static char *mt_process_table_copy_path(pid_t pid)
+{
+    char path[64], buffer[PATH_MAX];
+    
+    snprintf(path, sizeof(path), "/proc/%d/exe", (int)pid);
+    ssize_t length = readlink(path, buffer, sizeof(buffer));
+    
+    return (length > 0 && (size_t)length < sizeof(buffer)) ? strndup(buffer, (size_t)length) : NULL;
+}
+
+#endif
+
+#pragma mark - Public functions
+
+mt_process_table_t *mt_process_table_create(void)
+{
+    mt_process_table_t *table = calloc(1, sizeof(mt_process_table_t));
+    
+    if (table) {
+        
+        if (mt_process_table_read(table) && table->count < UINT32_MAX && mt_process_table_build_index(table)) {
+            
+            table->paths = calloc(table->count + 1, sizeof(char*));
+        }
+        
+        if (!table->paths) {
+            
+            mt_process_table_destroy(table);
+            table = NULL;
+        }
+    }
+    
+    return table;
+}
+
+void mt_process_table_destroy(mt_process_table_t *table)
+{
+    if (table) {
+        
+        if (table->paths) {
+            for (size_t i = 0; i < table->count; i++) { free(table->paths[i]); }
+        }
+        
+        free(table->paths);
+        free(table->index);
+        free(table->entries);
+        free(table);
+    }
+}
+
+size_t mt_process_table_count(const mt_process_table_t *table)
+{
+    return table->count;
+}
+
+static const mt_process_entry_t *mt_process_table_lookup(const mt_process_table_t *table, pid_t pid, size_t *entryIndex)
+{
+    const mt_process_entry_t *entry = NULL;
+    size_t slot = mt_process_table_hash(pid, table->indexMask);
+    
+    while (table->index[slot] != 0) {
+        
+        const mt_process_entry_t *candidate = &table->entries[table->index[slot] - 1];
+        
+        if (candidate->pid == pid) {
+            
+            entry = candidate;
+            if (entryIndex) { *entryIndex = table->index[slot] - 1; }
+            break;
+        }
+        
+        slot = (slot + 1) & table->indexMask;
+    }
+    
+    return entry;
+}
+
+const mt_process_entry_t *mt_process_table_find(const mt_process_table_t *table, pid_t pid)
+{
+    return mt_process_table_lookup(table, pid, NULL);
+}
+
+// returns the parent of the given entry. A parent that has been started after its child
+// must have exited and its process id has been reused, so it's not treated as the parent
+static const mt_process_entry_t *mt_process_table_parent(const mt_process_table_t *table, const mt_process_entry_t *entry)
+{
+    const mt_process_entry_t *parent = (entry->parentPID > 1) ? mt_process_table_find(table, entry->parentPID) : NULL;
+    
+    return (parent && parent->startTime <= entry->startTime) ? parent : NULL;
+}
+
+size_t mt_process_table_ancestors(const mt_process_table_t *table, pid_t pid, pid_t *ancestors, size_t maxCount)
+{
+    size_t count = 0;
+    const mt_process_entry_t *entry = (pid > 1) ? mt_process_table_find(table, pid) : NULL;
+    
+    while (entry && (entry = mt_process_table_parent(table, entry)) && count < MT_PROCESS_TABLE_MAX_DEPTH) {
+        
+        if (ancestors && count < maxCount) { ancestors[count] = entry->pid; }
+        count++;
+    }
+    
+    return count;
+}
+
+pid_t mt_process_table_root(const mt_process_table_t *table, pid_t pid)
+{
+    pid_t root = (pid > 1) ? pid : 0;
+    const mt_process_entry_t *entry = (root) ? mt_process_table_find(table, pid) : NULL;
+    
+    for (size_t depth = 0; entry && (entry = mt_process_table_parent(table, entry)) && depth < MT_PROCESS_TABLE_MAX_DEPTH; depth++) {
+        root = entry->pid;
+    }
+    
+    return root;
+}
+
+const char *mt_process_table_path(mt_process_table_t *table, pid_t pid)
+{
+    const char *path = NULL;
+    size_t entryIndex = 0;
+    
+    if (mt_process_table_lookup(table, pid, &entryIndex)) {
+        
+        if (!table->paths[entryIndex]) { table->paths[entryIndex] = mt_process_table_copy_path(pid); }
+        path = table->paths[entryIndex];
+    }
+    
+    return path;
+}
@@ -0,0 +1,112 @@
+/*
+    MTProcessTable.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTProcessTable_h
+#define MTProcessTable_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+    A snapshot of the process table. The snapshot is taken with a single sysctl(KERN_PROC_ALL)
+    call on macOS (or by scanning /proc on Linux, so the code can be tested and benchmarked
+    there) and indexed by process id. Walking up the ancestry of a process then just follows
+    the parent links in memory, without any further system calls.
+ 
+    Executable paths are not part of the snapshot, because getting them requires a system call
+    per process. Instead, a process's path is looked up the first time it's requested and then
+    cached in the snapshot. A table must not be used from multiple threads at the same time.
+*/
+
+typedef struct {
+    pid_t pid;
+    pid_t parentPID;
+    uint64_t startTime;     // in microseconds since 1970 on macOS, in clock ticks since boot on Linux
+} mt_process_entry_t;
+
+typedef struct mt_process_table mt_process_table_t;
+
+/*!
+ @function      mt_process_table_create
+ @abstract      Takes a snapshot of the process table.
+ @discussion    Returns the table or NULL if an error occurred (errno is set). The caller is
+                responsible for releasing the table using mt_process_table_destroy.
+*/
+mt_process_table_t *mt_process_table_create(void);
+
+/*!
+ @function      mt_process_table_destroy
+ @abstract      Releases the given table.
+ @param         table A pointer to the table. May be NULL.
+*/
+void mt_process_table_destroy(mt_process_table_t *table);
+
+/*!
+ @function      mt_process_table_count
+ @abstract      Returns the number of processes in the table.
+ @param         table A pointer to the table.
+*/
+size_t mt_process_table_count(const mt_process_table_t *table);
+
+/*!
+ @function      mt_process_table_find
+ @abstract      Returns the entry of the process with the given id.
+ @param         table A pointer to the table.
+ @param         pid The process id.
+ @discussion    Returns NULL if the process did not exist when the snapshot was taken.
+*/
+const mt_process_entry_t *mt_process_table_find(const mt_process_table_t *table, pid_t pid);
+
+/*!
+ @function      mt_process_table_ancestors
+ @abstract      Gets the ancestors of the process with the given id.
+ @param         table A pointer to the table.
+ @param         pid The process id.
+ @param         ancestors A buffer that receives the ids of the ancestors, starting with the direct parent. May be NULL.
+ @param         maxCount The number of process ids the buffer can hold.
+ @discussion    Returns the number of ancestors, which may be greater than maxCount. launchd (pid 1) and
+                the kernel (pid 0) are not counted. The walk stops at a parent that is not part of the
+                snapshot or has been started after its child (so its process id must have been reused).
+                Does not make any system calls.
+*/
+size_t mt_process_table_ancestors(const mt_process_table_t *table, pid_t pid, pid_t *ancestors, size_t maxCount);
+
+/*!
+ @function      mt_process_table_root
+ @abstract      Returns the root of the given process's ancestry.
+ @param         table A pointer to the table.
+ @param         pid The process id.
+ @discussion    Returns the id of the topmost ancestor that is not launchd, the process id itself if the
+                process has been started by launchd or 0 if pid is not greater than 1. The walk stops
+                like the one of mt_process_table_ancestors. Does not make any system calls.
+*/
+pid_t mt_process_table_root(const mt_process_table_t *table, pid_t pid);
+
+/*!
+ @function      mt_process_table_path
+ @abstract      Returns the executable path of the process with the given id.
+ @param         table A pointer to the table.
+ @param         pid The process id.
+ @discussion    Returns a null-terminated string that is valid for the lifetime of the table, or NULL if
+                the process is not in the table or its path could not be determined. The path is looked
+                up (using a system call) on first use and cached afterwards.
+*/
+const char *mt_process_table_path(mt_process_table_t *table, pid_t pid);
+
+#endif /* MTProcessTable_h */
@@ -17,6 +17,7 @@
 
 #import <Foundation/Foundation.h>
 #import "MTParentProcess.h"
+#import "MTProcessLineage.h"
 
 @interface MTProcessValidation : NSObject
 
@@ -30,9 +31,22 @@
  @method        initWithPID:
  @abstract      Initialize a MTProcessValidation object with the given process id.
  @param         pid The id of the process that should be validated.
- @discussion    Returns an initialized MTProcessValidation object.
+ @discussion    Returns an initialized MTProcessValidation object. The ancestry of the process is
+                determined by walking the process table.
 */
-- (instancetype)initWithPID:(pid_t)pid NS_DESIGNATED_INITIALIZER;
+- (instancetype)initWithPID:(pid_t)pid;
+
+/*!
+ @method        initWithPID:processLineage:
+ @abstract      Initialize a MTProcessValidation object with the given process id and process lineage table.
+ @param         pid The id of the process that should be validated.
+ @param         lineage A pointer to the process lineage table. May be NULL.
+ @discussion    Returns an initialized MTProcessValidation object. The root and direct parent of the process
+                are taken from the lineage table. Only if the process is not in the table (or its root is
+                unknown), the ancestry is determined by walking the process table. The table must stay
+                valid for the lifetime of the object.
+*/
+- (instancetype)initWithPID:(pid_t)pid processLineage:(mt_process_lineage_t*)lineage NS_DESIGNATED_INITIALIZER;
 
 /*!
  @method        isValid
@@ -41,5 +55,14 @@
 */
 - (BOOL)isValid;
 
+/*!
+ @method        validationCacheStatistics
+ @abstract      Get the hit and miss counters of the package validation cache.
+ @discussion    Package validation results are cached for a short time, keyed on the package file's
+                device, inode, size, modification time and the sha256 checksum of its table of contents.
+                Returns a dictionary containing the number of cache hits and misses.
+*/
++ (NSDictionary*)validationCacheStatistics;
+
 @end
 
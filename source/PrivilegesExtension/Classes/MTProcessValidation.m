@@ -16,22 +16,71 @@
 */
 
 #import "MTProcessValidation.h"
+#import "MTXarArchive.h"
 #import "Constants.h"
+#import <CommonCrypto/CommonDigest.h>
 #import <os/log.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+
+// Developer ID certificate markers
+#define kMTDeveloperIDInstallerLeafOID          @"1.2.840.113635.100.6.1.14"
+#define kMTDeveloperIDIntermediateOID           @"1.2.840.113635.100.6.2.6"
+
+typedef enum {
+    MTPackageSignatureInvalid       = 0,
+    MTPackageSignatureValid         = 1,
+    MTPackageSignatureUndetermined  = 2
+} MTPackageSignatureStatus;
+
+// sha256 fingerprint of the Apple Root CA certificate
+static const uint8_t kMTAppleRootCAFingerprint[CC_SHA256_DIGEST_LENGTH] = {
+    0xb0, 0xb1, 0x73, 0x0e, 0xcb, 0xc7, 0xff, 0x45, 0x05, 0x14, 0x2c, 0x49, 0xf1, 0x29, 0x5e, 0x6e,
+    0xda, 0x6b, 0xca, 0xed, 0x7e, 0x2c, 0x68, 0xc5, 0xbe, 0x91, 0xb5, 0xa1, 0x10, 0x01, 0xf0, 0x24
+};
+
+// identifies a package file and the contents it had when it was validated
+typedef struct {
+    dev_t device;
+    ino_t inode;
+    off_t size;
+    struct timespec modificationTime;
+    uint8_t tocDigest[CC_SHA256_DIGEST_LENGTH];
+} MTPackageIdentity;
+
+@interface MTPackageValidationResult : NSObject
+@property (assign) BOOL isValid;
+@property (assign) NSTimeInterval expirationTime;
+@end
+
+@implementation MTPackageValidationResult
+@end
+
+static NSMutableDictionary<NSData*, MTPackageValidationResult*> *packageValidationCache = nil;
+static uint64_t packageValidationCacheHits = 0;
+static uint64_t packageValidationCacheMisses = 0;
 
 @interface MTProcessValidation ()
 @property (assign) pid_t pid;
+@property (assign) mt_process_lineage_t *lineage;
 @end
 
 @implementation MTProcessValidation
 
 - (instancetype)initWithPID:(pid_t)pid
+{
+    self = [self initWithPID:pid processLineage:NULL];
+    return self;
+}
+
+- (instancetype)initWithPID:(pid_t)pid processLineage:(mt_process_lineage_t*)lineage
 {
     self = [super init];
     
     if (self) {
         
         _pid = pid;
+        _lineage = lineage;
         if (_pid <= 0) { self = nil; }
     }
     
@@ -41,36 +90,71 @@
 - (BOOL)isValid
 {
     BOOL isValid = NO;
+    NSString *rootProcessName = nil;
+    BOOL rootIsPlatformBinary = NO;
+    NSArray *packagePaths = nil;
+    MTProcess *directParent = nil;
+    mt_process_lineage_info_t lineageInfo;
     
-    MTParentProcess *parentProcess = [[MTParentProcess alloc] initWithChildPID:_pid];
-    MTProcess *rootProcess = [parentProcess root];
-    
-    NSString *rootProcessName = [rootProcess name];
+    // the lineage has been recorded while the processes were started, so it's still
+    // correct if parents exited or process ids have been reused in the meantime. We
+    // only walk the process table if the process has been started before we were
+    if (_lineage && mt_process_lineage_lookup(_lineage, _pid, 0, &lineageInfo) && lineageInfo.rootPID > 0) {
+        
+        rootProcessName = [NSString stringWithUTF8String:lineageInfo.rootName];
+        rootIsPlatformBinary = lineageInfo.rootIsPlatformBinary;
+        
+        if (lineageInfo.parentArgumentsKnown && lineageInfo.parentPackageCount < 2) {
+            
+            packagePaths = (lineageInfo.parentPackageCount == 1) ? [NSArray arrayWithObject:[NSString stringWithUTF8String:lineageInfo.parentPackagePath]] : [NSArray array];
+            
+        } else if (lineageInfo.parentPID > 0) {
+            
+            // get all arguments, so we can log all package paths if there are multiple ones
+            directParent = [[MTProcess alloc] initWithPID:lineageInfo.parentPID];
+        }
+        
+    } else {
+        
+        MTParentProcess *parentProcess = [[MTParentProcess alloc] initWithChildPID:_pid];
+        MTProcess *rootProcess = [parentProcess root];
+        
+        rootProcessName = [rootProcess name];
+        
+        // checking the code signature is expensive, so we only do it if the name matches
+        rootIsPlatformBinary = ([rootProcessName isEqualToString:@"package_script_service"] && [rootProcess isPlatformBinary]);
+        directParent = [parentProcess parent];
+    }
     
     // just go ahead if the process name is valid and the process
     // is a platform binary (signed with Apple certificates)
-    if ([rootProcessName isEqualToString:@"package_script_service"] && [rootProcess isPlatformBinary]) {
-
-        // get the parent and its command line arguments
-        MTProcess *directParent = [parentProcess parent];
-        NSArray *arguments = [directParent arguments];
+    if ([rootProcessName isEqualToString:@"package_script_service"] && rootIsPlatformBinary) {
 
-        if ([arguments count] > 0) {
+        // get the package paths from the parent's command line arguments
+        if (!packagePaths) {
+            
+            NSArray *arguments = [directParent arguments];
+            
+            if ([arguments count] > 0) {
+                
+                NSPredicate *predicate = [NSPredicate predicateWithFormat:@"SELF ENDSWITH[c] %@", @".pkg"];
+                packagePaths = [[NSOrderedSet orderedSetWithArray:[arguments filteredArrayUsingPredicate:predicate]] array];
+            }
+        }
 
-            NSPredicate *predicate = [NSPredicate predicateWithFormat:@"SELF ENDSWITH[c] %@", @".pkg"];
-            NSArray *filteredArray = [arguments filteredArrayUsingPredicate:predicate];
+        if (packagePaths) {
 
-            if ([filteredArray count] == 1) {
+            if ([packagePaths count] == 1) {
 
                 // check the package signature
-                NSString *pkgPath = [filteredArray firstObject];
+                NSString *pkgPath = [packagePaths firstObject];
                 isValid = [self packageIsValidAtPath:pkgPath];
 
                 if (!isValid) { os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to verify signature of package %{public}@", pkgPath); }
 
-            } else if ([filteredArray count] > 1) {
+            } else if ([packagePaths count] > 1) {
                 
-                os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to get package path. Found multiple packages: %{public}@", filteredArray);
+                os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to get package path. Found multiple packages: %{public}@", packagePaths);
                 
             } else {
                     
@@ -91,6 +175,220 @@
 }
 
 - (BOOL)packageIsValidAtPath:(NSString*)path
+{
+    BOOL isValid = NO;
+    NSData *cacheKey = nil;
+    
+    // the package data is mapped, so it must stay valid until we are done
+    NS_VALID_UNTIL_END_OF_SCOPE NSData *packageData = [self mappedPackageAtPath:path cacheKey:&cacheKey];
+    NSNumber *cachedResult = [MTProcessValidation cachedValidationResultForKey:cacheKey];
+    
+    if (cachedResult) {
+        
+        isValid = [cachedResult boolValue];
+        os_log_debug(OS_LOG_DEFAULT, "SAPCorp: Using cached validation result for package %{public}@", path);
+        
+    } else {
+        
+        isValid = [self packageIsValidAtPath:path data:packageData];
+        if (cacheKey) { [MTProcessValidation cacheValidationResult:isValid forKey:cacheKey]; }
+    }
+    
+    return isValid;
+}
+
+- (NSData*)mappedPackageAtPath:(NSString*)path cacheKey:(NSData**)cacheKey
+{
+    NSData *packageData = nil;
+    int fd = open([path fileSystemRepresentation], O_RDONLY | O_CLOEXEC);
+    
+    if (fd >= 0) {
+        
+        // we get the file's attributes from the file we map, so the
+        // cache key always describes the data we actually validate
+        struct stat fileInfo;
+        
+        if (fstat(fd, &fileInfo) == 0 && S_ISREG(fileInfo.st_mode) && fileInfo.st_size > 0) {
+            
+            size_t length = (size_t)fileInfo.st_size;
+            void *bytes = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            
+            if (bytes != MAP_FAILED) {
+                
+                packageData = [[NSData alloc] initWithBytesNoCopy:bytes length:length deallocator:^(void *mappedBytes, NSUInteger mappedLength) {
+                    munmap(mappedBytes, mappedLength);
+                }];
+                
+                mt_xar_data_t toc;
+                
+                if (cacheKey && mt_xar_read_toc(bytes, length, &toc) == MTXarResultSuccess && toc.length <= MT_XAR_MAX_TOC_LENGTH) {
+                    
+                    MTPackageIdentity identity;
+                    memset(&identity, 0, sizeof(identity));
+                    identity.device = fileInfo.st_dev;
+                    identity.inode = fileInfo.st_ino;
+                    identity.size = fileInfo.st_size;
+                    identity.modificationTime = fileInfo.st_mtimespec;
+                    CC_SHA256(toc.data, (CC_LONG)toc.length, identity.tocDigest);
+                    
+                    *cacheKey = [NSData dataWithBytes:&identity length:sizeof(identity)];
+                }
+            }
+        }
+        
+        close(fd);
+    }
+    
+    return packageData;
+}
+
+- (BOOL)packageIsValidAtPath:(NSString*)path data:(NSData*)packageData
+{
+    MTPackageSignatureStatus status = MTPackageSignatureUndetermined;
+
+    // only the header and the table of contents of the package are read, so
+    // mapping the package is cheap, even if the package is quite large
+    if (packageData) {
+
+        mt_xar_signature_t signature;
+        MTXarResult result = mt_xar_read_signature([packageData bytes], [packageData length], &signature);
+
+        if (result == MTXarResultSuccess) {
+
+            status = [self statusOfPackageSignature:&signature];
+            mt_xar_signature_free(&signature);
+
+        } else if (result != MTXarResultUnsupported) {
+
+            status = MTPackageSignatureInvalid;
+        }
+    }
+
+    // packages with an invalid signature or a signer other than us are rejected
+    // right away. All other packages must also pass the Gatekeeper assessment,
+    // because only Gatekeeper checks for revoked certificates and notarization
+    if (status != MTPackageSignatureInvalid) {
+
+        if (status == MTPackageSignatureUndetermined) { os_log(OS_LOG_DEFAULT, "SAPCorp: Unable to verify the package signature, relying on Gatekeeper assessment"); }
+        status = ([self gatekeeperAssessmentOfPackageAtPath:path]) ? MTPackageSignatureValid : MTPackageSignatureInvalid;
+    }
+
+    return (status == MTPackageSignatureValid);
+}
+
+- (MTPackageSignatureStatus)statusOfPackageSignature:(const mt_xar_signature_t*)signature
+{
+    MTPackageSignatureStatus status = MTPackageSignatureInvalid;
+
+    // calculate the checksum of the table of contents and
+    // compare it to the checksum stored in the package
+    uint8_t checksum[CC_SHA512_DIGEST_LENGTH];
+    size_t checksumLength = 0;
+    SecKeyAlgorithm algorithm = NULL;
+
+    switch (signature->checksumType) {
+
+        case MTXarChecksumSHA1:
+            CC_SHA1(signature->toc.data, (CC_LONG)signature->toc.length, checksum);
+            checksumLength = CC_SHA1_DIGEST_LENGTH;
+            algorithm = kSecKeyAlgorithmRSASignatureDigestPKCS1v15SHA1;
+            break;
+
+        case MTXarChecksumSHA256:
+            CC_SHA256(signature->toc.data, (CC_LONG)signature->toc.length, checksum);
+            checksumLength = CC_SHA256_DIGEST_LENGTH;
+            algorithm = kSecKeyAlgorithmRSASignatureDigestPKCS1v15SHA256;
+            break;
+
+        case MTXarChecksumSHA512:
+            CC_SHA512(signature->toc.data, (CC_LONG)signature->toc.length, checksum);
+            checksumLength = CC_SHA512_DIGEST_LENGTH;
+            algorithm = kSecKeyAlgorithmRSASignatureDigestPKCS1v15SHA512;
+            break;
+    }
+
+    NSMutableArray *certificates = [[NSMutableArray alloc] init];
+
+    for (size_t i = 0; i < signature->certificateCount; i++) {
+
+        NSData *certificateData = [NSData dataWithBytes:signature->certificates[i].data length:signature->certificates[i].length];
+        SecCertificateRef certificate = SecCertificateCreateWithData(kCFAllocatorDefault, (__bridge CFDataRef)certificateData);
+
+        if (certificate) { [certificates addObject:CFBridgingRelease(certificate)]; } else { break; }
+    }
+
+    if (checksumLength > 0 && checksumLength == signature->checksum.length && memcmp(checksum, signature->checksum.data, checksumLength) == 0 &&
+        [certificates count] == signature->certificateCount) {
+
+        // verify the signature of the checksum using the signer's public key
+        SecKeyRef publicKey = SecCertificateCopyKey((__bridge SecCertificateRef)[certificates firstObject]);
+
+        if (publicKey) {
+
+            NSData *checksumData = [NSData dataWithBytesNoCopy:checksum length:checksumLength freeWhenDone:NO];
+            NSData *signatureData = [NSData dataWithBytesNoCopy:(void*)signature->signature.data length:signature->signature.length freeWhenDone:NO];
+            BOOL signatureIsValid = SecKeyVerifySignature(publicKey, algorithm, (__bridge CFDataRef)checksumData, (__bridge CFDataRef)signatureData, NULL);
+            CFRelease(publicKey);
+
+            // the signature is correct, so now make sure the signer is who we expect. If
+            // the certificate chain cannot be evaluated (e.g. because the certificate has
+            // expired since the package was signed), the status remains undetermined
+            if (signatureIsValid) { status = [self statusOfSignerWithCertificates:certificates]; }
+        }
+    }
+
+    if (status == MTPackageSignatureInvalid) { os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Package signature is invalid"); }
+
+    return status;
+}
+
+- (MTPackageSignatureStatus)statusOfSignerWithCertificates:(NSArray*)certificates
+{
+    MTPackageSignatureStatus status = MTPackageSignatureUndetermined;
+
+    SecTrustRef trust = NULL;
+    SecPolicyRef policy = SecPolicyCreateBasicX509();
+    OSStatus result = SecTrustCreateWithCertificates((__bridge CFArrayRef)certificates, policy, &trust);
+    if (policy) { CFRelease(policy); }
+
+    if (result == errSecSuccess && SecTrustEvaluateWithError(trust, NULL)) {
+
+        NSArray *chain = CFBridgingRelease(SecTrustCopyCertificateChain(trust));
+
+        if ([chain count] > 2) {
+
+            // the chain must be anchored at the Apple Root CA
+            NSData *rootData = CFBridgingRelease(SecCertificateCopyData((__bridge SecCertificateRef)[chain lastObject]));
+            uint8_t fingerprint[CC_SHA256_DIGEST_LENGTH];
+            CC_SHA256([rootData bytes], (CC_LONG)[rootData length], fingerprint);
+
+            if (memcmp(fingerprint, kMTAppleRootCAFingerprint, sizeof(fingerprint)) == 0) {
+
+                // and the signer must be a Developer ID Installer of our team
+                SecCertificateRef signer = (__bridge SecCertificateRef)[chain firstObject];
+                NSString *signerName = CFBridgingRelease(SecCertificateCopySubjectSummary(signer));
+
+                BOOL isDeveloperID = ([self certificate:signer containsExtension:kMTDeveloperIDInstallerLeafOID] &&
+                                      [self certificate:(__bridge SecCertificateRef)[chain objectAtIndex:1] containsExtension:kMTDeveloperIDIntermediateOID]);
+
+                status = (isDeveloperID && [signerName rangeOfString:kMTPackageSignerPattern options:NSRegularExpressionSearch].location != NSNotFound) ? MTPackageSignatureValid : MTPackageSignatureInvalid;
+            }
+        }
+    }
+
+    if (trust) { CFRelease(trust); }
+
+    return status;
+}
+
+- (BOOL)certificate:(SecCertificateRef)certificate containsExtension:(NSString*)oid
+{
+    NSDictionary *values = CFBridgingRelease(SecCertificateCopyValues(certificate, (__bridge CFArrayRef)[NSArray arrayWithObject:oid], NULL));
+
+    return ([values objectForKey:oid] != nil);
+}
+
+- (BOOL)gatekeeperAssessmentOfPackageAtPath:(NSString*)path
 {
     BOOL isValid = NO;
 
@@ -129,7 +427,7 @@
             if ([match numberOfRanges] == 2) {
 
                 NSString *devTeam = [consoleMsg substringWithRange:[match rangeAtIndex:1]];
-                isValid = ([devTeam rangeOfString:@"Developer ID Installer:.*(7R5ZEU67FQ)" options:NSRegularExpressionSearch].location != NSNotFound);
+                isValid = ([devTeam rangeOfString:kMTPackageSignerPattern options:NSRegularExpressionSearch].location != NSNotFound);
             }
         }
     }
@@ -137,4 +435,66 @@
     return isValid;
 }
 
+#pragma mark - Validation cache
+
++ (NSNumber*)cachedValidationResultForKey:(NSData*)key
+{
+    NSNumber *result = nil;
+    
+    @synchronized (self) {
+        
+        MTPackageValidationResult *entry = (key) ? [packageValidationCache objectForKey:key] : nil;
+        
+        if (entry && [entry expirationTime] > [[NSProcessInfo processInfo] systemUptime]) {
+            
+            result = [NSNumber numberWithBool:[entry isValid]];
+            packageValidationCacheHits++;
+            
+        } else {
+            
+            packageValidationCacheMisses++;
+        }
+    }
+    
+    return result;
+}
+
++ (void)cacheValidationResult:(BOOL)isValid forKey:(NSData*)key
+{
+    NSTimeInterval now = [[NSProcessInfo processInfo] systemUptime];
+    
+    MTPackageValidationResult *entry = [[MTPackageValidationResult alloc] init];
+    [entry setIsValid:isValid];
+    [entry setExpirationTime:now + kMTPackageValidationCacheTimeout];
+    
+    @synchronized (self) {
+        
+        if (!packageValidationCache) { packageValidationCache = [[NSMutableDictionary alloc] init]; }
+        
+        // remove expired entries
+        NSSet *expiredKeys = [packageValidationCache keysOfEntriesPassingTest:^BOOL(NSData *key, MTPackageValidationResult *result, BOOL *stop) {
+            return ([result expirationTime] <= now);
+        }];
+        [packageValidationCache removeObjectsForKeys:[expiredKeys allObjects]];
+        
+        [packageValidationCache setObject:entry forKey:key];
+    }
+}
+
++ (NSDictionary*)validationCacheStatistics
+{
+    NSDictionary *statistics = nil;
+    
+    @synchronized (self) {
+        
+        statistics = [NSDictionary dictionaryWithObjectsAndKeys:
+                      [NSNumber numberWithUnsignedLongLong:packageValidationCacheHits], kMTExtensionStatisticsCacheHitsKey,
+                      [NSNumber numberWithUnsignedLongLong:packageValidationCacheMisses], kMTExtensionStatisticsCacheMissesKey,
+                      nil
+        ];
+    }
+    
+    return statistics;
+}
+
 @end
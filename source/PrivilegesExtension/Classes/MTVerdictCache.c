@@ -0,0 +1,168 @@
+/*
+    MTVerdictCache.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTVerdictCache.h"
+#include <string.h>
+
+// an entry consists of the upper 40 bits of the hash, the generation (15 bits), the argument
+// index (8 bits) and the verdict (1 bit). The lower bits of the hash select the slot. As the
+// generation is never 0, an empty entry never matches
+#define MT_VERDICT_ENTRY_TAG_MASK           0xFFFFFFFFFF000000ULL
+#define MT_VERDICT_ENTRY_GENERATION_SHIFT   9
+#define MT_VERDICT_ENTRY_GENERATION_MASK    0x7FFF
+#define MT_VERDICT_ENTRY_ARGUMENT_SHIFT     1
+
+#define MT_SIPHASH_ROTATE(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+
+_Static_assert((MT_VERDICT_CACHE_SIZE & (MT_VERDICT_CACHE_SIZE - 1)) == 0, "The cache size must be a power of two");
+
+#pragma mark - Hashing
+
+static inline void mt_siphash_round(uint64_t *v)
+{
+    v[0] += v[1]; v[1] = MT_SIPHASH_ROTATE(v[1], 13); v[1] ^= v[0]; v[0] = MT_SIPHASH_ROTATE(v[0], 32);
+    v[2] += v[3]; v[3] = MT_SIPHASH_ROTATE(v[3], 16); v[3] ^= v[2];
+    v[0] += v[3]; v[3] = MT_SIPHASH_ROTATE(v[3], 21); v[3] ^= v[0];
+    v[2] += v[1]; v[1] = MT_SIPHASH_ROTATE(v[1], 17); v[1] ^= v[2]; v[2] = MT_SIPHASH_ROTATE(v[2], 32);
+}
+
+static inline void mt_siphash_compress(uint64_t *v, uint64_t word)
+{
+    v[3] ^= word;
+    mt_siphash_round(v);
+    v[0] ^= word;
+}
+
+static void mt_verdict_hash_add_byte(mt_verdict_hash_t *hash, uint8_t byte)
+{
+    hash->tail |= (uint64_t)byte << (8 * (hash->length & 7));
+    hash->length++;
+    
+    if ((hash->length & 7) == 0) {
+        
+        mt_siphash_compress(hash->v, hash->tail);
+        hash->tail = 0;
+    }
+}
+
+void mt_verdict_hash_begin(const mt_verdict_cache_t *cache, mt_verdict_hash_t *hash)
+{
+    hash->v[0] = 0x736f6d6570736575ULL ^ cache->key[0];
+    hash->v[1] = 0x646f72616e646f6dULL ^ cache->key[1];
+    hash->v[2] = 0x6c7967656e657261ULL ^ cache->key[0];
+    hash->v[3] = 0x7465646279746573ULL ^ cache->key[1];
+    hash->tail = 0;
+    hash->length = 0;
+}
+
+void mt_verdict_hash_update(mt_verdict_hash_t *hash, const char *data, size_t length)
+{
+    for (size_t i = 0; i < sizeof(uint32_t); i++) { mt_verdict_hash_add_byte(hash, (uint8_t)(length >> (8 * i))); }
+    
+    size_t i = 0;
+    
+    // fill up the tail, then process whole words
+    while (i < length && (hash->length & 7) != 0) { mt_verdict_hash_add_byte(hash, (uint8_t)data[i++]); }
+    
+    for (; i + 8 <= length; i += 8) {
+        
+        uint64_t word = 0;
+        for (size_t j = 0; j < 8; j++) { word |= (uint64_t)(uint8_t)data[i + j] << (8 * j); }
+        
+        mt_siphash_compress(hash->v, word);
+        hash->length += 8;
+    }
+    
+    while (i < length) { mt_verdict_hash_add_byte(hash, (uint8_t)data[i++]); }
+}
+
+uint64_t mt_verdict_hash_end(mt_verdict_hash_t *hash)
+{
+    uint64_t *v = hash->v;
+    
+    mt_siphash_compress(v, hash->tail | ((uint64_t)hash->length << 56));
+    v[2] ^= 0xff;
+    mt_siphash_round(v);
+    mt_siphash_round(v);
+    mt_siphash_round(v);
+    
+    return v[0] ^ v[1] ^ v[2] ^ v[3];
+}
+
+#pragma mark - Cache
+
+void mt_verdict_cache_init(mt_verdict_cache_t *cache, uint64_t key0, uint64_t key1)
+{
+    for (size_t i = 0; i < MT_VERDICT_CACHE_SIZE; i++) { atomic_init(&cache->entries[i], 0); }
+    
+    atomic_init(&cache->hits, 0);
+    atomic_init(&cache->misses, 0);
+    atomic_init(&cache->generation, 1);
+    cache->key[0] = key0;
+    cache->key[1] = key1;
+}
+
+uint32_t mt_verdict_cache_generation(mt_verdict_cache_t *cache)
+{
+    return atomic_load_explicit(&cache->generation, memory_order_acquire);
+}
+
+void mt_verdict_cache_reset(mt_verdict_cache_t *cache)
+{
+    uint32_t generation = atomic_load_explicit(&cache->generation, memory_order_relaxed) + 1;
+    
+    // the generation is stored with 15 bits only. When it wraps around,
+    // we clear all entries so that no old entry can match again
+    if (generation > MT_VERDICT_ENTRY_GENERATION_MASK) {
+        
+        generation = 1;
+        for (size_t i = 0; i < MT_VERDICT_CACHE_SIZE; i++) { atomic_store_explicit(&cache->entries[i], 0, memory_order_relaxed); }
+    }
+    
+    atomic_store_explicit(&cache->generation, generation, memory_order_release);
+}
+
+bool mt_verdict_cache_lookup(mt_verdict_cache_t *cache, uint64_t hash, uint32_t generation, int *verdict, uint32_t *argument)
+{
+    bool hit = false;
+    uint64_t entry = atomic_load_explicit(&cache->entries[hash & (MT_VERDICT_CACHE_SIZE - 1)], memory_order_relaxed);
+    
+    if ((entry & MT_VERDICT_ENTRY_TAG_MASK) == (hash & MT_VERDICT_ENTRY_TAG_MASK) &&
+        ((entry >> MT_VERDICT_ENTRY_GENERATION_SHIFT) & MT_VERDICT_ENTRY_GENERATION_MASK) == generation) {
+        
+        *verdict = (int)(entry & 1);
+        *argument = (uint32_t)((entry >> MT_VERDICT_ENTRY_ARGUMENT_SHIFT) & MT_VERDICT_CACHE_MAX_ARGUMENT);
+        hit = true;
+    }
+    
+    atomic_fetch_add_explicit((hit) ? &cache->hits : &cache->misses, 1, memory_order_relaxed);
+    
+    return hit;
+}
+
+void mt_verdict_cache_insert(mt_verdict_cache_t *cache, uint64_t hash, uint32_t generation, int verdict, uint32_t argument)
+{
+    if (argument <= MT_VERDICT_CACHE_MAX_ARGUMENT) {
+        
+        uint64_t entry = (hash & MT_VERDICT_ENTRY_TAG_MASK) |
+                         ((uint64_t)(generation & MT_VERDICT_ENTRY_GENERATION_MASK) << MT_VERDICT_ENTRY_GENERATION_SHIFT) |
+                         ((uint64_t)argument << MT_VERDICT_ENTRY_ARGUMENT_SHIFT) |
+                         (uint64_t)(verdict & 1);
+        
+        atomic_store_explicit(&cache->entries[hash & (MT_VERDICT_CACHE_SIZE - 1)], entry, memory_order_relaxed);
+    }
+}
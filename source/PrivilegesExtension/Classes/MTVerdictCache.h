@@ -0,0 +1,130 @@
+/*
+    MTVerdictCache.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTVerdictCache_h
+#define MTVerdictCache_h
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    A small, lock-free cache of event verdicts. Entries are keyed on a 64 bit hash of the
+    event's executable identity and arguments. The hash is a SipHash-1-3 with a random key
+    that is generated when the cache is initialized, so nobody can craft arguments that
+    collide with the key of a cached "allow" verdict.
+ 
+    Every entry is a single 64 bit word that contains (most of) the hash, the generation it
+    was stored in, the verdict and the index of the argument that caused the verdict. So
+    readers never see a partially written entry. Resetting the cache just starts a new
+    generation, which invalidates all existing entries at once. Callers must get the current
+    generation before they start evaluating an event and store the verdict with that
+    generation, so a verdict based on an outdated configuration is never found after a reset.
+*/
+
+#define MT_VERDICT_CACHE_SIZE               512
+#define MT_VERDICT_CACHE_MAX_ARGUMENT       255
+
+typedef struct {
+    _Atomic uint64_t entries[MT_VERDICT_CACHE_SIZE];
+    _Atomic uint64_t hits;
+    _Atomic uint64_t misses;
+    _Atomic uint32_t generation;
+    uint64_t key[2];
+} mt_verdict_cache_t;
+
+typedef struct {
+    uint64_t v[4];
+    uint64_t tail;
+    size_t length;
+} mt_verdict_hash_t;
+
+/*!
+ @function      mt_verdict_cache_init
+ @abstract      Initializes an empty cache.
+ @param         cache A pointer to the cache.
+ @param         key0 The first half of the (random) hash key.
+ @param         key1 The second half of the (random) hash key.
+*/
+void mt_verdict_cache_init(mt_verdict_cache_t *cache, uint64_t key0, uint64_t key1);
+
+/*!
+ @function      mt_verdict_cache_generation
+ @abstract      Returns the current generation of the cache.
+ @param         cache A pointer to the cache.
+*/
+uint32_t mt_verdict_cache_generation(mt_verdict_cache_t *cache);
+
+/*!
+ @function      mt_verdict_cache_reset
+ @abstract      Invalidates all entries of the cache.
+ @param         cache A pointer to the cache.
+*/
+void mt_verdict_cache_reset(mt_verdict_cache_t *cache);
+
+/*!
+ @function      mt_verdict_hash_begin
+ @abstract      Starts calculating the hash of a cache key.
+ @param         cache A pointer to the cache.
+ @param         hash A pointer to the hash state.
+*/
+void mt_verdict_hash_begin(const mt_verdict_cache_t *cache, mt_verdict_hash_t *hash);
+
+/*!
+ @function      mt_verdict_hash_update
+ @abstract      Adds a string to the hash of a cache key.
+ @param         hash A pointer to the hash state.
+ @param         data The string. Does not need to be null-terminated.
+ @param         length The length of the string (in bytes).
+ @discussion    The length of the string is hashed as well, so different sequences of strings
+                never produce the same input for the hash function.
+*/
+void mt_verdict_hash_update(mt_verdict_hash_t *hash, const char *data, size_t length);
+
+/*!
+ @function      mt_verdict_hash_end
+ @abstract      Returns the hash of a cache key.
+ @param         hash A pointer to the hash state.
+*/
+uint64_t mt_verdict_hash_end(mt_verdict_hash_t *hash);
+
+/*!
+ @function      mt_verdict_cache_lookup
+ @abstract      Looks up the verdict for the given hash.
+ @param         cache A pointer to the cache.
+ @param         hash The hash of the cache key.
+ @param         generation The generation returned by mt_verdict_cache_generation.
+ @param         verdict A pointer to a variable that receives the cached verdict.
+ @param         argument A pointer to a variable that receives the index of the argument that caused the verdict.
+ @discussion    Returns true on a cache hit, otherwise returns false.
+*/
+bool mt_verdict_cache_lookup(mt_verdict_cache_t *cache, uint64_t hash, uint32_t generation, int *verdict, uint32_t *argument);
+
+/*!
+ @function      mt_verdict_cache_insert
+ @abstract      Stores a verdict in the cache. An existing entry in the same slot is replaced.
+ @param         cache A pointer to the cache.
+ @param         hash The hash of the cache key.
+ @param         generation The generation returned by mt_verdict_cache_generation before the event was evaluated.
+ @param         verdict The verdict (0 or 1).
+ @param         argument The index of the argument that caused the verdict. Verdicts for arguments with an
+                index greater than MT_VERDICT_CACHE_MAX_ARGUMENT are not cached.
+*/
+void mt_verdict_cache_insert(mt_verdict_cache_t *cache, uint64_t hash, uint32_t generation, int verdict, uint32_t argument);
+
+#endif /* MTVerdictCache_h */
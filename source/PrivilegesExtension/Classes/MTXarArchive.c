@@ -0,0 +1,371 @@
+/*
+    MTXarArchive.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTXarArchive.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#define MT_XAR_MAGIC                0x78617221  // "xar!"
+#define MT_XAR_HEADER_LENGTH        28
+
+// checksum algorithms as stored in the header
+#define MT_XAR_CKSUM_SHA1           1
+#define MT_XAR_CKSUM_OTHER          3
+
+typedef struct {
+    const char *begin;
+    const char *end;
+} mt_xar_range_t;
+
+#pragma mark - Reading the header
+
+static inline uint64_t mt_xar_read_be(const uint8_t *data, size_t length)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < length; i++) { value = (value << 8) | data[i]; }
+    
+    return value;
+}
+
+static bool mt_xar_checksum_from_name(const char *name, size_t length, MTXarChecksum *checksumType)
+{
+    bool success = true;
+    
+    if (length == 4 && memcmp(name, "sha1", 4) == 0) {
+        *checksumType = MTXarChecksumSHA1;
+    } else if (length == 6 && memcmp(name, "sha256", 6) == 0) {
+        *checksumType = MTXarChecksumSHA256;
+    } else if (length == 6 && memcmp(name, "sha512", 6) == 0) {
+        *checksumType = MTXarChecksumSHA512;
+    } else {
+        success = false;
+    }
+    
+    return success;
+}
+
+#pragma mark - Scanning the table of contents
+
+// the table of contents is written by xar itself, so instead of parsing the whole
+// document we just look for the few elements we need. The elements we look for are
+// not nested in themselves, so the first closing tag ends the element
+static bool mt_xar_find_element(mt_xar_range_t range, const char *name, mt_xar_range_t *attributes, mt_xar_range_t *content)
+{
+    bool found = false;
+    size_t nameLength = strlen(name);
+    const char *position = range.begin;
+    
+    while (!found && position + nameLength + 2 < range.end) {
+        
+        const char *tag = memchr(position, '<', range.end - position);
+        if (!tag || tag + nameLength + 2 >= range.end) { break; }
+        
+        const char *next = tag + 1 + nameLength;
+        
+        if (memcmp(tag + 1, name, nameLength) == 0 && (*next == '>' || *next == ' ' || *next == '\t' || *next == '\r' || *next == '\n')) {
+            
+            const char *tagEnd = memchr(next, '>', range.end - next);
+            
+            if (tagEnd && tagEnd[-1] != '/') {
+                
+                // look for the closing tag
+                for (const char *p = tagEnd + 1; p + nameLength + 3 <= range.end; p++) {
+                    
+                    p = memchr(p, '<', range.end - p);
+                    if (!p || p + nameLength + 3 > range.end) { break; }
+                    
+                    if (p[1] == '/' && memcmp(p + 2, name, nameLength) == 0 && p[2 + nameLength] == '>') {
+                        
+                        if (attributes) { *attributes = (mt_xar_range_t){ next, tagEnd }; }
+                        if (content) { *content = (mt_xar_range_t){ tagEnd + 1, p }; }
+                        found = true;
+                        break;
+                    }
+                }
+            }
+            
+            if (!found) { break; }
+            
+        } else {
+            
+            position = tag + 1;
+        }
+    }
+    
+    return found;
+}
+
+static bool mt_xar_find_attribute(mt_xar_range_t attributes, const char *name, mt_xar_range_t *value)
+{
+    bool found = false;
+    size_t nameLength = strlen(name);
+    
+    for (const char *p = attributes.begin; !found && p + nameLength + 3 <= attributes.end; p++) {
+        
+        if ((p == attributes.begin || p[-1] == ' ' || p[-1] == '\t' || p[-1] == '\r' || p[-1] == '\n') &&
+            memcmp(p, name, nameLength) == 0 && p[nameLength] == '=' && (p[nameLength + 1] == '"' || p[nameLength + 1] == '\'')) {
+            
+            const char *valueBegin = p + nameLength + 2;
+            const char *valueEnd = memchr(valueBegin, p[nameLength + 1], attributes.end - valueBegin);
+            
+            if (valueEnd) {
+                
+                *value = (mt_xar_range_t){ valueBegin, valueEnd };
+                found = true;
+            }
+        }
+    }
+    
+    return found;
+}
+
+static bool mt_xar_parse_number(mt_xar_range_t range, uint64_t *number)
+{
+    bool success = false;
+    uint64_t value = 0;
+    const char *p = range.begin;
+    
+    while (p < range.end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) { p++; }
+    
+    for (; p < range.end && *p >= '0' && *p <= '9'; p++) {
+        
+        if (value > (UINT64_MAX - 9) / 10) { return false; }
+        value = value * 10 + (uint64_t)(*p - '0');
+        success = true;
+    }
+    
+    while (p < range.end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) { p++; }
+    
+    if (success && p == range.end) { *number = value; } else { success = false; }
+    
+    return success;
+}
+
+// gets the heap data referenced by the <offset> and <size> elements of the given element
+static bool mt_xar_heap_data(mt_xar_range_t element, const uint8_t *heap, size_t heapLength, mt_xar_data_t *data)
+{
+    bool success = false;
+    mt_xar_range_t offsetRange, sizeRange;
+    uint64_t offset = 0, size = 0;
+    
+    if (mt_xar_find_element(element, "offset", NULL, &offsetRange) && mt_xar_parse_number(offsetRange, &offset) &&
+        mt_xar_find_element(element, "size", NULL, &sizeRange) && mt_xar_parse_number(sizeRange, &size) &&
+        size > 0 && offset <= heapLength && size <= heapLength - offset) {
+        
+        data->data = heap + offset;
+        data->length = (size_t)size;
+        success = true;
+    }
+    
+    return success;
+}
+
+#pragma mark - Decoding certificates
+
+static inline int mt_xar_base64_value(char c)
+{
+    int value = -1;
+    
+    if (c >= 'A' && c <= 'Z') {
+        value = c - 'A';
+    } else if (c >= 'a' && c <= 'z') {
+        value = c - 'a' + 26;
+    } else if (c >= '0' && c <= '9') {
+        value = c - '0' + 52;
+    } else if (c == '+') {
+        value = 62;
+    } else if (c == '/') {
+        value = 63;
+    }
+    
+    return value;
+}
+
+// decodes base64 encoded data, ignoring whitespace. Returns the number of decoded bytes or 0 on error
+static size_t mt_xar_base64_decode(mt_xar_range_t range, uint8_t *buffer)
+{
+    size_t length = 0;
+    uint32_t bits = 0;
+    int bitCount = 0;
+    bool padding = false;
+    
+    for (const char *p = range.begin; p < range.end; p++) {
+        
+        if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') { continue; }
+        
+        if (*p == '=') {
+            
+            padding = true;
+            
+        } else {
+            
+            int value = mt_xar_base64_value(*p);
+            if (value < 0 || padding) { return 0; }
+            
+            bits = (bits << 6) | (uint32_t)value;
+            bitCount += 6;
+            
+            if (bitCount >= 8) {
+                
+                bitCount -= 8;
+                buffer[length++] = (uint8_t)(bits >> bitCount);
+            }
+        }
+    }
+    
+    return length;
+}
+
+#pragma mark - Public functions
+
+MTXarResult mt_xar_read_toc(const uint8_t *archive, size_t length, mt_xar_data_t *toc)
+{
+    MTXarResult result = MTXarResultInvalidArchive;
+    
+    if (length >= MT_XAR_HEADER_LENGTH && mt_xar_read_be(archive, 4) == MT_XAR_MAGIC) {
+        
+        uint64_t headerLength = mt_xar_read_be(archive + 4, 2);
+        uint64_t tocLength = mt_xar_read_be(archive + 8, 8);
+        
+        if (headerLength >= MT_XAR_HEADER_LENGTH && headerLength <= length && tocLength > 0 && tocLength <= length - headerLength) {
+            
+            toc->data = archive + headerLength;
+            toc->length = (size_t)tocLength;
+            result = MTXarResultSuccess;
+        }
+    }
+    
+    return result;
+}
+
+MTXarResult mt_xar_read_signature(const uint8_t *archive, size_t length, mt_xar_signature_t *signature)
+{
+    MTXarResult result = MTXarResultInvalidArchive;
+    char *toc = NULL;
+    
+    memset(signature, 0, sizeof(mt_xar_signature_t));
+    
+    if (mt_xar_read_toc(archive, length, &signature->toc) != MTXarResultSuccess) { goto done; }
+    
+    size_t headerLength = signature->toc.data - archive;
+    size_t tocLength = signature->toc.length;
+    uint64_t uncompressedTocLength = mt_xar_read_be(archive + 16, 8);
+    uint32_t checksumAlgorithm = (uint32_t)mt_xar_read_be(archive + 24, 4);
+    
+    if (uncompressedTocLength == 0 || uncompressedTocLength > MT_XAR_MAX_TOC_LENGTH) {
+        
+        result = (uncompressedTocLength == 0) ? MTXarResultInvalidArchive : MTXarResultUnsupported;
+        goto done;
+    }
+    
+    // get the checksum algorithm. If it's not sha1, its name follows the fixed part of the header
+    if (checksumAlgorithm == MT_XAR_CKSUM_SHA1) {
+        
+        signature->checksumType = MTXarChecksumSHA1;
+        
+    } else if (checksumAlgorithm == MT_XAR_CKSUM_OTHER) {
+        
+        const char *name = (const char*)archive + MT_XAR_HEADER_LENGTH;
+        size_t nameLength = strnlen(name, headerLength - MT_XAR_HEADER_LENGTH);
+        
+        if (!mt_xar_checksum_from_name(name, nameLength, &signature->checksumType)) {
+            
+            result = MTXarResultUnsupported;
+            goto done;
+        }
+        
+    } else {
+        
+        result = (checksumAlgorithm == 0) ? MTXarResultNotSigned : MTXarResultUnsupported;
+        goto done;
+    }
+    
+    // decompress the table of contents
+    toc = malloc((size_t)uncompressedTocLength);
+    if (!toc) { goto done; }
+    
+    uLongf decompressedLength = (uLongf)uncompressedTocLength;
+    if (uncompress((Bytef*)toc, &decompressedLength, signature->toc.data, (uLong)tocLength) != Z_OK || decompressedLength != uncompressedTocLength) { goto done; }
+    
+    const uint8_t *heap = archive + headerLength + tocLength;
+    size_t heapLength = length - (headerLength + tocLength);
+    mt_xar_range_t document = { toc, toc + decompressedLength };
+    mt_xar_range_t tocElement, checksumElement, checksumAttributes, signatureElement, signatureAttributes, style;
+    
+    if (!mt_xar_find_element(document, "toc", NULL, &tocElement) ||
+        !mt_xar_find_element(tocElement, "checksum", &checksumAttributes, &checksumElement) ||
+        !mt_xar_heap_data(checksumElement, heap, heapLength, &signature->checksum)) { goto done; }
+    
+    // the style of the checksum must match the header
+    MTXarChecksum checksumStyle;
+    
+    if (!mt_xar_find_attribute(checksumAttributes, "style", &style) ||
+        !mt_xar_checksum_from_name(style.begin, style.end - style.begin, &checksumStyle) ||
+        checksumStyle != signature->checksumType) { goto done; }
+    
+    if (!mt_xar_find_element(tocElement, "signature", &signatureAttributes, &signatureElement)) {
+        
+        // packages may only have a CMS signature. We leave those to the caller
+        result = (mt_xar_find_element(tocElement, "x-signature", NULL, NULL)) ? MTXarResultUnsupported : MTXarResultNotSigned;
+        goto done;
+    }
+    
+    if (!mt_xar_find_attribute(signatureAttributes, "style", &style) || style.end - style.begin != 3 || memcmp(style.begin, "RSA", 3) != 0) {
+        
+        result = MTXarResultUnsupported;
+        goto done;
+    }
+    
+    if (!mt_xar_heap_data(signatureElement, heap, heapLength, &signature->signature)) { goto done; }
+    
+    // decode the certificates. The decoded data is never longer than the encoded data
+    signature->certificateData = malloc(signatureElement.end - signatureElement.begin);
+    if (!signature->certificateData) { goto done; }
+    
+    uint8_t *certificate = signature->certificateData;
+    mt_xar_range_t remaining = signatureElement, certificateElement;
+    
+    while (signature->certificateCount < MT_XAR_MAX_CERTIFICATES && mt_xar_find_element(remaining, "X509Certificate", NULL, &certificateElement)) {
+        
+        size_t certificateLength = mt_xar_base64_decode(certificateElement, certificate);
+        if (certificateLength == 0) { goto done; }
+        
+        signature->certificates[signature->certificateCount++] = (mt_xar_data_t){ certificate, certificateLength };
+        certificate += certificateLength;
+        remaining.begin = certificateElement.end;
+    }
+    
+    if (signature->certificateCount > 0) { result = MTXarResultSuccess; }
+    
+done:
+    free(toc);
+    if (result != MTXarResultSuccess) { mt_xar_signature_free(signature); }
+    
+    return result;
+}
+
+void mt_xar_signature_free(mt_xar_signature_t *signature)
+{
+    if (signature) {
+        
+        free(signature->certificateData);
+        signature->certificateData = NULL;
+        signature->certificateCount = 0;
+    }
+}
@@ -0,0 +1,101 @@
+/*
+    MTXarArchive.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTXarArchive_h
+#define MTXarArchive_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    Reads the signature of a xar archive (like an installer package) without spawning any
+    process. A xar archive starts with a big endian header (magic "xar!", header size, version,
+    compressed and uncompressed size of the table of contents and the checksum algorithm),
+    followed by the zlib compressed table of contents (an XML document) and the heap. The
+    table of contents contains the offset and size of its own checksum and of the signature
+    within the heap, followed by the signer's certificate chain (base64 encoded DER).
+ 
+    The checksum is calculated over the compressed table of contents and the signature is an
+    RSA PKCS#1 v1.5 signature of that checksum. Verifying the checksum, the signature and the
+    certificate chain is left to the caller, so this module only depends on zlib and can be
+    used (and tested) on any platform.
+*/
+
+#define MT_XAR_MAX_CERTIFICATES     8
+#define MT_XAR_MAX_TOC_LENGTH       (16 * 1024 * 1024)
+
+typedef enum {
+    MTXarResultSuccess          = 0,
+    MTXarResultInvalidArchive   = 1,    // not a xar archive or the archive is damaged
+    MTXarResultNotSigned        = 2,
+    MTXarResultUnsupported      = 3     // the archive uses a checksum or signature we don't know
+} MTXarResult;
+
+typedef enum {
+    MTXarChecksumSHA1           = 1,
+    MTXarChecksumSHA256         = 2,
+    MTXarChecksumSHA512         = 3
+} MTXarChecksum;
+
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+} mt_xar_data_t;
+
+typedef struct {
+    MTXarChecksum checksumType;
+    mt_xar_data_t toc;                                      // the compressed table of contents
+    mt_xar_data_t checksum;                                 // the stored checksum of the table of contents
+    mt_xar_data_t signature;                                // the RSA signature of the checksum
+    size_t certificateCount;
+    mt_xar_data_t certificates[MT_XAR_MAX_CERTIFICATES];    // DER encoded, the signer's certificate first
+    uint8_t *certificateData;
+} mt_xar_signature_t;
+
+/*!
+ @function      mt_xar_read_toc
+ @abstract      Gets the (compressed) table of contents of the given xar archive.
+ @param         archive A pointer to the archive's data.
+ @param         length The length of the archive's data (in bytes).
+ @param         toc A pointer to a mt_xar_data_t structure that receives the location of the table of contents.
+ @discussion    Returns MTXarResultSuccess or MTXarResultInvalidArchive. Only the header is read and
+                nothing is allocated, so this is a cheap way to identify the contents of an archive.
+*/
+MTXarResult mt_xar_read_toc(const uint8_t *archive, size_t length, mt_xar_data_t *toc);
+
+/*!
+ @function      mt_xar_read_signature
+ @abstract      Reads the signature of the given xar archive.
+ @param         archive A pointer to the archive's data.
+ @param         length The length of the archive's data (in bytes).
+ @param         signature A pointer to a mt_xar_signature_t structure that receives the signature.
+ @discussion    Returns MTXarResultSuccess if the signature has been read, otherwise returns the reason why not.
+                Only the header and the table of contents are read, so mapping a (large) package
+                into memory is cheap. The toc, checksum and signature fields point into the archive's
+                data, so the data must not be released while the signature is used. On success, the
+                caller is responsible for releasing the signature using mt_xar_signature_free.
+*/
+MTXarResult mt_xar_read_signature(const uint8_t *archive, size_t length, mt_xar_signature_t *signature);
+
+/*!
+ @function      mt_xar_signature_free
+ @abstract      Releases the memory allocated by mt_xar_read_signature.
+ @param         signature A pointer to the signature.
+*/
+void mt_xar_signature_free(mt_xar_signature_t *signature);
+
+#endif /* MTXarArchive_h */
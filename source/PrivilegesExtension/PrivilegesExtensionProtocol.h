@@ -26,6 +26,6 @@
 
 - (void)suspendExtensionUsingAuthorizedPID:(pid_t)pid completionHandler:(void(^)(BOOL success, NSError *error))completionHandler;
 - (void)resumeExtensionWithCompletionHandler:(void(^)(BOOL success))completionHandler;
-- (void)statusWithReply:(void(^)(NSString *status))reply;
+- (void)statusWithReply:(void(^)(NSString *status, NSDictionary *statistics))reply;
 
 @end
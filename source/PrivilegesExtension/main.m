@@ -18,133 +18,408 @@
 #import <EndpointSecurity/EndpointSecurity.h>
 #import <Cocoa/Cocoa.h>
 #import <os/log.h>
+#import <mach/mach_time.h>
+#import <bsm/libbsm.h>
 #import "MTPrivilegesExtension.h"
+#import "MTGlobPattern.h"
+#import "MTEventRing.h"
+#import "MTPathTrie.h"
+#import "MTEventPolicy.h"
+#import "MTEventRecorder.h"
+#import "Constants.h"
+
+static const char kProtectedPlistPattern[] = "*/corp.sap.privileges.*.plist";
+static mt_glob_t protectedPlistPattern;
+static mt_event_ring_t eventRing;
+static dispatch_source_t eventLogSource;
+static _Atomic(mt_path_trie_t*) protectedFileTrie;
+static _Atomic(mt_path_trie_t*) protectedExecTrie;
+static atomic_uint activeTrieReaders;
+static mt_verdict_cache_t *execVerdictCache;
+
+#ifdef DEBUG
+static mt_event_recorder_t *eventRecorder;
+#endif
+
+static mach_timebase_info_data_t machTimebase;
+
+# pragma mark - Protected paths
+
+static mt_path_trie_t *create_trie(NSArray *paths)
+{
+    const char **prefixes = calloc([paths count] + 1, sizeof(char*));
+    mt_path_trie_t *trie = NULL;
+    
+    if (prefixes) {
+        
+        for (NSUInteger i = 0; i < [paths count]; i++) { prefixes[i] = [[paths objectAtIndex:i] fileSystemRepresentation]; }
+        trie = mt_path_trie_create(prefixes, [paths count]);
+        free(prefixes);
+    }
+    
+    return trie;
+}
+
+// frees the given trie as soon as no event handler is reading any trie. Handlers
+// that start after the trie has been replaced always load the new trie, so once
+// the number of readers dropped to zero, nobody can still be using the old one
+static void retire_trie(mt_path_trie_t *trie)
+{
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, NSEC_PER_SEC), dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        
+        if (atomic_load(&activeTrieReaders) == 0) {
+            mt_path_trie_destroy(trie);
+        } else {
+            retire_trie(trie);
+        }
+    });
+}
+
+static void install_trie(_Atomic(mt_path_trie_t*) *slot, mt_path_trie_t *trie)
+{
+    // sequentially consistent, so the exchange is ordered before
+    // retire_trie() checks the number of readers
+    mt_path_trie_t *previousTrie = atomic_exchange(slot, trie);
+    if (previousTrie) { retire_trie(previousTrie); }
+}
 
 @interface Main : NSObject
 @property (nonatomic, strong, readwrite) MTPrivilegesExtension *privilegesExtension;
+@property (nonatomic, strong, readwrite) NSUserDefaults *userDefaults;
+@property (nonatomic, strong, readwrite) NSArray *mutedFilePaths;
+@property (nonatomic, assign) es_client_t *fileClient;
 @end
 
 @implementation Main
 
+- (instancetype)init
+{
+    self = [super init];
+    
+    if (self) {
+        _userDefaults = [[NSUserDefaults alloc] initWithSuiteName:kMTAppBundleIdentifier];
+    }
+    
+    return self;
+}
+
 - (void)run
 {
     os_log(OS_LOG_DEFAULT, "SAPCorp: Running");
     
+    [_userDefaults addObserver:self
+                    forKeyPath:kMTDefaultsAdditionalProtectedPathsKey
+                       options:NSKeyValueObservingOptionNew
+                       context:nil
+    ];
+    
     dispatch_main();
 }
 
+- (NSArray*)protectedFilePaths
+{
+    NSMutableArray *protectedPaths = [NSMutableArray arrayWithObjects:
+                                      @"/Applications/Privileges.app",
+                                      @"/Library/LaunchDaemons/corp.sap.privileges.daemon.plist",
+                                      @"/Library/LaunchDaemons/corp.sap.privileges.helper.plist",
+                                      @"/Library/LaunchDaemons/corp.sap.privileges.watcher.plist",
+                                      @"/Library/LaunchAgents/corp.sap.privileges.agent.plist",
+                                      nil
+    ];
+    
+    if ([_userDefaults objectIsForcedForKey:kMTDefaultsAdditionalProtectedPathsKey]) {
+        
+        for (id aPath in [_userDefaults arrayForKey:kMTDefaultsAdditionalProtectedPathsKey]) {
+            
+            // we don't accept paths like "/" or "/Library" because protecting
+            // them would prevent deleting or renaming almost any file
+            if ([aPath isKindOfClass:[NSString class]] && [aPath isAbsolutePath] && [[aPath pathComponents] count] > 2 && strlen([aPath fileSystemRepresentation]) < PATH_MAX) {
+                
+                if (![protectedPaths containsObject:aPath]) { [protectedPaths addObject:aPath]; }
+                
+            } else {
+                
+                os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Ignoring invalid protected path: %{public}@", aPath);
+            }
+        }
+    }
+    
+    return protectedPaths;
+}
+
+- (void)updateProtectedFilePaths
+{
+    NSArray *protectedPaths = [self protectedFilePaths];
+    
+    if (![protectedPaths isEqualToArray:_mutedFilePaths]) {
+        
+        // add the new paths before removing the old ones, so the files
+        // that stay protected are never unprotected in between
+        for (NSString *aPath in protectedPaths) {
+            if (![_mutedFilePaths containsObject:aPath]) { es_mute_path(_fileClient, [aPath fileSystemRepresentation], ES_MUTE_PATH_TYPE_TARGET_PREFIX); }
+        }
+        
+        install_trie(&protectedFileTrie, create_trie(protectedPaths));
+        
+        // verdicts cached before this point may depend on the previous configuration
+        mt_verdict_cache_reset(execVerdictCache);
+        
+        for (NSString *aPath in _mutedFilePaths) {
+            if (![protectedPaths containsObject:aPath]) { es_unmute_path(_fileClient, [aPath fileSystemRepresentation], ES_MUTE_PATH_TYPE_TARGET_PREFIX); }
+        }
+        
+        if (_mutedFilePaths) { os_log(OS_LOG_DEFAULT, "SAPCorp: Protected paths have been updated (%lu paths)", (unsigned long)[protectedPaths count]); }
+        
+        _mutedFilePaths = protectedPaths;
+    }
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+{
+    if (object == _userDefaults && [keyPath isEqualToString:kMTDefaultsAdditionalProtectedPathsKey]) {
+        
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self updateProtectedFilePaths];
+        });
+    }
+}
+
 @end
 
-# pragma mark - Event handlers
+# pragma mark - Event logging
 
-static void handle_unlink_events(es_client_t *client, const es_message_t *message)
+// denied events are not logged from within the event handlers. The handlers just
+// copy the relevant details into a lock-free ring buffer (after responding to the
+// event) and the ring is drained and logged on a separate queue
+static void log_event(MTEventType type, mt_event_string_t path)
 {
-    NSString *filePath = [NSString stringWithUTF8String:message->event.unlink.target->path.data];
-   
-    os_log(OS_LOG_DEFAULT, "SAPCorp: Prevented deletion of protected file: %{public}@", filePath);
-    es_respond_auth_result(client, message, ES_AUTH_RESULT_DENY, false);
+    mt_event_ring_push(&eventRing, type, path.data, path.length);
+    dispatch_source_merge_data(eventLogSource, 1);
 }
 
-static void handle_rename_events(es_client_t *client, const es_message_t *message)
+static void drain_event_log(void)
 {
-    NSString *filePath = [NSString stringWithUTF8String:message->event.rename.source->path.data];
-   
-    os_log(OS_LOG_DEFAULT, "SAPCorp: Prevented renaming of protected file: %{public}@", filePath);
-    es_respond_auth_result(client, message, ES_AUTH_RESULT_DENY, false);
+    mt_event_record_t record;
+    
+    while (mt_event_ring_pop(&eventRing, &record)) {
+        
+        const char *ellipsis = (record.truncated) ? "..." : "";
+        
+        switch (record.type) {
+                
+            case MTEventTypeUnlink:
+                os_log(OS_LOG_DEFAULT, "SAPCorp: Prevented deletion of protected file: %{public}s%{public}s", record.path, ellipsis);
+                break;
+                
+            case MTEventTypeRename:
+                os_log(OS_LOG_DEFAULT, "SAPCorp: Prevented renaming of protected file: %{public}s%{public}s", record.path, ellipsis);
+                break;
+                
+            case MTEventTypeClone:
+                os_log(OS_LOG_DEFAULT, "SAPCorp: Prevented cloning of protected file: %{public}s%{public}s", record.path, ellipsis);
+                break;
+                
+            case MTEventTypeExec:
+                os_log(OS_LOG_DEFAULT, "SAPCorp: Prevented unloading of protected launchd plist: %{public}s%{public}s", record.path, ellipsis);
+                break;
+        }
+    }
+    
+    uint64_t dropped = mt_event_ring_take_dropped(&eventRing);
+    
+    if (dropped > 0) {
+        os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Event log overflow, %llu log messages have been dropped", dropped);
+    }
 }
 
-static void handle_clone_events(es_client_t *client, const es_message_t *message)
+# pragma mark - Event handlers
+
+static mt_event_string_t event_string(es_string_token_t token)
 {
-    NSString *filePath = [NSString stringWithUTF8String:message->event.clone.source->path.data];
-   
-    os_log(OS_LOG_DEFAULT, "SAPCorp: Prevented cloning of protected file: %{public}@", filePath);
-    es_respond_auth_result(client, message, ES_AUTH_RESULT_DENY, false);
+    return (mt_event_string_t){ token.length, token.data };
 }
 
-static void handle_exec_events(es_client_t *client, const es_message_t *message)
+static mt_event_string_t exec_argument(const void *context, uint32_t index)
 {
-    es_auth_result_t authResult = ES_AUTH_RESULT_ALLOW;
+    return event_string(es_exec_arg((const es_event_exec_t*)context, index));
+}
 
-    es_event_exec_t execEvent = message->event.exec;
-    NSString *signingID = [NSString stringWithUTF8String:execEvent.target->signing_id.data];
+// creates a view of the message's fields the event policy needs, without copying
+// any strings, so the decision is made as fast as possible. Returns false if the
+// message has an unexpected event type
+static bool event_from_message(const es_message_t *message, mt_event_t *event)
+{
+    bool success = true;
+    memset(event, 0, sizeof(mt_event_t));
     
-    if ([signingID isEqualToString:@"com.apple.xpc.launchctl"]) {
-        
-        bool isPlatformBinary = execEvent.target->is_platform_binary;
-        int count = es_exec_arg_count(&execEvent);
-
-        if (count > 1 && isPlatformBinary) {
+    switch (message->event_type) {
             
-            NSMutableArray *arguments = [[NSMutableArray alloc] init];
+        case ES_EVENT_TYPE_AUTH_UNLINK:
+            event->type = MTEventTypeUnlink;
+            event->source = event_string(message->event.unlink.target->path);
+            break;
             
-            for (int i = 1; i < count; i++) {
+        case ES_EVENT_TYPE_AUTH_RENAME:
+            event->type = MTEventTypeRename;
+            event->source = event_string(message->event.rename.source->path);
+            
+            if (message->event.rename.destination_type == ES_DESTINATION_TYPE_EXISTING_FILE) {
                 
-                es_string_token_t argument = es_exec_arg(&execEvent, i);
+                event->destination = event_string(message->event.rename.destination.existing_file->path);
                 
-                if (argument.length > 0) {
-                    
-                    NSString *argumentString = [[NSString alloc] initWithBytes:argument.data
-                                                                        length:argument.length
-                                                                      encoding:NSUTF8StringEncoding
-                    ];
-                    
-                    if (i == 1 && ![argumentString isEqualToString:@"unload"] && ![argumentString isEqualToString:@"bootout"]) {
-                        
-                        break;
-                        
-                    } else {
-                        
-                        [arguments addObject:argumentString];
-                    }
-                }
+            } else {
+                
+                event->destination = event_string(message->event.rename.destination.new_path.dir->path);
+                event->destinationName = event_string(message->event.rename.destination.new_path.filename);
             }
+            break;
+            
+        case ES_EVENT_TYPE_AUTH_CLONE:
+            event->type = MTEventTypeClone;
+            event->source = event_string(message->event.clone.source->path);
+            event->destination = event_string(message->event.clone.target_dir->path);
+            event->destinationName = event_string(message->event.clone.target_name);
+            break;
             
-            if ([arguments count] > 0) {
+        case ES_EVENT_TYPE_AUTH_EXEC:
+            event->type = MTEventTypeExec;
+            event->source = event_string(message->event.exec.target->executable->path);
+            event->signingID = event_string(message->event.exec.target->signing_id);
+            event->isPlatformBinary = message->event.exec.target->is_platform_binary;
+            event->argumentCount = es_exec_arg_count(&message->event.exec);
+            event->argument = exec_argument;
+            event->argumentContext = &message->event.exec;
+            break;
+            
+        default:
+            success = false;
+    }
+    
+    return success;
+}
 
-                NSPredicate *predicate = [NSPredicate predicateWithFormat:@"SELF LIKE[c] %@", @"*/corp.sap.privileges.*.plist"];
-                NSArray *filteredArray = [arguments filteredArrayUsingPredicate:predicate];
-                
-                if ([filteredArray count] > 0) {
-                    
-                    os_log(OS_LOG_DEFAULT, "SAPCorp: Prevented unloading of protected launchd plist: %{public}@", [filteredArray firstObject]);
-                    authResult = ES_AUTH_RESULT_DENY;
-                }
-            }
-        }
+static void handle_event(es_client_t *client, const es_message_t *message)
+{
+    mt_event_t event;
+    
+    if (event_from_message(message, &event)) {
+        
+        // get the cache generation before loading the tries, so verdicts
+        // based on outdated tries are never found after a reset
+        uint32_t cacheGeneration = mt_verdict_cache_generation(execVerdictCache);
+        
+        // register as a reader before loading the tries, so they
+        // are not freed while we're using them (see retire_trie)
+        atomic_fetch_add(&activeTrieReaders, 1);
+        
+        mt_event_policy_t policy = {
+            atomic_load(&protectedFileTrie),
+            atomic_load(&protectedExecTrie),
+            &protectedPlistPattern,
+            execVerdictCache,
+            cacheGeneration
+        };
+        
+        mt_event_string_t loggedPath;
+        MTEventVerdict verdict = mt_event_policy_evaluate(&policy, &event, &loggedPath);
+        atomic_fetch_sub(&activeTrieReaders, 1);
+        
+        es_respond_auth_result(client, message, (verdict == MTEventVerdictDeny) ? ES_AUTH_RESULT_DENY : ES_AUTH_RESULT_ALLOW, false);
+        if (verdict == MTEventVerdictDeny) { log_event(event.type, loggedPath); }
+        
+#ifdef DEBUG
+        if (eventRecorder) { mt_event_recorder_write(eventRecorder, &event, verdict, clock_gettime_nsec_np(CLOCK_UPTIME_RAW)); }
+#endif
+        
+    } else {
+        
+        os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Unexpected event type encountered: %d", message->event_type);
     }
+}
 
-    es_respond_auth_result(client, message, authResult, false);
+static uint64_t nanoseconds_from_mach_time(uint64_t machTime)
+{
+    return machTime * machTimebase.numer / machTimebase.denom;
 }
 
-static void handle_event(es_client_t *client, const es_message_t *message, bool isPaused)
+static void dispatch_event(es_client_t *client, const es_message_t *message, const atomic_bool *pausedFlag, dispatch_queue_t queue, mt_deadline_monitor_t *monitor)
 {
-    if (isPaused) {
+    if (atomic_load_explicit(pausedFlag, memory_order_acquire)) {
         
         es_respond_auth_result(client, message, ES_AUTH_RESULT_ALLOW, false);
         
     } else {
         
-        switch (message->event_type) {
-                
-            case ES_EVENT_TYPE_AUTH_UNLINK:
-                handle_unlink_events(client, message);
-                break;
-                
-            case ES_EVENT_TYPE_AUTH_RENAME:
-                handle_rename_events(client, message);
-                break;
-                
-            case ES_EVENT_TYPE_AUTH_CLONE:
-                handle_clone_events(client, message);
-                break;
-                
-            case ES_EVENT_TYPE_AUTH_EXEC:
-                handle_exec_events(client, message);
-                break;
-                
-            default:
-                os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Unexpected event type encountered: %d", message->event_type);
+        // hand the event over to the worker queue for its type, so a slow
+        // event does not hold up the client. The message must be retained
+        // until we responded to it
+        es_retain_message(message);
+        
+        dispatch_async(queue, ^{
+            
+            uint64_t now = mach_absolute_time();
+            uint64_t slack = (message->deadline > now) ? nanoseconds_from_mach_time(message->deadline - now) : 0;
+            uint64_t budget = (message->deadline > message->mach_time) ? nanoseconds_from_mach_time(message->deadline - message->mach_time) : 0;
+            
+            // exec events are always evaluated, because there is no verdict that is safe
+            // without looking at them: allowing them would allow unloading our launchd
+            // plists and denying them would break launchctl. Their policy is just a trie
+            // lookup and a few string comparisons. Endpoint Security only delivers file
+            // events for protected paths, so denying them keeps the files protected
+            if (mt_deadline_monitor_admit(monitor, slack, budget) || message->event_type == ES_EVENT_TYPE_AUTH_EXEC) {
+                handle_event(client, message);
+            } else {
+                es_respond_auth_result(client, message, ES_AUTH_RESULT_DENY, false);
+            }
+            
+            es_release_message(message);
+        });
+    }
+}
+
+# pragma mark - Process lineage
+
+static mt_process_lineage_process_t lineage_process(const es_process_t *process)
+{
+    mt_process_lineage_process_t lineageProcess = {
+        audit_token_to_pid(process->audit_token),
+        (uint32_t)audit_token_to_pidversion(process->audit_token),
+        process->ppid,
+        event_string(process->executable->path),
+        process->is_platform_binary
+    };
+    
+    return lineageProcess;
+}
+
+// notifications don't need a response, so they are handled
+// right away instead of being handed over to a worker queue
+static void record_lineage(mt_process_lineage_t *lineage, const es_message_t *message)
+{
+    mt_process_lineage_process_t process = lineage_process(message->process);
+    
+    switch (message->event_type) {
+            
+        case ES_EVENT_TYPE_NOTIFY_FORK: {
+            
+            mt_process_lineage_process_t child = lineage_process(message->event.fork.child);
+            mt_process_lineage_fork(lineage, &process, &child);
+            break;
         }
+            
+        case ES_EVENT_TYPE_NOTIFY_EXEC: {
+            
+            mt_process_lineage_process_t target = lineage_process(message->event.exec.target);
+            mt_process_lineage_exec(lineage, &process, &target, es_exec_arg_count(&message->event.exec), exec_argument, &message->event.exec);
+            break;
+        }
+            
+        case ES_EVENT_TYPE_NOTIFY_EXIT:
+            mt_process_lineage_exit(lineage, process.pid, process.pidVersion);
+            break;
+            
+        default:
+            break;
     }
 }
 
@@ -154,6 +429,40 @@ int main(int argc, char *argv[])
     
     Main *m = [[Main alloc] init];
     m.privilegesExtension = [[MTPrivilegesExtension alloc] init];
+    const atomic_bool *pausedFlag = [m.privilegesExtension pausedFlag];
+    mt_deadline_monitor_t *fileDeadlineMonitor = [m.privilegesExtension fileDeadlineMonitor];
+    mt_deadline_monitor_t *execDeadlineMonitor = [m.privilegesExtension execDeadlineMonitor];
+    execVerdictCache = [m.privilegesExtension execVerdictCache];
+    mach_timebase_info(&machTimebase);
+    
+    // file and exec events are handled on separate worker queues, so
+    // a burst of one type cannot eat up the deadline of the other
+    dispatch_queue_attr_t workerAttributes = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INTERACTIVE, 0);
+    dispatch_queue_t fileQueue = dispatch_queue_create("corp.sap.privileges.extension.file", workerAttributes);
+    dispatch_queue_t execQueue = dispatch_queue_create("corp.sap.privileges.extension.exec", workerAttributes);
+    mt_glob_compile(&protectedPlistPattern, kProtectedPlistPattern);
+    
+    mt_event_ring_init(&eventRing);
+    eventLogSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_OR, 0, 0, dispatch_queue_create("corp.sap.privileges.extension.log", DISPATCH_QUEUE_SERIAL));
+    dispatch_source_set_event_handler(eventLogSource, ^{ drain_event_log(); });
+    dispatch_resume(eventLogSource);
+    
+#ifdef DEBUG
+    // debug builds can record all events and their verdicts, so
+    // they can be replayed against the event policy later on
+    NSString *recordingPath = [[NSUserDefaults standardUserDefaults] stringForKey:kMTDefaultsRecordEventsPathKey];
+    
+    if ([recordingPath length] > 0) {
+        
+        eventRecorder = mt_event_recorder_open([recordingPath fileSystemRepresentation]);
+        
+        if (eventRecorder) {
+            os_log(OS_LOG_DEFAULT, "SAPCorp: Recording events to %{public}@", recordingPath);
+        } else {
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to create event recording: %{public}s", strerror(errno));
+        }
+    }
+#endif
   
     while (![m.privilegesExtension isRunning]) {
         
@@ -161,7 +470,7 @@ int main(int argc, char *argv[])
     
         es_client_t *fileClient;
         es_new_client_result_t result = es_new_client(&fileClient, ^(es_client_t *client, const es_message_t *message) {
-            handle_event(client, message, [m.privilegesExtension isPaused]);
+            dispatch_event(client, message, pausedFlag, fileQueue, fileDeadlineMonitor);
         });
 
         if (result != ES_NEW_CLIENT_RESULT_SUCCESS) {
@@ -198,17 +507,11 @@ int main(int argc, char *argv[])
         es_unmute_all_target_paths(fileClient);
         es_invert_muting(fileClient, ES_MUTE_INVERSION_TYPE_TARGET_PATH);
         
-        NSArray *protectedPaths = [NSArray arrayWithObjects:
-                                   @"/Applications/Privileges.app",
-                                   @"/Library/LaunchDaemons/corp.sap.privileges.daemon.plist",
-                                   @"/Library/LaunchDaemons/corp.sap.privileges.helper.plist",
-                                   @"/Library/LaunchDaemons/corp.sap.privileges.watcher.plist",
-                                   @"/Library/LaunchAgents/corp.sap.privileges.agent.plist",
-                                   nil
-        ];
-        for (NSString *aPath in protectedPaths) {
-            es_mute_path(fileClient, [aPath UTF8String], ES_MUTE_PATH_TYPE_TARGET_PREFIX);
-        }
+        // the protected paths may be extended using a configuration profile and
+        // are updated without recreating the client if the profile changes
+        [m setFileClient:fileClient];
+        [m setMutedFilePaths:nil];
+        [m updateProtectedFilePaths];
 
         if (es_subscribe(fileClient, fileEvents, sizeof(fileEvents) / sizeof(fileEvents[0])) != ES_RETURN_SUCCESS) {
             os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to subscribe to file events");
@@ -221,7 +524,7 @@ int main(int argc, char *argv[])
         
         es_client_t *execClient;
         result = es_new_client(&execClient, ^(es_client_t *client, const es_message_t *message) {
-            handle_event(client, message, [m.privilegesExtension isPaused]);
+            dispatch_event(client, message, pausedFlag, execQueue, execDeadlineMonitor);
         });
 
         if (result != ES_NEW_CLIENT_RESULT_SUCCESS) {
@@ -260,8 +563,10 @@ int main(int argc, char *argv[])
         ];
             
         for (NSString *aPath in protectedExecPaths) {
-            es_mute_path(execClient, [aPath UTF8String], ES_MUTE_PATH_TYPE_TARGET_PREFIX);
+            es_mute_path(execClient, [aPath fileSystemRepresentation], ES_MUTE_PATH_TYPE_TARGET_PREFIX);
         }
+        
+        install_trie(&protectedExecTrie, create_trie(protectedExecPaths));
 
         if (es_subscribe(execClient, execEvents, sizeof(execEvents) / sizeof(execEvents[0])) != ES_RETURN_SUCCESS) {
             os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to subscribe to EXEC events");
@@ -273,6 +578,39 @@ int main(int argc, char *argv[])
         [m.privilegesExtension setIsRunning:YES];
     }
     
+#pragma mark - Initialize ES client for process lineage
+    
+    // the lineage is only used to validate processes that want to suspend the
+    // extension. Without it, they are validated by walking the process table
+    mt_process_lineage_t *processLineage = [m.privilegesExtension processLineage];
+    
+    if (processLineage) {
+        
+        es_client_t *lineageClient;
+        es_new_client_result_t result = es_new_client(&lineageClient, ^(es_client_t *client, const es_message_t *message) {
+            record_lineage(processLineage, message);
+        });
+        
+        if (result == ES_NEW_CLIENT_RESULT_SUCCESS) {
+            
+            es_event_type_t lineageEvents[] = {
+                ES_EVENT_TYPE_NOTIFY_FORK,
+                ES_EVENT_TYPE_NOTIFY_EXEC,
+                ES_EVENT_TYPE_NOTIFY_EXIT
+            };
+            
+            if (es_subscribe(lineageClient, lineageEvents, sizeof(lineageEvents) / sizeof(lineageEvents[0])) != ES_RETURN_SUCCESS) {
+                
+                os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to subscribe to process lineage events");
+                es_delete_client(lineageClient);
+            }
+            
+        } else {
+            
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to create endpoint security client (3): %d", result);
+        }
+    }
+    
     [m run];
 
     return 0;
@@ -16,7 +16,7 @@
 */
 
 #import "MTPrivilegesHelper.h"
-#import "MTCodeSigning.h"
+#import "MTConnectionRequirement.h"
 #import "Constants.h"
 #import "MTIdentity.h"
 #import "MTExtensionConnection.h"
@@ -27,6 +27,7 @@
 @property (nonatomic, strong, readwrite) NSMutableSet *activeConnections;
 @property (atomic, strong, readwrite) NSXPCListener *listener;
 @property (nonatomic, strong, readwrite) MTExtensionConnection *extensionConnection;
+@property (nonatomic, strong, readwrite) MTConnectionRequirement *connectionRequirement;
 @property (nonatomic, copy) void (^pendingReply)(BOOL success, NSError *error);
 @property (assign) MTExtensionRequestType currentRequestType;
 @property (assign) BOOL isReplacement;
@@ -36,8 +37,6 @@
 @property audit_token_t auditToken;
 @end
 
-OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement);
-
 @implementation MTPrivilegesHelper
 
 - (instancetype)init
@@ -49,6 +48,22 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
         _activeConnections = [[NSMutableSet alloc] init];
         _extensionConnection = [[MTExtensionConnection alloc] init];
                 
+        // only PrivilegesCLI and the Privileges agent are allowed to connect. They must be signed by the same
+        // signing authority and must have the same version number as this helper
+        NSError *error = nil;
+        _connectionRequirement = [[MTConnectionRequirement alloc] initWithBundleIdentifiers:[NSArray arrayWithObjects:
+                                                                                                  kMTCLIBundleIdentifier,
+                                                                                                  kMTAgentBundleIdentifier,
+                                                                                                  nil
+                                                                                              ]
+                                                                              versionString:[[NSBundle bundleForClass:[self class]] objectForInfoDictionaryKey:@"CFBundleShortVersionString"]
+                                                                                      error:&error
+        ];
+        
+        if (!_connectionRequirement) {
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to get code signature: %{public}@", error);
+        }
+                
         _listener = [[NSXPCListener alloc] initWithMachServiceName:kMTHelperMachServiceName];
         [_listener setDelegate:self];
         [_listener resume];
@@ -69,64 +84,38 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
     
     if (listener == _listener && newConnection != nil) {
         
-        // see how we have been signed and make sure only processes with the same signing authority can connect.
-        // additionally the calling application must have the same version number as this application and must 
-        // use either use the bundle identifier "corp.sap.privileges.cli" or "corp.sap.privileges.agent"
+        // make sure only processes matching our (precompiled) code signing requirement can connect
         NSError *error = nil;
-        NSString *signingAuth = [MTCodeSigning getSigningAuthorityWithError:&error];
-        NSString *requiredVersion = [[NSBundle bundleForClass:[self class]] objectForInfoDictionaryKey:@"CFBundleShortVersionString"];
         
-        if (signingAuth) {
-            
-            NSString *reqString = [MTCodeSigning codeSigningRequirementsWithCommonName:signingAuth
-                                                                     bundleIdentifiers:[NSArray arrayWithObjects:
-                                                                                        kMTCLIBundleIdentifier,
-                                                                                        kMTAgentBundleIdentifier,
-                                                                                        nil]
-                                                                         versionString:requiredVersion
-            ];
-            SecTaskRef taskRef = SecTaskCreateWithAuditToken(NULL, ((ExtendedNSXPCConnection*)newConnection).auditToken);
-                       
-            if (taskRef) {
+        if ([_connectionRequirement validateAuditToken:((ExtendedNSXPCConnection*)newConnection).auditToken error:&error]) {
 
-                OSStatus result = SecTaskValidateForRequirement(taskRef, (__bridge CFStringRef)(reqString));
-                
-                if (result == errSecSuccess) {
-
-                    acceptConnection = YES;
-                       
-                    [newConnection setExportedInterface:[NSXPCInterface interfaceWithProtocol:@protocol(PrivilegesHelperProtocol)]];
-                    [newConnection setExportedObject:self];
-                    
+            acceptConnection = YES;
+               
+            [newConnection setExportedInterface:[NSXPCInterface interfaceWithProtocol:@protocol(PrivilegesHelperProtocol)]];
+            [newConnection setExportedObject:self];
+            
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Warc-retain-cycles"
-                    [newConnection setInvalidationHandler:^{
-                                  
-                        [newConnection setInvalidationHandler:nil];
-                        dispatch_async(dispatch_get_main_queue(), ^{
-                            [self.activeConnections removeObject:newConnection];
-                            os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ invalidated", newConnection);
-                        });
-                    }];
+            [newConnection setInvalidationHandler:^{
+                          
+                [newConnection setInvalidationHandler:nil];
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    [self.activeConnections removeObject:newConnection];
+                    os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ invalidated", newConnection);
+                });
+            }];
 #pragma clang diagnostic pop
-                    
-                    [newConnection resume];
-                    
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        [self.activeConnections addObject:newConnection];
-                        os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ established", newConnection);
-                    });
-        
-                } else {
-                    
-                    os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Code signature verification failed (error %d)", result);
-                }
-                    
-                CFRelease(taskRef);
-            }
-                
+            
+            [newConnection resume];
+            
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [self.activeConnections addObject:newConnection];
+                os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ established", newConnection);
+            });
+
         } else {
-            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to get code signature: %{public}@", error);
+            
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Code signature verification failed (error %ld)", (long)[error code]);
         }
     }
 
@@ -198,8 +187,9 @@ OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement)
             os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to connect to extension: %{public}@", error);
             if (reply) { reply(@""); }
             
-        }] statusWithReply:^(NSString *status) {
+        }] statusWithReply:^(NSString *status, NSDictionary *statistics) {
             
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_INFO, "SAPCorp: System extension statistics: %{public}@", statistics);
             if (reply) { reply(status); }
         }];
     }];
@@ -17,6 +17,7 @@
 
 #import "PrivilegesTile.h"
 #import "MTPrivileges.h"
+#import "MTGroupMembershipCache.h"
 #import "Constants.h"
 #import <AudioToolbox/AudioServices.h>
 #import <os/log.h>
@@ -58,6 +59,7 @@
                                                                    queue:nil
                                                               usingBlock:^(NSNotification *notification) {
                 
+                [[MTGroupMembershipCache sharedCache] invalidate];
                 [self updateDockTileIcon:dockTile];
                 if (![[self->_privilegesApp currentUser] hasAdminPrivileges]) { [self setBadgeOfDockTile:dockTile toMinutesLeft:0]; }
             }];
@@ -115,6 +117,16 @@
             
             // make sure the Dock tile has the correct icon on load
             [self updateDockTileIcon:dockTile];
+            
+            // the agent only posts the time left once a minute, so we get
+            // it from the state the agent published to show it right away
+            mt_state_t state;
+            
+            if ([[_privilegesApp currentUser] getPublishedState:&state] && state.hasAdminPrivileges && state.expirationTime > 0) {
+                
+                NSTimeInterval timeLeft = [[NSDate dateWithTimeIntervalSince1970:state.expirationTime] timeIntervalSinceNow];
+                if (timeLeft > 0) { [self setBadgeOfDockTile:dockTile toMinutesLeft:(NSUInteger)ceil(timeLeft / 60.0)]; }
+            }
         }
         
     } else {
@@ -16,11 +16,18 @@
 */
 
 #import <Foundation/Foundation.h>
+#import "MTLocalGroupRecord.h"
 #import "Constants.h"
 #import <os/log.h>
+#import <membership.h>
+#import <pwd.h>
+
+#define kMTAdminGroupSnapshotUsersKey           @"Users"
+#define kMTAdminGroupSnapshotGroupMembersKey    @"GroupMembers"
+#define kMTAdminGroupSnapshotNestedGroupsKey    @"NestedGroups"
 
 @protocol PrivilegesWatcherDelegate <NSObject>
-- (void)postNotification;
+- (void)adminGroupRecordDidChange;
 @end
 
 void fsevents_callback(ConstFSEventStreamRef streamRef, void *clientCallBackInfo, size_t numEvents, void *eventPaths, const FSEventStreamEventFlags eventFlags[], const FSEventStreamEventId eventIds[])
@@ -32,11 +39,12 @@ void fsevents_callback(ConstFSEventStreamRef streamRef, void *clientCallBackInfo
         
         for (int i = 0; i < numEvents; i++) {
             
-            NSString *eventPath = [NSString stringWithUTF8String:paths[i]];
+            // compare the file name without creating a string object for every path
+            const char *fileName = strrchr(paths[i], '/');
             
-            if ([[eventPath lastPathComponent] isEqualToString:@"admin.plist"]) {
+            if (fileName && strcmp(fileName + 1, "admin.plist") == 0) {
                     
-                dispatch_async(dispatch_get_main_queue(), ^{ [myDelegate postNotification]; });
+                dispatch_async(dispatch_get_main_queue(), ^{ [myDelegate adminGroupRecordDidChange]; });
                 break;
             }
         }
@@ -44,24 +52,37 @@ void fsevents_callback(ConstFSEventStreamRef streamRef, void *clientCallBackInfo
 }
 
 @interface Main : NSObject <PrivilegesWatcherDelegate>
-@property (nonatomic, strong, readwrite) NSTimer *delayTimer;
+@property (nonatomic, strong, readwrite) NSUserDefaults *userDefaults;
+@property (nonatomic, strong, readwrite) NSTimer *debounceTimer;
 @property (nonatomic, strong, readwrite) NSTimer *terminationTimer;
 @property (assign) BOOL shouldTerminate;
 @end
 
 @implementation Main
 
+- (instancetype)init
+{
+    self = [super init];
+    
+    if (self) {
+        _userDefaults = [NSUserDefaults standardUserDefaults];
+    }
+    
+    return self;
+}
+
 - (void)run
 {
     os_log(OS_LOG_DEFAULT, "SAPCorp: Starting");
     
     [self scheduleTerminationTimer];
     
-    // post a notification so the PrivilegesAgent knows about the change
-    [self postNotification];
+    // we have been started because the admin group record changed,
+    // so compare it with the last snapshot right away
+    [self checkAdminGroupRecord];
     
     // monitor the admin group for further changes
-    NSString *basePath = @"/var/db/dslocal/nodes/Default/groups";
+    NSString *basePath = [kMTAdminGroupRecordPath stringByDeletingLastPathComponent];
     NSArray *pathsToWatch = [NSArray arrayWithObject:basePath];
     FSEventStreamContext cntxt = {0, (__bridge void *)(self), NULL, NULL, NULL};
     dispatch_queue_t queue = dispatch_queue_create("corp.sap.privileges.watcher.queue", DISPATCH_QUEUE_SERIAL);
@@ -103,22 +124,147 @@ void fsevents_callback(ConstFSEventStreamRef streamRef, void *clientCallBackInfo
         _terminationTimer = nil;
     };
     
-    _terminationTimer = [NSTimer scheduledTimerWithTimeInterval:30
+    // we stay around for a while after the last change, so launchd
+    // does not have to start us again for every change of a burst
+    _terminationTimer = [NSTimer scheduledTimerWithTimeInterval:kMTWatcherIdleTimeout
                                                         repeats:YES
                                                           block:^(NSTimer *timer) {
         self->_shouldTerminate = YES;
     }];
 }
 
-- (void)postNotification
+- (void)adminGroupRecordDidChange
+{
+    // the record is usually written multiple times in a row,
+    // so we wait until it did not change for a moment
+    if (_debounceTimer) {
+        [_debounceTimer invalidate];
+        _debounceTimer = nil;
+    };
+    
+    _debounceTimer = [NSTimer scheduledTimerWithTimeInterval:kMTAdminGroupChangeDebounceInterval
+                                                     repeats:NO
+                                                       block:^(NSTimer *timer) {
+        self->_debounceTimer = nil;
+        [self checkAdminGroupRecord];
+    }];
+    
+    [self scheduleTerminationTimer];
+}
+
+- (void)checkAdminGroupRecord
+{
+    MTLocalGroupRecord *adminGroupRecord = [[MTLocalGroupRecord alloc] initWithContentsOfFile:kMTAdminGroupRecordPath];
+    NSArray *users = [adminGroupRecord users];
+    NSArray *groupMembers = [adminGroupRecord groupMembers];
+    NSArray *nestedGroups = [adminGroupRecord nestedGroups];
+    
+    if (users && groupMembers && nestedGroups) {
+        
+        BOOL hasChanged = YES;
+        NSDictionary *snapshot = [_userDefaults dictionaryForKey:kMTDefaultsAdminGroupSnapshotKey];
+        NSArray *previousUsers = [snapshot objectForKey:kMTAdminGroupSnapshotUsersKey];
+        NSArray *previousGroupMembers = [snapshot objectForKey:kMTAdminGroupSnapshotGroupMembersKey];
+        NSArray *previousNestedGroups = [snapshot objectForKey:kMTAdminGroupSnapshotNestedGroupsKey];
+        
+        if ([previousUsers isKindOfClass:[NSArray class]] && [previousGroupMembers isKindOfClass:[NSArray class]] &&
+            [previousNestedGroups isKindOfClass:[NSArray class]]) {
+            
+            NSMutableSet *addedUsers = [NSMutableSet setWithArray:users];
+            [addedUsers minusSet:[NSSet setWithArray:previousUsers]];
+            NSMutableSet *removedUsers = [NSMutableSet setWithArray:previousUsers];
+            [removedUsers minusSet:[NSSet setWithArray:users]];
+            
+            NSMutableSet *addedMembers = [NSMutableSet setWithArray:groupMembers];
+            [addedMembers minusSet:[NSSet setWithArray:previousGroupMembers]];
+            NSMutableSet *removedMembers = [NSMutableSet setWithArray:previousGroupMembers];
+            [removedMembers minusSet:[NSSet setWithArray:groupMembers]];
+            
+            BOOL nestedGroupsChanged = ![[NSSet setWithArray:nestedGroups] isEqualToSet:[NSSet setWithArray:previousNestedGroups]];
+            
+            if ([addedUsers count] + [removedUsers count] + [addedMembers count] + [removedMembers count] > 0 || nestedGroupsChanged) {
+                
+                // we only tell the agent whose membership changed, if every changed member
+                // belongs to one of the changed users. Otherwise (e.g. if nested groups changed
+                // or a member cannot be resolved) we post the notification without the changed
+                // users, so the agent checks the membership of its user again
+                NSDictionary *userInfo = nil;
+                
+                if (!nestedGroupsChanged &&
+                    [self members:addedMembers belongToUsers:addedUsers] &&
+                    [self members:removedMembers belongToUsers:removedUsers]) {
+                    
+                    userInfo = [NSDictionary dictionaryWithObjectsAndKeys:
+                                [addedUsers allObjects], kMTNotificationKeyAddedUsers,
+                                [removedUsers allObjects], kMTNotificationKeyRemovedUsers,
+                                nil
+                    ];
+                }
+                
+                [self postNotificationWithUserInfo:userInfo];
+                
+            } else {
+                
+                hasChanged = NO;
+            }
+            
+        } else {
+            
+            // without a snapshot we cannot tell what changed
+            [self postNotificationWithUserInfo:nil];
+        }
+        
+        if (hasChanged) {
+            
+            snapshot = [NSDictionary dictionaryWithObjectsAndKeys:
+                        users, kMTAdminGroupSnapshotUsersKey,
+                        groupMembers, kMTAdminGroupSnapshotGroupMembersKey,
+                        nestedGroups, kMTAdminGroupSnapshotNestedGroupsKey,
+                        nil
+            ];
+            
+            [_userDefaults setObject:snapshot forKey:kMTDefaultsAdminGroupSnapshotKey];
+        }
+        
+    } else {
+        
+        os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to read admin group record");
+        [self postNotificationWithUserInfo:nil];
+    }
+}
+
+- (BOOL)members:(NSSet<NSString*>*)members belongToUsers:(NSSet<NSString*>*)userNames
+{
+    BOOL belongToUsers = YES;
+    
+    for (NSString *member in members) {
+        
+        uuid_t uuid;
+        id_t uid = 0;
+        int idType = 0;
+        struct passwd *pwd = NULL;
+        
+        if (uuid_parse([member UTF8String], uuid) == 0 && mbr_uuid_to_id(uuid, &uid, &idType) == 0 && idType == ID_TYPE_UID) {
+            pwd = getpwuid(uid);
+        }
+        
+        if (!pwd || ![userNames containsObject:[NSString stringWithUTF8String:pwd->pw_name]]) {
+            
+            belongToUsers = NO;
+            break;
+        }
+    }
+    
+    return belongToUsers;
+}
+
+- (void)postNotificationWithUserInfo:(NSDictionary*)userInfo
 {
     [[NSDistributedNotificationCenter defaultCenter] postNotificationName:kMTNotificationNameAdminGroupDidChange
                                                                    object:nil
-                                                                 userInfo:nil
+                                                                 userInfo:userInfo
                                                                   options:NSNotificationDeliverImmediately | NSNotificationPostToAllSessions
     ];
-    
-    [self scheduleTerminationTimer];
 }
 
 @end
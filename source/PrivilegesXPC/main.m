@@ -17,80 +17,78 @@
 
 #import <Foundation/Foundation.h>
 #import "PrivilegesXPC.h"
-#import "MTCodeSigning.h"
+#import "MTConnectionRequirement.h"
 #import <os/log.h>
 
 @interface ServiceDelegate : NSObject <NSXPCListenerDelegate>
+@property (nonatomic, strong, readwrite) MTConnectionRequirement *connectionRequirement;
 @end
 
 @interface ExtendedNSXPCConnection : NSXPCConnection
 @property audit_token_t auditToken;
 @end
 
-OSStatus SecTaskValidateForRequirement(SecTaskRef task, CFStringRef requirement);
-
 @implementation ServiceDelegate
 
+- (instancetype)init
+{
+    self = [super init];
+    
+    if (self) {
+        
+        // only Privileges components are allowed to connect. They must be signed by the same
+        // signing authority and must have the same version number as this xpc service
+        NSError *error = nil;
+        _connectionRequirement = [[MTConnectionRequirement alloc] initWithBundleIdentifiers:[NSArray arrayWithObject:@"corp.sap.privileges*"]
+                                                                              versionString:[[NSBundle bundleForClass:[self class]] objectForInfoDictionaryKey:@"CFBundleShortVersionString"]
+                                                                                      error:&error
+        ];
+        
+        if (!_connectionRequirement) {
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to get code signature: %{public}@", error);
+        }
+    }
+    
+    return self;
+}
+
 - (BOOL)listener:(NSXPCListener *)listener shouldAcceptNewConnection:(NSXPCConnection *)newConnection 
 {
     BOOL acceptConnection = NO;
     
-    // see how we have been signed and make sure only processes with the same signing authority can connect.
-    // additionally the calling application must have the same version number as this xpc service and must be
-    // one of the components using a bundle identifier starting with "corp.sap.privileges"
+    // make sure only processes matching our (precompiled) code signing requirement can connect
     NSError *error = nil;
-    NSString *signingAuth = [MTCodeSigning getSigningAuthorityWithError:&error];
-    NSString *requiredVersion = [[NSBundle bundleForClass:[self class]] objectForInfoDictionaryKey:@"CFBundleShortVersionString"];
     
-    if (signingAuth) {
-        
-        NSString *reqString = [MTCodeSigning codeSigningRequirementsWithCommonName:signingAuth
-                                                                  bundleIdentifier:@"corp.sap.privileges*" 
-                                                                     versionString:requiredVersion
-        ];
-        SecTaskRef taskRef = SecTaskCreateWithAuditToken(NULL, ((ExtendedNSXPCConnection*)newConnection).auditToken);
-       
-        if (taskRef) {            
-            
-            OSStatus result = SecTaskValidateForRequirement(taskRef, (__bridge CFStringRef)(reqString));
-            
-            if (result == errSecSuccess) {
+    if ([_connectionRequirement validateAuditToken:((ExtendedNSXPCConnection*)newConnection).auditToken error:&error]) {
 
-                acceptConnection = YES;
-                   
-                [newConnection setExportedInterface:[NSXPCInterface interfaceWithProtocol:@protocol(PrivilegesXPCProtocol)]];
-                PrivilegesXPC *exportedObject = [PrivilegesXPC new];
-                [newConnection setExportedObject:exportedObject];
-                
+        acceptConnection = YES;
+           
+        [newConnection setExportedInterface:[NSXPCInterface interfaceWithProtocol:@protocol(PrivilegesXPCProtocol)]];
+        PrivilegesXPC *exportedObject = [PrivilegesXPC new];
+        [newConnection setExportedObject:exportedObject];
+        
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Warc-retain-cycles"
-                [newConnection setInvalidationHandler:^{
-                              
-                    [newConnection setInvalidationHandler:nil];
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ invalidated", newConnection);
-                    });
-                }];
+        [newConnection setInvalidationHandler:^{
+                      
+            [newConnection setInvalidationHandler:nil];
+            dispatch_async(dispatch_get_main_queue(), ^{
+                os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ invalidated", newConnection);
+            });
+        }];
 #pragma clang diagnostic pop
 
-                [newConnection resume];
-                
-                dispatch_async(dispatch_get_main_queue(), ^{
-                    os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ established", newConnection);
-                });
-    
-            } else {
-                
-                os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Code signature verification failed (error %d)", result);
-            }
-                
-            CFRelease(taskRef);
-        }
-            
+        [newConnection resume];
+        
+        dispatch_async(dispatch_get_main_queue(), ^{
+            os_log(OS_LOG_DEFAULT, "SAPCorp: %{public}@ established", newConnection);
+        });
+
     } else {
-        os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to get code signature: %{public}@", error);
-    }
         
+        os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Code signature verification failed (error %ld)", (long)[error code]);
+    }
+
     return acceptConnection;
 }
 
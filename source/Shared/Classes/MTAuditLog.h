@@ -0,0 +1,102 @@
+/*
+    MTAuditLog.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @enum          MTAuditLogAction
+ @abstract      Specifies the type of a privilege change.
+ @constant      MTAuditLogActionGrant Administrator privileges have been granted.
+ @constant      MTAuditLogActionRevoke Administrator privileges have been revoked.
+*/
+typedef enum {
+    MTAuditLogActionGrant  = 1,
+    MTAuditLogActionRevoke = 2
+} MTAuditLogAction;
+
+// event keys
+#define kMTAuditLogKeyDate                  @"date"
+#define kMTAuditLogKeyUser                  @"user"
+#define kMTAuditLogKeyAction                @"action"
+#define kMTAuditLogKeyDuration              @"duration"
+#define kMTAuditLogKeyReason                @"reason"
+#define kMTAuditLogKeyComponent             @"component"
+
+/*!
+ @class         MTAuditLog
+ @abstract      A class that provides access to the local audit log of privilege changes.
+ @discussion    The audit log is stored in an indexed, append-only format, so the history of a single
+                user or the events since a given date can be queried without reading the whole log.
+                Writing to the default audit log requires root privileges.
+*/
+
+@interface MTAuditLog : NSObject
+
+/*!
+ @method        init
+ @discussion    The init method is not available. Please use initWithPath: instead.
+ */
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        initWithPath:
+ @abstract      Initialize a MTAuditLog object with the given base path.
+ @param         path The base path of the audit log files.
+ @discussion    Returns an initialized MTAuditLog object.
+*/
+- (instancetype)initWithPath:(NSString*)path NS_DESIGNATED_INITIALIZER;
+
+/*!
+ @method        defaultPath
+ @abstract      Returns the base path of the system's audit log.
+*/
++ (NSString*)defaultPath;
+
+/*!
+ @method        appendEventForUser:action:reason:component:error:
+ @abstract      Appends a privilege change to the audit log.
+ @param         userName The short name of the user whose privileges changed.
+ @param         action The privilege change.
+ @param         reason The reason for the change. May be nil.
+ @param         component The name of the component that requested the change. May be nil.
+ @param         error A reference to a NSError object that contains a detailed error message if an error occurred. May be nil.
+ @discussion    For revocations, the duration of the user's administrator privileges is calculated from the
+                user's previous event. Returns YES if the event has been written successfully, otherwise returns NO.
+*/
+- (BOOL)appendEventForUser:(NSString*)userName
+                    action:(MTAuditLogAction)action
+                    reason:(NSString*)reason
+                 component:(NSString*)component
+                     error:(NSError**)error;
+
+/*!
+ @method        enumerateEventsForUser:since:usingBlock:error:
+ @abstract      Enumerates the events of the audit log in chronological order.
+ @param         userName The short name of the user whose events should be returned or nil to return the events of all users.
+ @param         date The date of the oldest event to return or nil to return all events.
+ @param         block The block that is called for every event. The event dictionary contains the keys defined above.
+                Set stop to YES to stop the enumeration.
+ @param         error A reference to a NSError object that contains a detailed error message if an error occurred. May be nil.
+ @discussion    Returns YES if the audit log has been read successfully, otherwise returns NO. An audit log that
+                does not exist is treated like an empty audit log.
+*/
+- (BOOL)enumerateEventsForUser:(NSString*)userName
+                         since:(NSDate*)date
+                    usingBlock:(void (^)(NSDictionary *event, BOOL *stop))block
+                         error:(NSError**)error;
+
+@end
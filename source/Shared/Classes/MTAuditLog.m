@@ -0,0 +1,196 @@
+/*
+    MTAuditLog.m
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTAuditLog.h"
+#import "MTAuditStore.h"
+#import "Constants.h"
+
+typedef struct {
+    __unsafe_unretained void (^block)(NSDictionary *event, BOOL *stop);
+} MTAuditLogQueryContext;
+
+static int MTAuditLogQueryCallback(const mt_audit_record_t *record, void *context)
+{
+    MTAuditLogQueryContext *queryContext = (MTAuditLogQueryContext*)context;
+    BOOL stop = NO;
+    
+    @autoreleasepool {
+        
+        NSMutableDictionary *event = [[NSMutableDictionary alloc] init];
+        [event setObject:[NSDate dateWithTimeIntervalSince1970:record->timestamp] forKey:kMTAuditLogKeyDate];
+        [event setObject:[NSNumber numberWithUnsignedChar:record->action] forKey:kMTAuditLogKeyAction];
+        [event setObject:[NSNumber numberWithUnsignedInt:record->duration] forKey:kMTAuditLogKeyDuration];
+        
+        NSString *userName = [[NSString alloc] initWithBytes:record->user length:record->userLength encoding:NSUTF8StringEncoding];
+        if (userName) { [event setObject:userName forKey:kMTAuditLogKeyUser]; }
+        
+        if (record->reasonLength > 0) {
+            
+            NSString *reason = [[NSString alloc] initWithBytes:record->reason length:record->reasonLength encoding:NSUTF8StringEncoding];
+            if (reason) { [event setObject:reason forKey:kMTAuditLogKeyReason]; }
+        }
+        
+        if (record->componentLength > 0) {
+            
+            NSString *component = [[NSString alloc] initWithBytes:record->component length:record->componentLength encoding:NSUTF8StringEncoding];
+            if (component) { [event setObject:component forKey:kMTAuditLogKeyComponent]; }
+        }
+        
+        queryContext->block(event, &stop);
+    }
+    
+    return (stop) ? 1 : 0;
+}
+
+@interface MTAuditLog ()
+@property (nonatomic, strong, readwrite) NSString *path;
+@end
+
+@implementation MTAuditLog
+
+- (instancetype)initWithPath:(NSString*)path
+{
+    self = [super init];
+    
+    if (self) {
+        _path = path;
+    }
+    
+    return self;
+}
+
++ (NSString*)defaultPath
+{
+    NSString *path = nil;
+    
+    NSURL *appSupportDir = [[NSFileManager defaultManager] URLForDirectory:NSApplicationSupportDirectory
+                                                                  inDomain:NSLocalDomainMask
+                                                         appropriateForURL:nil
+                                                                    create:NO
+                                                                     error:nil
+    ];
+    
+    if (appSupportDir) {
+        
+        path = [[appSupportDir URLByAppendingPathComponent:[NSString stringWithFormat:@"%@/%@", kMTAppName, kMTAuditLogName]] path];
+    }
+    
+    return path;
+}
+
+- (BOOL)appendEventForUser:(NSString*)userName
+                    action:(MTAuditLogAction)action
+                    reason:(NSString*)reason
+                 component:(NSString*)component
+                     error:(NSError**)error
+{
+    BOOL success = NO;
+    NSError *appendError = nil;
+    
+    if ([_path length] > 0 && [userName length] > 0) {
+        
+        NSDictionary *attributesDict = [NSDictionary dictionaryWithObjectsAndKeys:
+                                        [NSNumber numberWithShort:0755], NSFilePosixPermissions,
+                                        @"root", NSFileOwnerAccountName,
+                                        @"wheel", NSFileGroupOwnerAccountName,
+                                        nil
+        ];
+        
+        if ([[NSFileManager defaultManager] createDirectoryAtPath:[_path stringByDeletingLastPathComponent]
+                                      withIntermediateDirectories:YES
+                                                       attributes:(geteuid() == 0) ? attributesDict : nil
+                                                            error:&appendError
+            ]) {
+            
+            const char *userString = [userName UTF8String];
+            const char *reasonString = [reason UTF8String];
+            const char *componentString = [component UTF8String];
+            
+            mt_audit_record_t record = {
+                .timestamp = (int64_t)[[NSDate date] timeIntervalSince1970],
+                .duration = 0,
+                .action = (uint8_t)action,
+                .user = userString,
+                .userLength = strlen(userString),
+                .reason = reasonString,
+                .reasonLength = (reasonString) ? strlen(reasonString) : 0,
+                .component = componentString,
+                .componentLength = (componentString) ? strlen(componentString) : 0
+            };
+            
+            if (mt_audit_store_append([_path fileSystemRepresentation], &record) == 0) {
+                
+                success = YES;
+                
+            } else {
+                
+                appendError = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+            }
+        }
+        
+    } else {
+        
+        NSDictionary *errorDetail = [NSDictionary dictionaryWithObjectsAndKeys:@"Invalid audit log path or user name", NSLocalizedDescriptionKey, nil];
+        appendError = [NSError errorWithDomain:kMTErrorDomain code:100 userInfo:errorDetail];
+    }
+    
+    if (error) { *error = appendError; }
+    
+    return success;
+}
+
+- (BOOL)enumerateEventsForUser:(NSString*)userName
+                         since:(NSDate*)date
+                    usingBlock:(void (^)(NSDictionary *event, BOOL *stop))block
+                         error:(NSError**)error
+{
+    BOOL success = NO;
+    NSError *queryError = nil;
+    
+    if ([_path length] > 0 && block) {
+        
+        MTAuditLogQueryContext context = { .block = block };
+        
+        long count = mt_audit_store_query(
+                                          [_path fileSystemRepresentation],
+                                          ([userName length] > 0) ? [userName UTF8String] : NULL,
+                                          (date) ? (int64_t)[date timeIntervalSince1970] : INT64_MIN,
+                                          MTAuditLogQueryCallback,
+                                          &context
+                                          );
+        
+        if (count >= 0) {
+            
+            success = YES;
+            
+        } else {
+            
+            queryError = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+        }
+        
+    } else {
+        
+        NSDictionary *errorDetail = [NSDictionary dictionaryWithObjectsAndKeys:@"Invalid audit log path", NSLocalizedDescriptionKey, nil];
+        queryError = [NSError errorWithDomain:kMTErrorDomain code:100 userInfo:errorDetail];
+    }
+    
+    if (error) { *error = queryError; }
+    
+    return success;
+}
+
+@end
@@ -0,0 +1,453 @@
+/*
+    MTAuditStore.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTAuditStore.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MT_AUDIT_HEADER_LENGTH          8
+#define MT_AUDIT_RECORD_LENGTH          24
+#define MT_AUDIT_INDEX_ENTRY_LENGTH     32
+#define MT_AUDIT_USER_ENTRY_LENGTH      16
+#define MT_AUDIT_STRING_MAX             0xFFFF
+
+#define MT_AUDIT_MAGIC_DATA             "PRVAUD01"
+#define MT_AUDIT_MAGIC_INDEX            "PRVIDX01"
+#define MT_AUDIT_MAGIC_USERS            "PRVUSR01"
+
+typedef struct {
+    int fd;
+    const uint8_t *map;
+    size_t length;
+} mt_audit_mapping_t;
+
+typedef struct {
+    int64_t searchTimestamp;
+    uint64_t recordOffset;
+    uint32_t userHash;
+    uint64_t previousEntry;
+} mt_audit_index_entry_t;
+
+#pragma mark - Encoding
+
+static void mt_audit_put_uint(uint8_t *bytes, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; i++) { bytes[i] = (uint8_t)(value >> (8 * i)); }
+}
+
+static uint64_t mt_audit_get_uint(const uint8_t *bytes, size_t size)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) { value |= (uint64_t)bytes[i] << (8 * i); }
+    
+    return value;
+}
+
+static uint32_t mt_audit_user_hash(const char *user, size_t length)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)user[i];
+        hash *= 16777619u;
+    }
+    
+    return hash;
+}
+
+static void mt_audit_decode_index_entry(const uint8_t *bytes, mt_audit_index_entry_t *entry)
+{
+    entry->searchTimestamp = (int64_t)mt_audit_get_uint(bytes, 8);
+    entry->recordOffset = mt_audit_get_uint(bytes + 8, 8);
+    entry->userHash = (uint32_t)mt_audit_get_uint(bytes + 16, 4);
+    entry->previousEntry = mt_audit_get_uint(bytes + 24, 8);
+}
+
+// decodes the record at the given offset and makes sure it is
+// completely contained in the given buffer
+static int mt_audit_decode_record(const uint8_t *data, size_t length, uint64_t offset, mt_audit_record_t *record)
+{
+    if (offset < MT_AUDIT_HEADER_LENGTH || offset > length || length - offset < MT_AUDIT_RECORD_LENGTH) { return -1; }
+    
+    const uint8_t *bytes = data + offset;
+    uint64_t recordLength = mt_audit_get_uint(bytes, 4);
+    size_t userLength = (size_t)mt_audit_get_uint(bytes + 18, 2);
+    size_t reasonLength = (size_t)mt_audit_get_uint(bytes + 20, 2);
+    size_t componentLength = (size_t)mt_audit_get_uint(bytes + 22, 2);
+    
+    if (recordLength != MT_AUDIT_RECORD_LENGTH + userLength + reasonLength + componentLength) { return -1; }
+    if (recordLength > length - offset) { return -1; }
+    
+    record->timestamp = (int64_t)mt_audit_get_uint(bytes + 4, 8);
+    record->duration = (uint32_t)mt_audit_get_uint(bytes + 12, 4);
+    record->action = bytes[16];
+    record->user = (const char*)bytes + MT_AUDIT_RECORD_LENGTH;
+    record->userLength = userLength;
+    record->reason = record->user + userLength;
+    record->reasonLength = reasonLength;
+    record->component = record->reason + reasonLength;
+    record->componentLength = componentLength;
+    
+    return 0;
+}
+
+#pragma mark - Files
+
+static void mt_audit_path(char *path, const char *basePath, const char *extension)
+{
+    snprintf(path, PATH_MAX, "%s.%s", basePath, extension);
+}
+
+// opens (and creates, if necessary) one of the store's files for writing
+// and makes sure the file has the expected header
+static int mt_audit_open_writable(const char *basePath, const char *extension, const char *magic, int *fd, uint64_t *size)
+{
+    char path[PATH_MAX];
+    struct stat fileInfo;
+    uint8_t header[MT_AUDIT_HEADER_LENGTH];
+    
+    mt_audit_path(path, basePath, extension);
+    
+    *fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (*fd < 0 || fstat(*fd, &fileInfo) != 0) { return -1; }
+    
+    if (fileInfo.st_size == 0) {
+        
+        if (pwrite(*fd, magic, MT_AUDIT_HEADER_LENGTH, 0) != MT_AUDIT_HEADER_LENGTH) { return -1; }
+        *size = MT_AUDIT_HEADER_LENGTH;
+        
+    } else {
+        
+        if (pread(*fd, header, MT_AUDIT_HEADER_LENGTH, 0) != MT_AUDIT_HEADER_LENGTH || memcmp(header, magic, MT_AUDIT_HEADER_LENGTH) != 0) {
+            
+            errno = EINVAL;
+            return -1;
+        }
+        
+        *size = (uint64_t)fileInfo.st_size;
+    }
+    
+    return 0;
+}
+
+// maps one of the store's files read-only. A file that does not exist
+// results in an empty mapping
+static int mt_audit_map(const char *basePath, const char *extension, const char *magic, mt_audit_mapping_t *mapping)
+{
+    char path[PATH_MAX];
+    struct stat fileInfo;
+    
+    mapping->fd = -1;
+    mapping->map = NULL;
+    mapping->length = 0;
+    
+    mt_audit_path(path, basePath, extension);
+    
+    mapping->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (mapping->fd < 0) { return (errno == ENOENT) ? 0 : -1; }
+    if (fstat(mapping->fd, &fileInfo) != 0) { return -1; }
+    if (fileInfo.st_size <= MT_AUDIT_HEADER_LENGTH) { return 0; }
+    
+    void *map = mmap(NULL, (size_t)fileInfo.st_size, PROT_READ, MAP_SHARED, mapping->fd, 0);
+    if (map == MAP_FAILED) { return -1; }
+    
+    mapping->map = map;
+    mapping->length = (size_t)fileInfo.st_size;
+    
+    if (memcmp(mapping->map, magic, MT_AUDIT_HEADER_LENGTH) != 0) {
+        
+        errno = EINVAL;
+        return -1;
+    }
+    
+    return 0;
+}
+
+static void mt_audit_unmap(mt_audit_mapping_t *mapping)
+{
+    if (mapping->map) { munmap((void*)mapping->map, mapping->length); }
+    if (mapping->fd >= 0) { close(mapping->fd); }
+    
+    mapping->fd = -1;
+    mapping->map = NULL;
+    mapping->length = 0;
+}
+
+// returns the most recent index entry (1-based) of the user with the
+// given hash or 0 if the user does not exist
+static uint64_t mt_audit_last_user_entry(const uint8_t *users, size_t length, uint32_t userHash, uint64_t *entryOffset)
+{
+    for (size_t offset = MT_AUDIT_HEADER_LENGTH; offset + MT_AUDIT_USER_ENTRY_LENGTH <= length; offset += MT_AUDIT_USER_ENTRY_LENGTH) {
+        
+        if ((uint32_t)mt_audit_get_uint(users + offset, 4) == userHash) {
+            
+            if (entryOffset) { *entryOffset = offset; }
+            return mt_audit_get_uint(users + offset + 8, 8);
+        }
+    }
+    
+    return 0;
+}
+
+#pragma mark - Public functions
+
+int mt_audit_store_append(const char *basePath, mt_audit_record_t *record)
+{
+    int result = -1;
+    int dataFd = -1, indexFd = -1, usersFd = -1;
+    uint64_t dataSize = 0, indexSize = 0, usersSize = 0;
+    uint8_t *users = NULL;
+    uint8_t *recordBytes = NULL;
+    
+    if (!basePath || !record || !record->user || record->userLength == 0) {
+        
+        errno = EINVAL;
+        return -1;
+    }
+    
+    // the data file's lock serializes all writers
+    if (mt_audit_open_writable(basePath, "dat", MT_AUDIT_MAGIC_DATA, &dataFd, &dataSize) == 0 &&
+        flock(dataFd, LOCK_EX) == 0 &&
+        mt_audit_open_writable(basePath, "idx", MT_AUDIT_MAGIC_INDEX, &indexFd, &indexSize) == 0 &&
+        mt_audit_open_writable(basePath, "usr", MT_AUDIT_MAGIC_USERS, &usersFd, &usersSize) == 0) {
+        
+        size_t userLength = (record->userLength > MT_AUDIT_STRING_MAX) ? MT_AUDIT_STRING_MAX : record->userLength;
+        size_t reasonLength = (!record->reason) ? 0 : (record->reasonLength > MT_AUDIT_STRING_MAX) ? MT_AUDIT_STRING_MAX : record->reasonLength;
+        size_t componentLength = (!record->component) ? 0 : (record->componentLength > MT_AUDIT_STRING_MAX) ? MT_AUDIT_STRING_MAX : record->componentLength;
+        uint32_t userHash = mt_audit_user_hash(record->user, userLength);
+        
+        // ignore incomplete index entries (e.g. after a crash)
+        uint64_t entryCount = (indexSize - MT_AUDIT_HEADER_LENGTH) / MT_AUDIT_INDEX_ENTRY_LENGTH;
+        int64_t searchTimestamp = record->timestamp;
+        uint8_t entryBytes[MT_AUDIT_INDEX_ENTRY_LENGTH];
+        mt_audit_index_entry_t entry;
+        
+        if (entryCount > 0) {
+            
+            if (pread(indexFd, entryBytes, MT_AUDIT_INDEX_ENTRY_LENGTH, MT_AUDIT_HEADER_LENGTH + (entryCount - 1) * MT_AUDIT_INDEX_ENTRY_LENGTH) != MT_AUDIT_INDEX_ENTRY_LENGTH) { goto done; }
+            
+            mt_audit_decode_index_entry(entryBytes, &entry);
+            if (entry.searchTimestamp > searchTimestamp) { searchTimestamp = entry.searchTimestamp; }
+        }
+        
+        // get the user's most recent entry
+        users = malloc(usersSize);
+        if (!users || pread(usersFd, users, usersSize, 0) != (ssize_t)usersSize) { goto done; }
+        
+        uint64_t userEntryOffset = 0;
+        uint64_t previousEntry = mt_audit_last_user_entry(users, usersSize, userHash, &userEntryOffset);
+        if (previousEntry > entryCount) { previousEntry = 0; }
+        
+        // if privileges are revoked, calculate how long the user had
+        // administrator privileges (if the previous record is a grant)
+        if (record->action == MT_AUDIT_ACTION_REVOKE && record->duration == 0) {
+            
+            uint64_t currentEntry = previousEntry;
+            
+            while (currentEntry > 0) {
+                
+                uint8_t headerBytes[MT_AUDIT_RECORD_LENGTH + MT_AUDIT_STRING_MAX];
+                
+                if (pread(indexFd, entryBytes, MT_AUDIT_INDEX_ENTRY_LENGTH, MT_AUDIT_HEADER_LENGTH + (currentEntry - 1) * MT_AUDIT_INDEX_ENTRY_LENGTH) != MT_AUDIT_INDEX_ENTRY_LENGTH) { break; }
+                mt_audit_decode_index_entry(entryBytes, &entry);
+                
+                // only the record header and the user name are needed here
+                if (pread(dataFd, headerBytes, MT_AUDIT_RECORD_LENGTH + userLength, (off_t)entry.recordOffset) != (ssize_t)(MT_AUDIT_RECORD_LENGTH + userLength)) { break; }
+                
+                if (mt_audit_get_uint(headerBytes + 18, 2) == userLength && memcmp(headerBytes + MT_AUDIT_RECORD_LENGTH, record->user, userLength) == 0) {
+                    
+                    int64_t grantTimestamp = (int64_t)mt_audit_get_uint(headerBytes + 4, 8);
+                    
+                    if (headerBytes[16] == MT_AUDIT_ACTION_GRANT && record->timestamp > grantTimestamp) {
+                        
+                        int64_t duration = record->timestamp - grantTimestamp;
+                        record->duration = (duration > UINT32_MAX) ? UINT32_MAX : (uint32_t)duration;
+                    }
+                    
+                    break;
+                }
+                
+                // the entries of a user are linked from newer to older entries
+                if (entry.previousEntry >= currentEntry) { break; }
+                currentEntry = entry.previousEntry;
+            }
+        }
+        
+        // write the record
+        size_t recordLength = MT_AUDIT_RECORD_LENGTH + userLength + reasonLength + componentLength;
+        recordBytes = malloc(recordLength);
+        if (!recordBytes) { goto done; }
+        
+        mt_audit_put_uint(recordBytes, recordLength, 4);
+        mt_audit_put_uint(recordBytes + 4, (uint64_t)record->timestamp, 8);
+        mt_audit_put_uint(recordBytes + 12, record->duration, 4);
+        recordBytes[16] = record->action;
+        recordBytes[17] = 0;
+        mt_audit_put_uint(recordBytes + 18, userLength, 2);
+        mt_audit_put_uint(recordBytes + 20, reasonLength, 2);
+        mt_audit_put_uint(recordBytes + 22, componentLength, 2);
+        memcpy(recordBytes + MT_AUDIT_RECORD_LENGTH, record->user, userLength);
+        if (reasonLength > 0) { memcpy(recordBytes + MT_AUDIT_RECORD_LENGTH + userLength, record->reason, reasonLength); }
+        if (componentLength > 0) { memcpy(recordBytes + MT_AUDIT_RECORD_LENGTH + userLength + reasonLength, record->component, componentLength); }
+        
+        if (pwrite(dataFd, recordBytes, recordLength, (off_t)dataSize) != (ssize_t)recordLength || fsync(dataFd) != 0) { goto done; }
+        
+        // write the index entry
+        mt_audit_put_uint(entryBytes, (uint64_t)searchTimestamp, 8);
+        mt_audit_put_uint(entryBytes + 8, dataSize, 8);
+        mt_audit_put_uint(entryBytes + 16, userHash, 4);
+        mt_audit_put_uint(entryBytes + 20, 0, 4);
+        mt_audit_put_uint(entryBytes + 24, previousEntry, 8);
+        
+        off_t entryOffset = (off_t)(MT_AUDIT_HEADER_LENGTH + entryCount * MT_AUDIT_INDEX_ENTRY_LENGTH);
+        if (pwrite(indexFd, entryBytes, MT_AUDIT_INDEX_ENTRY_LENGTH, entryOffset) != MT_AUDIT_INDEX_ENTRY_LENGTH) { goto done; }
+        if (ftruncate(indexFd, entryOffset + MT_AUDIT_INDEX_ENTRY_LENGTH) != 0 || fsync(indexFd) != 0) { goto done; }
+        
+        // update the user index
+        uint8_t userBytes[MT_AUDIT_USER_ENTRY_LENGTH];
+        mt_audit_put_uint(userBytes, userHash, 4);
+        mt_audit_put_uint(userBytes + 4, 0, 4);
+        mt_audit_put_uint(userBytes + 8, entryCount + 1, 8);
+        
+        if (userEntryOffset == 0) { userEntryOffset = MT_AUDIT_HEADER_LENGTH + ((usersSize - MT_AUDIT_HEADER_LENGTH) / MT_AUDIT_USER_ENTRY_LENGTH) * MT_AUDIT_USER_ENTRY_LENGTH; }
+        if (pwrite(usersFd, userBytes, MT_AUDIT_USER_ENTRY_LENGTH, (off_t)userEntryOffset) != MT_AUDIT_USER_ENTRY_LENGTH || fsync(usersFd) != 0) { goto done; }
+        
+        result = 0;
+    }
+    
+done:
+    free(users);
+    free(recordBytes);
+    
+    if (usersFd >= 0) { close(usersFd); }
+    if (indexFd >= 0) { close(indexFd); }
+    if (dataFd >= 0) { close(dataFd); }
+    
+    return result;
+}
+
+long mt_audit_store_query(const char *basePath, const char *user, int64_t since, mt_audit_callback_t callback, void *context)
+{
+    long matches = -1;
+    mt_audit_mapping_t data = { .fd = -1 }, index = { .fd = -1 }, users = { .fd = -1 };
+    mt_audit_record_t record;
+    mt_audit_index_entry_t entry;
+    uint64_t *userEntries = NULL;
+    
+    if (!basePath) {
+        
+        errno = EINVAL;
+        return -1;
+    }
+    
+    if (mt_audit_map(basePath, "dat", MT_AUDIT_MAGIC_DATA, &data) == 0 &&
+        mt_audit_map(basePath, "idx", MT_AUDIT_MAGIC_INDEX, &index) == 0 &&
+        mt_audit_map(basePath, "usr", MT_AUDIT_MAGIC_USERS, &users) == 0) {
+        
+        uint64_t entryCount = (index.length > MT_AUDIT_HEADER_LENGTH) ? (index.length - MT_AUDIT_HEADER_LENGTH) / MT_AUDIT_INDEX_ENTRY_LENGTH : 0;
+        matches = 0;
+        
+        if (user) {
+            
+            // follow the user's entries from the most recent to the oldest
+            // one and return them in chronological order afterwards
+            size_t userLength = strlen(user);
+            uint64_t currentEntry = mt_audit_last_user_entry(users.map, users.length, mt_audit_user_hash(user, userLength), NULL);
+            size_t capacity = 0;
+            size_t count = 0;
+            
+            while (currentEntry > 0 && currentEntry <= entryCount) {
+                
+                mt_audit_decode_index_entry(index.map + MT_AUDIT_HEADER_LENGTH + (currentEntry - 1) * MT_AUDIT_INDEX_ENTRY_LENGTH, &entry);
+                if (entry.searchTimestamp < since) { break; }
+                
+                if (mt_audit_decode_record(data.map, data.length, entry.recordOffset, &record) == 0 && record.timestamp >= since &&
+                    record.userLength == userLength && memcmp(record.user, user, userLength) == 0) {
+                    
+                    if (count == capacity) {
+                        
+                        capacity = (capacity == 0) ? 64 : capacity * 2;
+                        uint64_t *newEntries = realloc(userEntries, capacity * sizeof(uint64_t));
+                        
+                        if (!newEntries) {
+                            
+                            matches = -1;
+                            goto done;
+                        }
+                        
+                        userEntries = newEntries;
+                    }
+                    
+                    userEntries[count++] = entry.recordOffset;
+                }
+                
+                if (entry.previousEntry >= currentEntry) { break; }
+                currentEntry = entry.previousEntry;
+            }
+            
+            while (count > 0) {
+                
+                mt_audit_decode_record(data.map, data.length, userEntries[--count], &record);
+                matches++;
+                
+                if (callback && callback(&record, context) != 0) { break; }
+            }
+            
+        } else {
+            
+            // find the first entry that is not older than the given timestamp
+            uint64_t lower = 0;
+            uint64_t upper = entryCount;
+            
+            while (lower < upper) {
+                
+                uint64_t middle = lower + (upper - lower) / 2;
+                mt_audit_decode_index_entry(index.map + MT_AUDIT_HEADER_LENGTH + middle * MT_AUDIT_INDEX_ENTRY_LENGTH, &entry);
+                
+                if (entry.searchTimestamp < since) { lower = middle + 1; } else { upper = middle; }
+            }
+            
+            for (uint64_t i = lower; i < entryCount; i++) {
+                
+                mt_audit_decode_index_entry(index.map + MT_AUDIT_HEADER_LENGTH + i * MT_AUDIT_INDEX_ENTRY_LENGTH, &entry);
+                
+                if (mt_audit_decode_record(data.map, data.length, entry.recordOffset, &record) == 0 && record.timestamp >= since) {
+                    
+                    matches++;
+                    if (callback && callback(&record, context) != 0) { break; }
+                }
+            }
+        }
+    }
+    
+done:
+    free(userEntries);
+    mt_audit_unmap(&users);
+    mt_audit_unmap(&index);
+    mt_audit_unmap(&data);
+    
+    return matches;
+}
@@ -0,0 +1,95 @@
+/*
+    MTAuditStore.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTAuditStore_h
+#define MTAuditStore_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    A compact, append-only store for privilege changes. The store consists of three files
+    that share the same base path:
+ 
+    <base>.dat  The records. An 8 byte header ("PRVAUD01") followed by variable length records.
+                Each record starts with a 24 byte fixed part (record length, timestamp, duration,
+                action and the lengths of the strings), followed by the user name, the reason
+                and the name of the requesting component (all UTF-8, not null-terminated).
+ 
+    <base>.idx  The time index. An 8 byte header ("PRVIDX01") followed by one 32 byte entry per
+                record (search timestamp, record offset, user hash and a reference to the
+                previous entry of the same user). The search timestamps never decrease, so the
+                index can be searched using binary search even if the system clock went back.
+ 
+    <base>.usr  The user index. An 8 byte header ("PRVUSR01") followed by one 16 byte entry per
+                user (user hash and a reference to the user's most recent index entry). Together
+                with the back references of the time index, this allows to get all records of a
+                user without scanning the whole store.
+ 
+    All integers are stored in little endian byte order. The store does not depend on any
+    platform specific APIs besides POSIX, so it can be used (and benchmarked) on other
+    platforms as well.
+*/
+
+#define MT_AUDIT_ACTION_GRANT       1
+#define MT_AUDIT_ACTION_REVOKE      2
+
+typedef struct {
+    int64_t timestamp;
+    uint32_t duration;
+    uint8_t action;
+    const char *user;
+    size_t userLength;
+    const char *reason;
+    size_t reasonLength;
+    const char *component;
+    size_t componentLength;
+} mt_audit_record_t;
+
+/*!
+ @typedef       mt_audit_callback_t
+ @abstract      The callback that is called for every record that matches a query.
+ @discussion    The strings of the record are only valid for the duration of the callback. Return
+                a non-zero value to stop the query.
+*/
+typedef int (*mt_audit_callback_t)(const mt_audit_record_t *record, void *context);
+
+/*!
+ @function      mt_audit_store_append
+ @abstract      Appends a record to the store at the given base path. Files that do not exist are created.
+ @param         basePath A null-terminated string containing the base path of the store.
+ @param         record A pointer to the record to append. If the record's action is MT_AUDIT_ACTION_REVOKE and
+                its duration is 0, the duration is set to the number of seconds since the user's previous
+                record if that record is a grant. Strings longer than 65535 bytes are truncated.
+ @discussion    Returns 0 on success, otherwise returns -1 and sets errno.
+*/
+int mt_audit_store_append(const char *basePath, mt_audit_record_t *record);
+
+/*!
+ @function      mt_audit_store_query
+ @abstract      Calls the given callback for every record that matches the given criteria in chronological order.
+ @param         basePath A null-terminated string containing the base path of the store.
+ @param         user A null-terminated string containing the user name or NULL to get the records of all users.
+ @param         since The timestamp of the oldest record to return.
+ @param         callback The callback to call for every matching record.
+ @param         context A pointer that is passed to the callback.
+ @discussion    Returns the number of records passed to the callback or -1 if an error occurred. A store that
+                does not exist is treated like an empty store.
+*/
+long mt_audit_store_query(const char *basePath, const char *user, int64_t since, mt_audit_callback_t callback, void *context);
+
+#endif /* MTAuditStore_h */
@@ -0,0 +1,300 @@
+/*
+    MTBinaryPlist.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTBinaryPlist.h"
+#include <string.h>
+
+#define MT_BPLIST_HEADER_LENGTH     8
+#define MT_BPLIST_TRAILER_LENGTH    32
+
+#define MT_BPLIST_TYPE_INT          0x1
+#define MT_BPLIST_TYPE_ASCII        0x5
+#define MT_BPLIST_TYPE_UTF16        0x6
+#define MT_BPLIST_TYPE_ARRAY        0xA
+#define MT_BPLIST_TYPE_DICT         0xD
+
+static uint64_t mt_bplist_read_uint(const uint8_t *bytes, uint8_t size)
+{
+    uint64_t value = 0;
+    for (uint8_t i = 0; i < size; i++) { value = (value << 8) | bytes[i]; }
+    
+    return value;
+}
+
+// returns the offset of the object with the given reference
+static int mt_bplist_object_offset(const mt_bplist_t *plist, uint64_t objectRef, size_t *offset)
+{
+    if (objectRef >= plist->numObjects) { return -1; }
+    
+    const uint8_t *entry = plist->data + plist->offsetTableOffset + objectRef * plist->offsetIntSize;
+    uint64_t objectOffset = mt_bplist_read_uint(entry, plist->offsetIntSize);
+    
+    // objects must be located between the header and the offset table
+    if (objectOffset < MT_BPLIST_HEADER_LENGTH || objectOffset >= plist->offsetTableOffset) { return -1; }
+    
+    *offset = (size_t)objectOffset;
+    
+    return 1;
+}
+
+// reads the marker of the object with the given reference and returns its
+// type, the number of elements and the offset of the object's payload
+static int mt_bplist_object_header(const mt_bplist_t *plist, uint64_t objectRef, uint8_t *type, uint64_t *count, size_t *payloadOffset)
+{
+    size_t offset = 0;
+    if (mt_bplist_object_offset(plist, objectRef, &offset) != 1) { return -1; }
+    
+    uint8_t marker = plist->data[offset++];
+    uint64_t objectCount = marker & 0x0F;
+    
+    // counts >= 15 are stored in a separate integer object
+    // that directly follows the marker
+    if (objectCount == 0x0F) {
+        
+        if (offset >= plist->offsetTableOffset) { return -1; }
+        
+        uint8_t intMarker = plist->data[offset++];
+        if ((intMarker >> 4) != MT_BPLIST_TYPE_INT || (intMarker & 0x0F) > 3) { return -1; }
+        
+        uint8_t intSize = 1 << (intMarker & 0x0F);
+        if (intSize > plist->offsetTableOffset - offset) { return -1; }
+        
+        objectCount = mt_bplist_read_uint(plist->data + offset, intSize);
+        offset += intSize;
+    }
+    
+    *type = marker >> 4;
+    *count = objectCount;
+    *payloadOffset = offset;
+    
+    return 1;
+}
+
+// returns the payload of a container object and makes sure
+// it fits into the object area of the property list
+static int mt_bplist_container(const mt_bplist_t *plist, uint64_t objectRef, uint8_t expectedType, uint64_t *count, const uint8_t **refs)
+{
+    uint8_t type = 0;
+    uint64_t objectCount = 0;
+    size_t offset = 0;
+    
+    if (mt_bplist_object_header(plist, objectRef, &type, &objectCount, &offset) != 1 || type != expectedType) { return -1; }
+    
+    // dictionaries contain a key and a value reference per entry
+    uint64_t refsPerEntry = (type == MT_BPLIST_TYPE_DICT) ? 2 : 1;
+    uint64_t available = (plist->offsetTableOffset - offset) / plist->objectRefSize;
+    if (objectCount > available / refsPerEntry) { return -1; }
+    
+    *count = objectCount;
+    *refs = plist->data + offset;
+    
+    return 1;
+}
+
+int mt_bplist_init(mt_bplist_t *plist, const uint8_t *data, size_t length)
+{
+    if (!plist || !data || length < MT_BPLIST_HEADER_LENGTH + MT_BPLIST_TRAILER_LENGTH) { return -1; }
+    if (memcmp(data, "bplist00", MT_BPLIST_HEADER_LENGTH) != 0) { return -1; }
+    
+    const uint8_t *trailer = data + length - MT_BPLIST_TRAILER_LENGTH;
+    
+    plist->data = data;
+    plist->length = length;
+    plist->offsetIntSize = trailer[6];
+    plist->objectRefSize = trailer[7];
+    plist->numObjects = mt_bplist_read_uint(trailer + 8, 8);
+    plist->topObject = mt_bplist_read_uint(trailer + 16, 8);
+    plist->offsetTableOffset = mt_bplist_read_uint(trailer + 24, 8);
+    
+    if (plist->offsetIntSize < 1 || plist->offsetIntSize > 8) { return -1; }
+    if (plist->objectRefSize < 1 || plist->objectRefSize > 8) { return -1; }
+    if (plist->numObjects == 0 || plist->topObject >= plist->numObjects) { return -1; }
+    
+    // the offset table must be located between the objects and the trailer
+    uint64_t tableEnd = length - MT_BPLIST_TRAILER_LENGTH;
+    if (plist->offsetTableOffset <= MT_BPLIST_HEADER_LENGTH || plist->offsetTableOffset > tableEnd) { return -1; }
+    if (plist->numObjects > (tableEnd - plist->offsetTableOffset) / plist->offsetIntSize) { return -1; }
+    
+    return 1;
+}
+
+int mt_bplist_dict_get(const mt_bplist_t *plist, uint64_t dictRef, const char *key, uint64_t *valueRef)
+{
+    uint64_t count = 0;
+    const uint8_t *refs = NULL;
+    
+    if (!key || mt_bplist_container(plist, dictRef, MT_BPLIST_TYPE_DICT, &count, &refs) != 1) { return -1; }
+    
+    for (uint64_t i = 0; i < count; i++) {
+        
+        uint64_t keyRef = mt_bplist_read_uint(refs + i * plist->objectRefSize, plist->objectRefSize);
+        int result = mt_bplist_string_equals(plist, keyRef, key);
+        
+        if (result < 0) {
+            
+            return -1;
+            
+        } else if (result == 1) {
+            
+            if (valueRef) { *valueRef = mt_bplist_read_uint(refs + (count + i) * plist->objectRefSize, plist->objectRefSize); }
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+int mt_bplist_array_count(const mt_bplist_t *plist, uint64_t arrayRef, uint64_t *count)
+{
+    const uint8_t *refs = NULL;
+    
+    return mt_bplist_container(plist, arrayRef, MT_BPLIST_TYPE_ARRAY, count, &refs);
+}
+
+int mt_bplist_array_get(const mt_bplist_t *plist, uint64_t arrayRef, uint64_t index, uint64_t *elementRef)
+{
+    uint64_t count = 0;
+    const uint8_t *refs = NULL;
+    
+    if (mt_bplist_container(plist, arrayRef, MT_BPLIST_TYPE_ARRAY, &count, &refs) != 1) { return -1; }
+    if (index >= count) { return 0; }
+    
+    if (elementRef) { *elementRef = mt_bplist_read_uint(refs + index * plist->objectRefSize, plist->objectRefSize); }
+    
+    return 1;
+}
+
+int mt_bplist_string_get(const mt_bplist_t *plist, uint64_t stringRef, const uint8_t **bytes, size_t *byteLength, int *isUTF16)
+{
+    uint8_t type = 0;
+    uint64_t count = 0;
+    size_t offset = 0;
+    
+    if (mt_bplist_object_header(plist, stringRef, &type, &count, &offset) != 1) { return -1; }
+    if (type != MT_BPLIST_TYPE_ASCII && type != MT_BPLIST_TYPE_UTF16) { return -1; }
+    
+    // the count of UTF-16 strings is the number of code units
+    uint64_t unitSize = (type == MT_BPLIST_TYPE_UTF16) ? 2 : 1;
+    if (count > (plist->offsetTableOffset - offset) / unitSize) { return -1; }
+    
+    if (bytes) { *bytes = plist->data + offset; }
+    if (byteLength) { *byteLength = (size_t)(count * unitSize); }
+    if (isUTF16) { *isUTF16 = (type == MT_BPLIST_TYPE_UTF16); }
+    
+    return 1;
+}
+
+// decodes the next code point of a null-terminated UTF-8 string and
+// returns the number of bytes consumed or -1 if the string is invalid
+static int mt_bplist_next_code_point(const uint8_t *string, uint32_t *codePoint)
+{
+    uint8_t lead = string[0];
+    int length = 0;
+    uint32_t value = 0;
+    
+    if (lead < 0x80) {
+        length = 1; value = lead;
+    } else if ((lead & 0xE0) == 0xC0) {
+        length = 2; value = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3; value = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4; value = lead & 0x07;
+    } else {
+        return -1;
+    }
+    
+    for (int i = 1; i < length; i++) {
+        
+        // this also stops at the terminating null byte
+        if ((string[i] & 0xC0) != 0x80) { return -1; }
+        value = (value << 6) | (string[i] & 0x3F);
+    }
+    
+    if (value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF)) { return -1; }
+    
+    *codePoint = value;
+    
+    return length;
+}
+
+int mt_bplist_string_equals(const mt_bplist_t *plist, uint64_t stringRef, const char *string)
+{
+    const uint8_t *bytes = NULL;
+    size_t byteLength = 0;
+    int isUTF16 = 0;
+    
+    if (!string || mt_bplist_string_get(plist, stringRef, &bytes, &byteLength, &isUTF16) != 1) { return -1; }
+    
+    const uint8_t *needle = (const uint8_t*)string;
+    
+    if (!isUTF16) {
+        
+        size_t needleLength = strlen(string);
+        return (needleLength == byteLength && memcmp(bytes, needle, byteLength) == 0);
+    }
+    
+    // compare the UTF-16 code units of the string object with the
+    // code units of the given UTF-8 string without converting either
+    size_t position = 0;
+    
+    while (*needle) {
+        
+        uint32_t codePoint = 0;
+        int consumed = mt_bplist_next_code_point(needle, &codePoint);
+        if (consumed < 0) { return -1; }
+        needle += consumed;
+        
+        uint16_t units[2] = { (uint16_t)codePoint, 0 };
+        int unitCount = 1;
+        
+        if (codePoint > 0xFFFF) {
+            
+            codePoint -= 0x10000;
+            units[0] = (uint16_t)(0xD800 | (codePoint >> 10));
+            units[1] = (uint16_t)(0xDC00 | (codePoint & 0x3FF));
+            unitCount = 2;
+        }
+        
+        for (int i = 0; i < unitCount; i++) {
+            
+            if (byteLength - position < 2) { return 0; }
+            if ((uint16_t)mt_bplist_read_uint(bytes + position, 2) != units[i]) { return 0; }
+            position += 2;
+        }
+    }
+    
+    return (position == byteLength);
+}
+
+int mt_bplist_array_contains_string(const mt_bplist_t *plist, uint64_t arrayRef, const char *string)
+{
+    uint64_t count = 0;
+    const uint8_t *refs = NULL;
+    
+    if (mt_bplist_container(plist, arrayRef, MT_BPLIST_TYPE_ARRAY, &count, &refs) != 1) { return -1; }
+    
+    for (uint64_t i = 0; i < count; i++) {
+        
+        uint64_t elementRef = mt_bplist_read_uint(refs + i * plist->objectRefSize, plist->objectRefSize);
+        int result = mt_bplist_string_equals(plist, elementRef, string);
+        
+        if (result != 0) { return result; }
+    }
+    
+    return 0;
+}
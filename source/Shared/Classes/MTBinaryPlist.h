@@ -0,0 +1,118 @@
+/*
+    MTBinaryPlist.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTBinaryPlist_h
+#define MTBinaryPlist_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    A minimal, read-only parser for binary property lists (bplist00). The parser does
+    not allocate any memory and does not depend on CoreFoundation, so it can be used
+    on other platforms as well. All functions validate object references, offsets and
+    counts against the size of the given buffer, so they are safe to use with untrusted
+    or truncated data.
+ 
+    Unless stated otherwise, all functions return 1 on success (or if the requested
+    object has been found), 0 if the requested object does not exist or does not match
+    and -1 if the data is malformed or the object has an unexpected type.
+*/
+
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+    uint8_t offsetIntSize;
+    uint8_t objectRefSize;
+    uint64_t numObjects;
+    uint64_t topObject;
+    uint64_t offsetTableOffset;
+} mt_bplist_t;
+
+/*!
+ @function      mt_bplist_init
+ @abstract      Initializes a mt_bplist_t structure with the given data.
+ @param         plist A pointer to the mt_bplist_t structure to initialize.
+ @param         data A pointer to the binary property list data. The data must stay
+                valid as long as the mt_bplist_t structure is used.
+ @param         length The length of the data in bytes.
+ @discussion    Returns 1 if the data contains a valid header and trailer, otherwise returns -1.
+*/
+int mt_bplist_init(mt_bplist_t *plist, const uint8_t *data, size_t length);
+
+/*!
+ @function      mt_bplist_dict_get
+ @abstract      Gets the value for the given key from a dictionary.
+ @param         plist A pointer to an initialized mt_bplist_t structure.
+ @param         dictRef The object reference of the dictionary.
+ @param         key A null-terminated UTF-8 string containing the key.
+ @param         valueRef A pointer that receives the object reference of the value.
+*/
+int mt_bplist_dict_get(const mt_bplist_t *plist, uint64_t dictRef, const char *key, uint64_t *valueRef);
+
+/*!
+ @function      mt_bplist_array_count
+ @abstract      Gets the number of elements of an array.
+ @param         plist A pointer to an initialized mt_bplist_t structure.
+ @param         arrayRef The object reference of the array.
+ @param         count A pointer that receives the number of elements.
+*/
+int mt_bplist_array_count(const mt_bplist_t *plist, uint64_t arrayRef, uint64_t *count);
+
+/*!
+ @function      mt_bplist_array_get
+ @abstract      Gets the element at the given index of an array.
+ @param         plist A pointer to an initialized mt_bplist_t structure.
+ @param         arrayRef The object reference of the array.
+ @param         index The index of the element.
+ @param         elementRef A pointer that receives the object reference of the element.
+*/
+int mt_bplist_array_get(const mt_bplist_t *plist, uint64_t arrayRef, uint64_t index, uint64_t *elementRef);
+
+/*!
+ @function      mt_bplist_string_get
+ @abstract      Gets the raw bytes of a string object.
+ @param         plist A pointer to an initialized mt_bplist_t structure.
+ @param         stringRef The object reference of the string.
+ @param         bytes A pointer that receives a pointer to the string's bytes (not null-terminated).
+ @param         byteLength A pointer that receives the length of the string in bytes.
+ @param         isUTF16 A pointer that receives 1 if the string is UTF-16 (big endian) encoded or 0
+                if the string is ASCII encoded.
+*/
+int mt_bplist_string_get(const mt_bplist_t *plist, uint64_t stringRef, const uint8_t **bytes, size_t *byteLength, int *isUTF16);
+
+/*!
+ @function      mt_bplist_string_equals
+ @abstract      Compares a string object with the given UTF-8 string.
+ @param         plist A pointer to an initialized mt_bplist_t structure.
+ @param         stringRef The object reference of the string.
+ @param         string A null-terminated UTF-8 string.
+ @discussion    Returns 1 if the strings are equal, 0 if they are not and -1 if the object is not
+                a string, the data is malformed or the given string is not valid UTF-8.
+*/
+int mt_bplist_string_equals(const mt_bplist_t *plist, uint64_t stringRef, const char *string);
+
+/*!
+ @function      mt_bplist_array_contains_string
+ @abstract      Checks if an array contains the given string.
+ @param         plist A pointer to an initialized mt_bplist_t structure.
+ @param         arrayRef The object reference of the array.
+ @param         string A null-terminated UTF-8 string.
+*/
+int mt_bplist_array_contains_string(const mt_bplist_t *plist, uint64_t arrayRef, const char *string);
+
+#endif /* MTBinaryPlist_h */
@@ -34,6 +34,15 @@
 */
 + (NSString*)getSigningAuthorityWithError:(NSError**)error;
 
+/*!
+ @method        signingAuthorityWithError:
+ @abstract      Returns the current app's signing authority.
+ @param         error A reference to a NSError object that contains a detailed error message if an error occurred.
+ @discussion    Same as getSigningAuthorityWithError: but the signing authority is only determined once
+                and then returned from a cache. If an error occurred, the next call tries again.
+*/
++ (NSString*)signingAuthorityWithError:(NSError**)error;
+
 /*!
  @method        codeSigningRequirementsWithCommonName:bundleIdentifier:versionString:
  @abstract      Returns the code signing requirements constructed from the given parameters.
@@ -58,6 +67,16 @@
                                  bundleIdentifiers:(NSArray*)bundleIdentifiers
                                      versionString:(NSString*)versionString;
 
+/*!
+ @method        signingIdentifierOfProcessWithAuditToken:
+ @abstract      Returns the code signing identifier of the process with the given audit token.
+ @param         auditToken The audit token of the process.
+ @discussion    Returns the signing identifier (e.g. corp.sap.privileges.cli) or nil if an error occurred.
+                Unlike the process name, the signing identifier cannot be changed without invalidating
+                the process' code signature.
+*/
++ (NSString*)signingIdentifierOfProcessWithAuditToken:(audit_token_t)auditToken;
+
 /*!
  @method        sandboxStatusWithCompletionHandler:
  @abstract      Returns whether the current application is sandboxed or not.
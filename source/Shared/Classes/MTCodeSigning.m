@@ -88,6 +88,21 @@
     return returnValue;
 }
 
++ (NSString*)signingAuthorityWithError:(NSError**)error
+{
+    static NSString *signingAuthority = nil;
+    NSString *returnValue = nil;
+    
+    @synchronized (self) {
+        
+        // our signing authority does not change while we are running
+        if (!signingAuthority) { signingAuthority = [self getSigningAuthorityWithError:error]; }
+        returnValue = signingAuthority;
+    }
+    
+    return returnValue;
+}
+
 + (NSString*)codeSigningRequirementsWithCommonName:(NSString*)commonName
                                   bundleIdentifier:(NSString*)bundleIdentifier
                                      versionString:(NSString*)versionString
@@ -133,6 +148,33 @@
     return [reqString copy];
 }
 
++ (NSString*)signingIdentifierOfProcessWithAuditToken:(audit_token_t)auditToken
+{
+    NSString *returnValue = nil;
+    SecCodeRef guestCode = NULL;
+    
+    NSDictionary *guestAttributes = [NSDictionary dictionaryWithObject:[NSData dataWithBytes:&auditToken length:sizeof(audit_token_t)]
+                                                                forKey:(__bridge NSString*)kSecGuestAttributeAudit
+    ];
+    
+    if (SecCodeCopyGuestWithAttributes(NULL, (__bridge CFDictionaryRef)guestAttributes, kSecCSDefaultFlags, &guestCode) == errSecSuccess) {
+        
+        CFDictionaryRef signingInfo = NULL;
+        
+        if (SecCodeCopySigningInformation(guestCode, kSecCSDefaultFlags, &signingInfo) == errSecSuccess) {
+            
+            CFStringRef identifier = CFDictionaryGetValue(signingInfo, kSecCodeInfoIdentifier);
+            if (identifier && CFGetTypeID(identifier) == CFStringGetTypeID()) { returnValue = [NSString stringWithString:(__bridge NSString*)identifier]; }
+            
+            CFRelease(signingInfo);
+        }
+        
+        CFRelease(guestCode);
+    }
+    
+    return returnValue;
+}
+
 + (void)sandboxStatusWithCompletionHandler:(void (^)(BOOL isSandboxed, NSError *error))completionHandler
 {
     if (completionHandler) {
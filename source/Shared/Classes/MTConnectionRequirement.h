@@ -0,0 +1,67 @@
+/*
+    MTConnectionRequirement.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @class         MTConnectionRequirement
+ @abstract      A class that validates the code signature of processes connecting to an xpc listener.
+ @discussion    The signing authority of the current process and the code signing requirement are determined
+                and compiled only once, when the object is initialized. Validating a connection then just
+                checks the connecting process against the precompiled requirement.
+*/
+
+@interface MTConnectionRequirement : NSObject
+
+/*!
+ @method        init
+ @discussion    The init method is not available. Please use initWithBundleIdentifiers:versionString:error: instead.
+ */
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        initWithBundleIdentifiers:versionString:error:
+ @abstract      Initialize a MTConnectionRequirement object with the given parameters.
+ @param         bundleIdentifiers An array of bundle identifiers. The connecting process must use one of them.
+ @param         versionString The minimum version string (e.g. 2.0.0) of the connecting process.
+ @param         error A reference to a NSError object that contains a detailed error message if an error occurred. May be nil.
+ @discussion    The connecting process must be signed by the same signing authority as the current process.
+                Returns an initialized MTConnectionRequirement object or nil if the signing authority of the
+                current process could not be determined or the requirement could not be compiled. In
+                this case, error always contains an error.
+*/
+- (instancetype)initWithBundleIdentifiers:(NSArray<NSString*>*)bundleIdentifiers
+                            versionString:(NSString*)versionString
+                                    error:(NSError**)error NS_DESIGNATED_INITIALIZER;
+
+/*!
+ @method        requirementString
+ @abstract      Returns the code signing requirement in its text form.
+*/
+- (NSString*)requirementString;
+
+/*!
+ @method        validateAuditToken:error:
+ @abstract      Validates the process with the given audit token against the code signing requirement.
+ @param         auditToken The audit token of the process to validate.
+ @param         error A reference to a NSError object that contains the status code if the validation failed. May be nil.
+ @discussion    Returns YES if the process satisfies the code signing requirement, otherwise returns NO. The time
+                needed for the validation is logged at the debug level.
+*/
+- (BOOL)validateAuditToken:(audit_token_t)auditToken error:(NSError**)error;
+
+@end
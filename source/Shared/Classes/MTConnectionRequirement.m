@@ -0,0 +1,129 @@
+/*
+    MTConnectionRequirement.m
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTConnectionRequirement.h"
+#import "MTCodeSigning.h"
+#import "Constants.h"
+#import <os/log.h>
+#import <mach/mach_time.h>
+
+@interface MTConnectionRequirement ()
+@property (nonatomic, strong, readwrite) NSString *requirementString;
+@property (assign) SecRequirementRef requirement;
+@property (assign) uint64_t validationCount;
+@property (assign) double validationTime;
+@end
+
+@implementation MTConnectionRequirement
+
+- (instancetype)initWithBundleIdentifiers:(NSArray<NSString*>*)bundleIdentifiers
+                            versionString:(NSString*)versionString
+                                    error:(NSError**)error
+{
+    self = [super init];
+    
+    if (self) {
+        
+        NSError *requirementError = nil;
+        NSString *signingAuth = [MTCodeSigning signingAuthorityWithError:&requirementError];
+        
+        if (signingAuth) {
+            
+            _requirementString = [MTCodeSigning codeSigningRequirementsWithCommonName:signingAuth
+                                                                    bundleIdentifiers:bundleIdentifiers
+                                                                        versionString:versionString
+            ];
+            
+            OSStatus result = SecRequirementCreateWithString((__bridge CFStringRef)_requirementString, kSecCSDefaultFlags, &_requirement);
+            
+            if (result != errSecSuccess) {
+                
+                NSDictionary *errorDetail = [NSDictionary dictionaryWithObjectsAndKeys:
+                                             [NSString stringWithFormat:@"Failed to compile code signing requirement: %d", result], NSLocalizedDescriptionKey,
+                                             nil
+                ];
+                requirementError = [NSError errorWithDomain:kMTErrorDomain code:100 userInfo:errorDetail];
+            }
+        }
+        
+        // never return an object without a compiled requirement, because
+        // SecCodeCheckValidity would accept any validly signed process then
+        if (!_requirement) {
+            
+            if (!requirementError) {
+                
+                NSDictionary *errorDetail = [NSDictionary dictionaryWithObjectsAndKeys:
+                                             @"Failed to determine the signing authority of the current process", NSLocalizedDescriptionKey,
+                                             nil
+                ];
+                requirementError = [NSError errorWithDomain:kMTErrorDomain code:100 userInfo:errorDetail];
+            }
+            
+            if (error) { *error = requirementError; }
+            self = nil;
+        }
+    }
+    
+    return self;
+}
+
+- (void)dealloc
+{
+    if (_requirement) { CFRelease(_requirement); }
+}
+
+- (BOOL)validateAuditToken:(audit_token_t)auditToken error:(NSError**)error
+{
+    uint64_t startTime = mach_absolute_time();
+    SecCodeRef guestCode = NULL;
+    OSStatus result = errSecCSReqFailed;
+    
+    NSDictionary *guestAttributes = [NSDictionary dictionaryWithObject:[NSData dataWithBytes:&auditToken length:sizeof(audit_token_t)]
+                                                                forKey:(__bridge NSString*)kSecGuestAttributeAudit
+    ];
+    
+    // without a requirement every validly signed process would pass, so we reject the connection
+    if (_requirement) {
+        
+        result = SecCodeCopyGuestWithAttributes(NULL, (__bridge CFDictionaryRef)guestAttributes, kSecCSDefaultFlags, &guestCode);
+        
+        if (result == errSecSuccess) {
+            
+            result = SecCodeCheckValidity(guestCode, kSecCSDefaultFlags, _requirement);
+            CFRelease(guestCode);
+        }
+    }
+    
+    // measure how long the validation took
+    static mach_timebase_info_data_t timebaseInfo;
+    if (timebaseInfo.denom == 0) { mach_timebase_info(&timebaseInfo); }
+    double elapsedTime = (double)(mach_absolute_time() - startTime) * timebaseInfo.numer / timebaseInfo.denom / NSEC_PER_MSEC;
+    
+    @synchronized (self) {
+        
+        _validationCount++;
+        _validationTime += elapsedTime;
+        
+        os_log_debug(OS_LOG_DEFAULT, "SAPCorp: Connection validated in %.3f ms (%llu validations, %.3f ms on average)", elapsedTime, _validationCount, _validationTime / _validationCount);
+    }
+    
+    if (result != errSecSuccess && error) { *error = [NSError errorWithDomain:kMTErrorDomain code:result userInfo:nil]; }
+    
+    return (result == errSecSuccess);
+}
+
+@end
@@ -0,0 +1,80 @@
+/*
+    MTGroupMembershipCache.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @class         MTGroupMembershipCache
+ @abstract      A process-wide cache for group memberships, keyed by user name and group id.
+ @discussion    Every cache entry stores the generation of the cache it has been created in. Calling
+                invalidate increments the generation, so all existing entries become stale and are
+                verified again the next time they are requested. The cache is invalidated automatically
+                if the directory service reports changed groups, which does not require a run loop. In
+                processes running a run loop, it is also invalidated if the admin group changes or if
+                privileges are changed by Privileges. Entries also expire after kMTGroupMembershipCacheMaxAge
+                seconds, so a missed notification never leaves a stale entry in place for longer than that.
+*/
+
+@interface MTGroupMembershipCache : NSObject
+
+/*!
+ @method        init
+ @discussion    The init method is not available. Please use sharedCache instead.
+ */
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        sharedCache
+ @abstract      Returns the shared cache object.
+*/
++ (instancetype)sharedCache;
+
+/*!
+ @method        membershipForUser:groupID:
+ @abstract      Returns the cached group membership for the given user and group.
+ @param         userName The short name of the user.
+ @param         groupID The id of the group.
+ @discussion    Returns an NSNumber containing a boolean or nil if there is no valid cache entry
+                for the given user and group.
+*/
+- (NSNumber*)membershipForUser:(NSString*)userName groupID:(gid_t)groupID;
+
+/*!
+ @method        setMembership:forUser:groupID:generation:
+ @abstract      Stores the group membership for the given user and group in the cache.
+ @param         isMember A boolean specifying whether the user is member of the group.
+ @param         userName The short name of the user.
+ @param         groupID The id of the group.
+ @param         generation The cache generation returned by generation before the membership has been looked up.
+ @discussion    If the cache has been invalidated since the given generation, the membership might already be
+                outdated and is not stored.
+*/
+- (void)setMembership:(BOOL)isMember forUser:(NSString*)userName groupID:(gid_t)groupID generation:(NSUInteger)generation;
+
+/*!
+ @method        invalidate
+ @abstract      Increments the cache generation, so all cached entries are verified again on next access.
+*/
+- (void)invalidate;
+
+/*!
+ @method        generation
+ @abstract      Returns the current cache generation.
+*/
+- (NSUInteger)generation;
+
+@end
@@ -0,0 +1,194 @@
+/*
+    MTGroupMembershipCache.m
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTGroupMembershipCache.h"
+#import "Constants.h"
+#import <os/log.h>
+#import <notify.h>
+
+#define kMTGroupMembershipCacheKeyIsMember      @"member"
+#define kMTGroupMembershipCacheKeyGeneration    @"generation"
+#define kMTGroupMembershipCacheKeyTimestamp     @"timestamp"
+
+@interface MTGroupMembershipCache ()
+@property (nonatomic, strong, readwrite) NSMutableDictionary *cacheEntries;
+@property (nonatomic, strong, readwrite) dispatch_queue_t cacheQueue;
+@property (nonatomic, strong, readwrite) id adminGroupObserver;
+@property (nonatomic, strong, readwrite) id privilegesObserver;
+@property (assign) int groupChangeToken;
+@property (assign) NSUInteger cacheGeneration;
+@property (assign) NSUInteger cacheHits;
+@property (assign) NSUInteger cacheMisses;
+@property (assign) uint64_t statisticsStartTime;
+- (instancetype)initPrivate;
+@end
+
+@implementation MTGroupMembershipCache
+
++ (instancetype)sharedCache
+{
+    static MTGroupMembershipCache *sharedCache = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        sharedCache = [[self alloc] initPrivate];
+    });
+    
+    return sharedCache;
+}
+
+- (instancetype)initPrivate
+{
+    self = [super init];
+    
+    if (self) {
+        
+        _cacheEntries = [[NSMutableDictionary alloc] init];
+        _cacheQueue = dispatch_queue_create("corp.sap.privileges.membershipcache", DISPATCH_QUEUE_SERIAL);
+        _statisticsStartTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+        
+        // invalidate the cache if the admin group changed or
+        // if privileges have been changed by Privileges
+        NSNotificationCenter *notificationCenter = [NSDistributedNotificationCenter defaultCenter];
+        
+        _adminGroupObserver = [notificationCenter addObserverForName:kMTNotificationNameAdminGroupDidChange
+                                                              object:nil
+                                                               queue:nil
+                                                          usingBlock:^(NSNotification *notification) {
+            [self invalidate];
+        }];
+        
+        _privilegesObserver = [notificationCenter addObserverForName:kMTNotificationNamePrivilegesDidChange
+                                                              object:nil
+                                                               queue:nil
+                                                          usingBlock:^(NSNotification *notification) {
+            [self invalidate];
+        }];
+        
+        // distributed notifications are only delivered to processes running
+        // a run loop (so not to the command line tool). The directory service's
+        // notification is delivered on our queue and also covers group changes
+        // made by other tools, so the entries do not depend on the maximum age
+        uint32_t status = notify_register_dispatch(kMTNotificationNameGroupCacheInvalidated, &_groupChangeToken, _cacheQueue, ^(int token) {
+            self->_cacheGeneration++;
+        });
+        
+        if (status != NOTIFY_STATUS_OK) {
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to register for group changes (error %u)", status);
+        }
+    }
+    
+    return self;
+}
+
+- (NSString*)keyForUser:(NSString*)userName groupID:(gid_t)groupID
+{
+    return [NSString stringWithFormat:@"%u:%@", groupID, userName];
+}
+
+- (NSNumber*)membershipForUser:(NSString*)userName groupID:(gid_t)groupID
+{
+    __block NSNumber *isMember = nil;
+    
+    if ([userName length] > 0) {
+        
+        NSString *cacheKey = [self keyForUser:userName groupID:groupID];
+        
+        dispatch_sync(_cacheQueue, ^{
+            
+            NSDictionary *cacheEntry = [self->_cacheEntries objectForKey:cacheKey];
+            
+            if (cacheEntry) {
+                
+                NSUInteger entryGeneration = [[cacheEntry objectForKey:kMTGroupMembershipCacheKeyGeneration] unsignedIntegerValue];
+                NSDate *entryTimestamp = [cacheEntry objectForKey:kMTGroupMembershipCacheKeyTimestamp];
+                
+                if (entryGeneration == self->_cacheGeneration && [[NSDate date] timeIntervalSinceDate:entryTimestamp] < kMTGroupMembershipCacheMaxAge) {
+                    isMember = [cacheEntry objectForKey:kMTGroupMembershipCacheKeyIsMember];
+                }
+            }
+            
+            if (isMember) { self->_cacheHits++; } else { self->_cacheMisses++; }
+            [self logStatisticsIfNeeded];
+        });
+    }
+    
+    return isMember;
+}
+
+- (void)setMembership:(BOOL)isMember forUser:(NSString*)userName groupID:(gid_t)groupID generation:(NSUInteger)generation
+{
+    if ([userName length] > 0) {
+        
+        NSString *cacheKey = [self keyForUser:userName groupID:groupID];
+        
+        dispatch_sync(_cacheQueue, ^{
+            
+            // a lookup that started before the cache has been invalidated
+            // might have returned the old membership, so we drop it
+            if (generation == self->_cacheGeneration) {
+                
+                NSDictionary *cacheEntry = [NSDictionary dictionaryWithObjectsAndKeys:
+                                            [NSNumber numberWithBool:isMember], kMTGroupMembershipCacheKeyIsMember,
+                                            [NSNumber numberWithUnsignedInteger:generation], kMTGroupMembershipCacheKeyGeneration,
+                                            [NSDate date], kMTGroupMembershipCacheKeyTimestamp,
+                                            nil
+                ];
+                
+                [self->_cacheEntries setObject:cacheEntry forKey:cacheKey];
+            }
+        });
+    }
+}
+
+- (void)invalidate
+{
+    dispatch_sync(_cacheQueue, ^{ self->_cacheGeneration++; });
+}
+
+- (NSUInteger)generation
+{
+    __block NSUInteger generation = 0;
+    dispatch_sync(_cacheQueue, ^{ generation = self->_cacheGeneration; });
+    
+    return generation;
+}
+
+- (void)logStatisticsIfNeeded
+{
+    // log the number of identity service calls (cache misses) once per minute,
+    // so the effect of the cache can be measured
+    uint64_t elapsedTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - _statisticsStartTime;
+    
+    if (elapsedTime >= 60 * NSEC_PER_SEC) {
+        
+        os_log_debug(OS_LOG_DEFAULT, "SAPCorp: Group membership cache: %lu identity service calls, %lu cache hits in the last %llu seconds", (unsigned long)_cacheMisses, (unsigned long)_cacheHits, elapsedTime / NSEC_PER_SEC);
+        
+        _cacheHits = 0;
+        _cacheMisses = 0;
+        _statisticsStartTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    }
+}
+
+- (void)dealloc
+{
+    [[NSDistributedNotificationCenter defaultCenter] removeObserver:_adminGroupObserver];
+    [[NSDistributedNotificationCenter defaultCenter] removeObserver:_privilegesObserver];
+    notify_cancel(_groupChangeToken);
+}
+
+@end
@@ -44,7 +44,9 @@ typedef enum {
  @method        gidFromGroupName:
  @abstract      Get the group id from a group name.
  @param         groupName The short name of the group.
- @discussion    Returns the id of the given group or -1 if an error occurred.
+ @discussion    Returns the id of the given group or -1 if an error occurred. Group ids are looked up
+                once and then taken from an index, which is cleared whenever the directory service
+                reports changed groups.
  */
 + (int)gidFromGroupName:(NSString*)groupName;
 
@@ -64,7 +66,8 @@ typedef enum {
 @param         userName The short name of the user.
 @param         groupName The name of the group.
 @param         error A reference to an NSError object that contains a detailed error message if an error occurred. May be nil.
-@discussion    Returns YES if the user is member of the group, otherwise returns NO.
+@discussion    Returns YES if the user is member of the group, otherwise returns NO. If the group id is
+               already known, use groupMembershipForUser:groupID:error: instead.
 */
 + (BOOL)groupMembershipForUser:(NSString*)userName groupName:(NSString*)groupName error:(NSError**)error;
 
@@ -18,10 +18,75 @@
 #import "MTIdentity.h"
 #import "Constants.h"
 #import <os/log.h>
+#import <notify.h>
 
 @implementation MTIdentity
 
++ (dispatch_queue_t)groupIndexQueue
+{
+    static dispatch_queue_t groupIndexQueue = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        groupIndexQueue = dispatch_queue_create("corp.sap.privileges.groupindex", DISPATCH_QUEUE_SERIAL);
+    });
+    
+    return groupIndexQueue;
+}
+
++ (NSMutableDictionary*)groupIndex
+{
+    // must be called on the group index queue
+    static NSMutableDictionary *groupIndex = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        
+        groupIndex = [[NSMutableDictionary alloc] init];
+        
+        // the directory service posts this notification whenever
+        // groups have been created, deleted or changed
+        int notifyToken = 0;
+        uint32_t status = notify_register_dispatch(kMTNotificationNameGroupCacheInvalidated, &notifyToken, [self groupIndexQueue], ^(int token) {
+            [groupIndex removeAllObjects];
+        });
+        
+        if (status != NOTIFY_STATUS_OK) {
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_ERROR, "SAPCorp: Failed to register for group changes (error %u)", status);
+        }
+    });
+    
+    return groupIndex;
+}
+
 + (int)gidFromGroupName:(NSString*)groupName
+{
+    __block int posixID = -1;
+    
+    if ([groupName length] > 0) {
+        
+        // the query runs on the queue as well, so the index cannot be
+        // cleared while we're about to store an outdated result
+        dispatch_sync([self groupIndexQueue], ^{
+            
+            NSNumber *cachedID = [[self groupIndex] objectForKey:groupName];
+            
+            if (cachedID) {
+                
+                posixID = [cachedID intValue];
+                
+            } else {
+                
+                posixID = [self queryGIDFromGroupName:groupName];
+                if (posixID != -1) { [[self groupIndex] setObject:[NSNumber numberWithInt:posixID] forKey:groupName]; }
+            }
+        });
+    }
+    
+    return posixID;
+}
+
++ (int)queryGIDFromGroupName:(NSString*)groupName
 {
     int posixID = -1;
     
@@ -88,7 +153,7 @@
     BOOL isMember = NO;
     NSString *errorMsg;
     
-    gid_t groupID = [self gidFromGroupName:groupName];
+    int groupID = [self gidFromGroupName:groupName];
     
     if (groupID == -1) {
         
@@ -97,7 +162,7 @@
     } else {
         
         isMember = [self groupMembershipForUser:userName
-                                           groupID:[self gidFromGroupName:groupName]
+                                           groupID:(gid_t)groupID
                                              error:error
         ];
     }
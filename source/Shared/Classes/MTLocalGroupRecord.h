@@ -0,0 +1,89 @@
+/*
+    MTLocalGroupRecord.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @enum          MTLocalGroupMembership
+ @abstract      Specifies the group membership of a user as determined from a local group record.
+ @constant      MTLocalGroupMembershipUnknown The membership cannot be determined from the group record alone
+                (e.g. because the group contains nested groups). Use CBIdentity instead.
+ @constant      MTLocalGroupMembershipNotMember The user is not a member of the group.
+ @constant      MTLocalGroupMembershipMember The user is a member of the group.
+*/
+typedef enum {
+    MTLocalGroupMembershipUnknown   = -1,
+    MTLocalGroupMembershipNotMember = 0,
+    MTLocalGroupMembershipMember    = 1
+} MTLocalGroupMembership;
+
+/*!
+ @class         MTLocalGroupRecord
+ @abstract      A class that provides fast, read-only access to a group record of the local directory node.
+ @discussion    The record is read directly from the binary property list stored in the local directory node.
+                Reading the record requires root privileges.
+*/
+
+@interface MTLocalGroupRecord : NSObject
+
+/*!
+ @method        init
+ @discussion    The init method is not available. Please use initWithContentsOfFile: instead.
+ */
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        initWithContentsOfFile:
+ @abstract      Initialize a MTLocalGroupRecord object with the group record at the given path.
+ @param         path The path to the group record.
+ @discussion    Returns an initialized MTLocalGroupRecord object or nil if the file could not be read or does
+                not contain a binary property list.
+*/
+- (instancetype)initWithContentsOfFile:(NSString*)path NS_DESIGNATED_INITIALIZER;
+
+/*!
+ @method        membershipForUser:
+ @abstract      Get the group membership of the given user.
+ @param         userName The short name of the user.
+ @discussion    Returns MTLocalGroupMembershipMember if the user is listed in the group's "users" attribute. Returns
+                MTLocalGroupMembershipNotMember if the user is not listed and the group has no nested groups. Otherwise
+                returns MTLocalGroupMembershipUnknown.
+*/
+- (MTLocalGroupMembership)membershipForUser:(NSString*)userName;
+
+/*!
+ @method        users
+ @abstract      Get the short names of all users listed in the group record.
+ @discussion    Returns an array of user names or nil if the record is malformed.
+*/
+- (NSArray<NSString*>*)users;
+
+/*!
+ @method        groupMembers
+ @abstract      Get the uuids of all members listed in the group record.
+ @discussion    Returns an array of uuid strings or nil if the record is malformed.
+*/
+- (NSArray<NSString*>*)groupMembers;
+
+/*!
+ @method        nestedGroups
+ @abstract      Get the uuids of all nested groups listed in the group record.
+ @discussion    Returns an array of uuid strings or nil if the record is malformed.
+*/
+- (NSArray<NSString*>*)nestedGroups;
+
+@end
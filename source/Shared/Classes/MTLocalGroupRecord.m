@@ -0,0 +1,134 @@
+/*
+    MTLocalGroupRecord.m
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTLocalGroupRecord.h"
+#import "MTBinaryPlist.h"
+
+#define kMTLocalGroupRecordKeyUsers             "users"
+#define kMTLocalGroupRecordKeyGroupMembers      "groupmembers"
+#define kMTLocalGroupRecordKeyNestedGroups      "nestedgroups"
+
+@interface MTLocalGroupRecord ()
+@property (nonatomic, strong, readwrite) NSData *recordData;
+@property (assign) mt_bplist_t plist;
+@end
+
+@implementation MTLocalGroupRecord
+
+- (instancetype)initWithContentsOfFile:(NSString*)path
+{
+    self = [super init];
+    
+    if (self) {
+        
+        _recordData = (path) ? [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil] : nil;
+        
+        mt_bplist_t plist;
+        
+        if (_recordData && mt_bplist_init(&plist, [_recordData bytes], [_recordData length]) == 1) {
+            _plist = plist;
+        } else {
+            self = nil;
+        }
+    }
+    
+    return self;
+}
+
+- (MTLocalGroupMembership)membershipForUser:(NSString*)userName
+{
+    MTLocalGroupMembership membership = MTLocalGroupMembershipUnknown;
+    
+    if ([userName length] > 0) {
+        
+        mt_bplist_t plist = _plist;
+        uint64_t usersRef = 0;
+        int result = mt_bplist_dict_get(&plist, plist.topObject, kMTLocalGroupRecordKeyUsers, &usersRef);
+        
+        // the attribute is missing if the group has no users
+        if (result == 1) { result = mt_bplist_array_contains_string(&plist, usersRef, [userName UTF8String]); }
+        
+        if (result == 1) {
+            
+            membership = MTLocalGroupMembershipMember;
+            
+        } else if (result == 0) {
+            
+            // the user might still be a member of one of the nested groups
+            uint64_t nestedRef = 0;
+            uint64_t nestedCount = 0;
+            result = mt_bplist_dict_get(&plist, plist.topObject, kMTLocalGroupRecordKeyNestedGroups, &nestedRef);
+            
+            if (result == 0 || (result == 1 && mt_bplist_array_count(&plist, nestedRef, &nestedCount) == 1 && nestedCount == 0)) {
+                membership = MTLocalGroupMembershipNotMember;
+            }
+        }
+    }
+    
+    return membership;
+}
+
+- (NSArray<NSString*>*)stringsForKey:(const char*)key
+{
+    NSMutableArray *strings = [[NSMutableArray alloc] init];
+    mt_bplist_t plist = _plist;
+    uint64_t arrayRef = 0;
+    uint64_t count = 0;
+    
+    int result = mt_bplist_dict_get(&plist, plist.topObject, key, &arrayRef);
+    if (result == 1) { result = mt_bplist_array_count(&plist, arrayRef, &count); }
+    
+    for (uint64_t i = 0; result == 1 && i < count; i++) {
+        
+        uint64_t elementRef = 0;
+        const uint8_t *bytes = NULL;
+        size_t byteLength = 0;
+        int isUTF16 = 0;
+        
+        result = mt_bplist_array_get(&plist, arrayRef, i, &elementRef);
+        if (result == 1) { result = mt_bplist_string_get(&plist, elementRef, &bytes, &byteLength, &isUTF16); }
+        
+        if (result == 1) {
+            
+            NSString *string = [[NSString alloc] initWithBytes:bytes
+                                                        length:byteLength
+                                                      encoding:(isUTF16) ? NSUTF16BigEndianStringEncoding : NSASCIIStringEncoding
+            ];
+            
+            if (string) { [strings addObject:string]; } else { result = -1; }
+        }
+    }
+    
+    return (result < 0) ? nil : strings;
+}
+
+- (NSArray<NSString*>*)users
+{
+    return [self stringsForKey:kMTLocalGroupRecordKeyUsers];
+}
+
+- (NSArray<NSString*>*)groupMembers
+{
+    return [self stringsForKey:kMTLocalGroupRecordKeyGroupMembers];
+}
+
+- (NSArray<NSString*>*)nestedGroups
+{
+    return [self stringsForKey:kMTLocalGroupRecordKeyNestedGroups];
+}
+
+@end
@@ -298,6 +298,13 @@
  */
 - (MTPrivilegesLoggingConfiguration*)remoteLoggingConfiguration;
 
+/*!
+ @method        requestRateLimits
+ @abstract      Get the rate limits for privilege change requests.
+ @discussion    Returns a dictionary containing the rate limits per caller class or nil if no rate limits have been configured.
+ */
+- (NSDictionary*)requestRateLimits;
+
 /*!
  @method        hideSettingsButton
  @abstract      Get whether the app's "Settings" button should be hidden.
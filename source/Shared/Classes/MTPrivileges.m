@@ -412,6 +412,18 @@
     return loggingConfiguration;
 }
 
+- (NSDictionary*)requestRateLimits
+{
+    NSDictionary *rateLimits = nil;
+    
+    if ([_userDefaults objectIsForcedForKey:kMTDefaultsRequestRateLimitsKey]) {
+        
+        rateLimits = [_userDefaults dictionaryForKey:kMTDefaultsRequestRateLimitsKey];
+    }
+    
+    return rateLimits;
+}
+
 - (BOOL)runActionAfterGrantOnly
 {
     BOOL grantOnly = NO;
@@ -17,6 +17,7 @@
 
 #import <Foundation/Foundation.h>
 #import "MTSyslogOptions.h"
+#import "MTWebhookOptions.h"
 
 @interface MTPrivilegesLoggingConfiguration : NSObject
 
@@ -59,6 +60,13 @@
  */
 - (MTSyslogOptions*)syslogOptions;
 
+/*!
+ @method        webhookOptions
+ @abstract      Get the options configured for webhooks.
+ @discussion    Returns an MTWebhookOptions object initialized with the configured options.
+ */
+- (MTWebhookOptions*)webhookOptions;
+
 /*!
  @method        queueUnsentEvents
  @abstract      Get whether unsent remote logging events should be queued for resending.
@@ -66,6 +66,13 @@
     return options;
 }
 
+- (MTWebhookOptions*)webhookOptions
+{
+    MTWebhookOptions *options = [[MTWebhookOptions alloc] initWithDictionary:[_remoteLoggingConfiguration objectForKey:kMTDefaultsRemoteLoggingWebhookOptionsKey]];
+    
+    return options;
+}
+
 - (BOOL)queueUnsentEvents
 {
     BOOL queue = [[_remoteLoggingConfiguration objectForKey:kMTDefaultsRemoteLoggingQueueEventsKey] boolValue];
@@ -17,6 +17,7 @@
 
 #import <Foundation/Foundation.h>
 #import "MTIdentity.h"
+#import "MTStatePage.h"
 
 /*!
  @class         MTPrivilegesUser
@@ -35,7 +36,8 @@
 /*!
  @method        hasAdminPrivileges
  @abstract      Get whether the MTPrivilegesUser has administrator privileges.
- @discussion    Returns YES if the user has administrator privileges, otherwise returns NO.
+ @discussion    Returns YES if the user has administrator privileges, otherwise returns NO. The result
+                is cached in the shared MTGroupMembershipCache.
 */
 - (BOOL)hasAdminPrivileges;
 
@@ -59,9 +61,11 @@
  @abstract      Request administrator privileges for the current MTPrivilegesUser.
  @param         reason A string containing the reason the user requests administrator privileges. May be nil.
  @param         completionHandler The handler to call when the request is complete.
- @discussion    Returns YES if the operation was successful, otherwise returns NO.
+ @discussion    Returns YES if the operation was successful, otherwise returns NO. If the agent rejected the
+                request because too many requests have been sent, the error object has the code
+                kMTErrorCodeRateLimitExceeded.
 */
-- (void)requestAdminPrivilegesWithReason:(NSString*)reason completionHandler:(void(^)(BOOL success))completionHandler;
+- (void)requestAdminPrivilegesWithReason:(NSString*)reason completionHandler:(void(^)(BOOL success, NSError *error))completionHandler;
 
 /*!
  @method        revokeAdminPrivilegesWithCompletionHandler:
@@ -69,15 +73,17 @@
  @param         completionHandler The handler to call when the request is complete.
  @discussion    Returns YES if the operation was successful, otherwise returns NO.
 */
-- (void)revokeAdminPrivilegesWithCompletionHandler:(void(^)(BOOL success))completionHandler;
+- (void)revokeAdminPrivilegesWithCompletionHandler:(void(^)(BOOL success, NSError *error))completionHandler;
 
 /*!
  @method        renewAdminPrivilegesWithCompletionHandler:
  @abstract      Renew expiring administrator privileges for the current MTPrivilegesUser.
  @param         completionHandler The handler to call when the request is complete.
- @discussion    Returns YES if the operation was successful, otherwise returns NO.
+ @discussion    Returns YES if the operation was successful, otherwise returns NO. If the agent rejected the
+                request because too many requests have been sent, the error object has the code
+                kMTErrorCodeRateLimitExceeded.
 */
-- (void)renewAdminPrivilegesWithCompletionHandler:(void(^)(BOOL success))completionHandler;
+- (void)renewAdminPrivilegesWithCompletionHandler:(void(^)(BOOL success, NSError *error))completionHandler;
 
 /*!
  @method        authenticateWithCompletionHandler:
@@ -92,10 +98,30 @@
  @abstract      Get the date when the current user's administrator privileges expire.
  @param         reply The reply block to call when the request is complete.
  @discussion    Returns the expiration date and the number of minutes remaining. Expiration date will be nil
-                if the administrator privileges are already expired.
+                if the administrator privileges are already expired. If the agent published its state (see
+                getPublishedState:), the reply block is called right away, without connecting to the agent.
 */
 - (void)privilegesExpirationWithReply:(void(^)(NSDate *expire, NSUInteger remaining))reply;
 
+/*!
+ @method        rateLimiterStatisticsWithReply:
+ @abstract      Get the rate limits and counters of the agent for privilege change requests.
+ @param         reply The reply block to call when the request is complete.
+ @discussion    Returns a dictionary containing the caller classes as keys and dictionaries with the configured
+                limits and the number of admitted and rejected requests as values (see Constants.h) or nil if
+                an error occurred.
+*/
+- (void)rateLimiterStatisticsWithReply:(void(^)(NSDictionary *statistics))reply;
+
+/*!
+ @method        getPublishedState:
+ @abstract      Get the privilege state the agent published for the MTPrivilegesUser.
+ @param         state A pointer to a structure that receives the state.
+ @discussion    The state is read from shared memory, so no connection to the agent is needed. Returns YES
+                if the agent published a state and is still running, otherwise returns NO.
+*/
+- (BOOL)getPublishedState:(mt_state_t*)state;
+
 /*!
  @method        canExecuteFileAtURL:reply:
  @abstract      Get whether the current user can execute the file at the given url.
@@ -17,6 +17,7 @@
 
 #import "MTPrivilegesUser.h"
 #import "MTAgentConnection.h"
+#import "MTGroupMembershipCache.h"
 #import "Constants.h"
 #import <SystemConfiguration/SystemConfiguration.h>
 #import <pwd.h>
@@ -26,6 +27,7 @@
 @property (nonatomic, strong, readwrite) NSUserDefaults *userDefaults;
 @property (nonatomic, strong, readwrite) NSUserDefaults *appGroupDefaults;
 @property (nonatomic, strong, readwrite) NSString *userName;
+@property (assign) mt_state_page_t *statePage;
 @end
 
 @implementation MTPrivilegesUser
@@ -65,13 +67,61 @@
     return self;
 }
 
+- (void)dealloc
+{
+    mt_state_page_close(_statePage);
+}
+
 - (BOOL)hasAdminPrivileges
 {
-    NSError *error = nil;
-    BOOL isMember = [MTIdentity groupMembershipForUser:[self userName] groupID:kMTAdminGroupID error:&error];
+    BOOL isMember = NO;
+    MTGroupMembershipCache *membershipCache = [MTGroupMembershipCache sharedCache];
+    NSNumber *cachedMembership = [membershipCache membershipForUser:[self userName] groupID:kMTAdminGroupID];
+    
+    if (cachedMembership) {
+        
+        isMember = [cachedMembership boolValue];
+        
+    } else {
+        
+        NSError *error = nil;
+        NSUInteger cacheGeneration = [membershipCache generation];
+        isMember = [MTIdentity groupMembershipForUser:[self userName] groupID:kMTAdminGroupID error:&error];
+        
+        if (error) {
+            os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to get group membership for user %{public}@: %{public}@", [self userName], error);
+        } else {
+            [membershipCache setMembership:isMember forUser:[self userName] groupID:kMTAdminGroupID generation:cacheGeneration];
+        }
+    }
+    
+    return isMember;
+}
+
+- (BOOL)isMemberOfGroup:(NSString*)groupName
+{
+    BOOL isMember = NO;
+    
+    // resolve the group name only once, so the group's
+    // membership can be checked (and cached) by its id
+    int groupID = [MTIdentity gidFromGroupName:groupName];
     
-    if (error) {
-        os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to get group membership for user %{public}@: %{public}@", [self userName], error);
+    if (groupID != -1) {
+        
+        MTGroupMembershipCache *membershipCache = [MTGroupMembershipCache sharedCache];
+        NSNumber *cachedMembership = [membershipCache membershipForUser:[self userName] groupID:(gid_t)groupID];
+        
+        if (cachedMembership) {
+            
+            isMember = [cachedMembership boolValue];
+            
+        } else {
+            
+            NSError *error = nil;
+            NSUInteger cacheGeneration = [membershipCache generation];
+            isMember = [MTIdentity groupMembershipForUser:[self userName] groupID:(gid_t)groupID error:&error];
+            if (!error) { [membershipCache setMembership:isMember forUser:[self userName] groupID:(gid_t)groupID generation:cacheGeneration]; }
+        }
     }
     
     return isMember;
@@ -93,7 +143,7 @@
     }
 }
 
-- (void)requestAdminPrivilegesWithReason:(NSString *)reason completionHandler:(void (^)(BOOL success))completionHandler
+- (void)requestAdminPrivilegesWithReason:(NSString *)reason completionHandler:(void (^)(BOOL success, NSError *error))completionHandler
 {
     [_agentConnection connectToAgentWithExportedObject:nil
                                 andExecuteCommandBlock:^{
@@ -101,16 +151,16 @@
         [[[self->_agentConnection connection] remoteObjectProxyWithErrorHandler:^(NSError *error) {
             
             os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to connect to agent: %{public}@", error);
-            if (completionHandler) { completionHandler(NO); }
+            if (completionHandler) { completionHandler(NO, error); }
             
-        }] requestAdminRightsWithReason:reason completionHandler:^(BOOL success) {
+        }] requestAdminRightsWithReason:reason completionHandler:^(BOOL success, NSError *error) {
            
-            if (completionHandler) { completionHandler(success); }
+            if (completionHandler) { completionHandler(success, error); }
         }];
     }];
 }
 
-- (void)revokeAdminPrivilegesWithCompletionHandler:(void (^)(BOOL success))completionHandler
+- (void)revokeAdminPrivilegesWithCompletionHandler:(void (^)(BOOL success, NSError *error))completionHandler
 {
     [_agentConnection connectToAgentWithExportedObject:nil
                                     andExecuteCommandBlock:^{
@@ -118,16 +168,16 @@
         [[[self->_agentConnection connection] remoteObjectProxyWithErrorHandler:^(NSError *error) {
             
             os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to connect to agent: %{public}@", error);
-            if (completionHandler) { completionHandler(NO); }
+            if (completionHandler) { completionHandler(NO, error); }
             
-        }] revokeAdminRightsWithCompletionHandler:^(BOOL success) {
+        }] revokeAdminRightsWithCompletionHandler:^(BOOL success, NSError *error) {
           
-            if (completionHandler) { completionHandler(success); }
+            if (completionHandler) { completionHandler(success, error); }
         }];
     }];
 }
 
-- (void)renewAdminPrivilegesWithCompletionHandler:(void (^)(BOOL success))completionHandler
+- (void)renewAdminPrivilegesWithCompletionHandler:(void (^)(BOOL success, NSError *error))completionHandler
 {
     [_agentConnection connectToAgentWithExportedObject:nil
                                     andExecuteCommandBlock:^{
@@ -135,11 +185,11 @@
         [[[self->_agentConnection connection] remoteObjectProxyWithErrorHandler:^(NSError *error) {
             
             os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to connect to agent: %{public}@", error);
-            if (completionHandler) { completionHandler(NO); }
+            if (completionHandler) { completionHandler(NO, error); }
             
-        }] renewAdminRightsWithCompletionHandler:^(BOOL success) {
+        }] renewAdminRightsWithCompletionHandler:^(BOOL success, NSError *error) {
           
-            if (completionHandler) { completionHandler(success); }
+            if (completionHandler) { completionHandler(success, error); }
         }];
     }];
 }
@@ -162,6 +212,35 @@
 }
 
 - (void)privilegesExpirationWithReply:(void (^)(NSDate *expire, NSUInteger remaining))reply
+{
+    mt_state_t state;
+    
+    if ([self getPublishedState:&state]) {
+        
+        NSDate *expirationDate = (state.expirationTime > 0) ? [NSDate dateWithTimeIntervalSince1970:state.expirationTime] : nil;
+        NSTimeInterval timeLeft = [expirationDate timeIntervalSinceNow];
+        
+        if (reply) { reply(expirationDate, (timeLeft > 0) ? (NSUInteger)ceil(timeLeft / 60.0) : 0); }
+        
+    } else {
+        
+        [_agentConnection connectToAgentWithExportedObject:nil
+                                    andExecuteCommandBlock:^{
+            
+            [[[self->_agentConnection connection] remoteObjectProxyWithErrorHandler:^(NSError *error) {
+                
+                os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to connect to agent: %{public}@", error);
+                if (reply) { reply(nil, 0); }
+                
+            }] expirationWithReply:^(NSDate *expires, NSUInteger remaining) {
+                
+                if (reply) { reply(expires, remaining); }
+            }];
+        }];
+    }
+}
+
+- (void)rateLimiterStatisticsWithReply:(void (^)(NSDictionary *statistics))reply
 {
     [_agentConnection connectToAgentWithExportedObject:nil
                                 andExecuteCommandBlock:^{
@@ -169,15 +248,44 @@
         [[[self->_agentConnection connection] remoteObjectProxyWithErrorHandler:^(NSError *error) {
             
             os_log_with_type(OS_LOG_DEFAULT, OS_LOG_TYPE_FAULT, "SAPCorp: Failed to connect to agent: %{public}@", error);
-            if (reply) { reply(nil, 0); }
+            if (reply) { reply(nil); }
             
-        }] expirationWithReply:^(NSDate *expires, NSUInteger remaining) {
-         
-            if (reply) { reply(expires, remaining); }
+        }] rateLimiterStatisticsWithReply:^(NSDictionary *statistics) {
+            
+            if (reply) { reply(statistics); }
         }];
     }];
 }
 
+- (BOOL)getPublishedState:(mt_state_t*)state
+{
+    BOOL success = NO;
+    
+    @synchronized (self) {
+        
+        // the agent creates the page when it's launched, so
+        // we try again next time if it does not exist yet
+        if (!_statePage) {
+            
+            struct passwd *pw = getpwnam([_userName UTF8String]);
+            
+            if (pw) {
+                
+                char statePageName[32];
+                snprintf(statePageName, sizeof(statePageName), kMTStatePageNameFormat, pw->pw_uid);
+                _statePage = mt_state_page_open(statePageName, pw->pw_uid, false);
+            }
+        }
+        
+        // the state is outdated if the agent that published it is not running anymore
+        if (_statePage && mt_state_page_read(_statePage, state)) {
+            success = mt_state_writer_is_running(state);
+        }
+    }
+    
+    return success;
+}
+
 - (void)canExecuteFileAtURL:(NSURL*)url reply:(void (^)(BOOL canExecute))reply
 {
     [_agentConnection connectToAgentWithExportedObject:nil
@@ -226,13 +334,13 @@
         
         if ([limitToGroup isKindOfClass:[NSString class]]) {
             
-            groupRestricted = ![MTIdentity groupMembershipForUser:_userName groupName:limitToGroup error:nil];
+            groupRestricted = ![self isMemberOfGroup:limitToGroup];
             
         } else if ([limitToGroup isKindOfClass:[NSArray class]]) {
             
             for (NSString *groupName in limitToGroup) {
                 
-                if ([MTIdentity groupMembershipForUser:_userName groupName:groupName error:nil]) {
+                if ([groupName isKindOfClass:[NSString class]] && [self isMemberOfGroup:groupName]) {
                     groupRestricted = NO;
                     break;
                 }
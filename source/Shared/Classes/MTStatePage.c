@@ -0,0 +1,270 @@
+/*
+    MTStatePage.c
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "MTStatePage.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+#define MT_STATE_PAGE_MAGIC             0x53565250      // "PRVS"
+#define MT_STATE_PAGE_VERSION           2
+#define MT_STATE_PAGE_MODE              0600
+#define MT_STATE_PAGE_LENGTH            4096            // room for future versions of the layout
+#define MT_STATE_PAGE_MAX_ATTEMPTS      1024
+
+#define MT_STATE_FLAG_ADMIN             0x1
+#define MT_STATE_ENFORCEMENT_SHIFT      8
+#define MT_STATE_ENFORCEMENT_MASK       0xFF
+
+// the layout of the shared memory object. All fields are accessed atomically,
+// so readers never race with the writer in terms of the C memory model
+typedef struct {
+    _Atomic uint32_t magic;
+    _Atomic uint32_t version;
+    _Atomic uint32_t sequence;          // 0 = never written, odd = being written
+    _Atomic int32_t writerPID;
+    _Atomic uint64_t writerStartTime;
+    _Atomic uint64_t flags;
+    _Atomic int64_t expirationTime;
+    _Atomic uint64_t configGeneration;
+} mt_state_page_layout_t;
+
+struct mt_state_page {
+    mt_state_page_layout_t *layout;
+    uint64_t startTime;                 // of the writing process
+    bool writable;
+};
+
+// returns the start time of the given process (in microseconds since 1970)
+// or 0 if it cannot be determined
+static uint64_t mt_state_process_start_time(pid_t pid)
+{
+    uint64_t startTime = 0;
+    
+#if defined(__APPLE__)
+    struct kinfo_proc processInfo;
+    size_t length = sizeof(processInfo);
+    int mib[4] = { CTL_KERN, KERN_PROC, KERN_PROC_PID, pid };
+    
+    if (sysctl(mib, 4, &processInfo, &length, NULL, 0) == 0 && length == sizeof(processInfo) && processInfo.kp_proc.p_pid == pid) {
+        startTime = (uint64_t)processInfo.kp_proc.p_starttime.tv_sec * 1000000 + (uint64_t)processInfo.kp_proc.p_starttime.tv_usec;
+    }
+#else
+    (void)pid;
+#endif
+    
+    return startTime;
+}
+
+// opens the shared memory object. Objects that are accessible by other users
+// (created by earlier versions) are replaced when opened for writing
+static int mt_state_page_open_object(const char *name, bool writable)
+{
+    int fd = shm_open(name, (writable) ? (O_RDWR | O_CREAT) : O_RDONLY, MT_STATE_PAGE_MODE);
+    struct stat fileInfo;
+    
+    if (fd >= 0 && writable && fstat(fd, &fileInfo) == 0 && (fileInfo.st_mode & (S_IRWXG | S_IRWXO)) != 0 &&
+        fchmod(fd, MT_STATE_PAGE_MODE) != 0) {
+        
+        close(fd);
+        shm_unlink(name);
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, MT_STATE_PAGE_MODE);
+    }
+    
+    return fd;
+}
+
+mt_state_page_t *mt_state_page_open(const char *name, uid_t owner, bool writable)
+{
+    mt_state_page_t *page = NULL;
+    
+    if (writable && owner != geteuid()) {
+        
+        errno = EPERM;
+        
+    } else {
+        
+        int fd = mt_state_page_open_object(name, writable);
+        
+        if (fd >= 0) {
+            
+            struct stat fileInfo;
+            int result = fstat(fd, &fileInfo);
+            
+            // a shared memory object of another user could have been
+            // created on purpose, so we never use it
+            if (result == 0 && fileInfo.st_uid != owner) {
+                
+                errno = EACCES;
+                result = -1;
+            }
+            
+            // the size of a shared memory object can only be set once on macOS
+            if (result == 0 && writable && fileInfo.st_size == 0) {
+                
+                result = ftruncate(fd, MT_STATE_PAGE_LENGTH);
+                fileInfo.st_size = MT_STATE_PAGE_LENGTH;
+            }
+            
+            if (result == 0 && fileInfo.st_size < (off_t)sizeof(mt_state_page_layout_t)) {
+                
+                errno = EINVAL;
+                result = -1;
+            }
+            
+            if (result == 0) {
+                
+                void *map = mmap(NULL, sizeof(mt_state_page_layout_t), (writable) ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+                page = (map != MAP_FAILED) ? calloc(1, sizeof(mt_state_page_t)) : NULL;
+                
+                if (page) {
+                    
+                    page->layout = map;
+                    page->writable = writable;
+                    if (writable) { page->startTime = mt_state_process_start_time(getpid()); }
+                    
+                } else if (map != MAP_FAILED) {
+                    
+                    munmap(map, sizeof(mt_state_page_layout_t));
+                }
+            }
+            
+            int savedErrno = errno;
+            close(fd);
+            errno = savedErrno;
+        }
+    }
+    
+    if (page && writable) {
+        
+        mt_state_page_layout_t *layout = page->layout;
+        
+        // pages of an incompatible version are taken over. The magic
+        // number is written last, so readers ignore the page until then
+        if (atomic_load_explicit(&layout->magic, memory_order_acquire) != MT_STATE_PAGE_MAGIC ||
+            atomic_load_explicit(&layout->version, memory_order_relaxed) != MT_STATE_PAGE_VERSION) {
+            
+            atomic_store_explicit(&layout->magic, 0, memory_order_relaxed);
+            atomic_store_explicit(&layout->sequence, 0, memory_order_relaxed);
+            atomic_store_explicit(&layout->version, MT_STATE_PAGE_VERSION, memory_order_relaxed);
+            atomic_store_explicit(&layout->magic, MT_STATE_PAGE_MAGIC, memory_order_release);
+        }
+    }
+    
+    return page;
+}
+
+void mt_state_page_close(mt_state_page_t *page)
+{
+    if (page) {
+        
+        munmap(page->layout, sizeof(mt_state_page_layout_t));
+        free(page);
+    }
+}
+
+void mt_state_page_write(mt_state_page_t *page, const mt_state_t *state)
+{
+    if (page->writable) {
+        
+        mt_state_page_layout_t *layout = page->layout;
+        uint64_t flags = ((uint64_t)(state->enforcement & MT_STATE_ENFORCEMENT_MASK) << MT_STATE_ENFORCEMENT_SHIFT);
+        if (state->hasAdminPrivileges) { flags |= MT_STATE_FLAG_ADMIN; }
+        
+        // if a previous writer died while writing, the sequence number is
+        // odd and we just continue with the next even number. 0 is skipped,
+        // because it means the page has never been written
+        uint32_t sequence = atomic_load_explicit(&layout->sequence, memory_order_relaxed);
+        uint32_t nextSequence = (sequence + 2) & ~1U;
+        if (nextSequence == 0) { nextSequence = 2; }
+        
+        atomic_store_explicit(&layout->sequence, nextSequence - 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        
+        atomic_store_explicit(&layout->writerPID, (int32_t)getpid(), memory_order_relaxed);
+        atomic_store_explicit(&layout->writerStartTime, page->startTime, memory_order_relaxed);
+        atomic_store_explicit(&layout->flags, flags, memory_order_relaxed);
+        atomic_store_explicit(&layout->expirationTime, state->expirationTime, memory_order_relaxed);
+        atomic_store_explicit(&layout->configGeneration, state->configGeneration, memory_order_relaxed);
+        
+        atomic_store_explicit(&layout->sequence, nextSequence, memory_order_release);
+    }
+}
+
+bool mt_state_page_read(const mt_state_page_t *page, mt_state_t *state)
+{
+    bool success = false;
+    mt_state_page_layout_t *layout = page->layout;
+    
+    if (atomic_load_explicit(&layout->magic, memory_order_acquire) == MT_STATE_PAGE_MAGIC &&
+        atomic_load_explicit(&layout->version, memory_order_relaxed) == MT_STATE_PAGE_VERSION) {
+        
+        for (int attempt = 0; attempt < MT_STATE_PAGE_MAX_ATTEMPTS && !success; attempt++) {
+            
+            uint32_t sequence = atomic_load_explicit(&layout->sequence, memory_order_acquire);
+            if (sequence == 0) { break; }
+            
+            if ((sequence & 1) == 0) {
+                
+                int32_t writerPID = atomic_load_explicit(&layout->writerPID, memory_order_relaxed);
+                uint64_t writerStartTime = atomic_load_explicit(&layout->writerStartTime, memory_order_relaxed);
+                uint64_t flags = atomic_load_explicit(&layout->flags, memory_order_relaxed);
+                int64_t expirationTime = atomic_load_explicit(&layout->expirationTime, memory_order_relaxed);
+                uint64_t configGeneration = atomic_load_explicit(&layout->configGeneration, memory_order_relaxed);
+                
+                // make sure the fields have been read before checking the sequence number again
+                atomic_thread_fence(memory_order_acquire);
+                
+                if (atomic_load_explicit(&layout->sequence, memory_order_relaxed) == sequence) {
+                    
+                    state->hasAdminPrivileges = ((flags & MT_STATE_FLAG_ADMIN) != 0);
+                    state->expirationTime = expirationTime;
+                    state->enforcement = (MTStateEnforcement)((flags >> MT_STATE_ENFORCEMENT_SHIFT) & MT_STATE_ENFORCEMENT_MASK);
+                    state->configGeneration = configGeneration;
+                    state->writerPID = (pid_t)writerPID;
+                    state->writerStartTime = writerStartTime;
+                    success = true;
+                }
+            }
+            
+            if (!success && (attempt & 63) == 63) { sched_yield(); }
+        }
+    }
+    
+    return success;
+}
+
+bool mt_state_writer_is_running(const mt_state_t *state)
+{
+    bool isRunning = (state->writerPID > 0 && (kill(state->writerPID, 0) == 0 || errno == EPERM));
+    
+    // the process id might have been reused by another process
+    // since the state has been written, so the start time must
+    // match as well
+    if (isRunning) { isRunning = (mt_state_process_start_time(state->writerPID) == state->writerStartTime); }
+    
+    return isRunning;
+}
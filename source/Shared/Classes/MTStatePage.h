@@ -0,0 +1,107 @@
+/*
+    MTStatePage.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTStatePage_h
+#define MTStatePage_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+    A small, versioned record of a user's privilege state, published by the agent in a POSIX
+    shared memory object, so other processes can read the state without any IPC. The record is
+    guarded by a sequence lock: the writer makes the sequence number odd before and even again
+    after changing the record, and readers retry until they read the same even sequence number
+    before and after copying the record. So readers never block the writer and never see a
+    partially written record.
+ 
+    There must only be one writer per page. Readers check that the shared memory object belongs
+    to the expected user, so other users cannot make them read a forged record. The module only
+    depends on POSIX and C11 atomics, so it can be tested on other platforms as well.
+*/
+
+typedef enum {
+    MTStateEnforcementNotEnforced   = 0,
+    MTStateEnforcementNone          = 1,
+    MTStateEnforcementAdmin         = 2,
+    MTStateEnforcementUser          = 3
+} MTStateEnforcement;
+
+typedef struct {
+    bool hasAdminPrivileges;
+    int64_t expirationTime;             // in seconds since 1970, 0 if the privileges do not expire
+    MTStateEnforcement enforcement;
+    uint64_t configGeneration;          // changes whenever the configuration changed
+    pid_t writerPID;                    // set by mt_state_page_write
+    uint64_t writerStartTime;           // set by mt_state_page_write
+} mt_state_t;
+
+typedef struct mt_state_page mt_state_page_t;
+
+/*!
+ @function      mt_state_page_open
+ @abstract      Opens the state page with the given name.
+ @param         name A null-terminated string containing the name of the shared memory object.
+ @param         owner The id of the user the shared memory object must belong to.
+ @param         writable Pass true to open the page for writing. The page is created if it does not
+                exist and is only accessible by its owner. Only the owner can open a page for writing.
+ @discussion    Returns the page or NULL if an error occurred (errno is set). The caller is responsible
+                for closing the page using mt_state_page_close.
+*/
+mt_state_page_t *mt_state_page_open(const char *name, uid_t owner, bool writable);
+
+/*!
+ @function      mt_state_page_close
+ @abstract      Closes the given page.
+ @param         page A pointer to the page. May be NULL.
+ @discussion    The shared memory object is not removed, so readers can still read the last state.
+*/
+void mt_state_page_close(mt_state_page_t *page);
+
+/*!
+ @function      mt_state_page_write
+ @abstract      Publishes the given state.
+ @param         page A pointer to a page that has been opened for writing.
+ @param         state A pointer to the state. Its writerPID and writerStartTime are ignored and replaced
+                with the id and the start time of the calling process.
+ @discussion    Never blocks and does not make any system calls.
+*/
+void mt_state_page_write(mt_state_page_t *page, const mt_state_t *state);
+
+/*!
+ @function      mt_state_page_read
+ @abstract      Reads the state from the given page.
+ @param         page A pointer to the page.
+ @param         state A pointer to a structure that receives the state.
+ @discussion    Returns true if a consistent state has been read. Returns false if no state has been
+                published yet, if the page has been written by an incompatible version or if the
+                writer kept changing the state (or died while writing it).
+*/
+bool mt_state_page_read(const mt_state_page_t *page, mt_state_t *state);
+
+/*!
+ @function      mt_state_writer_is_running
+ @abstract      Returns whether the process that published the given state is still running.
+ @param         state A pointer to a state returned by mt_state_page_read.
+ @discussion    Compares the start time of the process as well, so a process that reused the
+                writer's process id is not mistaken for the writer. On platforms other than macOS
+                only the process id is checked.
+*/
+bool mt_state_writer_is_running(const mt_state_t *state);
+
+#endif /* MTStatePage_h */
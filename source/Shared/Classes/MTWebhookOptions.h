@@ -0,0 +1,78 @@
+/*
+    MTWebhookOptions.h
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+  @enum Webhook Content Encoding
+  @discussion Specifies the content encoding used for the webhook request body. MTWebhookContentEncodingNone
+              sends the body uncompressed, MTWebhookContentEncodingGzip compresses it using gzip (RFC 1952) and
+              MTWebhookContentEncodingDeflate compresses it using the zlib format (RFC 1950).
+*/
+typedef enum {
+    MTWebhookContentEncodingNone    = 0,
+    MTWebhookContentEncodingGzip    = 1,
+    MTWebhookContentEncodingDeflate = 2
+} MTWebhookContentEncoding;
+
+@interface MTWebhookOptions : NSObject
+
+/*!
+ @method        init
+ @discussion    The init method is not available. Please use initWithDictionary: instead.
+ */
+- (instancetype)init NS_UNAVAILABLE;
+
+/*!
+ @method        initWithDictionary:
+ @abstract      Initialize a MTWebhookOptions object with a given dictionary.
+ @param         dict An NSDictionary containing the webhook options.
+ @discussion    Returns an initialized MTWebhookOptions object.
+*/
+- (instancetype)initWithDictionary:(NSDictionary*)dict NS_DESIGNATED_INITIALIZER;
+
+/*!
+ @method        contentEncoding
+ @abstract      Get the content encoding used for the webhook request body.
+ @discussion    Returns the configured content encoding or MTWebhookContentEncodingNone if no (or an unsupported)
+                content encoding has been configured.
+ */
+- (MTWebhookContentEncoding)contentEncoding;
+
+/*!
+ @method        compressionThreshold
+ @abstract      Get the minimum size of a request body (in bytes) before it is compressed.
+ @discussion    Returns the configured threshold or kMTWebhookCompressionThresholdDefault if no threshold has been configured.
+ */
+- (NSUInteger)compressionThreshold;
+
+/*!
+ @method        compressionLevel
+ @abstract      Get the compression level used for the webhook request body.
+ @discussion    Returns the configured compression level (1-9) or kMTWebhookCompressionLevelDefault if no valid
+                compression level has been configured.
+ */
+- (NSInteger)compressionLevel;
+
+/*!
+ @method        warmUpConnection
+ @abstract      Get whether the connection to the webhook should be established before an event is posted.
+ @discussion    Returns YES if warming up the connection has been enabled, otherwise returns NO.
+ */
+- (BOOL)warmUpConnection;
+
+@end
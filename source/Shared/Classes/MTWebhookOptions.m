@@ -0,0 +1,86 @@
+/*
+    MTWebhookOptions.m
+    Copyright 2016-2026 SAP SE
+     
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+     
+    http://www.apache.org/licenses/LICENSE-2.0
+     
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#import "MTWebhookOptions.h"
+#import "Constants.h"
+
+@interface MTWebhookOptions ()
+@property (nonatomic, strong, readwrite) NSDictionary *webhookOptions;
+@end
+
+@implementation MTWebhookOptions
+
+- (instancetype)initWithDictionary:(NSDictionary *)dict
+{
+    self = [super init];
+    
+    if (self) {
+        
+        _webhookOptions = dict;
+    }
+    
+    return self;
+}
+
+- (MTWebhookContentEncoding)contentEncoding
+{
+    MTWebhookContentEncoding encoding = MTWebhookContentEncodingNone;
+    id encodingValue = [_webhookOptions objectForKey:kMTDefaultsRemoteLoggingWebhookEncodingKey];
+    
+    if ([encodingValue isKindOfClass:[NSString class]]) {
+        
+        NSString *encodingString = [encodingValue lowercaseString];
+        
+        if ([encodingString isEqualToString:@"gzip"]) {
+            encoding = MTWebhookContentEncodingGzip;
+        } else if ([encodingString isEqualToString:@"deflate"]) {
+            encoding = MTWebhookContentEncodingDeflate;
+        }
+    }
+    
+    return encoding;
+}
+
+- (NSUInteger)compressionThreshold
+{
+    NSUInteger threshold = kMTWebhookCompressionThresholdDefault;
+    
+    if ([_webhookOptions objectForKey:kMTDefaultsRemoteLoggingWebhookThresholdKey]) {
+        
+        NSInteger thresholdValue = [[_webhookOptions objectForKey:kMTDefaultsRemoteLoggingWebhookThresholdKey] integerValue];
+        if (thresholdValue >= 0) { threshold = thresholdValue; }
+    }
+    
+    return threshold;
+}
+
+- (NSInteger)compressionLevel
+{
+    NSInteger level = [[_webhookOptions objectForKey:kMTDefaultsRemoteLoggingWebhookLevelKey] integerValue];
+    if (level < 1 || level > 9) { level = kMTWebhookCompressionLevelDefault; }
+    
+    return level;
+}
+
+- (BOOL)warmUpConnection
+{
+    BOOL warmUp = [[_webhookOptions objectForKey:kMTDefaultsRemoteLoggingWebhookWarmUpKey] boolValue];
+    
+    return warmUp;
+}
+
+@end
@@ -22,6 +22,7 @@
 #define kMTExtensionMachServiceName                 @"corp.sap.privileges.extension.xpc"
 #define kMTXPCServiceName                           @"corp.sap.privileges.xpcservice"
 #define kMTQueuedEventsPlistName                    @"QueuedEvents.plist"
+#define kMTAuditLogName                             @"AuditLog"
 #define kMTAppBundleIdentifier                      @"corp.sap.privileges"
 #define kMTAgentBundleIdentifier                    @"corp.sap.privileges.agent"
 #define kMTCLIBundleIdentifier                      @"corp.sap.privileges.cli"
@@ -31,11 +32,15 @@
 #define kMTAppGroupIdentifier                       @"7R5ZEU67FQ.corp.sap.privileges"
 #define kMTDockTilePluginBundleIdentifier           @"corp.sap.privileges.docktileplugin"
 #define kMTErrorDomain                              @"corp.sap.privileges.ErrorDomain"
+#define kMTErrorRetryAfterKey                       @"RetryAfter"
 #define kMTWebhookEventTypeGranted                  @"corp.sap.privileges.granted"
 #define kMTWebhookEventTypeRevoked                  @"corp.sap.privileges.revoked"
 #define kMTGitHubURL                                @"https://github.com/SAP/macOS-enterprise-privileges"
 #define kMTDiskutilPath                             @"/usr/sbin/diskutil"
 #define kMTspctlPath                                @"/usr/sbin/spctl"
+#define kMTPackageSignerPattern                     @"Developer ID Installer:.*(7R5ZEU67FQ)"
+#define kMTAdminGroupRecordPath                     @"/var/db/dslocal/nodes/Default/groups/admin.plist"
+#define kMTStatePageNameFormat                      "/corp.sap.privileges.%u"
 
 #define kMTAdminGroupID                             80
 #define kMTExpirationDefault                        20
@@ -43,10 +48,27 @@
 #define kMTReasonMaxLengthDefault                   250
 #define kMTFixedExpirationIntervals                 @[@0, @5, @10, @20, @30, @60]
 #define kMTRemoteLoggingRetryIntervals              @[@300, @900, @1800, @3600]
+#define kMTRemoteLoggingWarmUpIdleTimeout           120
 #define kMTRevokeAtLoginThreshold                   60
 #define kMTQueuedEventsMaxDefault                   20
 #define kMTQueuedEventsTreatAsDelayedInterval       5
+#define kMTWebhookCompressionThresholdDefault       1024
+#define kMTWebhookCompressionLevelDefault           6
 #define kMTRenewalNotificationIntervalDefault       1
+#define kMTGroupMembershipCacheMaxAge               30
+#define kMTPrebootUpdateDebounceInterval            5
+#define kMTPrivilegeChangeTimeout                   30
+#define kMTExtensionDeadlineSafetyMargin            1
+#define kMTErrorCodeRateLimitExceeded               429
+#define kMTPackageValidationCacheTimeout            60
+#define kMTProcessLineageCapacity                   8192
+#define kMTAdminGroupChangeDebounceInterval         1
+#define kMTWatcherIdleTimeout                       300
+#define kMTExpirationUpdateTolerance                1
+#define kMTStatusItemUpdateTolerance                .1
+#define kMTStatusItemAnimationInterval              .03
+#define kMTStatusItemAnimationTolerance             .005
+#define kMTRemoteLoggingDeadlineTolerance           10
 
 #define kMTEnforcedPrivilegeTypeNone                @"none"
 #define kMTEnforcedPrivilegeTypeAdmin               @"admin"
@@ -72,6 +94,13 @@
 #define kMTDefaultsReasonPresetsKey                         @"ReasonPresetList"
 #define kMTDefaultsReasonCheckingEnabledKey                 @"ReasonCheckingEnabled"
 #define kMTDefaultsReasonStrictPresetsKey                   @"ReasonStrictPresetList"
+#define kMTDefaultsRequestRateLimitsKey                     @"RequestRateLimits"
+#define kMTDefaultsRequestRateLimitCLIKey                   @"CLI"
+#define kMTDefaultsRequestRateLimitGUIKey                   @"GUI"
+#define kMTDefaultsRequestRateLimitRenewalKey               @"Renewal"
+#define kMTDefaultsRequestRateLimitTimerKey                 @"Timer"
+#define kMTDefaultsRequestRateLimitCapacityKey              @"Capacity"
+#define kMTDefaultsRequestRateLimitRefillIntervalKey        @"RefillInterval"
 #define kMTDefaultsRemoteLoggingKey                         @"RemoteLogging"
 #define kMTDefaultsRemoteLoggingServerTypeKey               @"ServerType"
 #define kMTDefaultsRemoteLoggingServerAddressKey            @"ServerAddress"
@@ -84,6 +113,11 @@
 #define kMTDefaultsRemoteLoggingSyslogFormatKey             @"MessageFormat"
 #define kMTDefaultsRemoteLoggingSyslogSDKey                 @"StructuredData"
 #define kMTDefaultsRemoteLoggingWebhookDataKey              @"WebhookCustomData"
+#define kMTDefaultsRemoteLoggingWebhookOptionsKey           @"WebhookOptions"
+#define kMTDefaultsRemoteLoggingWebhookEncodingKey          @"ContentEncoding"
+#define kMTDefaultsRemoteLoggingWebhookThresholdKey         @"CompressionThreshold"
+#define kMTDefaultsRemoteLoggingWebhookLevelKey             @"CompressionLevel"
+#define kMTDefaultsRemoteLoggingWebhookWarmUpKey            @"WarmUpConnection"
 #define kMTDefaultsRemoteLoggingQueueEventsKey              @"QueueUnsentEvents"
 #define kMTDefaultsRemoteLoggingQueuedEventsMaxKey          @"QueuedEventsMax"
 #define kMTDefaultsHideOtherWindowsKey                      @"HideOtherWindows"
@@ -120,6 +154,9 @@
 #define kMTDefaultsIconAppearanceThemeKey                   @"AppleIconAppearanceTheme"
 #define kMTDefaultsIconAppearanceTintColorKey               @"AppleIconAppearanceTintColor"
 #define kMTDefaultsEnableSystemExtensionKey                 @"EnableSystemExtension"
+#define kMTDefaultsAdditionalProtectedPathsKey              @"AdditionalProtectedPaths"
+#define kMTDefaultsRecordEventsPathKey                      @"RecordEventsPath"
+#define kMTDefaultsAdminGroupSnapshotKey                    @"AdminGroupSnapshot"
 
 // NSNotification
 #define kMTNotificationNamePrivilegesDidChange      @"corp.sap.privileges.PrivilegesDidChange"
@@ -129,13 +166,38 @@
 #define kMTNotificationActionIdentifierRenew        @"corp.sap.privileges.action.renew"
 #define kMTNotificationNameAdminGroupDidChange      @"corp.sap.privileges.AdminGroupDidChange"
 #define kMTNotificationNameScreenIsLocked           @"com.apple.screenIsLocked"
+#define kMTNotificationNameGroupCacheInvalidated    "com.apple.system.DirectoryService.InvalidateCache.group"
 
 // NSNotification user info keys
 #define kMTNotificationKeyTimeLeft                  @"TimeLeft"
 #define kMTNotificationKeyPreferencesChanged        @"PreferenceKey"
+#define kMTNotificationKeyAddedUsers                @"AddedUsers"
+#define kMTNotificationKeyRemovedUsers              @"RemovedUsers"
 
 // System extension status
 #define kMTExtensionStatusEnabled       @"enabled"
 #define kMTExtensionStatusDisabled      @"disabled"
 #define kMTExtensionStatusSuspended     @"suspended"
 #define kMTExtensionStatusWaiting       @"waiting for full disk access"
+
+// System extension statistics
+#define kMTExtensionStatisticsFileEventsKey         @"FileEvents"
+#define kMTExtensionStatisticsExecEventsKey         @"ExecEvents"
+#define kMTExtensionStatisticsEventCountKey         @"EventCount"
+#define kMTExtensionStatisticsNearMissesKey         @"DeadlineNearMisses"
+#define kMTExtensionStatisticsAverageSlackKey       @"AverageDeadlineSlack"
+#define kMTExtensionStatisticsMinimumSlackKey       @"MinimumDeadlineSlack"
+#define kMTExtensionStatisticsCacheHitsKey          @"VerdictCacheHits"
+#define kMTExtensionStatisticsCacheMissesKey        @"VerdictCacheMisses"
+#define kMTExtensionStatisticsCacheHitRateKey       @"VerdictCacheHitRate"
+#define kMTExtensionStatisticsPackageValidationKey  @"PackageValidation"
+#define kMTExtensionStatisticsProcessLineageKey     @"ProcessLineage"
+#define kMTExtensionStatisticsTrackedProcessesKey   @"TrackedProcesses"
+#define kMTExtensionStatisticsEvictedProcessesKey   @"EvictedProcesses"
+#define kMTExtensionStatisticsDroppedProcessesKey   @"DroppedProcesses"
+
+// Rate limiter statistics
+#define kMTRateLimiterStatisticsCapacityKey         @"Capacity"
+#define kMTRateLimiterStatisticsRefillIntervalKey   @"RefillInterval"
+#define kMTRateLimiterStatisticsAdmittedKey         @"Admitted"
+#define kMTRateLimiterStatisticsRejectedKey         @"Rejected"
@@ -0,0 +1,461 @@
+/*
+    main.c
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    Tests the audit store against a simple in-memory model. Every record that is appended to the
+    store is also appended to the model, and every query is answered by scanning the model, so the
+    indexes of the store must produce the same records in the same order. The stores are created in
+    a temporary directory that is removed afterwards.
+    
+    mt-audit-test [records]
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include "MTAuditStore.h"
+#include "MTTestSupport.h"
+
+#define MODEL_MAX_RECORDS   20000
+#define MODEL_MAX_STRING    64
+
+typedef struct {
+    int64_t timestamp;
+    uint32_t duration;
+    uint8_t action;
+    char user[MODEL_MAX_STRING];
+    char reason[MODEL_MAX_STRING];
+    char component[MODEL_MAX_STRING];
+} model_record_t;
+
+typedef struct {
+    const model_record_t *expected[MODEL_MAX_RECORDS];
+    size_t expectedCount;
+    size_t position;
+    size_t mismatches;
+    size_t stopAfter;
+} query_context_t;
+
+static char storeDirectory[PATH_MAX - 64];
+static unsigned long storeCount = 0;
+static unsigned long fuzzRecords = 5000;
+static model_record_t *model = NULL;
+static size_t modelCount = 0;
+
+#pragma mark - Helpers
+
+static void new_store(char *basePath)
+{
+    snprintf(basePath, PATH_MAX, "%s/store%lu", storeDirectory, ++storeCount);
+    modelCount = 0;
+}
+
+static void remove_store(const char *basePath)
+{
+    static const char *extensions[] = { "dat", "idx", "usr" };
+    char path[PATH_MAX + 8];
+    
+    for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); i++) {
+        
+        snprintf(path, sizeof(path), "%s.%s", basePath, extensions[i]);
+        unlink(path);
+    }
+}
+
+// appends the record to the store and to the model. Like the store, the model
+// calculates the duration of a revoke from the user's previous record
+static int append_record(const char *basePath, int64_t timestamp, uint8_t action, uint32_t duration, const char *user, const char *reason, const char *component)
+{
+    mt_audit_record_t record = {
+        .timestamp = timestamp,
+        .duration = duration,
+        .action = action,
+        .user = user,
+        .userLength = strlen(user),
+        .reason = reason,
+        .reasonLength = (reason) ? strlen(reason) : 0,
+        .component = component,
+        .componentLength = (component) ? strlen(component) : 0
+    };
+    
+    int result = mt_audit_store_append(basePath, &record);
+    
+    if (result == 0 && modelCount < MODEL_MAX_RECORDS) {
+        
+        model_record_t *modelRecord = &model[modelCount];
+        memset(modelRecord, 0, sizeof(model_record_t));
+        
+        modelRecord->timestamp = timestamp;
+        modelRecord->duration = duration;
+        modelRecord->action = action;
+        snprintf(modelRecord->user, MODEL_MAX_STRING, "%s", user);
+        snprintf(modelRecord->reason, MODEL_MAX_STRING, "%s", (reason) ? reason : "");
+        snprintf(modelRecord->component, MODEL_MAX_STRING, "%s", (component) ? component : "");
+        
+        if (action == MT_AUDIT_ACTION_REVOKE && duration == 0) {
+            
+            for (size_t i = modelCount; i > 0; i--) {
+                
+                const model_record_t *previous = &model[i - 1];
+                if (strcmp(previous->user, user) != 0) { continue; }
+                
+                if (previous->action == MT_AUDIT_ACTION_GRANT && timestamp > previous->timestamp) { modelRecord->duration = (uint32_t)(timestamp - previous->timestamp); }
+                break;
+            }
+        }
+        
+        MT_CHECK_EQUAL(record.duration, modelRecord->duration);
+        modelCount++;
+    }
+    
+    return result;
+}
+
+static int string_matches(const char *expected, const char *actual, size_t actualLength)
+{
+    return (strlen(expected) == actualLength && memcmp(expected, actual, actualLength) == 0);
+}
+
+static int compare_with_model(const mt_audit_record_t *record, void *context)
+{
+    query_context_t *query = context;
+    
+    if (query->position >= query->expectedCount) {
+        
+        query->mismatches++;
+        
+    } else {
+        
+        const model_record_t *expected = query->expected[query->position];
+        
+        if (record->timestamp != expected->timestamp || record->duration != expected->duration || record->action != expected->action ||
+            !string_matches(expected->user, record->user, record->userLength) ||
+            !string_matches(expected->reason, record->reason, record->reasonLength) ||
+            !string_matches(expected->component, record->component, record->componentLength)) {
+            
+            query->mismatches++;
+        }
+    }
+    
+    query->position++;
+    
+    return (query->stopAfter > 0 && query->position >= query->stopAfter);
+}
+
+// runs the query against the store and the model and returns the number of differences
+static size_t check_query(const char *basePath, const char *user, int64_t since)
+{
+    static query_context_t query;
+    memset(&query, 0, sizeof(query));
+    
+    for (size_t i = 0; i < modelCount; i++) {
+        
+        if (model[i].timestamp >= since && (!user || strcmp(model[i].user, user) == 0)) { query.expected[query.expectedCount++] = &model[i]; }
+    }
+    
+    long matches = mt_audit_store_query(basePath, user, since, compare_with_model, &query);
+    size_t differences = query.mismatches;
+    
+    if (matches != (long)query.expectedCount) { differences++; }
+    if (query.position != query.expectedCount) { differences++; }
+    
+    if (differences > 0) {
+        
+        fprintf(stderr, "Query for %s since %lld: %ld records (expected %zu), %zu mismatches\n",
+                (user) ? user : "all users", (long long)since, matches, query.expectedCount, query.mismatches);
+    }
+    
+    return differences;
+}
+
+// the hash the store uses for its user index (FNV-1a)
+static uint32_t user_hash(const char *user)
+{
+    uint32_t hash = 2166136261u;
+    
+    for (const char *p = user; *p; p++) {
+        hash ^= (uint8_t)*p;
+        hash *= 16777619u;
+    }
+    
+    return hash;
+}
+
+#pragma mark - Tests
+
+static void test_missing_store(void)
+{
+    char basePath[PATH_MAX];
+    new_store(basePath);
+    
+    MT_CHECK_EQUAL(mt_audit_store_query(basePath, NULL, 0, NULL, NULL), 0);
+    MT_CHECK_EQUAL(mt_audit_store_query(basePath, "root", 0, NULL, NULL), 0);
+    MT_CHECK_EQUAL(mt_audit_store_query(NULL, NULL, 0, NULL, NULL), -1);
+}
+
+static void test_append_and_query(void)
+{
+    char basePath[PATH_MAX];
+    new_store(basePath);
+    
+    MT_CHECK_EQUAL(append_record(basePath, 1000, MT_AUDIT_ACTION_GRANT, 0, "alice", "Installing software", "Privileges"), 0);
+    MT_CHECK_EQUAL(append_record(basePath, 1100, MT_AUDIT_ACTION_GRANT, 0, "bob", NULL, "PrivilegesCLI"), 0);
+    MT_CHECK_EQUAL(append_record(basePath, 1600, MT_AUDIT_ACTION_REVOKE, 0, "alice", NULL, "PrivilegesAgent"), 0);
+    MT_CHECK_EQUAL(append_record(basePath, 1700, MT_AUDIT_ACTION_REVOKE, 42, "bob", NULL, NULL), 0);
+    MT_CHECK_EQUAL(append_record(basePath, 1800, MT_AUDIT_ACTION_REVOKE, 0, "carol", NULL, NULL), 0);
+    
+    // the durations of the revokes
+    MT_CHECK_EQUAL(model[2].duration, 600);
+    MT_CHECK_EQUAL(model[3].duration, 42);
+    MT_CHECK_EQUAL(model[4].duration, 0);
+    
+    MT_CHECK_EQUAL(check_query(basePath, NULL, 0), 0);
+    MT_CHECK_EQUAL(check_query(basePath, NULL, 1100), 0);
+    MT_CHECK_EQUAL(check_query(basePath, NULL, 1801), 0);
+    MT_CHECK_EQUAL(check_query(basePath, "alice", 0), 0);
+    MT_CHECK_EQUAL(check_query(basePath, "alice", 1001), 0);
+    MT_CHECK_EQUAL(check_query(basePath, "bob", 0), 0);
+    MT_CHECK_EQUAL(check_query(basePath, "dave", 0), 0);
+    MT_CHECK_EQUAL(check_query(basePath, "alic", 0), 0);
+    
+    // invalid records
+    mt_audit_record_t record = { .timestamp = 2000, .action = MT_AUDIT_ACTION_GRANT, .user = "", .userLength = 0 };
+    MT_CHECK_EQUAL(mt_audit_store_append(basePath, &record), -1);
+    MT_CHECK_EQUAL(errno, EINVAL);
+    MT_CHECK_EQUAL(mt_audit_store_append(basePath, NULL), -1);
+    
+    remove_store(basePath);
+}
+
+static void test_clock_going_back(void)
+{
+    char basePath[PATH_MAX];
+    new_store(basePath);
+    
+    // the records are stored in the order they were appended, even
+    // if the system clock has been set back in the meantime
+    append_record(basePath, 5000, MT_AUDIT_ACTION_GRANT, 0, "alice", NULL, NULL);
+    append_record(basePath, 3000, MT_AUDIT_ACTION_REVOKE, 0, "alice", NULL, NULL);
+    append_record(basePath, 3500, MT_AUDIT_ACTION_GRANT, 0, "bob", NULL, NULL);
+    append_record(basePath, 6000, MT_AUDIT_ACTION_REVOKE, 0, "bob", NULL, NULL);
+    append_record(basePath, 4000, MT_AUDIT_ACTION_GRANT, 0, "alice", NULL, NULL);
+    
+    // a revoke that is older than the grant has no duration
+    MT_CHECK_EQUAL(model[1].duration, 0);
+    MT_CHECK_EQUAL(model[3].duration, 2500);
+    
+    int64_t timestamps[] = { 0, 3000, 3001, 3500, 4000, 4500, 5000, 6000, 6001 };
+    
+    for (size_t i = 0; i < sizeof(timestamps) / sizeof(timestamps[0]); i++) {
+        
+        MT_CHECK_EQUAL(check_query(basePath, NULL, timestamps[i]), 0);
+        MT_CHECK_EQUAL(check_query(basePath, "alice", timestamps[i]), 0);
+        MT_CHECK_EQUAL(check_query(basePath, "bob", timestamps[i]), 0);
+    }
+    
+    remove_store(basePath);
+}
+
+static void test_colliding_users(void)
+{
+    char basePath[PATH_MAX];
+    const char *first = "user449599";
+    const char *second = "user612382";
+    new_store(basePath);
+    
+    // the users share an entry in the user index, so the revoke
+    // of the second user must not use the grant of the first one
+    MT_CHECK(user_hash(first) == user_hash(second));
+    append_record(basePath, 1000, MT_AUDIT_ACTION_GRANT, 0, first, NULL, NULL);
+    append_record(basePath, 1500, MT_AUDIT_ACTION_REVOKE, 0, second, NULL, NULL);
+    append_record(basePath, 1600, MT_AUDIT_ACTION_GRANT, 0, second, NULL, NULL);
+    append_record(basePath, 1700, MT_AUDIT_ACTION_REVOKE, 0, first, NULL, NULL);
+    
+    MT_CHECK_EQUAL(model[1].duration, 0);
+    MT_CHECK_EQUAL(model[3].duration, 700);
+    
+    MT_CHECK_EQUAL(check_query(basePath, first, 0), 0);
+    MT_CHECK_EQUAL(check_query(basePath, second, 0), 0);
+    MT_CHECK_EQUAL(check_query(basePath, NULL, 0), 0);
+    
+    remove_store(basePath);
+}
+
+static int check_reason_length(const mt_audit_record_t *record, void *context)
+{
+    *(size_t*)context = record->reasonLength;
+    
+    return 0;
+}
+
+static void test_truncated_reason(void)
+{
+    char basePath[PATH_MAX];
+    new_store(basePath);
+    
+    size_t length = 70000;
+    char *reason = malloc(length);
+    memset(reason, 'r', length);
+    
+    mt_audit_record_t record = { .timestamp = 1000, .action = MT_AUDIT_ACTION_GRANT, .user = "alice", .userLength = 5, .reason = reason, .reasonLength = length };
+    MT_CHECK_EQUAL(mt_audit_store_append(basePath, &record), 0);
+    
+    size_t reasonLength = 0;
+    MT_CHECK_EQUAL(mt_audit_store_query(basePath, NULL, 0, check_reason_length, &reasonLength), 1);
+    MT_CHECK_EQUAL(reasonLength, 65535);
+    
+    free(reason);
+    remove_store(basePath);
+}
+
+static void test_callback_stops_query(void)
+{
+    char basePath[PATH_MAX];
+    static query_context_t query;
+    new_store(basePath);
+    
+    for (int i = 0; i < 10; i++) { append_record(basePath, 1000 + i, MT_AUDIT_ACTION_GRANT, 0, "alice", NULL, NULL); }
+    
+    memset(&query, 0, sizeof(query));
+    for (size_t i = 0; i < modelCount; i++) { query.expected[query.expectedCount++] = &model[i]; }
+    query.stopAfter = 3;
+    
+    MT_CHECK_EQUAL(mt_audit_store_query(basePath, NULL, 0, compare_with_model, &query), 3);
+    MT_CHECK_EQUAL(query.mismatches, 0);
+    
+    memset(&query, 0, sizeof(query));
+    for (size_t i = 0; i < modelCount; i++) { query.expected[query.expectedCount++] = &model[i]; }
+    query.stopAfter = 4;
+    
+    MT_CHECK_EQUAL(mt_audit_store_query(basePath, "alice", 0, compare_with_model, &query), 4);
+    MT_CHECK_EQUAL(query.mismatches, 0);
+    
+    remove_store(basePath);
+}
+
+static void test_damaged_store(void)
+{
+    char basePath[PATH_MAX];
+    char path[PATH_MAX + 8];
+    new_store(basePath);
+    
+    append_record(basePath, 1000, MT_AUDIT_ACTION_GRANT, 0, "alice", NULL, NULL);
+    append_record(basePath, 2000, MT_AUDIT_ACTION_REVOKE, 0, "alice", NULL, NULL);
+    
+    // an incomplete index entry (e.g. after a crash) is ignored and overwritten
+    snprintf(path, sizeof(path), "%s.idx", basePath);
+    int fd = open(path, O_WRONLY | O_APPEND);
+    MT_CHECK(fd >= 0 && write(fd, "partial", 7) == 7);
+    if (fd >= 0) { close(fd); }
+    
+    MT_CHECK_EQUAL(check_query(basePath, NULL, 0), 0);
+    MT_CHECK_EQUAL(append_record(basePath, 3000, MT_AUDIT_ACTION_GRANT, 0, "alice", NULL, NULL), 0);
+    MT_CHECK_EQUAL(check_query(basePath, NULL, 0), 0);
+    MT_CHECK_EQUAL(check_query(basePath, "alice", 0), 0);
+    
+    // a file with the wrong header is not touched
+    snprintf(path, sizeof(path), "%s.usr", basePath);
+    fd = open(path, O_WRONLY);
+    MT_CHECK(fd >= 0 && pwrite(fd, "PRVXXX01", 8, 0) == 8);
+    if (fd >= 0) { close(fd); }
+    
+    errno = 0;
+    MT_CHECK_EQUAL(mt_audit_store_query(basePath, NULL, 0, NULL, NULL), -1);
+    MT_CHECK_EQUAL(errno, EINVAL);
+    
+    mt_audit_record_t record = { .timestamp = 4000, .action = MT_AUDIT_ACTION_GRANT, .user = "alice", .userLength = 5 };
+    MT_CHECK_EQUAL(mt_audit_store_append(basePath, &record), -1);
+    
+    remove_store(basePath);
+}
+
+static void test_random_history(void)
+{
+    char basePath[PATH_MAX];
+    char user[16];
+    size_t differences = 0;
+    new_store(basePath);
+    
+    // a history of many users, with the clock occasionally going back
+    int64_t clock = 1700000000;
+    uint64_t startTime = mt_test_time();
+    
+    for (unsigned long i = 0; i < fuzzRecords; i++) {
+        
+        clock += (mt_test_random_below(20) == 0) ? -(int64_t)mt_test_random_below(3600) : (int64_t)mt_test_random_below(600);
+        snprintf(user, sizeof(user), "user%u", mt_test_random_below(50));
+        
+        uint8_t action = (mt_test_random_below(2)) ? MT_AUDIT_ACTION_GRANT : MT_AUDIT_ACTION_REVOKE;
+        uint32_t duration = (mt_test_random_below(4) == 0) ? mt_test_random_below(1000) : 0;
+        const char *reason = (mt_test_random_below(3) == 0) ? "Random reason" : NULL;
+        
+        MT_CHECK_EQUAL(append_record(basePath, clock, action, duration, user, reason, "PrivilegesAgent"), 0);
+    }
+    
+    uint64_t appendTime = mt_test_time() - startTime;
+    startTime = mt_test_time();
+    
+    for (int i = 0; i < 200; i++) {
+        
+        int64_t since = model[mt_test_random_below((uint32_t)modelCount)].timestamp + (int64_t)mt_test_random_below(3) - 1;
+        snprintf(user, sizeof(user), "user%u", mt_test_random_below(55));
+        
+        differences += check_query(basePath, NULL, since);
+        differences += check_query(basePath, user, since);
+    }
+    
+    uint64_t queryTime = mt_test_time() - startTime;
+    
+    MT_CHECK_EQUAL(differences, 0);
+    fprintf(stderr, "%lu records: %.1f µs per append, %.1f µs per query\n", fuzzRecords, appendTime / 1000.0 / fuzzRecords, queryTime / 1000.0 / 400);
+    
+    remove_store(basePath);
+}
+
+int main(int argc, const char * argv[])
+{
+    if (argc > 1) { fuzzRecords = strtoul(argv[1], NULL, 10); }
+    if (fuzzRecords > MODEL_MAX_RECORDS) { fuzzRecords = MODEL_MAX_RECORDS; }
+    
+    const char *tempDirectory = getenv("TMPDIR");
+    snprintf(storeDirectory, sizeof(storeDirectory), "%s/mt-audit-test.XXXXXX", (tempDirectory) ? tempDirectory : "/tmp");
+    
+    model = calloc(MODEL_MAX_RECORDS, sizeof(model_record_t));
+    
+    if (!model || !mkdtemp(storeDirectory)) {
+        
+        fprintf(stderr, "Failed to create the test directory\n");
+        return EXIT_FAILURE;
+    }
+    
+    mt_test_seed();
+    
+    MT_RUN_TEST(test_missing_store);
+    MT_RUN_TEST(test_append_and_query);
+    MT_RUN_TEST(test_clock_going_back);
+    MT_RUN_TEST(test_colliding_users);
+    MT_RUN_TEST(test_truncated_reason);
+    MT_RUN_TEST(test_callback_stops_query);
+    MT_RUN_TEST(test_damaged_store);
+    MT_RUN_TEST(test_random_history);
+    
+    rmdir(storeDirectory);
+    free(model);
+    
+    return mt_test_result();
+}
@@ -0,0 +1,409 @@
+/*
+    main.c
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    Tests the binary property list reader with group record fixtures (see Fixtures/make_fixtures.py)
+    and fuzzes it with truncated and mutated copies of them. Every fuzz input is copied into a buffer
+    of its exact size, so reads past the end are caught by the address sanitizer.
+    
+    mt-bplist-test <fixtures directory> [iterations]
+*/
+
+#include "MTBinaryPlist.h"
+#include "MTTestSupport.h"
+
+typedef struct {
+    uint8_t *data;
+    size_t length;
+} fixture_t;
+
+static const char *fixturesPath = NULL;
+static unsigned long fuzzIterations = 200000;
+
+#pragma mark - Helpers
+
+static fixture_t load_fixture(const char *name)
+{
+    fixture_t fixture = { NULL, 0 };
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", fixturesPath, name);
+    
+    FILE *file = fopen(path, "rb");
+    
+    if (file) {
+        
+        fseek(file, 0, SEEK_END);
+        long length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        
+        fixture.data = (length > 0) ? malloc((size_t)length) : NULL;
+        
+        if (fixture.data && fread(fixture.data, 1, (size_t)length, file) == (size_t)length) {
+            fixture.length = (size_t)length;
+        } else {
+            free(fixture.data);
+            fixture.data = NULL;
+        }
+        
+        fclose(file);
+    }
+    
+    if (!fixture.data) { fprintf(stderr, "Failed to load fixture %s\n", path); }
+    
+    return fixture;
+}
+
+static int users_ref(const mt_bplist_t *plist, uint64_t *usersRef)
+{
+    return mt_bplist_dict_get(plist, plist->topObject, "users", usersRef);
+}
+
+// walks the whole property list the way MTLocalGroupRecord does and checks that every
+// result is in range and every returned string lies within the data
+static void walk_plist(const mt_bplist_t *plist)
+{
+    static const char *keys[] = { "users", "groupmembers", "nestedgroups", "name", "gid", "missing" };
+    static const char *strings[] = { "root", "jürgen", "user\xF0\x9F\x98\x80", "", "\xC3" };
+    
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        
+        uint64_t valueRef = 0;
+        int result = mt_bplist_dict_get(plist, plist->topObject, keys[i], &valueRef);
+        MT_CHECK(result >= -1 && result <= 1);
+        if (result != 1) { continue; }
+        
+        uint64_t count = 0;
+        result = mt_bplist_array_count(plist, valueRef, &count);
+        MT_CHECK(result == 1 || result == -1);
+        
+        for (uint64_t j = 0; result == 1 && j < count; j++) {
+            
+            uint64_t elementRef = 0;
+            const uint8_t *bytes = NULL;
+            size_t byteLength = 0;
+            int isUTF16 = 0;
+            
+            MT_CHECK(mt_bplist_array_get(plist, valueRef, j, &elementRef) == 1);
+            
+            if (mt_bplist_string_get(plist, elementRef, &bytes, &byteLength, &isUTF16) == 1) {
+                
+                MT_CHECK(bytes >= plist->data && bytes + byteLength <= plist->data + plist->length);
+                
+                // touch every byte, so the sanitizer sees out-of-bounds strings
+                volatile uint8_t sum = 0;
+                for (size_t k = 0; k < byteLength; k++) { sum += bytes[k]; }
+                (void)sum;
+            }
+        }
+        
+        if (result == 1) { MT_CHECK(mt_bplist_array_get(plist, valueRef, count, NULL) == 0); }
+        
+        for (size_t j = 0; j < sizeof(strings) / sizeof(strings[0]); j++) {
+            
+            result = mt_bplist_array_contains_string(plist, valueRef, strings[j]);
+            MT_CHECK(result >= -1 && result <= 1);
+        }
+    }
+}
+
+#pragma mark - Tests
+
+static void test_group_record(void)
+{
+    fixture_t fixture = load_fixture("admin.plist");
+    mt_bplist_t plist;
+    uint64_t usersRef = 0;
+    uint64_t count = 0;
+    
+    MT_CHECK(fixture.data && mt_bplist_init(&plist, fixture.data, fixture.length) == 1);
+    if (!fixture.data) { return; }
+    
+    MT_CHECK_EQUAL(plist.objectRefSize, 1);
+    MT_CHECK_EQUAL(users_ref(&plist, &usersRef), 1);
+    MT_CHECK_EQUAL(mt_bplist_array_count(&plist, usersRef, &count), 1);
+    MT_CHECK_EQUAL(count, 4);
+    
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, "root"), 1);
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, "localadmin"), 1);
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, "Root"), 0);
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, "roo"), 0);
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, "rootx"), 0);
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, ""), 0);
+    
+    // the elements keep their order
+    uint64_t elementRef = 0;
+    const uint8_t *bytes = NULL;
+    size_t byteLength = 0;
+    int isUTF16 = -1;
+    
+    MT_CHECK_EQUAL(mt_bplist_array_get(&plist, usersRef, 1, &elementRef), 1);
+    MT_CHECK_EQUAL(mt_bplist_string_get(&plist, elementRef, &bytes, &byteLength, &isUTF16), 1);
+    MT_CHECK(byteLength == 10 && memcmp(bytes, "localadmin", 10) == 0 && isUTF16 == 0);
+    MT_CHECK_EQUAL(mt_bplist_array_get(&plist, usersRef, 4, &elementRef), 0);
+    
+    // other attributes are arrays of strings as well
+    uint64_t nameRef = 0;
+    MT_CHECK_EQUAL(mt_bplist_dict_get(&plist, plist.topObject, "name", &nameRef), 1);
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, nameRef, "admin"), 1);
+    MT_CHECK_EQUAL(mt_bplist_dict_get(&plist, plist.topObject, "nestedgroups", NULL), 1);
+    MT_CHECK_EQUAL(mt_bplist_dict_get(&plist, plist.topObject, "missing", NULL), 0);
+    MT_CHECK_EQUAL(mt_bplist_dict_get(&plist, plist.topObject, "user", NULL), 0);
+    
+    // type mismatches
+    MT_CHECK_EQUAL(mt_bplist_dict_get(&plist, usersRef, "root", NULL), -1);
+    MT_CHECK_EQUAL(mt_bplist_array_count(&plist, plist.topObject, &count), -1);
+    MT_CHECK_EQUAL(mt_bplist_string_get(&plist, usersRef, NULL, NULL, NULL), -1);
+    MT_CHECK_EQUAL(mt_bplist_array_get(&plist, plist.numObjects, 0, NULL), -1);
+    
+    free(fixture.data);
+}
+
+static void test_utf16_strings(void)
+{
+    fixture_t fixture = load_fixture("admin.plist");
+    mt_bplist_t plist;
+    uint64_t usersRef = 0;
+    
+    if (!fixture.data || mt_bplist_init(&plist, fixture.data, fixture.length) != 1 || users_ref(&plist, &usersRef) != 1) {
+        
+        MT_CHECK(0);
+        free(fixture.data);
+        return;
+    }
+    
+    uint64_t elementRef = 0;
+    size_t byteLength = 0;
+    int isUTF16 = 0;
+    
+    MT_CHECK_EQUAL(mt_bplist_array_get(&plist, usersRef, 2, &elementRef), 1);
+    MT_CHECK_EQUAL(mt_bplist_string_get(&plist, elementRef, NULL, &byteLength, &isUTF16), 1);
+    MT_CHECK(isUTF16 == 1 && byteLength == 12);
+    
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, "j\xC3\xBCrgen"), 1);
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, "jurgen"), 0);
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, "j\xC3\xBCrge"), 0);
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, "j\xC3\xBCrgenn"), 0);
+    
+    // a code point outside the basic multilingual plane is a surrogate pair
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, "user\xF0\x9F\x98\x80"), 1);
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, "user\xF0\x9F\x98\x81"), 0);
+    
+    // invalid UTF-8 is an error once a UTF-16 string has to be compared
+    MT_CHECK_EQUAL(mt_bplist_string_equals(&plist, elementRef, "j\xC3"), -1);
+    MT_CHECK_EQUAL(mt_bplist_string_equals(&plist, elementRef, "j\xED\xA0\x80rgen"), -1);
+    MT_CHECK_EQUAL(mt_bplist_string_equals(&plist, elementRef, "j\xF4\x90\x80\x80rgen"), -1);
+    
+    free(fixture.data);
+}
+
+static void test_large_group_record(void)
+{
+    fixture_t fixture = load_fixture("admin-large.plist");
+    mt_bplist_t plist;
+    uint64_t usersRef = 0;
+    uint64_t count = 0;
+    
+    MT_CHECK(fixture.data && mt_bplist_init(&plist, fixture.data, fixture.length) == 1);
+    if (!fixture.data) { return; }
+    
+    MT_CHECK_EQUAL(plist.objectRefSize, 2);
+    MT_CHECK_EQUAL(users_ref(&plist, &usersRef), 1);
+    MT_CHECK_EQUAL(mt_bplist_array_count(&plist, usersRef, &count), 1);
+    MT_CHECK_EQUAL(count, 1000);
+    
+    char userName[16];
+    
+    for (int i = 0; i < 1000; i++) {
+        
+        snprintf(userName, sizeof(userName), "user%04d", i);
+        MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, userName), 1);
+    }
+    
+    MT_CHECK_EQUAL(mt_bplist_array_contains_string(&plist, usersRef, "user1000"), 0);
+    
+    uint64_t nestedRef = 0;
+    MT_CHECK_EQUAL(mt_bplist_dict_get(&plist, plist.topObject, "nestedgroups", &nestedRef), 1);
+    MT_CHECK_EQUAL(mt_bplist_array_count(&plist, nestedRef, &count), 1);
+    MT_CHECK_EQUAL(count, 0);
+    
+    free(fixture.data);
+}
+
+static void test_group_without_users(void)
+{
+    fixture_t fixture = load_fixture("admin-empty.plist");
+    mt_bplist_t plist;
+    
+    MT_CHECK(fixture.data && mt_bplist_init(&plist, fixture.data, fixture.length) == 1);
+    if (!fixture.data) { return; }
+    
+    MT_CHECK_EQUAL(users_ref(&plist, NULL), 0);
+    MT_CHECK_EQUAL(mt_bplist_dict_get(&plist, plist.topObject, "nestedgroups", NULL), 0);
+    
+    free(fixture.data);
+}
+
+static void test_invalid_headers(void)
+{
+    fixture_t fixture = load_fixture("admin.plist");
+    mt_bplist_t plist;
+    
+    if (!fixture.data) { MT_CHECK(0); return; }
+    
+    MT_CHECK_EQUAL(mt_bplist_init(&plist, NULL, 0), -1);
+    MT_CHECK_EQUAL(mt_bplist_init(&plist, fixture.data, 39), -1);
+    
+    uint8_t *copy = malloc(fixture.length);
+    uint8_t *trailer = copy + fixture.length - 32;
+    
+    // wrong magic
+    memcpy(copy, fixture.data, fixture.length);
+    copy[7] = '1';
+    MT_CHECK_EQUAL(mt_bplist_init(&plist, copy, fixture.length), -1);
+    
+    // invalid integer sizes
+    memcpy(copy, fixture.data, fixture.length);
+    trailer[6] = 0;
+    MT_CHECK_EQUAL(mt_bplist_init(&plist, copy, fixture.length), -1);
+    trailer[6] = 9;
+    MT_CHECK_EQUAL(mt_bplist_init(&plist, copy, fixture.length), -1);
+    
+    memcpy(copy, fixture.data, fixture.length);
+    trailer[7] = 0;
+    MT_CHECK_EQUAL(mt_bplist_init(&plist, copy, fixture.length), -1);
+    
+    // the top object must exist
+    memcpy(copy, fixture.data, fixture.length);
+    memcpy(trailer + 16, trailer + 8, 8);
+    MT_CHECK_EQUAL(mt_bplist_init(&plist, copy, fixture.length), -1);
+    
+    // the offset table must not overlap the trailer or the header
+    memcpy(copy, fixture.data, fixture.length);
+    memset(trailer + 24, 0xFF, 8);
+    MT_CHECK_EQUAL(mt_bplist_init(&plist, copy, fixture.length), -1);
+    memset(trailer + 24, 0, 8);
+    trailer[31] = 8;
+    MT_CHECK_EQUAL(mt_bplist_init(&plist, copy, fixture.length), -1);
+    
+    // more objects than the offset table can hold
+    memcpy(copy, fixture.data, fixture.length);
+    memset(trailer + 8, 0x7F, 8);
+    MT_CHECK_EQUAL(mt_bplist_init(&plist, copy, fixture.length), -1);
+    
+    free(copy);
+    free(fixture.data);
+}
+
+static void test_fuzz_truncated(void)
+{
+    static const char *names[] = { "admin.plist", "admin-large.plist", "admin-empty.plist" };
+    
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        
+        fixture_t fixture = load_fixture(names[i]);
+        if (!fixture.data) { MT_CHECK(0); continue; }
+        
+        // cutting the data from the end loses the trailer, so the last 32 bytes of
+        // the remaining data are taken as trailer, which rarely makes any sense
+        for (size_t length = 0; length < fixture.length; length++) {
+            
+            uint8_t *copy = malloc(length + 1);
+            mt_bplist_t plist;
+            
+            memcpy(copy, fixture.data, length);
+            if (mt_bplist_init(&plist, copy, length) == 1) { walk_plist(&plist); }
+            
+            // cutting it from the start loses the header
+            memcpy(copy, fixture.data + fixture.length - length, length);
+            MT_CHECK_EQUAL(mt_bplist_init(&plist, copy, length), -1);
+            
+            free(copy);
+        }
+        
+        free(fixture.data);
+    }
+}
+
+static void test_fuzz_mutated(void)
+{
+    static const char *names[] = { "admin.plist", "admin-large.plist" };
+    
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        
+        fixture_t fixture = load_fixture(names[i]);
+        if (!fixture.data) { MT_CHECK(0); continue; }
+        
+        unsigned long iterations = (i == 0) ? fuzzIterations : fuzzIterations / 100;
+        unsigned long validInputs = 0;
+        
+        for (unsigned long iteration = 0; iteration < iterations; iteration++) {
+            
+            uint8_t *copy = malloc(fixture.length);
+            memcpy(copy, fixture.data, fixture.length);
+            
+            // flip some bytes, preferably in the trailer and the offset table,
+            // where a single byte changes the meaning of the whole file
+            uint32_t mutations = 1 + mt_test_random_below(4);
+            
+            for (uint32_t m = 0; m < mutations; m++) {
+                
+                size_t position = (mt_test_random_below(2)) ? fixture.length - 1 - mt_test_random_below(64) : mt_test_random_below((uint32_t)fixture.length);
+                copy[position] = (mt_test_random_below(4) == 0) ? (uint8_t)(copy[position] ^ (1 << mt_test_random_below(8))) : (uint8_t)mt_test_random();
+            }
+            
+            mt_bplist_t plist;
+            
+            if (mt_bplist_init(&plist, copy, fixture.length) == 1) {
+                
+                walk_plist(&plist);
+                validInputs++;
+            }
+            
+            free(copy);
+        }
+        
+        // most mutations must still produce a readable file, otherwise the walk is not fuzzed at all
+        MT_CHECK(validInputs > iterations / 4);
+        fprintf(stderr, "%s: %lu of %lu mutations walked\n", names[i], validInputs, iterations);
+        
+        free(fixture.data);
+    }
+}
+
+int main(int argc, const char * argv[])
+{
+    if (argc < 2) {
+        
+        fprintf(stderr, "Usage: mt-bplist-test <fixtures directory> [iterations]\n");
+        return EXIT_FAILURE;
+    }
+    
+    fixturesPath = argv[1];
+    if (argc > 2) { fuzzIterations = strtoul(argv[2], NULL, 10); }
+    
+    mt_test_seed();
+    
+    MT_RUN_TEST(test_group_record);
+    MT_RUN_TEST(test_utf16_strings);
+    MT_RUN_TEST(test_large_group_record);
+    MT_RUN_TEST(test_group_without_users);
+    MT_RUN_TEST(test_invalid_headers);
+    MT_RUN_TEST(test_fuzz_truncated);
+    MT_RUN_TEST(test_fuzz_mutated);
+    
+    return mt_test_result();
+}
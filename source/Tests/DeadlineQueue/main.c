@@ -0,0 +1,281 @@
+/*
+    main.c
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    Tests the deadline queue against a plain array of deadlines with random sequences of
+    schedules, cancellations and pops. A simulated timer wakes up at a random time within the
+    window the queue returns and delivers all deadlines that are due, so every deadline must
+    be delivered neither early nor later than its tolerance allows.
+    
+    mt-deadline-queue-test [iterations]
+*/
+
+#include <errno.h>
+#include <stdbool.h>
+#include "MTDeadlineQueue.h"
+#include "MTTestSupport.h"
+
+#define MAX_KEYS 64
+
+typedef struct {
+    bool scheduled;
+    uint64_t deadline;
+    uint64_t tolerance;
+} model_deadline_t;
+
+static uint64_t iterations = 200000;
+
+#pragma mark - Helpers
+
+static uint64_t model_latest(const model_deadline_t *deadline)
+{
+    return (deadline->deadline > UINT64_MAX - deadline->tolerance) ? UINT64_MAX : deadline->deadline + deadline->tolerance;
+}
+
+// returns the number of scheduled deadlines and the window of the next wakeup
+static size_t model_window(const model_deadline_t *model, uint32_t keys, uint64_t *earliest, uint64_t *latest)
+{
+    size_t count = 0;
+    *earliest = *latest = UINT64_MAX;
+    
+    for (uint32_t key = 0; key < keys; key++) {
+        
+        if (model[key].scheduled) {
+            
+            count++;
+            if (model[key].deadline < *earliest) { *earliest = model[key].deadline; }
+            if (model_latest(&model[key]) < *latest) { *latest = model_latest(&model[key]); }
+        }
+    }
+    
+    return count;
+}
+
+// compares the queue with the model and returns the number of differences
+static size_t compare_queue(const mt_deadline_queue_t *queue, const model_deadline_t *model, uint32_t keys)
+{
+    size_t differences = 0;
+    uint64_t earliest, latest, expectedEarliest, expectedLatest;
+    size_t count = model_window(model, keys, &expectedEarliest, &expectedLatest);
+    
+    if (mt_deadline_queue_count(queue) != count) { differences++; }
+    
+    for (uint32_t key = 0; key < keys; key++) {
+        if (mt_deadline_queue_is_scheduled(queue, key) != model[key].scheduled) { differences++; }
+    }
+    
+    if (mt_deadline_queue_next_wakeup(queue, &earliest, &latest) != (count > 0)) {
+        differences++;
+    } else if (count > 0 && (earliest != expectedEarliest || latest != expectedLatest)) {
+        differences++;
+    }
+    
+    return differences;
+}
+
+#pragma mark - Tests
+
+static void test_examples(void)
+{
+    mt_deadline_queue_t *queue = mt_deadline_queue_create(4);
+    MT_CHECK(queue != NULL);
+    if (!queue) { return; }
+    
+    uint64_t earliest = 0, latest = 0;
+    uint32_t key = 0;
+    MT_CHECK(!mt_deadline_queue_next_wakeup(queue, &earliest, &latest));
+    MT_CHECK(!mt_deadline_queue_pop(queue, UINT64_MAX, &key));
+    
+    // the window ends with the deadline whose tolerance ends first, even if it's not due first
+    MT_CHECK(mt_deadline_queue_schedule(queue, 0, 100, 50));
+    MT_CHECK(mt_deadline_queue_schedule(queue, 1, 120, 10));
+    MT_CHECK(mt_deadline_queue_schedule(queue, 2, 200, 0));
+    MT_CHECK(mt_deadline_queue_next_wakeup(queue, &earliest, &latest));
+    MT_CHECK_EQUAL(earliest, 100);
+    MT_CHECK_EQUAL(latest, 130);
+    
+    // scheduling a key again moves its deadline
+    MT_CHECK(mt_deadline_queue_schedule(queue, 1, 300, 10));
+    MT_CHECK_EQUAL(mt_deadline_queue_count(queue), 3);
+    MT_CHECK(mt_deadline_queue_next_wakeup(queue, &earliest, &latest));
+    MT_CHECK_EQUAL(latest, 150);
+    
+    // deadlines are never delivered early
+    MT_CHECK(!mt_deadline_queue_pop(queue, 99, &key));
+    MT_CHECK(mt_deadline_queue_pop(queue, 200, &key) && key == 0);
+    MT_CHECK(mt_deadline_queue_pop(queue, 200, &key) && key == 2);
+    MT_CHECK(!mt_deadline_queue_pop(queue, 200, &key));
+    
+    MT_CHECK(mt_deadline_queue_cancel(queue, 1));
+    MT_CHECK(!mt_deadline_queue_cancel(queue, 1));
+    MT_CHECK_EQUAL(mt_deadline_queue_count(queue), 0);
+    
+    // a tolerance that does not fit ends the window at the end of time
+    MT_CHECK(mt_deadline_queue_schedule(queue, 3, UINT64_MAX - 1, UINT64_MAX));
+    MT_CHECK(mt_deadline_queue_next_wakeup(queue, NULL, &latest) && latest == UINT64_MAX);
+    
+    errno = 0;
+    MT_CHECK(!mt_deadline_queue_schedule(queue, 4, 0, 0));
+    MT_CHECK_EQUAL(errno, EINVAL);
+    MT_CHECK(!mt_deadline_queue_cancel(queue, 4));
+    MT_CHECK(!mt_deadline_queue_is_scheduled(queue, 4));
+    
+    mt_deadline_queue_destroy(queue);
+    mt_deadline_queue_destroy(NULL);
+    
+    // a queue without keys is valid, but nothing can be scheduled
+    queue = mt_deadline_queue_create(0);
+    MT_CHECK(queue != NULL);
+    MT_CHECK(queue && !mt_deadline_queue_schedule(queue, 0, 0, 0));
+    mt_deadline_queue_destroy(queue);
+}
+
+static void test_fuzz(void)
+{
+    size_t differences = 0;
+    size_t earlyDeliveries = 0;
+    size_t lateDeliveries = 0;
+    
+    for (uint64_t round = 0; round < iterations / 1000; round++) {
+        
+        // few keys and a short time range make ties and rescheduling frequent
+        uint32_t keys = 1 + mt_test_random_below(MAX_KEYS);
+        uint64_t range = (round % 2) ? 100 : 1000000;
+        mt_deadline_queue_t *queue = mt_deadline_queue_create(keys);
+        model_deadline_t model[MAX_KEYS] = { { 0 } };
+        uint64_t now = 0;
+        
+        if (!queue) { MT_CHECK(0); return; }
+        
+        for (int step = 0; step < 1000; step++) {
+            
+            uint32_t key = mt_test_random_below(keys);
+            
+            switch (mt_test_random_below(4)) {
+                
+                case 0:
+                case 1: {
+                    
+                    // deadlines in the past are due right away
+                    uint64_t deadline = now + mt_test_random_below((uint32_t)range) - ((now > range / 4) ? range / 4 : 0);
+                    uint64_t tolerance = mt_test_random_below((uint32_t)range / 2);
+                    
+                    if (!mt_deadline_queue_schedule(queue, key, deadline, tolerance)) { differences++; }
+                    model[key] = (model_deadline_t){ true, deadline, tolerance };
+                    break;
+                }
+                
+                case 2:
+                    if (mt_deadline_queue_cancel(queue, key) != model[key].scheduled) { differences++; }
+                    model[key].scheduled = false;
+                    break;
+                
+                default: {
+                    
+                    // the timer fires somewhere in the window and delivers everything that is due
+                    uint64_t earliest, latest;
+                    
+                    if (mt_deadline_queue_next_wakeup(queue, &earliest, &latest)) {
+                        
+                        uint64_t wakeup = earliest + mt_test_random_below((uint32_t)(latest - earliest + 1));
+                        if (wakeup > now) { now = wakeup; }
+                        
+                        uint64_t previousDeadline = 0;
+                        
+                        while (mt_deadline_queue_pop(queue, now, &key)) {
+                            
+                            if (!model[key].scheduled || model[key].deadline < previousDeadline) {
+                                differences++;
+                            } else if (model[key].deadline > now) {
+                                earlyDeliveries++;
+                            } else if (model_latest(&model[key]) < now && wakeup == now) {
+                                lateDeliveries++;
+                            }
+                            
+                            previousDeadline = model[key].deadline;
+                            model[key].scheduled = false;
+                        }
+                        
+                        // nothing that is due is left behind
+                        uint64_t expectedEarliest, expectedLatest;
+                        if (model_window(model, keys, &expectedEarliest, &expectedLatest) > 0 && expectedEarliest <= now) { differences++; }
+                    }
+                    
+                    break;
+                }
+            }
+            
+            differences += compare_queue(queue, model, keys);
+        }
+        
+        mt_deadline_queue_destroy(queue);
+    }
+    
+    MT_CHECK_EQUAL(differences, 0);
+    MT_CHECK_EQUAL(earlyDeliveries, 0);
+    MT_CHECK_EQUAL(lateDeliveries, 0);
+}
+
+static void test_many_deadlines(void)
+{
+    // the window of a large queue, where most of the heap is skipped
+    uint32_t keys = 100000;
+    mt_deadline_queue_t *queue = mt_deadline_queue_create(keys);
+    model_deadline_t *model = calloc(keys, sizeof(model_deadline_t));
+    MT_CHECK(queue != NULL && model != NULL);
+    
+    if (queue && model) {
+        
+        for (uint32_t key = 0; key < keys; key++) {
+            
+            model[key] = (model_deadline_t){ true, mt_test_random(), mt_test_random_below(1000000000) };
+            mt_deadline_queue_schedule(queue, key, model[key].deadline, model[key].tolerance);
+        }
+        
+        MT_CHECK_EQUAL(compare_queue(queue, model, keys), 0);
+        
+        // everything comes out in order
+        uint64_t previousDeadline = 0;
+        uint32_t key = 0;
+        size_t popped = 0;
+        
+        while (mt_deadline_queue_pop(queue, UINT64_MAX, &key)) {
+            
+            if (model[key].deadline < previousDeadline) { break; }
+            previousDeadline = model[key].deadline;
+            popped++;
+        }
+        
+        MT_CHECK_EQUAL(popped, keys);
+    }
+    
+    mt_deadline_queue_destroy(queue);
+    free(model);
+}
+
+int main(int argc, const char * argv[])
+{
+    if (argc > 1) { iterations = strtoull(argv[1], NULL, 10); }
+    
+    mt_test_seed();
+    
+    MT_RUN_TEST(test_examples);
+    MT_RUN_TEST(test_fuzz);
+    MT_RUN_TEST(test_many_deadlines);
+    
+    return mt_test_result();
+}
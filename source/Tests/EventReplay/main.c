@@ -0,0 +1,374 @@
+/*
+    main.c
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    mt-event-replay feeds recorded Endpoint Security event streams into the event policy of
+    the system extension and reports the policy's latency, its verdict correctness and the
+    throughput. Recordings are either written by debug builds of the extension (see the
+    RecordEventsPath default) or generated by this tool.
+    
+    mt-event-replay generate <recording> [count]
+        Writes a synthetic stream of unlink, rename, clone and exec events. Every event
+        is recorded with the verdict the extension is expected to respond with.
+    
+    mt-event-replay replay <recording> [--rate <events per second>] [--protect <path>]...
+        Plays the recording back through mt_event_policy_evaluate, using the protected
+        paths of the extension (plus the given ones), and compares every verdict with
+        the recorded one. The events are played back as fast as possible unless a rate
+        is given. Exits with 1 if a verdict differs or the recording is damaged.
+*/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "MTEventRecorder.h"
+
+static const char *kProtectedFilePaths[] = {
+    "/Applications/Privileges.app",
+    "/Library/LaunchDaemons/corp.sap.privileges.daemon.plist",
+    "/Library/LaunchDaemons/corp.sap.privileges.helper.plist",
+    "/Library/LaunchDaemons/corp.sap.privileges.watcher.plist",
+    "/Library/LaunchAgents/corp.sap.privileges.agent.plist"
+};
+
+static const char *kProtectedExecPaths[] = {
+    "/bin/launchctl"
+};
+
+static const char kProtectedPlistPattern[] = "*/corp.sap.privileges.*.plist";
+static const char kLaunchctlSigningID[] = "com.apple.xpc.launchctl";
+
+#define MT_MAX_ADDITIONAL_PATHS 64
+
+# pragma mark - Helpers
+
+static uint64_t monotonic_time(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static mt_event_string_t event_string(const char *string)
+{
+    return (mt_event_string_t){ (string) ? strlen(string) : 0, string };
+}
+
+static mt_event_string_t argument_from_array(const void *context, uint32_t index)
+{
+    return event_string(((const char * const *)context)[index]);
+}
+
+static int compare_latencies(const void *a, const void *b)
+{
+    uint64_t first = *(const uint64_t*)a;
+    uint64_t second = *(const uint64_t*)b;
+    
+    return (first < second) ? -1 : (first > second);
+}
+
+// xorshift, so the synthetic stream is the same on every host
+static uint32_t next_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    
+    return (uint32_t)(*state >> 32);
+}
+
+# pragma mark - Synthetic streams
+
+typedef struct {
+    MTEventType type;
+    const char *source;
+    const char *destination;
+    const char *destinationName;
+    const char *signingID;
+    bool isPlatformBinary;
+    const char * const *arguments;
+    MTEventVerdict expectedVerdict;
+} mt_synthetic_event_t;
+
+static const char *kBootoutDaemon[] = { "launchctl", "bootout", "system", "/Library/LaunchDaemons/corp.sap.privileges.daemon.plist", NULL };
+static const char *kUnloadAgent[] = { "launchctl", "unload", "-w", "/Users/Shared/../../Library/LaunchAgents/corp.sap.privileges.agent.plist", NULL };
+static const char *kUnloadOther[] = { "launchctl", "unload", "-w", "/Library/LaunchAgents/com.example.agent.plist", NULL };
+static const char *kLoadDaemon[] = { "launchctl", "load", "/Library/LaunchDaemons/corp.sap.privileges.daemon.plist", NULL };
+static const char *kPrint[] = { "launchctl", "print", "system", NULL };
+
+static const mt_synthetic_event_t kSyntheticEvents[] = {
+    { MTEventTypeUnlink, "/Applications/Privileges.app/Contents/MacOS/Privileges", NULL, NULL, NULL, false, NULL, MTEventVerdictDeny },
+    { MTEventTypeUnlink, "/Applications/Privileges.app", NULL, NULL, NULL, false, NULL, MTEventVerdictDeny },
+    { MTEventTypeUnlink, "/Applications/Privileges2.app/Contents/Info.plist", NULL, NULL, NULL, false, NULL, MTEventVerdictAllow },
+    { MTEventTypeUnlink, "/Library/LaunchDaemons/corp.sap.privileges.daemon.plist", NULL, NULL, NULL, false, NULL, MTEventVerdictDeny },
+    { MTEventTypeRename, "/Library/LaunchAgents/corp.sap.privileges.agent.plist", "/tmp", "agent.plist", NULL, false, NULL, MTEventVerdictDeny },
+    { MTEventTypeRename, "/tmp/evil.plist", "/Library/LaunchDaemons", "corp.sap.privileges.helper.plist", NULL, false, NULL, MTEventVerdictDeny },
+    { MTEventTypeRename, "/tmp/evil.plist", "/Library/LaunchDaemons/corp.sap.privileges.watcher.plist", NULL, NULL, false, NULL, MTEventVerdictDeny },
+    { MTEventTypeRename, "/tmp/a", "/tmp", "b", NULL, false, NULL, MTEventVerdictAllow },
+    { MTEventTypeClone, "/Applications/Privileges.app/Contents/Info.plist", "/tmp", "Info.plist", NULL, false, NULL, MTEventVerdictDeny },
+    { MTEventTypeClone, "/tmp/a", "/Applications/Privileges.app/Contents", "b", NULL, false, NULL, MTEventVerdictDeny },
+    { MTEventTypeClone, "/tmp/a", "/tmp", "b", NULL, false, NULL, MTEventVerdictAllow },
+    { MTEventTypeExec, "/bin/launchctl", NULL, NULL, kLaunchctlSigningID, true, kBootoutDaemon, MTEventVerdictDeny },
+    { MTEventTypeExec, "/bin/launchctl", NULL, NULL, kLaunchctlSigningID, true, kUnloadAgent, MTEventVerdictDeny },
+    { MTEventTypeExec, "/bin/launchctl", NULL, NULL, kLaunchctlSigningID, true, kUnloadOther, MTEventVerdictAllow },
+    { MTEventTypeExec, "/bin/launchctl", NULL, NULL, kLaunchctlSigningID, true, kLoadDaemon, MTEventVerdictAllow },
+    { MTEventTypeExec, "/bin/launchctl", NULL, NULL, kLaunchctlSigningID, true, kPrint, MTEventVerdictAllow },
+    { MTEventTypeExec, "/bin/launchctl", NULL, NULL, "com.example.launchctl", false, kBootoutDaemon, MTEventVerdictAllow }
+};
+
+static int generate_recording(const char *path, unsigned long count)
+{
+    int success = 0;
+    mt_event_recorder_t *recorder = mt_event_recorder_open(path);
+    
+    if (recorder) {
+        
+        size_t scenarioCount = sizeof(kSyntheticEvents) / sizeof(kSyntheticEvents[0]);
+        uint64_t randomState = 0x9e3779b97f4a7c15ULL;
+        uint64_t timestamp = 0;
+        success = 1;
+        
+        for (unsigned long i = 0; i < count && success; i++) {
+            
+            const mt_synthetic_event_t *synthetic = &kSyntheticEvents[next_random(&randomState) % scenarioCount];
+            
+            mt_event_t event;
+            memset(&event, 0, sizeof(mt_event_t));
+            event.type = synthetic->type;
+            event.source = event_string(synthetic->source);
+            event.destination = event_string(synthetic->destination);
+            event.destinationName = event_string(synthetic->destinationName);
+            event.signingID = event_string(synthetic->signingID);
+            event.isPlatformBinary = synthetic->isPlatformBinary;
+            
+            if (synthetic->arguments) {
+                
+                while (synthetic->arguments[event.argumentCount]) { event.argumentCount++; }
+                event.argument = argument_from_array;
+                event.argumentContext = synthetic->arguments;
+            }
+            
+            // one event every 10 to 100 microseconds
+            timestamp += 10000 + (next_random(&randomState) % 90000);
+            success = (mt_event_recorder_write(recorder, &event, synthetic->expectedVerdict, timestamp) == 0);
+        }
+        
+        mt_event_recorder_close(recorder);
+        
+        if (success) {
+            printf("Wrote %lu events to %s\n", count, path);
+        } else {
+            fprintf(stderr, "Failed to write %s: %s\n", path, strerror(errno));
+        }
+        
+    } else {
+        
+        fprintf(stderr, "Failed to create %s: %s\n", path, strerror(errno));
+    }
+    
+    return success;
+}
+
+# pragma mark - Replay
+
+static void wait_until(uint64_t time)
+{
+    uint64_t now = monotonic_time();
+    
+    // sleep for longer waits and spin for the last bit, because
+    // sleeping is not accurate enough for high event rates
+    if (time > now + 200000) {
+        
+        uint64_t interval = time - now - 100000;
+        struct timespec duration = { (time_t)(interval / 1000000000ULL), (long)(interval % 1000000000ULL) };
+        nanosleep(&duration, NULL);
+    }
+    
+    while (monotonic_time() < time) {}
+}
+
+static int replay_recording(const char *path, uint64_t rate, const char * const *additionalPaths, size_t additionalPathCount)
+{
+    int success = 0;
+    mt_event_player_t *player = mt_event_player_open(path);
+    
+    if (player) {
+        
+        size_t fileCount = sizeof(kProtectedFilePaths) / sizeof(kProtectedFilePaths[0]);
+        const char *filePaths[sizeof(kProtectedFilePaths) / sizeof(kProtectedFilePaths[0]) + MT_MAX_ADDITIONAL_PATHS];
+        memcpy(filePaths, kProtectedFilePaths, sizeof(kProtectedFilePaths));
+        memcpy(filePaths + fileCount, additionalPaths, additionalPathCount * sizeof(char*));
+        
+        mt_glob_t plistPattern;
+        mt_glob_compile(&plistPattern, kProtectedPlistPattern);
+        
+        mt_verdict_cache_t verdictCache;
+        mt_verdict_cache_init(&verdictCache, 0x736f6d6570736575ULL, 0x646f72616e646f6dULL);
+        
+        mt_event_policy_t policy = {
+            mt_path_trie_create(filePaths, fileCount + additionalPathCount),
+            mt_path_trie_create(kProtectedExecPaths, sizeof(kProtectedExecPaths) / sizeof(kProtectedExecPaths[0])),
+            &plistPattern,
+            &verdictCache,
+            mt_verdict_cache_generation(&verdictCache)
+        };
+        
+        // count the events first, so the latencies can be kept without reallocating
+        unsigned long count = 0;
+        mt_event_t event;
+        MTEventVerdict recordedVerdict;
+        int status;
+        
+        while ((status = mt_event_player_next(player, &event, NULL, NULL)) == 1) { count++; }
+        
+        uint64_t *latencies = malloc((count > 0) ? count * sizeof(uint64_t) : 1);
+        
+        if (status < 0) {
+            
+            fprintf(stderr, "The recording %s is damaged\n", path);
+            
+        } else if (policy.protectedFiles && policy.protectedExecutables && latencies) {
+            
+            unsigned long events = 0;
+            unsigned long wrongVerdicts = 0;
+            unsigned long denied = 0;
+            
+            mt_event_player_rewind(player);
+            uint64_t startTime = monotonic_time();
+            
+            while ((status = mt_event_player_next(player, &event, &recordedVerdict, NULL)) == 1) {
+                
+                if (rate > 0) { wait_until(startTime + events * 1000000000ULL / rate); }
+                
+                uint64_t evaluationStart = monotonic_time();
+                MTEventVerdict verdict = mt_event_policy_evaluate(&policy, &event, NULL);
+                latencies[events++] = monotonic_time() - evaluationStart;
+                
+                if (verdict == MTEventVerdictDeny) { denied++; }
+                
+                if (verdict != recordedVerdict) {
+                    
+                    if (wrongVerdicts++ < 10) {
+                        fprintf(stderr, "Event %lu (type %d, %.*s): expected %s, got %s\n", events, event.type,
+                                (int)event.source.length, event.source.data, (recordedVerdict == MTEventVerdictDeny) ? "deny" : "allow",
+                                (verdict == MTEventVerdictDeny) ? "deny" : "allow");
+                    }
+                }
+            }
+            
+            double duration = (double)(monotonic_time() - startTime) / 1e9;
+            
+            if (status < 0) {
+                
+                fprintf(stderr, "The recording %s is damaged\n", path);
+                
+            } else if (events > 0) {
+                
+                qsort(latencies, events, sizeof(uint64_t), compare_latencies);
+                
+                printf("Events:          %lu (%lu denied)\n", events, denied);
+                printf("Rate:            %s\n", (rate > 0) ? "paced" : "unpaced");
+                printf("Throughput:      %.0f events/s\n", (double)events / duration);
+                printf("Wrong verdicts:  %lu\n", wrongVerdicts);
+                printf("Latency (ns):    p50 %llu, p90 %llu, p99 %llu, p99.9 %llu, max %llu\n",
+                       (unsigned long long)latencies[events / 2],
+                       (unsigned long long)latencies[events * 9 / 10],
+                       (unsigned long long)latencies[events * 99 / 100],
+                       (unsigned long long)latencies[events * 999 / 1000],
+                       (unsigned long long)latencies[events - 1]
+                );
+                
+                success = (wrongVerdicts == 0);
+                
+            } else {
+                
+                printf("The recording %s does not contain any events\n", path);
+                success = 1;
+            }
+            
+        } else {
+            
+            fprintf(stderr, "Failed to create the event policy\n");
+        }
+        
+        free(latencies);
+        mt_path_trie_destroy((mt_path_trie_t*)policy.protectedFiles);
+        mt_path_trie_destroy((mt_path_trie_t*)policy.protectedExecutables);
+        mt_event_player_close(player);
+        
+    } else {
+        
+        fprintf(stderr, "Failed to open the recording %s\n", path);
+    }
+    
+    return success;
+}
+
+static void print_usage(void)
+{
+    fprintf(stderr, "Usage: mt-event-replay generate <recording> [count]\n");
+    fprintf(stderr, "       mt-event-replay replay <recording> [--rate <events per second>] [--protect <path>]...\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int success = 0;
+    
+    if (argc >= 3 && argc <= 4 && strcmp(argv[1], "generate") == 0) {
+        
+        unsigned long count = (argc == 4) ? strtoul(argv[3], NULL, 10) : 100000;
+        success = generate_recording(argv[2], count);
+        
+    } else if (argc >= 3 && strcmp(argv[1], "replay") == 0) {
+        
+        const char *additionalPaths[MT_MAX_ADDITIONAL_PATHS];
+        size_t additionalPathCount = 0;
+        uint64_t rate = 0;
+        int validArguments = 1;
+        
+        for (int i = 3; i < argc && validArguments; i += 2) {
+            
+            if (i + 1 < argc && strcmp(argv[i], "--rate") == 0) {
+                
+                rate = strtoull(argv[i + 1], NULL, 10);
+                
+            } else if (i + 1 < argc && strcmp(argv[i], "--protect") == 0 && additionalPathCount < MT_MAX_ADDITIONAL_PATHS) {
+                
+                additionalPaths[additionalPathCount++] = argv[i + 1];
+                
+            } else {
+                
+                validArguments = 0;
+            }
+        }
+        
+        if (validArguments) {
+            success = replay_recording(argv[2], rate, additionalPaths, additionalPathCount);
+        } else {
+            print_usage();
+        }
+        
+    } else {
+        
+        print_usage();
+    }
+    
+    return (success) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+#
+# Writes the fixtures used by the tests. Run this script from the Fixtures directory.
+#
+# The binary property lists are used by the MTBinaryPlist tests. They mimic the group
+# records in /var/db/dslocal/nodes/Default/groups, where every attribute is an array
+# of strings.
+#
+# The xar archives are used by the MTXarArchive tests. They are laid out like signed
+# installer packages, but MTXarArchive only locates the checksum, the signature and the
+# certificates, so the certificates and signatures are placeholder data.
+
+import base64
+import hashlib
+import plistlib
+import struct
+import zlib
+
+def group_record(name, gid, users, nested_groups):
+    record = {
+        "generateduid": ["ABCDEFAB-CDEF-ABCD-EFAB-CDEF00000050"],
+        "gid": [str(gid)],
+        "name": [name],
+        "passwd": ["*"],
+        "realname": ["Administrators"],
+        "smb_sid": ["S-1-5-32-544"],
+        "groupmembers": ["FFFFEEEE-DDDD-CCCC-BBBB-AAAA%08X" % i for i in range(len(users or []))],
+    }
+
+    if users is not None: record["users"] = users
+    if nested_groups is not None: record["nestedgroups"] = nested_groups
+
+    return record
+
+def write(path, record):
+    with open(path, "wb") as file:
+        plistlib.dump(record, file, fmt=plistlib.FMT_BINARY, sort_keys=True)
+
+# non-ASCII strings are stored as UTF-16, the last one needs a surrogate pair
+write("admin.plist", group_record("admin", 80, ["root", "localadmin", "jürgen", "user\U0001F600"], ["ABCDEFAB-CDEF-ABCD-EFAB-CDEF0000000C"]))
+
+# more than 255 objects, so object references are two bytes long
+write("admin-large.plist", group_record("admin", 80, ["user%04d" % i for i in range(1000)], []))
+
+# the attribute is missing if a group has no users
+write("admin-empty.plist", group_record("admin", 80, None, None))
+
+# installer packages
+
+CERTIFICATES = [bytes([0x30, 0x82, 0x04, 0x00]) + bytes((i * 31 + n) % 256 for i in range(1024)) for n in (1, 2)]
+SIGNATURE_LENGTH = 256
+
+def write_xar(path, checksum, style="RSA", signed=True, cms=False):
+    digest_length = hashlib.new(checksum).digest_size
+    signature = ""
+
+    if signed:
+        encoded = ["\n".join(base64.b64encode(c).decode()[i:i + 64] for i in range(0, len(base64.b64encode(c)), 64)) for c in CERTIFICATES]
+        signature = ('  <signature style="%s">\n   <offset>%d</offset>\n   <size>%d</size>\n'
+                     '   <KeyInfo xmlns="http://www.w3.org/2000/09/xmldsig#">\n    <X509Data>\n%s    </X509Data>\n   </KeyInfo>\n  </signature>\n'
+                     % (style, digest_length, SIGNATURE_LENGTH, "".join("<X509Certificate>%s</X509Certificate>\n" % e for e in encoded)))
+
+    if cms:
+        signature += '  <x-signature style="CMS">\n   <offset>%d</offset>\n   <size>%d</size>\n  </x-signature>\n' % (digest_length, SIGNATURE_LENGTH)
+
+    toc = ('<?xml version="1.0" encoding="UTF-8"?>\n<xar>\n <toc>\n'
+           '  <checksum style="%s">\n   <offset>0</offset>\n   <size>%d</size>\n  </checksum>\n'
+           '  <creation-time>2026-01-01T00:00:00</creation-time>\n%s'
+           '  <file id="1">\n   <name>Distribution</name>\n  </file>\n </toc>\n</xar>\n' % (checksum, digest_length, signature)).encode()
+    compressed_toc = zlib.compress(toc)
+
+    # sha1 is identified by its number, other checksums by their name following the header
+    if checksum == "sha1":
+        name, algorithm = b"", 1
+    else:
+        name, algorithm = checksum.encode() + b"\0", 3
+        name += b"\0" * (-len(name) % 4)
+
+    header = struct.pack(">IHHQQI", 0x78617221, 28 + len(name), 1, len(compressed_toc), len(toc), algorithm) + name
+    heap = hashlib.new(checksum, compressed_toc).digest() + bytes(i % 251 for i in range(SIGNATURE_LENGTH)) + b"PAYLOAD" * 100
+
+    with open(path, "wb") as file:
+        file.write(header + compressed_toc + heap)
+
+for checksum in ("sha1", "sha256", "sha512"):
+    write_xar("package-%s.pkg" % checksum, checksum)
+
+write_xar("package-unsigned.pkg", "sha1", signed=False)
+write_xar("package-cms.pkg", "sha256", signed=False, cms=True)
+write_xar("package-dsa.pkg", "sha1", style="DSA")
+
+for n, certificate in enumerate(CERTIFICATES):
+    with open("package-certificate-%d.der" % n, "wb") as file:
+        file.write(certificate)
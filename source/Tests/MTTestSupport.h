@@ -0,0 +1,115 @@
+/*
+    MTTestSupport.h
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef MTTestSupport_h
+#define MTTestSupport_h
+
+/*
+    A minimal test harness for the portable C modules. Each test program defines its tests
+    as functions, runs them with MT_RUN_TEST and returns mt_test_result() from main. A failed
+    check reports the file and line and marks the whole program as failed, but the remaining
+    checks still run, so a single run shows all failures.
+    
+    The fuzz tests use mt_test_random, a seeded xorshift generator, so a failure can be
+    reproduced by passing the seed printed by the failing run (see mt_test_seed).
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int mt_test_failures = 0;
+static uint64_t mt_test_random_state = 0x9e3779b97f4a7c15ULL;
+
+#define MT_CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            mt_test_failures++; \
+        } \
+    } while (0)
+
+#define MT_CHECK_EQUAL(actual, expected) \
+    do { \
+        long long mt_actual = (long long)(actual), mt_expected = (long long)(expected); \
+        if (mt_actual != mt_expected) { \
+            fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #actual, #expected, mt_actual, mt_expected); \
+            mt_test_failures++; \
+        } \
+    } while (0)
+
+#define MT_CHECK_STRING(actual, expected) \
+    do { \
+        const char *mt_actual = (actual), *mt_expected = (expected); \
+        if (!mt_actual || !mt_expected || strcmp(mt_actual, mt_expected) != 0) { \
+            fprintf(stderr, "%s:%d: check failed: %s == \"%s\" (got \"%s\")\n", __FILE__, __LINE__, #actual, (mt_expected) ? mt_expected : "(null)", (mt_actual) ? mt_actual : "(null)"); \
+            mt_test_failures++; \
+        } \
+    } while (0)
+
+#define MT_RUN_TEST(test) \
+    do { \
+        int mt_failures_before = mt_test_failures; \
+        test(); \
+        fprintf(stderr, "%s %s\n", (mt_test_failures == mt_failures_before) ? "[ OK ]" : "[FAIL]", #test); \
+    } while (0)
+
+static inline int mt_test_result(void)
+{
+    return (mt_test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// seeds the random generator from the MT_TEST_SEED environment variable or the clock
+static inline uint64_t mt_test_seed(void)
+{
+    const char *seedString = getenv("MT_TEST_SEED");
+    uint64_t seed = (seedString) ? strtoull(seedString, NULL, 0) : (uint64_t)time(NULL);
+    
+    mt_test_random_state = (seed) ? seed : 1;
+    fprintf(stderr, "MT_TEST_SEED=%llu\n", (unsigned long long)seed);
+    
+    return seed;
+}
+
+static inline uint64_t mt_test_random(void)
+{
+    uint64_t x = mt_test_random_state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    mt_test_random_state = x;
+    
+    return x;
+}
+
+// returns a random number in [0, upperBound)
+static inline uint32_t mt_test_random_below(uint32_t upperBound)
+{
+    return (upperBound) ? (uint32_t)(mt_test_random() % upperBound) : 0;
+}
+
+static inline uint64_t mt_test_time(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+#endif /* MTTestSupport_h */
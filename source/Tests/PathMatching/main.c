@@ -0,0 +1,287 @@
+/*
+    main.c
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    Tests the glob patterns and the path trie of the event policy. Both are fuzzed against naive
+    reference implementations (a backtracking glob matcher and a linear prefix scan). Strings and
+    paths are copied into buffers of their exact size without a terminating null byte, so the
+    sanitizers catch reads past their end.
+    
+    mt-path-matching-test [iterations]
+*/
+
+#include <stdbool.h>
+#include "MTGlobPattern.h"
+#include "MTPathTrie.h"
+#include "MTTestSupport.h"
+
+#define MAX_PREFIXES 8
+
+static uint64_t iterations = 200000;
+
+#pragma mark - Helpers
+
+static char random_char(const char *alphabet)
+{
+    return alphabet[mt_test_random_below((uint32_t)strlen(alphabet))];
+}
+
+static void random_string(char *buffer, size_t maxLength, const char *alphabet)
+{
+    size_t length = mt_test_random_below((uint32_t)maxLength + 1);
+    for (size_t i = 0; i < length; i++) { buffer[i] = random_char(alphabet); }
+    buffer[length] = '\0';
+}
+
+static char *exact_copy(const char *string, size_t length)
+{
+    char *copy = malloc((length > 0) ? length : 1);
+    if (copy) { memcpy(copy, string, length); }
+    
+    return copy;
+}
+
+static bool glob_matches(const mt_glob_t *glob, const char *string)
+{
+    size_t length = strlen(string);
+    char *copy = exact_copy(string, length);
+    bool matches = mt_glob_match(glob, copy, length);
+    free(copy);
+    
+    return matches;
+}
+
+static bool trie_matches(const mt_path_trie_t *trie, const char *path)
+{
+    size_t length = strlen(path);
+    char *copy = exact_copy(path, length);
+    bool matches = mt_path_trie_matches(trie, copy, length);
+    free(copy);
+    
+    return matches;
+}
+
+#pragma mark - Reference implementations
+
+static char lower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+static bool reference_glob_match(const char *pattern, const char *string)
+{
+    bool matches = false;
+    
+    if (*pattern == '\0') {
+        matches = (*string == '\0');
+    } else if (*pattern == '*') {
+        for (const char *s = string; !matches; s++) {
+            matches = reference_glob_match(pattern + 1, s);
+            if (*s == '\0') { break; }
+        }
+    } else if (*string != '\0' && (*pattern == '?' || lower(*pattern) == lower(*string))) {
+        matches = reference_glob_match(pattern + 1, string + 1);
+    }
+    
+    return matches;
+}
+
+static size_t reference_glob_segments(const char *pattern)
+{
+    size_t segments = 0;
+    
+    for (size_t i = 0; pattern[i] != '\0'; i++) {
+        if (pattern[i] != '*' && (i == 0 || pattern[i - 1] == '*')) { segments++; }
+    }
+    
+    return segments;
+}
+
+static bool reference_prefix_match(char prefixes[][16], size_t count, const char *path)
+{
+    bool matches = false;
+    
+    for (size_t i = 0; !matches && i < count; i++) {
+        matches = (strncmp(prefixes[i], path, strlen(prefixes[i])) == 0);
+    }
+    
+    return matches;
+}
+
+#pragma mark - Tests
+
+static void test_glob_examples(void)
+{
+    mt_glob_t glob;
+    
+    MT_CHECK_EQUAL(mt_glob_compile(&glob, "/Applications/*.app/Contents/MacOS/*"), 0);
+    MT_CHECK(glob_matches(&glob, "/Applications/Safari.app/Contents/MacOS/Safari"));
+    MT_CHECK(glob_matches(&glob, "/applications/A.APP/contents/macos/"));
+    MT_CHECK(!glob_matches(&glob, "/Applications/Safari.app/Contents/Info.plist"));
+    
+    MT_CHECK_EQUAL(mt_glob_compile(&glob, "/usr/bin/?sh"), 0);
+    MT_CHECK(glob_matches(&glob, "/usr/bin/zsh"));
+    MT_CHECK(!glob_matches(&glob, "/usr/bin/sh"));
+    MT_CHECK(!glob_matches(&glob, "/usr/bin/bash"));
+    
+    MT_CHECK_EQUAL(mt_glob_compile(&glob, ""), 0);
+    MT_CHECK(glob_matches(&glob, ""));
+    MT_CHECK(!glob_matches(&glob, "a"));
+    
+    MT_CHECK_EQUAL(mt_glob_compile(&glob, "***"), 0);
+    MT_CHECK(glob_matches(&glob, ""));
+    MT_CHECK(glob_matches(&glob, "anything"));
+    
+    // the segments around a "*" must not overlap
+    MT_CHECK_EQUAL(mt_glob_compile(&glob, "ab*ba"), 0);
+    MT_CHECK(!glob_matches(&glob, "aba"));
+    MT_CHECK(glob_matches(&glob, "abba"));
+}
+
+static void test_glob_limits(void)
+{
+    mt_glob_t glob;
+    char pattern[MT_GLOB_MAX_LENGTH + 1];
+    
+    memset(pattern, 'a', MT_GLOB_MAX_LENGTH - 1);
+    pattern[MT_GLOB_MAX_LENGTH - 1] = '\0';
+    MT_CHECK_EQUAL(mt_glob_compile(&glob, pattern), 0);
+    
+    memset(pattern, 'a', MT_GLOB_MAX_LENGTH);
+    pattern[MT_GLOB_MAX_LENGTH] = '\0';
+    MT_CHECK_EQUAL(mt_glob_compile(&glob, pattern), -1);
+    
+    for (size_t segments = 1; segments <= MT_GLOB_MAX_SEGMENTS + 1; segments++) {
+        
+        size_t length = 0;
+        for (size_t i = 0; i < segments; i++) { length += (size_t)sprintf(pattern + length, "a*"); }
+        MT_CHECK_EQUAL(mt_glob_compile(&glob, pattern), (segments <= MT_GLOB_MAX_SEGMENTS) ? 0 : -1);
+    }
+}
+
+static void test_glob_fuzz(void)
+{
+    size_t differences = 0;
+    size_t compileErrors = 0;
+    
+    for (uint64_t i = 0; i < iterations; i++) {
+        
+        // mostly short patterns over a small alphabet, so that matches are frequent,
+        // and now and then a pattern with more segments than allowed
+        char pattern[48], string[32];
+        random_string(pattern, (i % 16 == 0) ? 40 : 12, "abAB/.*?");
+        random_string(string, 24, "abAB/.*?");
+        
+        mt_glob_t glob;
+        bool valid = (reference_glob_segments(pattern) <= MT_GLOB_MAX_SEGMENTS);
+        
+        if ((mt_glob_compile(&glob, pattern) == 0) != valid) {
+            compileErrors++;
+        } else if (valid && glob_matches(&glob, string) != reference_glob_match(pattern, string)) {
+            if (differences++ < 10) { fprintf(stderr, "pattern \"%s\", string \"%s\"\n", pattern, string); }
+        }
+    }
+    
+    MT_CHECK_EQUAL(compileErrors, 0);
+    MT_CHECK_EQUAL(differences, 0);
+}
+
+static void test_trie_examples(void)
+{
+    const char *prefixes[] = { "/System/", "/usr/lib/", "/usr/libexec/", "/usr/lib/dyld", "/System/" };
+    mt_path_trie_t *trie = mt_path_trie_create(prefixes, sizeof(prefixes) / sizeof(prefixes[0]));
+    MT_CHECK(trie != NULL);
+    
+    MT_CHECK(trie_matches(trie, "/System/Library/CoreServices/Finder.app"));
+    MT_CHECK(trie_matches(trie, "/usr/lib/dyld"));
+    MT_CHECK(trie_matches(trie, "/usr/libexec/xpcproxy"));
+    MT_CHECK(!trie_matches(trie, "/usr/li"));
+    MT_CHECK(!trie_matches(trie, "/System"));
+    MT_CHECK(!trie_matches(trie, "/system/Library"));
+    MT_CHECK(!trie_matches(trie, ""));
+    
+    mt_path_trie_destroy(trie);
+    
+    // an empty trie matches nothing, an empty prefix matches everything
+    trie = mt_path_trie_create(NULL, 0);
+    MT_CHECK(trie != NULL);
+    MT_CHECK(!trie_matches(trie, "/"));
+    mt_path_trie_destroy(trie);
+    
+    const char *empty[] = { "" };
+    trie = mt_path_trie_create(empty, 1);
+    MT_CHECK(trie != NULL);
+    MT_CHECK(trie_matches(trie, ""));
+    MT_CHECK(trie_matches(trie, "/Users"));
+    mt_path_trie_destroy(trie);
+    
+    mt_path_trie_destroy(NULL);
+}
+
+static void test_trie_fuzz(void)
+{
+    size_t differences = 0;
+    size_t creationErrors = 0;
+    
+    for (uint64_t i = 0; i < iterations / 10; i++) {
+        
+        char prefixes[MAX_PREFIXES][16];
+        const char *pointers[MAX_PREFIXES];
+        size_t count = mt_test_random_below(MAX_PREFIXES + 1);
+        
+        // a small alphabet produces shared prefixes, duplicates and prefixes of prefixes
+        for (size_t j = 0; j < count; j++) {
+            
+            random_string(prefixes[j], (j == 0) ? 3 : 8, "ab/");
+            pointers[j] = prefixes[j];
+        }
+        
+        mt_path_trie_t *trie = mt_path_trie_create(pointers, count);
+        
+        if (!trie) {
+            creationErrors++;
+        } else {
+            
+            for (int j = 0; j < 10; j++) {
+                
+                char path[16];
+                random_string(path, 10, "ab/");
+                if (trie_matches(trie, path) != reference_prefix_match(prefixes, count, path)) { differences++; }
+            }
+            
+            mt_path_trie_destroy(trie);
+        }
+    }
+    
+    MT_CHECK_EQUAL(creationErrors, 0);
+    MT_CHECK_EQUAL(differences, 0);
+}
+
+int main(int argc, const char * argv[])
+{
+    if (argc > 1) { iterations = strtoull(argv[1], NULL, 10); }
+    
+    mt_test_seed();
+    
+    MT_RUN_TEST(test_glob_examples);
+    MT_RUN_TEST(test_glob_limits);
+    MT_RUN_TEST(test_glob_fuzz);
+    MT_RUN_TEST(test_trie_examples);
+    MT_RUN_TEST(test_trie_fuzz);
+    
+    return mt_test_result();
+}
@@ -0,0 +1,176 @@
+/*
+    main.m
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    Tests the coalescing of preboot volume updates. Instead of updating the preboot volume, the
+    updater runs a shell script that logs the start and the end of every update, so the tests can
+    count the updates and verify that they never overlap.
+*/
+
+#import <Foundation/Foundation.h>
+#import "MTPrebootUpdater.h"
+#import "MTTestSupport.h"
+
+static NSString *logPath = nil;
+
+#pragma mark - Helpers
+
+static MTPrebootUpdater *stub_updater(NSTimeInterval debounceInterval, NSTimeInterval updateDuration)
+{
+    NSString *script = [NSString stringWithFormat:@"echo start >> '%@'; sleep %.2f; echo end >> '%@'", logPath, updateDuration, logPath];
+    [[NSFileManager defaultManager] removeItemAtPath:logPath error:nil];
+    
+    return [[MTPrebootUpdater alloc] initWithExecutablePath:@"/bin/sh"
+                                                  arguments:[NSArray arrayWithObjects:@"-c", script, nil]
+                                           debounceInterval:debounceInterval
+    ];
+}
+
+static NSArray *logged_events(void)
+{
+    NSString *log = [NSString stringWithContentsOfFile:logPath encoding:NSUTF8StringEncoding error:nil];
+    NSArray *lines = [[log stringByTrimmingCharactersInSet:[NSCharacterSet newlineCharacterSet]] componentsSeparatedByString:@"\n"];
+    
+    return ([log length] > 0) ? lines : [NSArray array];
+}
+
+// returns the number of updates and checks that they did not overlap
+static NSUInteger completed_updates(void)
+{
+    NSArray *events = logged_events();
+    NSUInteger updates = 0;
+    
+    for (NSUInteger i = 0; i < [events count]; i++) {
+        
+        NSString *expected = (i % 2 == 0) ? @"start" : @"end";
+        MT_CHECK([[events objectAtIndex:i] isEqualToString:expected]);
+        if (i % 2 == 1) { updates++; }
+    }
+    
+    MT_CHECK([events count] % 2 == 0);
+    
+    return updates;
+}
+
+static BOOL wait_until(BOOL (^condition)(void), NSTimeInterval timeout)
+{
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:timeout];
+    while (!condition() && [deadline timeIntervalSinceNow] > 0) { [NSThread sleepForTimeInterval:.01]; }
+    
+    return condition();
+}
+
+static BOOL wait_until_idle(MTPrebootUpdater *updater)
+{
+    return wait_until(^BOOL{ return ![updater isBusy]; }, 10);
+}
+
+#pragma mark - Tests
+
+static void test_burst_is_coalesced(void)
+{
+    MTPrebootUpdater *updater = stub_updater(.2, .05);
+    
+    // e.g. a group change event followed by the change
+    // notifications of several admin users
+    for (int i = 0; i < 50; i++) { [updater requestUpdate]; }
+    
+    MT_CHECK([updater isBusy]);
+    MT_CHECK(wait_until_idle(updater));
+    MT_CHECK_EQUAL(completed_updates(), 1);
+}
+
+static void test_debounce_is_restarted(void)
+{
+    MTPrebootUpdater *updater = stub_updater(.3, .05);
+    
+    // requests arriving faster than the debounce interval keep postponing the update
+    for (int i = 0; i < 5; i++) {
+        
+        [updater requestUpdate];
+        [NSThread sleepForTimeInterval:.1];
+    }
+    
+    MT_CHECK_EQUAL([logged_events() count], 0);
+    MT_CHECK(wait_until_idle(updater));
+    MT_CHECK_EQUAL(completed_updates(), 1);
+}
+
+static void test_requests_while_running(void)
+{
+    MTPrebootUpdater *updater = stub_updater(.05, .5);
+    
+    [updater requestUpdate];
+    MT_CHECK(wait_until(^BOOL{ return ([logged_events() count] == 1); }, 5));
+    
+    // all requests made during the update result in a single trailing update,
+    // which must not start before the running update has finished
+    for (int i = 0; i < 20; i++) { [updater requestUpdate]; }
+    
+    MT_CHECK(wait_until_idle(updater));
+    MT_CHECK_EQUAL(completed_updates(), 2);
+}
+
+static void test_separate_requests(void)
+{
+    MTPrebootUpdater *updater = stub_updater(.05, .05);
+    
+    for (int i = 0; i < 3; i++) {
+        
+        [updater requestUpdate];
+        MT_CHECK(wait_until_idle(updater));
+    }
+    
+    MT_CHECK_EQUAL(completed_updates(), 3);
+}
+
+static void test_failing_executable(void)
+{
+    MTPrebootUpdater *updater = [[MTPrebootUpdater alloc] initWithExecutablePath:@"/nonexistent/updater"
+                                                                       arguments:nil
+                                                                debounceInterval:.05
+    ];
+    
+    [updater requestUpdate];
+    MT_CHECK(wait_until_idle(updater));
+    
+    // the updater must still accept requests afterwards
+    [updater requestUpdate];
+    MT_CHECK([updater isBusy]);
+    MT_CHECK(wait_until_idle(updater));
+}
+
+int main(int argc, const char * argv[])
+{
+#pragma unused(argc)
+#pragma unused(argv)
+    
+    @autoreleasepool {
+        
+        logPath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"mt-preboot-test-%d.log", getpid()]];
+        
+        MT_RUN_TEST(test_burst_is_coalesced);
+        MT_RUN_TEST(test_debounce_is_restarted);
+        MT_RUN_TEST(test_requests_while_running);
+        MT_RUN_TEST(test_separate_requests);
+        MT_RUN_TEST(test_failing_executable);
+        
+        [[NSFileManager defaultManager] removeItemAtPath:logPath error:nil];
+    }
+    
+    return mt_test_result();
+}
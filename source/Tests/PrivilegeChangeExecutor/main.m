@@ -0,0 +1,313 @@
+/*
+    main.m
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    Simulates privilege change requests against MTPrivilegeChangeExecutor. The change handler
+    does not change any group membership. It keeps the privileges of the simulated users in a
+    dictionary, takes some time to "apply" them and fails for some users, so the tests can check
+    the coalescing and supersede rules and that every request is completed exactly once.
+    
+    mt-executor-test [requests]
+*/
+
+#import <Foundation/Foundation.h>
+#import <stdatomic.h>
+#import "MTPrivilegeChangeExecutor.h"
+#import "MTTestSupport.h"
+
+@interface MTSimulatedUsers : NSObject
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString*, NSNumber*> *privileges;
+@property (nonatomic, strong, readwrite) NSSet<NSString*> *failingUsers;
+@property (assign) NSTimeInterval applyDuration;
+@property (assign, readonly) NSUInteger batchCount;
+@property (assign, readonly) BOOL overlapDetected;
+- (MTPrivilegeChangeHandler)changeHandler;
+@end
+
+@implementation MTSimulatedUsers
+{
+    atomic_int _activeBatches;
+}
+
+- (instancetype)init
+{
+    self = [super init];
+    
+    if (self) {
+        _privileges = [[NSMutableDictionary alloc] init];
+    }
+    
+    return self;
+}
+
+- (MTPrivilegeChangeHandler)changeHandler
+{
+    return ^NSDictionary<NSString*, NSNumber*>*(NSDictionary<NSString*, NSNumber*> *changes) {
+        
+        if (atomic_fetch_add(&self->_activeBatches, 1) != 0) { self->_overlapDetected = YES; }
+        
+        NSMutableDictionary *results = [[NSMutableDictionary alloc] init];
+        [NSThread sleepForTimeInterval:[self applyDuration]];
+        
+        @synchronized (self) {
+            
+            self->_batchCount++;
+            
+            for (NSString *userName in changes) {
+                
+                BOOL success = ![[self failingUsers] containsObject:userName];
+                if (success) { [self->_privileges setObject:[changes objectForKey:userName] forKey:userName]; }
+                [results setObject:[NSNumber numberWithBool:success] forKey:userName];
+            }
+        }
+        
+        atomic_fetch_sub(&self->_activeBatches, 1);
+        
+        return results;
+    };
+}
+
+@end
+
+typedef struct {
+    const char *userName;
+    BOOL grant;
+    int result;
+    int completions;
+} request_t;
+
+static unsigned long simulatedRequests = 2000;
+
+#pragma mark - Helpers
+
+static BOOL wait_until_idle(MTPrivilegeChangeExecutor *executor)
+{
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:30];
+    while ([executor isBusy] && [deadline timeIntervalSinceNow] > 0) { [NSThread sleepForTimeInterval:.005]; }
+    
+    return ![executor isBusy];
+}
+
+static void submit(MTPrivilegeChangeExecutor *executor, request_t *requests, NSUInteger index, NSTimeInterval timeout)
+{
+    request_t *request = &requests[index];
+    
+    [executor submitChangeForUser:[NSString stringWithUTF8String:request->userName]
+             grantAdminPrivileges:request->grant
+                          timeout:timeout
+                completionHandler:^(MTPrivilegeChangeResult result) {
+        
+        @synchronized (executor) {
+            
+            request->result = result;
+            request->completions++;
+        }
+    }];
+}
+
+#pragma mark - Tests
+
+static void test_single_request(void)
+{
+    MTSimulatedUsers *users = [[MTSimulatedUsers alloc] init];
+    MTPrivilegeChangeExecutor *executor = [[MTPrivilegeChangeExecutor alloc] initWithChangeHandler:[users changeHandler]];
+    request_t requests[] = { { "alice", YES, -1, 0 } };
+    
+    submit(executor, requests, 0, 0);
+    
+    MT_CHECK(wait_until_idle(executor));
+    MT_CHECK_EQUAL(requests[0].completions, 1);
+    MT_CHECK_EQUAL(requests[0].result, MTPrivilegeChangeResultSuccess);
+    MT_CHECK([[[users privileges] objectForKey:@"alice"] boolValue]);
+}
+
+static void test_grant_revoke_grant(void)
+{
+    MTSimulatedUsers *users = [[MTSimulatedUsers alloc] init];
+    MTPrivilegeChangeExecutor *executor = [[MTPrivilegeChangeExecutor alloc] initWithChangeHandler:[users changeHandler]];
+    [users setApplyDuration:.2];
+    
+    request_t requests[] = {
+        { "bob", NO, -1, 0 },
+        { "alice", YES, -1, 0 },
+        { "alice", NO, -1, 0 },
+        { "alice", YES, -1, 0 }
+    };
+    
+    // the first request keeps the handler busy while the requests for alice are waiting
+    submit(executor, requests, 0, 0);
+    [NSThread sleepForTimeInterval:.05];
+    for (NSUInteger i = 1; i < 4; i++) { submit(executor, requests, i, 0); }
+    
+    MT_CHECK(wait_until_idle(executor));
+    MT_CHECK_EQUAL([users batchCount], 2);
+    MT_CHECK([[[users privileges] objectForKey:@"alice"] boolValue]);
+    
+    MT_CHECK_EQUAL(requests[0].result, MTPrivilegeChangeResultSuccess);
+    MT_CHECK_EQUAL(requests[1].result, MTPrivilegeChangeResultCoalesced);
+    MT_CHECK_EQUAL(requests[2].result, MTPrivilegeChangeResultSuperseded);
+    MT_CHECK_EQUAL(requests[3].result, MTPrivilegeChangeResultSuccess);
+    
+    for (NSUInteger i = 0; i < 4; i++) { MT_CHECK_EQUAL(requests[i].completions, 1); }
+}
+
+static void test_failed_change(void)
+{
+    MTSimulatedUsers *users = [[MTSimulatedUsers alloc] init];
+    MTPrivilegeChangeExecutor *executor = [[MTPrivilegeChangeExecutor alloc] initWithChangeHandler:[users changeHandler]];
+    [users setApplyDuration:.1];
+    [users setFailingUsers:[NSSet setWithObject:@"mallory"]];
+    
+    request_t requests[] = {
+        { "bob", YES, -1, 0 },
+        { "mallory", YES, -1, 0 },
+        { "mallory", NO, -1, 0 },
+        { "mallory", NO, -1, 0 }
+    };
+    
+    submit(executor, requests, 0, 0);
+    [NSThread sleepForTimeInterval:.03];
+    for (NSUInteger i = 1; i < 4; i++) { submit(executor, requests, i, 0); }
+    
+    // requests that asked for the same privileges share the failure
+    MT_CHECK(wait_until_idle(executor));
+    MT_CHECK_EQUAL(requests[1].result, MTPrivilegeChangeResultSuperseded);
+    MT_CHECK_EQUAL(requests[2].result, MTPrivilegeChangeResultFailed);
+    MT_CHECK_EQUAL(requests[3].result, MTPrivilegeChangeResultFailed);
+    MT_CHECK([[users privileges] objectForKey:@"mallory"] == nil);
+}
+
+static void test_timeout(void)
+{
+    MTSimulatedUsers *users = [[MTSimulatedUsers alloc] init];
+    MTPrivilegeChangeExecutor *executor = [[MTPrivilegeChangeExecutor alloc] initWithChangeHandler:[users changeHandler]];
+    [users setApplyDuration:.5];
+    
+    request_t requests[] = {
+        { "alice", YES, -1, 0 },
+        { "bob", YES, -1, 0 },
+        { "carol", YES, -1, 0 }
+    };
+    
+    // bob's request cannot be started within its timeout, carol's can wait
+    submit(executor, requests, 0, .1);
+    [NSThread sleepForTimeInterval:.05];
+    submit(executor, requests, 1, .1);
+    submit(executor, requests, 2, 5);
+    
+    MT_CHECK(wait_until_idle(executor));
+    MT_CHECK_EQUAL(requests[0].result, MTPrivilegeChangeResultSuccess);
+    MT_CHECK_EQUAL(requests[1].result, MTPrivilegeChangeResultTimedOut);
+    MT_CHECK_EQUAL(requests[2].result, MTPrivilegeChangeResultSuccess);
+    MT_CHECK([[users privileges] objectForKey:@"bob"] == nil);
+    
+    for (NSUInteger i = 0; i < 3; i++) { MT_CHECK_EQUAL(requests[i].completions, 1); }
+}
+
+static void test_random_requests(void)
+{
+    MTSimulatedUsers *users = [[MTSimulatedUsers alloc] init];
+    MTPrivilegeChangeExecutor *executor = [[MTPrivilegeChangeExecutor alloc] initWithChangeHandler:[users changeHandler]];
+    [users setApplyDuration:.002];
+    [users setFailingUsers:[NSSet setWithObjects:@"user3", @"user7", nil]];
+    
+    static const char *userNames[] = {
+        "user0", "user1", "user2", "user3", "user4", "user5", "user6", "user7", "user8", "user9",
+        "user10", "user11", "user12", "user13", "user14", "user15", "user16", "user17", "user18", "user19"
+    };
+    
+    request_t *requests = calloc(simulatedRequests, sizeof(request_t));
+    NSMutableDictionary<NSString*, NSNumber*> *lastRequests = [[NSMutableDictionary alloc] init];
+    
+    for (NSUInteger i = 0; i < simulatedRequests; i++) {
+        
+        requests[i].userName = userNames[mt_test_random_below(20)];
+        requests[i].grant = (mt_test_random_below(2) == 1);
+        requests[i].result = -1;
+        
+        [lastRequests setObject:[NSNumber numberWithUnsignedInteger:i] forKey:[NSString stringWithUTF8String:requests[i].userName]];
+        submit(executor, requests, i, 0);
+        
+        if (mt_test_random_below(10) == 0) { [NSThread sleepForTimeInterval:mt_test_random_below(3000) / 1000000.0]; }
+    }
+    
+    MT_CHECK(wait_until_idle(executor));
+    MT_CHECK(![users overlapDetected]);
+    
+    NSUInteger counts[5] = { 0 };
+    
+    @synchronized (executor) {
+        
+        for (NSUInteger i = 0; i < simulatedRequests; i++) {
+            
+            request_t *request = &requests[i];
+            NSString *userName = [NSString stringWithUTF8String:request->userName];
+            BOOL isFailing = [[users failingUsers] containsObject:userName];
+            MT_CHECK_EQUAL(request->completions, 1);
+            
+            if (request->result >= 0 && request->result < 5) { counts[request->result]++; }
+            
+            // superseded and coalesced requests must have a later request for the same user
+            if (request->result == MTPrivilegeChangeResultSuperseded || request->result == MTPrivilegeChangeResultCoalesced) {
+                
+                NSUInteger last = [[lastRequests objectForKey:userName] unsignedIntegerValue];
+                MT_CHECK(i < last);
+            }
+            
+            MT_CHECK(request->result != MTPrivilegeChangeResultTimedOut);
+            MT_CHECK((request->result == MTPrivilegeChangeResultFailed) == (isFailing && request->result != MTPrivilegeChangeResultSuperseded));
+            if (request->result == MTPrivilegeChangeResultCoalesced) { MT_CHECK(!isFailing); }
+        }
+        
+        // the privileges of every user match the user's last request
+        for (NSString *userName in lastRequests) {
+            
+            request_t *request = &requests[[[lastRequests objectForKey:userName] unsignedIntegerValue]];
+            
+            if (request->result == MTPrivilegeChangeResultSuccess) {
+                MT_CHECK([[[users privileges] objectForKey:userName] boolValue] == request->grant);
+            } else {
+                MT_CHECK(request->result == MTPrivilegeChangeResultFailed);
+            }
+        }
+    }
+    
+    fprintf(stderr, "%lu requests in %lu batches: %lu applied, %lu coalesced, %lu superseded, %lu failed\n",
+            simulatedRequests, (unsigned long)[users batchCount],
+            (unsigned long)counts[MTPrivilegeChangeResultSuccess], (unsigned long)counts[MTPrivilegeChangeResultCoalesced],
+            (unsigned long)counts[MTPrivilegeChangeResultSuperseded], (unsigned long)counts[MTPrivilegeChangeResultFailed]);
+    
+    free(requests);
+}
+
+int main(int argc, const char * argv[])
+{
+    @autoreleasepool {
+        
+        if (argc > 1) { simulatedRequests = strtoul(argv[1], NULL, 10); }
+        
+        mt_test_seed();
+        
+        MT_RUN_TEST(test_single_request);
+        MT_RUN_TEST(test_grant_revoke_grant);
+        MT_RUN_TEST(test_failed_change);
+        MT_RUN_TEST(test_timeout);
+        MT_RUN_TEST(test_random_requests);
+    }
+    
+    return mt_test_result();
+}
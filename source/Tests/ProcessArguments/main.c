@@ -0,0 +1,428 @@
+/*
+    main.c
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    Tests the process argument reader with the test process itself and with a child that has
+    more arguments than fit into the initial buffer. The parser is fuzzed with random argument
+    lists in the sysctl(KERN_PROCARGS2) layout, which must be parsed back exactly, and with
+    truncated and mutated copies of them, which must be rejected or parsed without reading
+    past the end of the data.
+    
+    mt-process-arguments-test [iterations]
+*/
+
+#include <errno.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "MTProcessArguments.h"
+#include "MTTestSupport.h"
+
+#define MAX_STRINGS     16
+#define MAX_STRING      24
+#define MAX_LAYOUT      (sizeof(int) + (2 * MAX_STRINGS + 4) * (MAX_STRING + 1) + 16)
+
+typedef struct {
+    char path[MAX_STRING + 1];
+    size_t argumentCount;
+    char arguments[MAX_STRINGS][MAX_STRING + 1];
+    size_t environmentCount;
+    char environment[MAX_STRINGS][MAX_STRING + 1];
+} process_t;
+
+extern char **environ;
+
+static unsigned long fuzzIterations = 200000;
+static int testArgc = 0;
+static const char **testArgv = NULL;
+
+#pragma mark - Helpers
+
+static int span_equals(mt_process_span_t span, const char *string)
+{
+    return (span.length == strlen(string) && memcmp(span.data, string, span.length) == 0);
+}
+
+static size_t offset_of(const char *data, size_t length, const char *string)
+{
+    const char *position = memmem(data, length, string, strlen(string));
+    
+    return (position) ? (size_t)(position - data) : length;
+}
+
+static void random_string(char *buffer, size_t minLength)
+{
+    size_t length = minLength + mt_test_random_below(MAX_STRING - (uint32_t)minLength + 1);
+    
+    // any byte but the null character
+    for (size_t i = 0; i < length; i++) { buffer[i] = (char)(1 + mt_test_random_below(255)); }
+    buffer[length] = '\0';
+}
+
+static void random_process(process_t *process)
+{
+    random_string(process->path, 1);
+    process->argumentCount = mt_test_random_below(MAX_STRINGS + 1);
+    process->environmentCount = mt_test_random_below(MAX_STRINGS + 1);
+    
+    // the first argument must not be empty, as it can't be told apart from the padding,
+    // and neither must environment variables, as an empty string ends the environment
+    for (size_t i = 0; i < process->argumentCount; i++) { random_string(process->arguments[i], (i == 0) ? 1 : 0); }
+    for (size_t i = 0; i < process->environmentCount; i++) { random_string(process->environment[i], 1); }
+}
+
+static size_t append_string(char *layout, size_t length, const char *string)
+{
+    size_t stringLength = strlen(string) + 1;
+    memcpy(layout + length, string, stringLength);
+    
+    return length + stringLength;
+}
+
+// writes the process in the layout returned by sysctl(KERN_PROCARGS2)
+static size_t process_layout(const process_t *process, char *layout)
+{
+    int argc = (int)process->argumentCount;
+    memcpy(layout, &argc, sizeof(argc));
+    
+    size_t length = append_string(layout, sizeof(argc), process->path);
+    
+    size_t padding = mt_test_random_below(8);
+    memset(layout + length, 0, padding);
+    length += padding;
+    
+    for (size_t i = 0; i < process->argumentCount; i++) { length = append_string(layout, length, process->arguments[i]); }
+    for (size_t i = 0; i < process->environmentCount; i++) { length = append_string(layout, length, process->environment[i]); }
+    
+    // macOS adds an empty string and the "apple" strings, which must be ignored. Without
+    // arguments and environment, that empty string can't be told apart from the padding
+    if ((process->argumentCount > 0 || process->environmentCount > 0) && mt_test_random_below(2)) {
+        
+        length = append_string(layout, length, "");
+        length = append_string(layout, length, "executable_path=/usr/bin/true");
+    }
+    
+    return length;
+}
+
+static int parse_copy(mt_process_arguments_t *arguments, const char *data, size_t length, char **copy)
+{
+    // an exact-size copy, so the sanitizers catch reads past the end
+    *copy = malloc((length > 0) ? length : 1);
+    memcpy(*copy, data, length);
+    
+    return mt_process_arguments_parse(arguments, *copy, length);
+}
+
+// checks that the spans lie within the data and do not contain null characters
+static void check_spans(const mt_process_arguments_t *arguments, const char *data, size_t length)
+{
+    size_t count = arguments->argumentCount + arguments->environmentCount;
+    MT_CHECK(count == 0 || count <= arguments->spanCapacity);
+    
+    for (size_t i = 0; i <= count; i++) {
+        
+        mt_process_span_t span = (i < count) ? arguments->spans[i] : arguments->executablePath;
+        MT_CHECK(span.data >= data && span.data + span.length <= data + length);
+        MT_CHECK(memchr(span.data, '\0', span.length) == NULL);
+    }
+}
+
+#pragma mark - Tests
+
+static void test_parse_layout(void)
+{
+    static const char layout[] = "argc/usr/bin/tool\0\0\0\0one\0\0three\0A=1\0B=\0\0apple=1\0";
+    
+    mt_process_arguments_t arguments;
+    mt_process_arguments_init(&arguments);
+    
+    // the layout starts with the argument count in host byte order
+    char data[sizeof(layout) - 1];
+    int argc = 3;
+    memcpy(data, layout, sizeof(data));
+    memcpy(data, &argc, sizeof(argc));
+    
+    MT_CHECK_EQUAL(mt_process_arguments_parse(&arguments, data, sizeof(data)), 0);
+    MT_CHECK(span_equals(arguments.executablePath, "/usr/bin/tool"));
+    MT_CHECK_EQUAL(arguments.argumentCount, 3);
+    MT_CHECK(span_equals(mt_process_arguments_argument(&arguments, 0), "one"));
+    MT_CHECK(span_equals(mt_process_arguments_argument(&arguments, 1), ""));
+    MT_CHECK(span_equals(mt_process_arguments_argument(&arguments, 2), "three"));
+    MT_CHECK_EQUAL(arguments.environmentCount, 2);
+    MT_CHECK(span_equals(mt_process_arguments_environment(&arguments, 0), "A=1"));
+    MT_CHECK(span_equals(mt_process_arguments_environment(&arguments, 1), "B="));
+    
+    // an environment variable that is not terminated is ignored
+    MT_CHECK_EQUAL(mt_process_arguments_parse(&arguments, data, offset_of(data, sizeof(data), "B=") + 2), 0);
+    MT_CHECK_EQUAL(arguments.environmentCount, 1);
+    
+    // no environment at all
+    MT_CHECK_EQUAL(mt_process_arguments_parse(&arguments, data, offset_of(data, sizeof(data), "A=1")), 0);
+    MT_CHECK_EQUAL(arguments.argumentCount, 3);
+    MT_CHECK_EQUAL(arguments.environmentCount, 0);
+    
+    mt_process_arguments_free(&arguments);
+}
+
+static void test_parse_invalid(void)
+{
+    mt_process_arguments_t arguments;
+    mt_process_arguments_init(&arguments);
+    
+    char data[64] = { 0 };
+    int argc = 0;
+    
+    // too short for the argument count
+    errno = 0;
+    MT_CHECK_EQUAL(mt_process_arguments_parse(&arguments, data, sizeof(argc) - 1), -1);
+    MT_CHECK_EQUAL(errno, EINVAL);
+    
+    // no executable path
+    MT_CHECK_EQUAL(mt_process_arguments_parse(&arguments, data, sizeof(argc)), -1);
+    
+    // the executable path is not terminated
+    memcpy(data + sizeof(argc), "/bin/sh", 7);
+    MT_CHECK_EQUAL(mt_process_arguments_parse(&arguments, data, sizeof(argc) + 7), -1);
+    MT_CHECK_EQUAL(mt_process_arguments_parse(&arguments, data, sizeof(argc) + 8), 0);
+    MT_CHECK_EQUAL(arguments.argumentCount, 0);
+    
+    // a negative or too large argument count
+    argc = -1;
+    memcpy(data, &argc, sizeof(argc));
+    MT_CHECK_EQUAL(mt_process_arguments_parse(&arguments, data, sizeof(data)), -1);
+    
+    argc = (int)sizeof(data) + 1;
+    memcpy(data, &argc, sizeof(argc));
+    MT_CHECK_EQUAL(mt_process_arguments_parse(&arguments, data, sizeof(data)), -1);
+    
+    // fewer arguments than announced
+    argc = 2;
+    memcpy(data, &argc, sizeof(argc));
+    memcpy(data + sizeof(argc) + 8, "sh", 3);
+    MT_CHECK_EQUAL(mt_process_arguments_parse(&arguments, data, sizeof(argc) + 11), -1);
+    MT_CHECK_EQUAL(arguments.argumentCount, 1);
+    
+    mt_process_arguments_free(&arguments);
+}
+
+static void test_read_own_process(void)
+{
+    mt_process_arguments_t arguments;
+    mt_process_arguments_init(&arguments);
+    
+    MT_CHECK_EQUAL(mt_process_arguments_read(&arguments, getpid()), 0);
+    MT_CHECK_EQUAL(arguments.argumentCount, testArgc);
+    
+    for (size_t i = 0; i < arguments.argumentCount && i < (size_t)testArgc; i++) {
+        MT_CHECK(span_equals(mt_process_arguments_argument(&arguments, i), testArgv[i]));
+    }
+    
+    // the environment has not been changed, so it's still the one the process has been started with
+    size_t environmentCount = 0;
+    while (environ[environmentCount]) { environmentCount++; }
+    
+    MT_CHECK_EQUAL(arguments.environmentCount, environmentCount);
+    
+    for (size_t i = 0; i < arguments.environmentCount && i < environmentCount; i++) {
+        MT_CHECK(span_equals(mt_process_arguments_environment(&arguments, i), environ[i]));
+    }
+    
+    MT_CHECK(arguments.executablePath.length > 0 && arguments.executablePath.data[0] == '/');
+    
+    // reading again reuses the buffers
+    char *buffer = arguments.buffer;
+    mt_process_span_t *spans = arguments.spans;
+    
+    MT_CHECK_EQUAL(mt_process_arguments_read(&arguments, getpid()), 0);
+    MT_CHECK(arguments.buffer == buffer && arguments.spans == spans);
+    MT_CHECK_EQUAL(arguments.argumentCount, testArgc);
+    
+    // a process that does not exist
+    pid_t pid = fork();
+    if (pid == 0) { _exit(EXIT_SUCCESS); }
+    waitpid(pid, NULL, 0);
+    
+    errno = 0;
+    MT_CHECK_EQUAL(mt_process_arguments_read(&arguments, pid), -1);
+    MT_CHECK(errno != 0);
+    
+    mt_process_arguments_free(&arguments);
+    MT_CHECK(arguments.buffer == NULL && arguments.spans == NULL);
+}
+
+static void test_read_long_arguments(void)
+{
+    // more than fits into the initial buffer (and into the initial span array)
+    enum { argumentCount = 2000, argumentLength = 100 };
+    
+    char **argv = calloc(argumentCount + 1, sizeof(char*));
+    char *strings = malloc(argumentCount * (argumentLength + 1));
+    argv[0] = "/bin/sh";
+    argv[1] = "-c";
+    argv[2] = "read line";
+    
+    for (size_t i = 3; i < argumentCount; i++) {
+        
+        argv[i] = strings + i * (argumentLength + 1);
+        memset(argv[i], 'a' + (int)(i % 26), argumentLength);
+        argv[i][argumentLength] = '\0';
+    }
+    
+    // the shell waits (without starting another process) until its input is closed
+    pid_t pid = 0;
+    int fds[2] = { -1, -1 };
+    char *envp[] = { "MT_TEST=1", NULL };
+    posix_spawn_file_actions_t fileActions;
+    
+    MT_CHECK_EQUAL(pipe(fds), 0);
+    posix_spawn_file_actions_init(&fileActions);
+    posix_spawn_file_actions_adddup2(&fileActions, fds[0], STDIN_FILENO);
+    posix_spawn_file_actions_addclose(&fileActions, fds[1]);
+    MT_CHECK_EQUAL(posix_spawn(&pid, argv[0], &fileActions, NULL, argv, envp), 0);
+    posix_spawn_file_actions_destroy(&fileActions);
+    close(fds[0]);
+    
+    mt_process_arguments_t arguments;
+    mt_process_arguments_init(&arguments);
+    
+    // until the child has executed the shell, it still has our arguments
+    uint64_t deadline = mt_test_time() + 5000000000ULL;
+    int result = -1;
+    
+    while (pid > 0 && mt_test_time() < deadline) {
+        
+        result = mt_process_arguments_read(&arguments, pid);
+        if (result == 0 && arguments.argumentCount == argumentCount) { break; }
+        usleep(1000);
+    }
+    
+    MT_CHECK_EQUAL(result, 0);
+    MT_CHECK_EQUAL(arguments.argumentCount, argumentCount);
+    
+    for (size_t i = 0; i < arguments.argumentCount && i < argumentCount; i++) {
+        MT_CHECK(span_equals(mt_process_arguments_argument(&arguments, i), argv[i]));
+    }
+    
+    MT_CHECK_EQUAL(arguments.environmentCount, 1);
+    MT_CHECK(arguments.environmentCount < 1 || span_equals(mt_process_arguments_environment(&arguments, 0), "MT_TEST=1"));
+    
+    close(fds[1]);
+    if (pid > 0) { waitpid(pid, NULL, 0); }
+    
+    mt_process_arguments_free(&arguments);
+    free(strings);
+    free(argv);
+}
+
+static void test_fuzz_valid(void)
+{
+    mt_process_arguments_t arguments;
+    mt_process_arguments_init(&arguments);
+    size_t differences = 0;
+    
+    for (unsigned long iteration = 0; iteration < fuzzIterations; iteration++) {
+        
+        process_t process;
+        char layout[MAX_LAYOUT];
+        char *copy = NULL;
+        
+        random_process(&process);
+        size_t length = process_layout(&process, layout);
+        
+        int result = parse_copy(&arguments, layout, length, &copy);
+        int equal = (result == 0 && span_equals(arguments.executablePath, process.path) &&
+                     arguments.argumentCount == process.argumentCount && arguments.environmentCount == process.environmentCount);
+        
+        for (size_t i = 0; equal && i < process.argumentCount; i++) { equal = span_equals(mt_process_arguments_argument(&arguments, i), process.arguments[i]); }
+        for (size_t i = 0; equal && i < process.environmentCount; i++) { equal = span_equals(mt_process_arguments_environment(&arguments, i), process.environment[i]); }
+        
+        if (!equal) { differences++; }
+        free(copy);
+    }
+    
+    MT_CHECK_EQUAL(differences, 0);
+    mt_process_arguments_free(&arguments);
+}
+
+static void test_fuzz_damaged(void)
+{
+    mt_process_arguments_t arguments;
+    mt_process_arguments_init(&arguments);
+    unsigned long parsed = 0;
+    
+    for (unsigned long iteration = 0; iteration < fuzzIterations; iteration++) {
+        
+        process_t process;
+        char layout[MAX_LAYOUT];
+        char *copy = NULL;
+        
+        random_process(&process);
+        size_t length = process_layout(&process, layout);
+        
+        if (iteration % 2 == 0) {
+            
+            // cut the data anywhere, e.g. within an argument
+            length = mt_test_random_below((uint32_t)length + 1);
+            
+        } else {
+            
+            // change some bytes, including the argument count
+            uint32_t mutations = 1 + mt_test_random_below(3);
+            
+            for (uint32_t m = 0; m < mutations; m++) {
+                
+                size_t position = (mt_test_random_below(4) == 0) ? mt_test_random_below(sizeof(int)) : mt_test_random_below((uint32_t)length);
+                layout[position] = (mt_test_random_below(2)) ? '\0' : (char)mt_test_random();
+            }
+        }
+        
+        if (parse_copy(&arguments, layout, length, &copy) == 0) {
+            
+            check_spans(&arguments, copy, length);
+            parsed++;
+            
+        } else {
+            
+            MT_CHECK(errno == EINVAL);
+        }
+        
+        free(copy);
+    }
+    
+    fprintf(stderr, "%lu of %lu damaged layouts parsed\n", parsed, fuzzIterations);
+    mt_process_arguments_free(&arguments);
+}
+
+int main(int argc, const char * argv[])
+{
+    if (argc > 1) { fuzzIterations = strtoul(argv[1], NULL, 10); }
+    
+    testArgc = argc;
+    testArgv = argv;
+    
+    mt_test_seed();
+    
+    MT_RUN_TEST(test_parse_layout);
+    MT_RUN_TEST(test_parse_invalid);
+    MT_RUN_TEST(test_read_own_process);
+    MT_RUN_TEST(test_read_long_arguments);
+    MT_RUN_TEST(test_fuzz_valid);
+    MT_RUN_TEST(test_fuzz_damaged);
+    
+    return mt_test_result();
+}
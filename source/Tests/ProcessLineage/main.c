@@ -0,0 +1,731 @@
+/*
+    main.c
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    Tests the process lineage with a few hand-written scenarios and with random process histories.
+    A history simulates processes that fork, exec and exit, with a small range of process ids, so
+    ids are reused all the time, and with processes that were already running when the lineage was
+    created. Its fork, exec and exit notifications are fed into the lineage and into a model, which
+    implements the documented behavior without evicting anything. It only learns from lookups
+    which new processes the lineage had to drop. With enough capacity, every lookup must match the
+    model exactly. With less capacity, the lineage may also have evicted the exited parent of a
+    process, but everything else must still match.
+    
+    A history only depends on the seed, so a failing run can be replayed with the printed seed
+    (see mt_test_seed), and it prints the notifications that led to the first difference.
+    
+    mt-process-lineage-test [steps per history]
+*/
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <strings.h>
+#include "MTProcessLineage.h"
+#include "MTTestSupport.h"
+
+#define MAX_PIDS            64
+#define MAX_ARGUMENTS       4
+#define HISTORY_LENGTH      8
+
+typedef struct {
+    const char *path;
+    bool isPlatformBinary;
+} image_t;
+
+typedef struct {
+    size_t count;
+    const char *arguments[MAX_ARGUMENTS];
+} argument_list_t;
+
+// a process of the simulated system
+typedef struct {
+    bool running;
+    uint32_t pidVersion;
+    pid_t parentPID;
+    size_t image;
+} world_process_t;
+
+// the model's entry of a process, which is replaced when the process id is reused
+typedef struct {
+    uint64_t sequence;              // 0 = none
+    uint32_t pidVersion;
+    bool exited;
+    pid_t parentPID;
+    uint64_t parentSequence;
+    pid_t rootPID;
+    bool rootIsPlatformBinary;
+    char name[MT_PROCESS_LINEAGE_MAX_NAME];
+    char rootName[MT_PROCESS_LINEAGE_MAX_NAME];
+    bool argumentsKnown;
+    size_t packageCount;
+    char packagePath[MT_PROCESS_LINEAGE_MAX_PATH];
+} model_entry_t;
+
+typedef struct {
+    world_process_t processes[MAX_PIDS];
+    model_entry_t entries[MAX_PIDS];
+    uint64_t nextSequence;
+    uint32_t nextPIDVersion;
+    char history[HISTORY_LENGTH][128];
+    size_t historyCount;
+} simulation_t;
+
+static unsigned long historySteps = 20000;
+static char longName[MT_PROCESS_LINEAGE_MAX_NAME + 16];
+static char longPackagePath[MT_PROCESS_LINEAGE_MAX_PATH + 16];
+
+static const image_t images[] = {
+    { "/sbin/launchd", true },
+    { "/usr/bin/login", true },
+    { "/bin/zsh", true },
+    { "/usr/sbin/installer", true },
+    { "/Applications/Privileges.app/Contents/MacOS/Privileges", false },
+    { "/usr/local/bin/Installer", false },
+    { longName, false }
+};
+
+static const char *argumentPool[] = {
+    "-pkg", "/tmp/a.pkg", "/tmp/A.PKG", "/tmp/b.pkg", "-target", "/", "a.pk", ".pkg", longPackagePath
+};
+
+#pragma mark - Notifications
+
+static mt_event_string_t string_token(const char *string)
+{
+    return (mt_event_string_t){ (string) ? strlen(string) : 0, string };
+}
+
+static mt_event_string_t list_argument(const void *context, uint32_t index)
+{
+    const argument_list_t *list = context;
+    return string_token(list->arguments[index]);
+}
+
+static mt_process_lineage_process_t notification_process(const simulation_t *simulation, pid_t pid)
+{
+    const world_process_t *process = &simulation->processes[pid];
+    const image_t *image = &images[process->image];
+    
+    return (mt_process_lineage_process_t){ pid, process->pidVersion, process->parentPID, string_token(image->path), image->isPlatformBinary };
+}
+
+static void log_notification(simulation_t *simulation, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+static void log_notification(simulation_t *simulation, const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(simulation->history[simulation->historyCount++ % HISTORY_LENGTH], sizeof(simulation->history[0]), format, arguments);
+    va_end(arguments);
+}
+
+static void print_history(const simulation_t *simulation)
+{
+    size_t count = (simulation->historyCount < HISTORY_LENGTH) ? simulation->historyCount : HISTORY_LENGTH;
+    
+    for (size_t i = simulation->historyCount - count; i < simulation->historyCount; i++) {
+        fprintf(stderr, "    %s\n", simulation->history[i % HISTORY_LENGTH]);
+    }
+}
+
+#pragma mark - Model
+
+static void model_copy_name(char *name, const char *path)
+{
+    const char *lastComponent = strrchr(path, '/');
+    lastComponent = (lastComponent) ? lastComponent + 1 : path;
+    
+    // names that don't fit are not stored
+    size_t length = strlen(lastComponent);
+    if (length >= MT_PROCESS_LINEAGE_MAX_NAME) { length = 0; }
+    
+    memcpy(name, lastComponent, length);
+    name[length] = '\0';
+}
+
+static model_entry_t *model_add(simulation_t *simulation, const mt_process_lineage_process_t *process, const model_entry_t *parent)
+{
+    model_entry_t *entry = &simulation->entries[process->pid];
+    memset(entry, 0, sizeof(model_entry_t));
+    
+    entry->sequence = simulation->nextSequence++;
+    entry->pidVersion = process->pidVersion;
+    entry->parentPID = process->parentPID;
+    model_copy_name(entry->name, process->executablePath.data);
+    
+    if (process->parentPID == 1) {
+        
+        entry->rootPID = process->pid;
+        entry->rootIsPlatformBinary = process->isPlatformBinary;
+        memcpy(entry->rootName, entry->name, sizeof(entry->rootName));
+        
+    } else if (parent) {
+        
+        entry->rootPID = parent->rootPID;
+        entry->rootIsPlatformBinary = parent->rootIsPlatformBinary;
+        memcpy(entry->rootName, parent->rootName, sizeof(entry->rootName));
+    }
+    
+    if (parent) { entry->parentSequence = parent->sequence; }
+    
+    return entry;
+}
+
+static model_entry_t *model_entry(simulation_t *simulation, const mt_process_lineage_process_t *process)
+{
+    model_entry_t *entry = &simulation->entries[process->pid];
+    
+    if (entry->sequence == 0 || entry->pidVersion != process->pidVersion || entry->exited) {
+        
+        model_entry_t *parent = &simulation->entries[process->parentPID];
+        if (parent->sequence == 0 || parent->exited) { parent = NULL; }
+        
+        entry = model_add(simulation, process, parent);
+    }
+    
+    return entry;
+}
+
+static void model_exec(simulation_t *simulation, const mt_process_lineage_process_t *process, const mt_process_lineage_process_t *target, const argument_list_t *list)
+{
+    model_entry_t *entry = model_entry(simulation, process);
+    const char *package = NULL;
+    
+    entry->pidVersion = target->pidVersion;
+    model_copy_name(entry->name, target->executablePath.data);
+    
+    if (entry->rootPID == process->pid) {
+        
+        memcpy(entry->rootName, entry->name, sizeof(entry->rootName));
+        entry->rootIsPlatformBinary = target->isPlatformBinary;
+    }
+    
+    entry->packageCount = 0;
+    
+    for (size_t i = 0; i < list->count; i++) {
+        
+        size_t length = strlen(list->arguments[i]);
+        if (length < 4 || strcasecmp(list->arguments[i] + length - 4, ".pkg") != 0) { continue; }
+        
+        if (!package) {
+            
+            package = list->arguments[i];
+            entry->packageCount = 1;
+            
+        } else if (strcmp(package, list->arguments[i]) != 0) {
+            
+            entry->packageCount = 2;
+        }
+    }
+    
+    entry->argumentsKnown = (entry->packageCount != 1 || strlen(package) < MT_PROCESS_LINEAGE_MAX_PATH);
+    entry->packagePath[0] = '\0';
+    if (entry->packageCount == 1 && entry->argumentsKnown) { strcpy(entry->packagePath, package); }
+}
+
+static bool model_lookup(const simulation_t *simulation, pid_t pid, uint32_t pidVersion, mt_process_lineage_info_t *info)
+{
+    const model_entry_t *entry = &simulation->entries[pid];
+    memset(info, 0, sizeof(mt_process_lineage_info_t));
+    
+    if (entry->sequence == 0 || entry->exited || (pidVersion != 0 && entry->pidVersion != pidVersion)) { return false; }
+    
+    info->pid = pid;
+    info->pidVersion = entry->pidVersion;
+    info->rootPID = entry->rootPID;
+    info->rootIsPlatformBinary = entry->rootIsPlatformBinary;
+    memcpy(info->rootName, entry->rootName, sizeof(info->rootName));
+    
+    const model_entry_t *parent = (entry->parentPID >= 0 && entry->parentPID < MAX_PIDS) ? &simulation->entries[entry->parentPID] : NULL;
+    
+    if (parent && entry->parentSequence != 0 && parent->sequence == entry->parentSequence) {
+        
+        info->parentPID = entry->parentPID;
+        info->parentArgumentsKnown = parent->argumentsKnown;
+        info->parentPackageCount = parent->packageCount;
+        memcpy(info->parentPackagePath, parent->packagePath, sizeof(info->parentPackagePath));
+    }
+    
+    return true;
+}
+
+// the lineage drops new processes if it's full of running ones. The model learns about that
+// with a lookup and forgets the process as well, so both add it again when it's seen next
+static bool model_keep(simulation_t *simulation, mt_process_lineage_t *lineage, const mt_process_lineage_process_t *process)
+{
+    mt_process_lineage_info_t info;
+    bool kept = mt_process_lineage_lookup(lineage, process->pid, process->pidVersion, &info);
+    
+    if (!kept) { simulation->entries[process->pid].sequence = 0; }
+    
+    return kept;
+}
+
+#pragma mark - Simulation
+
+static pid_t free_pid(const simulation_t *simulation)
+{
+    pid_t pid = 0;
+    
+    for (int attempt = 0; attempt < 32 && pid == 0; attempt++) {
+        
+        pid_t candidate = 2 + (pid_t)mt_test_random_below(MAX_PIDS - 2);
+        if (!simulation->processes[candidate].running) { pid = candidate; }
+    }
+    
+    return pid;
+}
+
+static pid_t running_pid(const simulation_t *simulation, bool includeLaunchd)
+{
+    pid_t pid = 0;
+    
+    for (int attempt = 0; attempt < 32 && pid == 0; attempt++) {
+        
+        pid_t candidate = (includeLaunchd ? 1 : 2) + (pid_t)mt_test_random_below(includeLaunchd ? MAX_PIDS - 1 : MAX_PIDS - 2);
+        if (simulation->processes[candidate].running) { pid = candidate; }
+    }
+    
+    return pid;
+}
+
+static void simulation_init(simulation_t *simulation)
+{
+    memset(simulation, 0, sizeof(simulation_t));
+    simulation->nextSequence = 1;
+    simulation->nextPIDVersion = 1;
+    
+    simulation->processes[1] = (world_process_t){ true, simulation->nextPIDVersion++, 0, 0 };
+    
+    // processes that were already running when the lineage was created
+    for (int i = 0; i < MAX_PIDS / 4; i++) {
+        
+        pid_t pid = free_pid(simulation);
+        pid_t parentPID = running_pid(simulation, true);
+        
+        if (pid && parentPID) {
+            simulation->processes[pid] = (world_process_t){ true, simulation->nextPIDVersion++, parentPID, 1 + mt_test_random_below(sizeof(images) / sizeof(images[0]) - 1) };
+        }
+    }
+}
+
+static void simulate_fork(simulation_t *simulation, mt_process_lineage_t *lineage)
+{
+    pid_t parentPID = running_pid(simulation, true);
+    pid_t pid = free_pid(simulation);
+    if (!parentPID || !pid) { return; }
+    
+    // the child runs the parent's image
+    simulation->processes[pid] = (world_process_t){ true, simulation->nextPIDVersion++, parentPID, simulation->processes[parentPID].image };
+    
+    mt_process_lineage_process_t parent = notification_process(simulation, parentPID);
+    mt_process_lineage_process_t child = notification_process(simulation, pid);
+    log_notification(simulation, "fork %d.%u -> %d.%u", parentPID, parent.pidVersion, pid, child.pidVersion);
+    
+    mt_process_lineage_fork(lineage, &parent, &child);
+    
+    model_entry_t *parentEntry = model_entry(simulation, &parent);
+    if (!model_keep(simulation, lineage, &parent)) { parentEntry = NULL; }
+    
+    model_add(simulation, &child, parentEntry);
+    model_keep(simulation, lineage, &child);
+}
+
+static void simulate_exec(simulation_t *simulation, mt_process_lineage_t *lineage)
+{
+    pid_t pid = running_pid(simulation, false);
+    if (!pid) { return; }
+    
+    argument_list_t list = { mt_test_random_below(MAX_ARGUMENTS + 1), { NULL } };
+    for (size_t i = 0; i < list.count; i++) { list.arguments[i] = argumentPool[mt_test_random_below(sizeof(argumentPool) / sizeof(argumentPool[0]))]; }
+    
+    mt_process_lineage_process_t process = notification_process(simulation, pid);
+    simulation->processes[pid].pidVersion = simulation->nextPIDVersion++;
+    simulation->processes[pid].image = 1 + mt_test_random_below(sizeof(images) / sizeof(images[0]) - 1);
+    mt_process_lineage_process_t target = notification_process(simulation, pid);
+    
+    log_notification(simulation, "exec %d.%u -> %d.%u %s (%zu arguments)", pid, process.pidVersion, pid, target.pidVersion, images[simulation->processes[pid].image].path, list.count);
+    
+    mt_process_lineage_exec(lineage, &process, &target, (uint32_t)list.count, list_argument, &list);
+    model_exec(simulation, &process, &target, &list);
+    model_keep(simulation, lineage, &target);
+}
+
+static void simulate_exit(simulation_t *simulation, mt_process_lineage_t *lineage)
+{
+    pid_t pid = running_pid(simulation, false);
+    if (!pid) { return; }
+    
+    uint32_t pidVersion = simulation->processes[pid].pidVersion;
+    simulation->processes[pid].running = false;
+    
+    // orphans are adopted by launchd
+    for (pid_t i = 2; i < MAX_PIDS; i++) {
+        if (simulation->processes[i].running && simulation->processes[i].parentPID == pid) { simulation->processes[i].parentPID = 1; }
+    }
+    
+    log_notification(simulation, "exit %d.%u", pid, pidVersion);
+    mt_process_lineage_exit(lineage, pid, pidVersion);
+    
+    model_entry_t *entry = &simulation->entries[pid];
+    if (entry->sequence != 0 && entry->pidVersion == pidVersion) { entry->exited = true; }
+}
+
+// compares the lineage's view of a process with the model's. If exact is false, the lineage
+// may have evicted the parent of the process after it exited, so it does not know the parent
+static bool compare_lookup(const simulation_t *simulation, mt_process_lineage_t *lineage, pid_t pid, uint32_t pidVersion, bool exact)
+{
+    mt_process_lineage_info_t info, expected;
+    bool found = mt_process_lineage_lookup(lineage, pid, pidVersion, &info);
+    bool expectedFound = model_lookup(simulation, pid, pidVersion, &expected);
+    bool equal = (found == expectedFound);
+    
+    if (found && expectedFound) {
+        
+        equal = (info.pid == expected.pid && info.pidVersion == expected.pidVersion && info.rootPID == expected.rootPID &&
+                 info.rootIsPlatformBinary == expected.rootIsPlatformBinary && strcmp(info.rootName, expected.rootName) == 0);
+        
+        if (info.parentPID == 0 && expected.parentPID != 0 && !exact) {
+            
+            equal = equal && simulation->entries[expected.parentPID].exited;
+            
+        } else {
+            
+            equal = equal && (info.parentPID == expected.parentPID && info.parentPackageCount == expected.parentPackageCount);
+            
+            // the package path of the parent may have been overwritten by more recent ones
+            if (info.parentArgumentsKnown) {
+                equal = equal && expected.parentArgumentsKnown && strcmp(info.parentPackagePath, expected.parentPackagePath) == 0;
+            } else {
+                equal = equal && (!expected.parentArgumentsKnown || expected.parentPackageCount == 1);
+            }
+        }
+    }
+    
+    if (!equal) {
+        
+        fprintf(stderr, "lookup of %d.%u: found %d (expected %d), parent %d (expected %d), root %d \"%s\" (expected %d \"%s\"), packages %zu \"%s\" (expected %zu \"%s\")\n",
+                pid, pidVersion, found, expectedFound, info.parentPID, expected.parentPID, info.rootPID, info.rootName, expected.rootPID, expected.rootName,
+                info.parentPackageCount, info.parentPackagePath, expected.parentPackageCount, expected.parentPackagePath);
+        print_history(simulation);
+    }
+    
+    return equal;
+}
+
+static bool run_history(size_t capacity, bool exact)
+{
+    simulation_t *simulation = malloc(sizeof(simulation_t));
+    mt_process_lineage_t *lineage = mt_process_lineage_create(capacity);
+    bool success = (simulation && lineage);
+    
+    if (success) { simulation_init(simulation); }
+    
+    for (unsigned long step = 0; success && step < historySteps; step++) {
+        
+        switch (mt_test_random_below(3)) {
+            case 0: simulate_fork(simulation, lineage); break;
+            case 1: simulate_exec(simulation, lineage); break;
+            default: simulate_exit(simulation, lineage); break;
+        }
+        
+        // compare some processes after every step and all of them now and then, including
+        // lookups of processes that exited and of previous versions of running processes
+        for (pid_t pid = 1; success && pid < MAX_PIDS; pid++) {
+            
+            if (step % 64 != 0 && mt_test_random_below(MAX_PIDS / 4) != 0) { continue; }
+            
+            uint32_t pidVersion = simulation->processes[pid].pidVersion;
+            
+            switch (mt_test_random_below(4)) {
+                case 0: pidVersion = 0; break;
+                case 1: pidVersion = (pidVersion > 1) ? pidVersion - 1 : 0; break;
+                default: break;
+            }
+            
+            success = compare_lookup(simulation, lineage, pid, pidVersion, exact);
+        }
+    }
+    
+    if (lineage) {
+        
+        mt_process_lineage_statistics_t statistics;
+        mt_process_lineage_statistics(lineage, &statistics);
+        MT_CHECK(statistics.count <= capacity);
+        
+        if (exact) {
+            MT_CHECK_EQUAL(statistics.evicted + statistics.dropped, 0);
+        } else {
+            fprintf(stderr, "capacity %zu: %llu evicted, %llu dropped\n", capacity, (unsigned long long)statistics.evicted, (unsigned long long)statistics.dropped);
+        }
+    }
+    
+    mt_process_lineage_destroy(lineage);
+    free(simulation);
+    
+    return success;
+}
+
+#pragma mark - Tests
+
+static void test_installer_scenario(void)
+{
+    mt_process_lineage_t *lineage = mt_process_lineage_create(16);
+    mt_process_lineage_info_t info;
+    
+    mt_process_lineage_process_t launchd = { 1, 1, 0, string_token("/sbin/launchd"), true };
+    mt_process_lineage_process_t login = { 100, 2, 1, string_token("/usr/bin/login"), true };
+    mt_process_lineage_process_t shell = { 101, 3, 100, string_token("/usr/bin/login"), true };
+    mt_process_lineage_process_t zsh = { 101, 4, 100, string_token("/bin/zsh"), true };
+    mt_process_lineage_process_t fork = { 102, 5, 101, string_token("/bin/zsh"), true };
+    mt_process_lineage_process_t installer = { 102, 6, 101, string_token("/usr/sbin/installer"), true };
+    mt_process_lineage_process_t helper = { 103, 7, 102, string_token("/usr/sbin/installer"), true };
+    
+    argument_list_t none = { 0, { NULL } };
+    argument_list_t arguments = { 4, { "-pkg", "/tmp/Privileges.pkg", "-target", "/" } };
+    
+    mt_process_lineage_fork(lineage, &launchd, &login);
+    mt_process_lineage_fork(lineage, &login, &shell);
+    mt_process_lineage_exec(lineage, &shell, &zsh, 0, list_argument, &none);
+    mt_process_lineage_fork(lineage, &zsh, &fork);
+    mt_process_lineage_exec(lineage, &fork, &installer, 4, list_argument, &arguments);
+    
+    // the login session exits, but its name stays with its descendants
+    mt_process_lineage_exit(lineage, login.pid, login.pidVersion);
+    mt_process_lineage_fork(lineage, &installer, &helper);
+    
+    MT_CHECK(mt_process_lineage_lookup(lineage, helper.pid, helper.pidVersion, &info));
+    MT_CHECK_EQUAL(info.parentPID, installer.pid);
+    MT_CHECK_EQUAL(info.rootPID, login.pid);
+    MT_CHECK_STRING(info.rootName, "login");
+    MT_CHECK(info.rootIsPlatformBinary);
+    MT_CHECK(info.parentArgumentsKnown);
+    MT_CHECK_EQUAL(info.parentPackageCount, 1);
+    MT_CHECK_STRING(info.parentPackagePath, "/tmp/Privileges.pkg");
+    
+    // the shell's process id version changed with the exec
+    MT_CHECK(!mt_process_lineage_lookup(lineage, shell.pid, shell.pidVersion, &info));
+    MT_CHECK(mt_process_lineage_lookup(lineage, zsh.pid, zsh.pidVersion, &info));
+    MT_CHECK(mt_process_lineage_lookup(lineage, zsh.pid, 0, &info));
+    MT_CHECK(!mt_process_lineage_lookup(lineage, login.pid, 0, &info));
+    
+    // the installer exits and its process id is reused by a process of another session
+    mt_process_lineage_process_t other = { 200, 8, 1, string_token("/usr/local/bin/Installer"), false };
+    mt_process_lineage_process_t reused = { 102, 9, 200, string_token("/usr/local/bin/Installer"), false };
+    
+    mt_process_lineage_exit(lineage, installer.pid, installer.pidVersion);
+    mt_process_lineage_fork(lineage, &other, &reused);
+    
+    MT_CHECK(mt_process_lineage_lookup(lineage, helper.pid, helper.pidVersion, &info));
+    MT_CHECK_EQUAL(info.parentPID, 0);
+    MT_CHECK_STRING(info.rootName, "login");
+    
+    MT_CHECK(mt_process_lineage_lookup(lineage, reused.pid, reused.pidVersion, &info));
+    MT_CHECK_EQUAL(info.parentPID, other.pid);
+    MT_CHECK_STRING(info.rootName, "Installer");
+    MT_CHECK(!info.rootIsPlatformBinary);
+    
+    // the parent has not been seen executing, so its arguments are unknown
+    MT_CHECK(!info.parentArgumentsKnown);
+    MT_CHECK_EQUAL(info.parentPackageCount, 0);
+    
+    mt_process_lineage_destroy(lineage);
+}
+
+static void test_existing_processes(void)
+{
+    mt_process_lineage_t *lineage = mt_process_lineage_create(16);
+    mt_process_lineage_info_t info;
+    argument_list_t none = { 0, { NULL } };
+    
+    // started by launchd before the lineage was created, so it's a root
+    mt_process_lineage_process_t daemon = { 50, 1, 1, string_token("/usr/libexec/daemon"), true };
+    mt_process_lineage_process_t daemonChild = { 51, 2, 50, string_token("/usr/libexec/daemon"), true };
+    
+    mt_process_lineage_fork(lineage, &daemon, &daemonChild);
+    MT_CHECK(mt_process_lineage_lookup(lineage, daemonChild.pid, 0, &info));
+    MT_CHECK_EQUAL(info.rootPID, daemon.pid);
+    MT_CHECK_STRING(info.rootName, "daemon");
+    
+    // the parent of an existing process is unknown, and so is its root
+    mt_process_lineage_process_t shell = { 60, 3, 59, string_token("/bin/zsh"), true };
+    mt_process_lineage_process_t tool = { 60, 4, 59, string_token("/usr/bin/tool"), true };
+    
+    mt_process_lineage_exec(lineage, &shell, &tool, 0, list_argument, &none);
+    MT_CHECK(mt_process_lineage_lookup(lineage, tool.pid, tool.pidVersion, &info));
+    MT_CHECK_EQUAL(info.parentPID, 0);
+    MT_CHECK_EQUAL(info.rootPID, 0);
+    MT_CHECK_STRING(info.rootName, "");
+    
+    // names that don't fit are not stored, so they never match
+    char path[MT_PROCESS_LINEAGE_MAX_NAME + 8];
+    memset(path, 'x', sizeof(path) - 1);
+    path[0] = '/';
+    path[sizeof(path) - 1] = '\0';
+    
+    mt_process_lineage_process_t longRoot = { 70, 5, 1, string_token(path), false };
+    mt_process_lineage_process_t longChild = { 71, 6, 70, string_token(path), false };
+    
+    mt_process_lineage_fork(lineage, &longRoot, &longChild);
+    MT_CHECK(mt_process_lineage_lookup(lineage, longChild.pid, 0, &info));
+    MT_CHECK_EQUAL(info.rootPID, longRoot.pid);
+    MT_CHECK_STRING(info.rootName, "");
+    
+    mt_process_lineage_destroy(lineage);
+}
+
+static void test_eviction_and_drops(void)
+{
+    mt_process_lineage_t *lineage = mt_process_lineage_create(4);
+    mt_process_lineage_statistics_t statistics;
+    mt_process_lineage_info_t info;
+    
+    mt_process_lineage_process_t root = { 10, 1, 1, string_token("/usr/bin/login"), true };
+    mt_process_lineage_process_t children[5];
+    
+    // the root and three children fill the table, the fourth child is dropped
+    for (int i = 0; i < 5; i++) {
+        
+        children[i] = (mt_process_lineage_process_t){ 11 + i, 2 + (uint32_t)i, 10, string_token("/bin/zsh"), true };
+        mt_process_lineage_fork(lineage, &root, &children[i]);
+    }
+    
+    mt_process_lineage_statistics(lineage, &statistics);
+    MT_CHECK_EQUAL(statistics.count, 4);
+    MT_CHECK_EQUAL(statistics.dropped, 2);
+    MT_CHECK_EQUAL(statistics.evicted, 0);
+    MT_CHECK(!mt_process_lineage_lookup(lineage, children[4].pid, 0, &info));
+    
+    // exited processes make room, the one that exited first goes first
+    mt_process_lineage_exit(lineage, children[1].pid, children[1].pidVersion);
+    mt_process_lineage_exit(lineage, children[0].pid, children[0].pidVersion);
+    mt_process_lineage_fork(lineage, &root, &children[3]);
+    
+    mt_process_lineage_statistics(lineage, &statistics);
+    MT_CHECK_EQUAL(statistics.count, 4);
+    MT_CHECK_EQUAL(statistics.evicted, 1);
+    MT_CHECK(mt_process_lineage_lookup(lineage, children[3].pid, 0, &info));
+    MT_CHECK_EQUAL(info.parentPID, root.pid);
+    
+    // the root exits, but its descendants keep its name
+    mt_process_lineage_process_t grandchild = { 30, 10, children[2].pid, string_token("/bin/zsh"), true };
+    mt_process_lineage_exit(lineage, root.pid, root.pidVersion);
+    mt_process_lineage_fork(lineage, &children[2], &grandchild);
+    
+    MT_CHECK(mt_process_lineage_lookup(lineage, grandchild.pid, 0, &info));
+    MT_CHECK_STRING(info.rootName, "login");
+    
+    mt_process_lineage_statistics(lineage, &statistics);
+    MT_CHECK_EQUAL(statistics.evicted, 2);
+    
+    mt_process_lineage_destroy(lineage);
+    MT_CHECK(mt_process_lineage_create(0) == NULL);
+}
+
+static void test_random_histories(void)
+{
+    // with a capacity of at least the number of process ids, nothing is ever evicted
+    MT_CHECK(run_history(MAX_PIDS, true));
+    
+    // eviction of exited processes, and dropping of new ones if the table is full
+    MT_CHECK(run_history(MAX_PIDS / 2, false));
+    MT_CHECK(run_history(MAX_PIDS / 8, false));
+}
+
+typedef struct {
+    mt_process_lineage_t *lineage;
+    pid_t firstPID;
+    unsigned long failures;
+} worker_t;
+
+static void *update_lineage(void *context)
+{
+    worker_t *worker = context;
+    mt_process_lineage_process_t root = { worker->firstPID, 1, 1, string_token("/usr/bin/login"), true };
+    argument_list_t arguments = { 2, { "-pkg", "/tmp/a.pkg" } };
+    mt_process_lineage_info_t info;
+    
+    for (uint32_t i = 0; i < 100000; i++) {
+        
+        mt_process_lineage_process_t child = { worker->firstPID + 1 + (pid_t)(i % 8), 2 + 2 * i, worker->firstPID, string_token("/bin/zsh"), true };
+        mt_process_lineage_process_t target = child;
+        target.pidVersion++;
+        target.executablePath = string_token("/usr/sbin/installer");
+        
+        mt_process_lineage_fork(worker->lineage, &root, &child);
+        mt_process_lineage_exec(worker->lineage, &child, &target, 2, list_argument, &arguments);
+        
+        if (!mt_process_lineage_lookup(worker->lineage, target.pid, target.pidVersion, &info) || info.parentPID != root.pid || strcmp(info.rootName, "login") != 0) {
+            worker->failures++;
+        }
+        
+        mt_process_lineage_exit(worker->lineage, target.pid, target.pidVersion);
+    }
+    
+    return NULL;
+}
+
+static void test_concurrent_updates(void)
+{
+    enum { threadCount = 4 };
+    
+    // each thread has its own processes, which (with their roots) always fit into the table
+    mt_process_lineage_t *lineage = mt_process_lineage_create(threadCount * 16);
+    pthread_t threads[threadCount];
+    worker_t workers[threadCount];
+    
+    for (int i = 0; i < threadCount; i++) {
+        
+        workers[i] = (worker_t){ lineage, 1000 * (i + 1), 0 };
+        pthread_create(&threads[i], NULL, update_lineage, &workers[i]);
+    }
+    
+    for (int i = 0; i < threadCount; i++) {
+        
+        pthread_join(threads[i], NULL);
+        MT_CHECK_EQUAL(workers[i].failures, 0);
+    }
+    
+    mt_process_lineage_statistics_t statistics;
+    mt_process_lineage_statistics(lineage, &statistics);
+    MT_CHECK(statistics.count <= statistics.capacity);
+    MT_CHECK_EQUAL(statistics.dropped, 0);
+    
+    mt_process_lineage_destroy(lineage);
+}
+
+int main(int argc, const char * argv[])
+{
+    if (argc > 1) { historySteps = strtoul(argv[1], NULL, 10); }
+    
+    // an executable name that is too long to be stored and a package path that is too long to be kept
+    memset(longName, 'n', sizeof(longName) - 1);
+    longName[0] = '/';
+    memset(longPackagePath, 'p', sizeof(longPackagePath) - 1);
+    memcpy(longPackagePath + sizeof(longPackagePath) - 5, ".pkg", 5);
+    
+    mt_test_seed();
+    
+    MT_RUN_TEST(test_installer_scenario);
+    MT_RUN_TEST(test_existing_processes);
+    MT_RUN_TEST(test_eviction_and_drops);
+    MT_RUN_TEST(test_random_histories);
+    MT_RUN_TEST(test_concurrent_updates);
+    
+    return mt_test_result();
+}
@@ -0,0 +1,207 @@
+/*
+    main.c
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    Tests the process table snapshot with a child and a grandchild of the test process, so the
+    expected ancestry is known, and measures how long taking a snapshot and walking the
+    ancestry of a process takes.
+    
+    mt-process-table-test [benchmark iterations]
+*/
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "MTProcessTable.h"
+#include "MTTestSupport.h"
+
+static unsigned long benchmarkIterations = 100;
+
+#pragma mark - Helpers
+
+// starts a child that starts a grandchild. Both wait until they are killed
+static pid_t start_grandchild(pid_t *child)
+{
+    pid_t grandchild = 0;
+    int fds[2];
+    
+    if (pipe(fds) == 0) {
+        
+        *child = fork();
+        
+        if (*child == 0) {
+            
+            pid_t pid = fork();
+            
+            if (pid == 0) {
+                
+                pid = getpid();
+                if (write(fds[1], &pid, sizeof(pid)) != sizeof(pid)) { _exit(EXIT_FAILURE); }
+            }
+            
+            for (;;) { pause(); }
+            
+        } else if (*child > 0) {
+            
+            if (read(fds[0], &grandchild, sizeof(grandchild)) != sizeof(grandchild)) { grandchild = 0; }
+        }
+        
+        close(fds[0]);
+        close(fds[1]);
+    }
+    
+    return grandchild;
+}
+
+static void stop_grandchild(pid_t child, pid_t grandchild)
+{
+    if (grandchild > 0) { kill(grandchild, SIGKILL); }
+    
+    if (child > 0) {
+        
+        kill(child, SIGKILL);
+        waitpid(child, NULL, 0);
+    }
+}
+
+#pragma mark - Tests
+
+static void test_own_process(void)
+{
+    mt_process_table_t *table = mt_process_table_create();
+    MT_CHECK(table != NULL);
+    if (!table) { return; }
+    
+    MT_CHECK(mt_process_table_count(table) > 1);
+    
+    const mt_process_entry_t *entry = mt_process_table_find(table, getpid());
+    MT_CHECK(entry != NULL);
+    MT_CHECK(entry && entry->pid == getpid() && entry->parentPID == getppid());
+    
+    const char *path = mt_process_table_path(table, getpid());
+    MT_CHECK(path != NULL && path[0] == '/');
+    
+    // the path is cached
+    MT_CHECK(path == mt_process_table_path(table, getpid()));
+    
+    // launchd (or init) and the kernel have no ancestry
+    MT_CHECK_EQUAL(mt_process_table_ancestors(table, 1, NULL, 0), 0);
+    MT_CHECK_EQUAL(mt_process_table_root(table, 1), 0);
+    MT_CHECK_EQUAL(mt_process_table_root(table, 0), 0);
+    
+    MT_CHECK(mt_process_table_find(table, -1) == NULL);
+    MT_CHECK(mt_process_table_path(table, -1) == NULL);
+    MT_CHECK_EQUAL(mt_process_table_ancestors(table, -1, NULL, 0), 0);
+    
+    mt_process_table_destroy(table);
+    mt_process_table_destroy(NULL);
+}
+
+static void test_grandchild(void)
+{
+    pid_t child = 0;
+    pid_t grandchild = start_grandchild(&child);
+    MT_CHECK(child > 0 && grandchild > 0);
+    
+    mt_process_table_t *table = (grandchild > 0) ? mt_process_table_create() : NULL;
+    
+    if (table) {
+        
+        const mt_process_entry_t *entry = mt_process_table_find(table, grandchild);
+        MT_CHECK(entry && entry->parentPID == child);
+        
+        // the grandchild's ancestry is the child, followed by our own ancestry
+        pid_t ancestors[64];
+        pid_t ownAncestors[64];
+        size_t count = mt_process_table_ancestors(table, grandchild, ancestors, 64);
+        size_t ownCount = mt_process_table_ancestors(table, getpid(), ownAncestors, 64);
+        
+        MT_CHECK_EQUAL(count, ownCount + 2);
+        MT_CHECK(count >= 2 && ancestors[0] == child && ancestors[1] == getpid());
+        MT_CHECK(count != ownCount + 2 || count > 64 || memcmp(ancestors + 2, ownAncestors, ownCount * sizeof(pid_t)) == 0);
+        
+        MT_CHECK_EQUAL(mt_process_table_root(table, grandchild), mt_process_table_root(table, getpid()));
+        
+        // a short buffer only receives the nearest ancestors, but all of them are counted
+        pid_t nearest[2] = { 0, -1 };
+        MT_CHECK_EQUAL(mt_process_table_ancestors(table, grandchild, nearest, 1), count);
+        MT_CHECK(nearest[0] == child && nearest[1] == -1);
+        
+        // the processes have not executed anything, so they run our executable
+        const char *path = mt_process_table_path(table, grandchild);
+        MT_CHECK(path != NULL);
+        MT_CHECK_STRING(path, mt_process_table_path(table, getpid()));
+        
+        mt_process_table_destroy(table);
+    }
+    
+    stop_grandchild(child, grandchild);
+    
+    // a new snapshot does not contain the processes anymore (unless their ids have been reused already)
+    table = mt_process_table_create();
+    
+    if (table) {
+        
+        MT_CHECK(mt_process_table_find(table, child) == NULL);
+        mt_process_table_destroy(table);
+    }
+}
+
+static void test_benchmark(void)
+{
+    uint64_t startTime = mt_test_time();
+    size_t count = 0;
+    
+    for (unsigned long i = 0; i < benchmarkIterations; i++) {
+        
+        mt_process_table_t *table = mt_process_table_create();
+        if (!table) { MT_CHECK(0); return; }
+        
+        count = mt_process_table_count(table);
+        mt_process_table_destroy(table);
+    }
+    
+    uint64_t elapsedTime = mt_test_time() - startTime;
+    fprintf(stderr, "snapshot of %zu processes: %.1f µs\n", count, elapsedTime / 1000.0 / benchmarkIterations);
+    
+    mt_process_table_t *table = mt_process_table_create();
+    if (!table) { MT_CHECK(0); return; }
+    
+    unsigned long lookups = benchmarkIterations * 10000;
+    size_t ancestors = 0;
+    pid_t pid = getpid();
+    startTime = mt_test_time();
+    
+    for (unsigned long i = 0; i < lookups; i++) { ancestors += mt_process_table_ancestors(table, pid, NULL, 0); }
+    
+    elapsedTime = mt_test_time() - startTime;
+    fprintf(stderr, "ancestry of %zu processes: %.1f ns\n", ancestors / lookups, (double)elapsedTime / lookups);
+    
+    mt_process_table_destroy(table);
+}
+
+int main(int argc, const char * argv[])
+{
+    if (argc > 1) { benchmarkIterations = strtoul(argv[1], NULL, 10); }
+    if (benchmarkIterations == 0) { benchmarkIterations = 1; }
+    
+    MT_RUN_TEST(test_own_process);
+    MT_RUN_TEST(test_grandchild);
+    MT_RUN_TEST(test_benchmark);
+    
+    return mt_test_result();
+}
@@ -0,0 +1,368 @@
+/*
+    main.c
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    Tests the state page: publishing and reading states, the checks of the owner and the
+    version of the shared memory object and the detection of a writer that is gone. A stress
+    test lets readers on several threads check every state they read while a writer keeps
+    publishing new ones, so a torn read would show up as a state that has never been written.
+    Finally it measures how long reading and writing a state takes.
+    
+    mt-state-page-test [writes]
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "MTStatePage.h"
+#include "MTTestSupport.h"
+
+#define READER_THREADS 3
+
+typedef struct {
+    const char *name;
+    const _Atomic bool *done;
+    uint64_t reads;
+    uint64_t failedReads;
+    uint64_t tornReads;
+    uint64_t reorderedReads;
+} reader_t;
+
+static uint64_t writes = 2000000;
+static char pageName[64];
+
+#pragma mark - Helpers
+
+// every field of the i-th state is derived from i, so readers can tell whether a state is
+// consistent. configGeneration is i itself, so readers can also tell the order of the states
+static mt_state_t numbered_state(uint64_t i)
+{
+    mt_state_t state = { 0 };
+    state.hasAdminPrivileges = ((i & 1) != 0);
+    state.expirationTime = (int64_t)(i * 3);
+    state.enforcement = (MTStateEnforcement)(i % 4);
+    state.configGeneration = i;
+    
+    return state;
+}
+
+static bool is_numbered_state(const mt_state_t *state)
+{
+    mt_state_t expected = numbered_state(state->configGeneration);
+    
+    return (state->hasAdminPrivileges == expected.hasAdminPrivileges && state->expirationTime == expected.expirationTime &&
+            state->enforcement == expected.enforcement && state->writerPID == getpid());
+}
+
+static mode_t object_mode(const char *name)
+{
+    mode_t mode = 0;
+    struct stat fileInfo;
+    int fd = shm_open(name, O_RDONLY, 0);
+    
+    if (fd >= 0) {
+        
+        if (fstat(fd, &fileInfo) == 0) { mode = fileInfo.st_mode & 0777; }
+        close(fd);
+    }
+    
+    return mode;
+}
+
+static void *read_states(void *context)
+{
+    reader_t *reader = context;
+    mt_state_page_t *page = mt_state_page_open(reader->name, geteuid(), false);
+    uint64_t lastGeneration = 0;
+    
+    while (page && !atomic_load(reader->done)) {
+        
+        mt_state_t state;
+        reader->reads++;
+        
+        if (!mt_state_page_read(page, &state)) {
+            
+            reader->failedReads++;
+            
+        } else {
+            
+            if (!is_numbered_state(&state)) { reader->tornReads++; }
+            if (state.configGeneration < lastGeneration) { reader->reorderedReads++; }
+            lastGeneration = state.configGeneration;
+        }
+    }
+    
+    mt_state_page_close(page);
+    
+    return (page) ? reader : NULL;
+}
+
+#pragma mark - Tests
+
+static void test_write_read(void)
+{
+    mt_state_page_t *writer = mt_state_page_open(pageName, geteuid(), true);
+    mt_state_page_t *reader = mt_state_page_open(pageName, geteuid(), false);
+    MT_CHECK(writer != NULL && reader != NULL);
+    if (!writer || !reader) { mt_state_page_close(writer); mt_state_page_close(reader); return; }
+    
+    // nothing has been published yet
+    mt_state_t state;
+    MT_CHECK(!mt_state_page_read(reader, &state));
+    
+    // the writer's process id is set by the page, not by the caller
+    mt_state_t published = { true, 1767225600, MTStateEnforcementAdmin, 42, 1, 2 };
+    mt_state_page_write(writer, &published);
+    
+    MT_CHECK(mt_state_page_read(reader, &state));
+    MT_CHECK(state.hasAdminPrivileges);
+    MT_CHECK_EQUAL(state.expirationTime, 1767225600);
+    MT_CHECK_EQUAL(state.enforcement, MTStateEnforcementAdmin);
+    MT_CHECK_EQUAL(state.configGeneration, 42);
+    MT_CHECK_EQUAL(state.writerPID, getpid());
+    MT_CHECK(mt_state_writer_is_running(&state));
+    
+    // readers cannot write
+    mt_state_page_write(reader, &(mt_state_t){ false, 0, MTStateEnforcementNone, 43, 0, 0 });
+    MT_CHECK(mt_state_page_read(reader, &state) && state.configGeneration == 42);
+    
+    for (MTStateEnforcement enforcement = MTStateEnforcementNotEnforced; enforcement <= MTStateEnforcementUser; enforcement++) {
+        
+        mt_state_page_write(writer, &(mt_state_t){ false, 0, enforcement, 44, 0, 0 });
+        MT_CHECK(mt_state_page_read(reader, &state) && state.enforcement == enforcement && !state.hasAdminPrivileges);
+    }
+    
+    mt_state_page_close(writer);
+    
+    // the state survives the writer
+    MT_CHECK(mt_state_page_read(reader, &state) && state.configGeneration == 44);
+    
+    mt_state_page_close(reader);
+    mt_state_page_close(NULL);
+}
+
+static void test_owner(void)
+{
+    mt_state_page_t *page = mt_state_page_open(pageName, geteuid(), true);
+    MT_CHECK(page != NULL);
+    mt_state_page_close(page);
+    
+    // only the owner can access the shared memory object
+    MT_CHECK_EQUAL(object_mode(pageName), 0600);
+    
+    // the object belongs to us, not to the user the caller expects
+    errno = 0;
+    MT_CHECK(mt_state_page_open(pageName, geteuid() + 1, false) == NULL);
+    MT_CHECK_EQUAL(errno, EACCES);
+    
+    // pages of other users can never be written
+    errno = 0;
+    MT_CHECK(mt_state_page_open(pageName, geteuid() + 1, true) == NULL);
+    MT_CHECK_EQUAL(errno, EPERM);
+    
+    // objects created by earlier versions are accessible by everyone, until they are opened for writing
+    shm_unlink(pageName);
+    int fd = shm_open(pageName, O_RDWR | O_CREAT, 0644);
+    MT_CHECK(fd >= 0 && fchmod(fd, 0644) == 0);
+    if (fd >= 0) { close(fd); }
+    
+    page = mt_state_page_open(pageName, geteuid(), true);
+    MT_CHECK(page != NULL);
+    MT_CHECK_EQUAL(object_mode(pageName), 0600);
+    mt_state_page_close(page);
+    
+    errno = 0;
+    MT_CHECK(mt_state_page_open("/mt-state-page-test-missing", geteuid(), false) == NULL);
+    MT_CHECK_EQUAL(errno, ENOENT);
+}
+
+static void test_incompatible_version(void)
+{
+    // a page written by another version of the layout. The version follows the magic number
+    shm_unlink(pageName);
+    int fd = shm_open(pageName, O_RDWR | O_CREAT, 0600);
+    uint32_t header[4] = { 0x53565250, 1, 2, 0 };
+    
+    MT_CHECK(fd >= 0 && ftruncate(fd, 4096) == 0 && pwrite(fd, header, sizeof(header), 0) == sizeof(header));
+    if (fd >= 0) { close(fd); }
+    
+    mt_state_t state;
+    mt_state_page_t *reader = mt_state_page_open(pageName, geteuid(), false);
+    MT_CHECK(reader != NULL);
+    if (!reader) { return; }
+    
+    MT_CHECK(!mt_state_page_read(reader, &state));
+    
+    // the writer takes the page over, but there is no state until it publishes one
+    mt_state_page_t *writer = mt_state_page_open(pageName, geteuid(), true);
+    MT_CHECK(writer != NULL);
+    MT_CHECK(!mt_state_page_read(reader, &state));
+    
+    if (writer) {
+        
+        mt_state_page_write(writer, &(mt_state_t){ true, 0, MTStateEnforcementNone, 7, 0, 0 });
+        MT_CHECK(mt_state_page_read(reader, &state) && state.configGeneration == 7);
+        mt_state_page_close(writer);
+    }
+    
+    mt_state_page_close(reader);
+    
+    // objects that are too small for the layout are never mapped
+    shm_unlink(pageName);
+    fd = shm_open(pageName, O_RDWR | O_CREAT, 0600);
+    MT_CHECK(fd >= 0 && ftruncate(fd, 8) == 0);
+    if (fd >= 0) { close(fd); }
+    
+    errno = 0;
+    MT_CHECK(mt_state_page_open(pageName, geteuid(), false) == NULL);
+    MT_CHECK_EQUAL(errno, EINVAL);
+    shm_unlink(pageName);
+}
+
+static void test_dead_writer(void)
+{
+    // the page is created by us, and the child publishes a state and exits
+    mt_state_page_t *page = mt_state_page_open(pageName, geteuid(), true);
+    MT_CHECK(page != NULL);
+    if (!page) { return; }
+    
+    pid_t child = fork();
+    
+    if (child == 0) {
+        
+        mt_state_page_t *childPage = mt_state_page_open(pageName, geteuid(), true);
+        if (childPage) { mt_state_page_write(childPage, &(mt_state_t){ true, 0, MTStateEnforcementNone, 99, 0, 0 }); }
+        _exit((childPage) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    
+    int status = 0;
+    MT_CHECK(child > 0 && waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+    
+    mt_state_t state;
+    MT_CHECK(mt_state_page_read(page, &state));
+    MT_CHECK_EQUAL(state.writerPID, child);
+    MT_CHECK_EQUAL(state.configGeneration, 99);
+    MT_CHECK(!mt_state_writer_is_running(&state));
+    
+    // a state without a writer
+    state.writerPID = 0;
+    MT_CHECK(!mt_state_writer_is_running(&state));
+    
+    mt_state_page_close(page);
+}
+
+static void test_concurrent_readers(void)
+{
+    mt_state_page_t *writer = mt_state_page_open(pageName, geteuid(), true);
+    MT_CHECK(writer != NULL);
+    if (!writer) { return; }
+    
+    mt_state_t first = numbered_state(0);
+    mt_state_page_write(writer, &first);
+    
+    _Atomic bool done = false;
+    pthread_t threads[READER_THREADS];
+    reader_t readers[READER_THREADS];
+    
+    for (int i = 0; i < READER_THREADS; i++) {
+        
+        readers[i] = (reader_t){ pageName, &done, 0, 0, 0, 0 };
+        pthread_create(&threads[i], NULL, read_states, &readers[i]);
+    }
+    
+    for (uint64_t i = 1; i <= writes; i++) {
+        
+        mt_state_t state = numbered_state(i);
+        mt_state_page_write(writer, &state);
+    }
+    
+    atomic_store(&done, true);
+    
+    for (int i = 0; i < READER_THREADS; i++) {
+        
+        void *result = NULL;
+        pthread_join(threads[i], &result);
+        MT_CHECK(result != NULL);
+        
+        fprintf(stderr, "reader %d: %llu reads, %llu failed\n", i, (unsigned long long)readers[i].reads, (unsigned long long)readers[i].failedReads);
+        MT_CHECK(readers[i].reads > readers[i].failedReads);
+        MT_CHECK_EQUAL(readers[i].tornReads, 0);
+        MT_CHECK_EQUAL(readers[i].reorderedReads, 0);
+    }
+    
+    mt_state_t state;
+    MT_CHECK(mt_state_page_read(writer, &state) && state.configGeneration == writes);
+    
+    mt_state_page_close(writer);
+}
+
+static void test_benchmark(void)
+{
+    mt_state_page_t *page = mt_state_page_open(pageName, geteuid(), true);
+    MT_CHECK(page != NULL);
+    if (!page) { return; }
+    
+    uint64_t startTime = mt_test_time();
+    
+    for (uint64_t i = 0; i < writes; i++) {
+        
+        mt_state_t state = numbered_state(i);
+        mt_state_page_write(page, &state);
+    }
+    
+    uint64_t elapsedTime = mt_test_time() - startTime;
+    fprintf(stderr, "write: %.1f ns\n", (double)elapsedTime / writes);
+    
+    mt_state_t state;
+    uint64_t reads = 0;
+    startTime = mt_test_time();
+    
+    for (uint64_t i = 0; i < writes; i++) { reads += mt_state_page_read(page, &state); }
+    
+    elapsedTime = mt_test_time() - startTime;
+    fprintf(stderr, "read: %.1f ns\n", (double)elapsedTime / writes);
+    MT_CHECK_EQUAL(reads, writes);
+    
+    mt_state_page_close(page);
+}
+
+int main(int argc, const char * argv[])
+{
+    if (argc > 1) { writes = strtoull(argv[1], NULL, 10); }
+    if (writes == 0) { writes = 1; }
+    
+    // a name of our own, so parallel runs don't share a page
+    snprintf(pageName, sizeof(pageName), "/mt-state-page-test-%d", (int)getpid());
+    shm_unlink(pageName);
+    
+    MT_RUN_TEST(test_write_read);
+    MT_RUN_TEST(test_owner);
+    MT_RUN_TEST(test_incompatible_version);
+    MT_RUN_TEST(test_dead_writer);
+    MT_RUN_TEST(test_concurrent_readers);
+    MT_RUN_TEST(test_benchmark);
+    
+    shm_unlink(pageName);
+    
+    return mt_test_result();
+}
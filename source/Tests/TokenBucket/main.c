@@ -0,0 +1,266 @@
+/*
+    main.c
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    Tests the token bucket against a counting token bucket and measures the cost of a request,
+    both uncontended and with several threads hammering the same bucket.
+    
+    mt-token-bucket-test [benchmark iterations]
+*/
+
+#include <pthread.h>
+#include "MTTokenBucket.h"
+#include "MTTestSupport.h"
+
+#define BENCHMARK_THREADS 4
+
+typedef struct {
+    mt_token_bucket_t *bucket;
+    uint64_t iterations;
+    uint64_t now;
+    uint64_t admitted;
+    uint64_t elapsedTime;
+} worker_t;
+
+static uint64_t benchmarkIterations = 10000000;
+
+#pragma mark - Reference model
+
+// a token bucket that counts its tokens (in nanoseconds of refill time)
+// and refills them continuously
+typedef struct {
+    uint64_t credit;
+    uint64_t maxCredit;
+    uint64_t interval;
+    uint64_t lastTime;
+} model_bucket_t;
+
+static void model_init(model_bucket_t *model, uint32_t capacity, uint64_t interval)
+{
+    model->maxCredit = capacity * interval;
+    model->credit = model->maxCredit;
+    model->interval = interval;
+    model->lastTime = 0;
+}
+
+static int model_try_acquire(model_bucket_t *model, uint64_t now, uint64_t *retryAfter)
+{
+    model->credit += now - model->lastTime;
+    if (model->credit > model->maxCredit) { model->credit = model->maxCredit; }
+    model->lastTime = now;
+    
+    if (model->credit >= model->interval) {
+        
+        model->credit -= model->interval;
+        return 1;
+    }
+    
+    *retryAfter = model->interval - model->credit;
+    
+    return 0;
+}
+
+#pragma mark - Tests
+
+static void test_unlimited(void)
+{
+    mt_token_bucket_t bucket;
+    mt_token_bucket_init(&bucket, 0, 1000);
+    
+    for (int i = 0; i < 1000; i++) { MT_CHECK_EQUAL(mt_token_bucket_try_acquire(&bucket, 0, NULL), 1); }
+    
+    MT_CHECK_EQUAL(atomic_load(&bucket.admitted), 1000);
+    MT_CHECK_EQUAL(atomic_load(&bucket.rejected), 0);
+}
+
+static void test_burst_and_refill(void)
+{
+    mt_token_bucket_t bucket;
+    uint64_t now = 1000000000;
+    uint64_t retryAfter = 0;
+    mt_token_bucket_init(&bucket, 5, 1000);
+    
+    for (int i = 0; i < 5; i++) { MT_CHECK_EQUAL(mt_token_bucket_try_acquire(&bucket, now, NULL), 1); }
+    
+    MT_CHECK_EQUAL(mt_token_bucket_try_acquire(&bucket, now, &retryAfter), 0);
+    MT_CHECK_EQUAL(retryAfter, 1000);
+    MT_CHECK_EQUAL(mt_token_bucket_try_acquire(&bucket, now + 400, &retryAfter), 0);
+    MT_CHECK_EQUAL(retryAfter, 600);
+    
+    // one token per interval
+    MT_CHECK_EQUAL(mt_token_bucket_try_acquire(&bucket, now + 1000, NULL), 1);
+    MT_CHECK_EQUAL(mt_token_bucket_try_acquire(&bucket, now + 1000, NULL), 0);
+    
+    // the bucket never holds more than its capacity
+    now += 1000000;
+    for (int i = 0; i < 5; i++) { MT_CHECK_EQUAL(mt_token_bucket_try_acquire(&bucket, now, NULL), 1); }
+    MT_CHECK_EQUAL(mt_token_bucket_try_acquire(&bucket, now, NULL), 0);
+    
+    MT_CHECK_EQUAL(atomic_load(&bucket.admitted), 11);
+    MT_CHECK_EQUAL(atomic_load(&bucket.rejected), 4);
+}
+
+static void test_forced_requests(void)
+{
+    mt_token_bucket_t bucket;
+    uint64_t now = 1000000000;
+    uint64_t retryAfter = 0;
+    mt_token_bucket_init(&bucket, 3, 1000);
+    
+    // forcing tokens out of an empty bucket keeps
+    // it empty for at most one refill interval
+    for (int i = 0; i < 100; i++) { mt_token_bucket_force_acquire(&bucket, now); }
+    
+    MT_CHECK_EQUAL(mt_token_bucket_try_acquire(&bucket, now, &retryAfter), 0);
+    MT_CHECK_EQUAL(retryAfter, 1000);
+    MT_CHECK_EQUAL(mt_token_bucket_try_acquire(&bucket, now + 1000, NULL), 1);
+    MT_CHECK_EQUAL(mt_token_bucket_try_acquire(&bucket, now + 1000, NULL), 0);
+    
+    // forced requests are counted as admitted
+    MT_CHECK_EQUAL(atomic_load(&bucket.admitted), 101);
+    MT_CHECK_EQUAL(atomic_load(&bucket.rejected), 2);
+    
+    // capacity 0 ignores forced requests
+    mt_token_bucket_init(&bucket, 0, 1000);
+    for (int i = 0; i < 100; i++) { mt_token_bucket_force_acquire(&bucket, now); }
+    MT_CHECK_EQUAL(mt_token_bucket_try_acquire(&bucket, now, NULL), 1);
+}
+
+static void test_random_against_model(void)
+{
+    size_t differences = 0;
+    
+    for (int run = 0; run < 200; run++) {
+        
+        uint32_t capacity = 1 + mt_test_random_below(20);
+        uint64_t interval = 1 + mt_test_random_below(1000000);
+        uint64_t now = mt_test_random_below(1000000);
+        
+        mt_token_bucket_t bucket;
+        model_bucket_t model;
+        mt_token_bucket_init(&bucket, capacity, interval);
+        model_init(&model, capacity, interval);
+        model.lastTime = now;
+        
+        for (int i = 0; i < 5000; i++) {
+            
+            // bursts of requests at the same time and pauses of varying length
+            uint32_t step = mt_test_random_below(8);
+            if (step > 2) { now += mt_test_random_below((uint32_t)(interval * step / 2 + 1)); }
+            
+            uint64_t retryAfter = 0, expectedRetryAfter = 0;
+            int admitted = mt_token_bucket_try_acquire(&bucket, now, &retryAfter);
+            int expected = model_try_acquire(&model, now, &expectedRetryAfter);
+            
+            if (admitted != expected || (!admitted && retryAfter != expectedRetryAfter)) { differences++; }
+        }
+    }
+    
+    MT_CHECK_EQUAL(differences, 0);
+}
+
+static void *acquire_tokens(void *context)
+{
+    worker_t *worker = context;
+    uint64_t startTime = mt_test_time();
+    
+    for (uint64_t i = 0; i < worker->iterations; i++) {
+        if (mt_token_bucket_try_acquire(worker->bucket, worker->now, NULL)) { worker->admitted++; }
+    }
+    
+    worker->elapsedTime = mt_test_time() - startTime;
+    
+    return NULL;
+}
+
+static void test_concurrent_requests(void)
+{
+    mt_token_bucket_t bucket;
+    pthread_t threads[BENCHMARK_THREADS];
+    worker_t workers[BENCHMARK_THREADS];
+    uint64_t admitted = 0;
+    
+    // without time passing, exactly "capacity" requests are admitted, no matter how many threads race
+    mt_token_bucket_init(&bucket, 1000, 1000000);
+    
+    for (int i = 0; i < BENCHMARK_THREADS; i++) {
+        
+        workers[i] = (worker_t){ &bucket, 100000, 5000000000ULL, 0, 0 };
+        pthread_create(&threads[i], NULL, acquire_tokens, &workers[i]);
+    }
+    
+    for (int i = 0; i < BENCHMARK_THREADS; i++) {
+        
+        pthread_join(threads[i], NULL);
+        admitted += workers[i].admitted;
+    }
+    
+    MT_CHECK_EQUAL(admitted, 1000);
+    MT_CHECK_EQUAL(atomic_load(&bucket.admitted), 1000);
+    MT_CHECK_EQUAL(atomic_load(&bucket.rejected), BENCHMARK_THREADS * 100000 - 1000);
+}
+
+static void test_benchmark(void)
+{
+    mt_token_bucket_t bucket;
+    pthread_t threads[BENCHMARK_THREADS];
+    worker_t workers[BENCHMARK_THREADS];
+    
+    // a bucket that always has tokens, so every request moves the arrival time
+    mt_token_bucket_init(&bucket, UINT32_MAX, 1);
+    workers[0] = (worker_t){ &bucket, benchmarkIterations, UINT64_MAX / 2, 0, 0 };
+    acquire_tokens(&workers[0]);
+    
+    MT_CHECK_EQUAL(workers[0].admitted, benchmarkIterations);
+    fprintf(stderr, "uncontended: %.1f ns per request\n", (double)workers[0].elapsedTime / benchmarkIterations);
+    
+    mt_token_bucket_init(&bucket, UINT32_MAX, 1);
+    uint64_t iterations = benchmarkIterations / BENCHMARK_THREADS;
+    uint64_t elapsedTime = 0;
+    
+    for (int i = 0; i < BENCHMARK_THREADS; i++) {
+        
+        workers[i] = (worker_t){ &bucket, iterations, UINT64_MAX / 2, 0, 0 };
+        pthread_create(&threads[i], NULL, acquire_tokens, &workers[i]);
+    }
+    
+    for (int i = 0; i < BENCHMARK_THREADS; i++) {
+        
+        pthread_join(threads[i], NULL);
+        if (workers[i].elapsedTime > elapsedTime) { elapsedTime = workers[i].elapsedTime; }
+    }
+    
+    MT_CHECK_EQUAL(atomic_load(&bucket.admitted), iterations * BENCHMARK_THREADS);
+    fprintf(stderr, "%d threads: %.1f ns per request\n", BENCHMARK_THREADS, (double)elapsedTime / iterations);
+}
+
+int main(int argc, const char * argv[])
+{
+    if (argc > 1) { benchmarkIterations = strtoull(argv[1], NULL, 10); }
+    if (benchmarkIterations < BENCHMARK_THREADS) { benchmarkIterations = BENCHMARK_THREADS; }
+    
+    mt_test_seed();
+    
+    MT_RUN_TEST(test_unlimited);
+    MT_RUN_TEST(test_burst_and_refill);
+    MT_RUN_TEST(test_forced_requests);
+    MT_RUN_TEST(test_random_against_model);
+    MT_RUN_TEST(test_concurrent_requests);
+    MT_RUN_TEST(test_benchmark);
+    
+    return mt_test_result();
+}
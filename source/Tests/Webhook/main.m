@@ -0,0 +1,344 @@
+/*
+    main.m
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    Posts webhook data to a local stand-in for a webhook. The stand-in accepts one request per
+    connection, decodes the request body according to its Content-Encoding header (like a real
+    webhook would) and keeps the decoded body, so the tests can verify that every configured
+    content encoding arrives intact and that bodies below the compression threshold are sent
+    uncompressed.
+*/
+
+#import <Foundation/Foundation.h>
+#import <arpa/inet.h>
+#import <netinet/in.h>
+#import <sys/socket.h>
+#import <zlib.h>
+#import "MTWebhook.h"
+#import "Constants.h"
+#import "MTTestSupport.h"
+
+@interface MTWebhookStandIn : NSObject
+@property (nonatomic, strong, readonly) NSURL *url;
+@property (nonatomic, strong, readonly) NSString *contentEncoding;
+@property (nonatomic, strong, readonly) NSData *decodedBody;
+@property (assign, readonly) NSUInteger bodyLength;
+- (instancetype)init;
+- (void)stop;
+@end
+
+@implementation MTWebhookStandIn
+{
+    int _socket;
+    NSThread *_thread;
+}
+
+- (instancetype)init
+{
+    self = [super init];
+    
+    if (self) {
+        
+        struct sockaddr_in address = { .sin_family = AF_INET, .sin_port = 0, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+        socklen_t addressLength = sizeof(address);
+        
+        _socket = socket(AF_INET, SOCK_STREAM, 0);
+        
+        if (_socket < 0 || bind(_socket, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(_socket, 4) != 0 ||
+            getsockname(_socket, (struct sockaddr*)&address, &addressLength) != 0) {
+            
+            self = nil;
+            
+        } else {
+            
+            _url = [NSURL URLWithString:[NSString stringWithFormat:@"http://127.0.0.1:%d/webhook", ntohs(address.sin_port)]];
+            _thread = [[NSThread alloc] initWithTarget:self selector:@selector(acceptConnections) object:nil];
+            [_thread start];
+        }
+    }
+    
+    return self;
+}
+
+- (void)acceptConnections
+{
+    int connection = -1;
+    
+    while ((connection = accept(_socket, NULL, NULL)) >= 0) {
+        
+        @autoreleasepool {
+            
+            [self handleConnection:connection];
+            close(connection);
+        }
+    }
+}
+
+- (void)handleConnection:(int)connection
+{
+    NSMutableData *request = [[NSMutableData alloc] init];
+    NSData *separator = [@"\r\n\r\n" dataUsingEncoding:NSASCIIStringEncoding];
+    NSRange headerEnd = NSMakeRange(NSNotFound, 0);
+    char buffer[4096];
+    ssize_t bytesRead = 0;
+    
+    while (headerEnd.location == NSNotFound && (bytesRead = read(connection, buffer, sizeof(buffer))) > 0) {
+        
+        [request appendBytes:buffer length:bytesRead];
+        headerEnd = [request rangeOfData:separator options:0 range:NSMakeRange(0, [request length])];
+    }
+    
+    if (headerEnd.location == NSNotFound) { return; }
+    
+    NSString *header = [[NSString alloc] initWithData:[request subdataWithRange:NSMakeRange(0, headerEnd.location)] encoding:NSASCIIStringEncoding];
+    NSUInteger contentLength = 0;
+    NSString *contentEncoding = nil;
+    
+    for (NSString *line in [header componentsSeparatedByString:@"\r\n"]) {
+        
+        NSRange colon = [line rangeOfString:@":"];
+        if (colon.location == NSNotFound) { continue; }
+        
+        NSString *name = [[line substringToIndex:colon.location] lowercaseString];
+        NSString *value = [[line substringFromIndex:colon.location + 1] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        
+        if ([name isEqualToString:@"content-length"]) {
+            contentLength = [value integerValue];
+        } else if ([name isEqualToString:@"content-encoding"]) {
+            contentEncoding = value;
+        }
+    }
+    
+    NSUInteger bodyStart = NSMaxRange(headerEnd);
+    
+    while ([request length] - bodyStart < contentLength && (bytesRead = read(connection, buffer, sizeof(buffer))) > 0) {
+        [request appendBytes:buffer length:bytesRead];
+    }
+    
+    NSData *body = [request subdataWithRange:NSMakeRange(bodyStart, MIN(contentLength, [request length] - bodyStart))];
+    NSData *decodedBody = body;
+    
+    if ([contentEncoding isEqualToString:@"gzip"]) {
+        decodedBody = [MTWebhookStandIn inflatedData:body windowBits:15 + 16];
+    } else if ([contentEncoding isEqualToString:@"deflate"]) {
+        decodedBody = [MTWebhookStandIn inflatedData:body windowBits:15];
+    }
+    
+    @synchronized (self) {
+        
+        _contentEncoding = contentEncoding;
+        _decodedBody = decodedBody;
+        _bodyLength = [body length];
+    }
+    
+    const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    write(connection, response, sizeof(response) - 1);
+}
+
++ (NSData*)inflatedData:(NSData*)data windowBits:(int)windowBits
+{
+    NSMutableData *inflatedData = nil;
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    
+    if (inflateInit2(&stream, windowBits) == Z_OK) {
+        
+        NSMutableData *outputData = [[NSMutableData alloc] init];
+        unsigned char buffer[16384];
+        int status = Z_OK;
+        
+        stream.next_in = (Bytef*)[data bytes];
+        stream.avail_in = (uInt)[data length];
+        
+        while (status == Z_OK) {
+            
+            stream.next_out = buffer;
+            stream.avail_out = sizeof(buffer);
+            status = inflate(&stream, Z_NO_FLUSH);
+            
+            if (status == Z_OK || status == Z_STREAM_END) { [outputData appendBytes:buffer length:sizeof(buffer) - stream.avail_out]; }
+        }
+        
+        // trailing data would mean the body has been encoded incorrectly
+        if (status == Z_STREAM_END && stream.avail_in == 0) { inflatedData = outputData; }
+        inflateEnd(&stream);
+    }
+    
+    return inflatedData;
+}
+
+- (void)stop
+{
+    shutdown(_socket, SHUT_RDWR);
+    close(_socket);
+}
+
+@end
+
+#pragma mark - Helpers
+
+static NSData *webhook_test_data(NSUInteger length)
+{
+    // json-like data that compresses like real webhook events
+    NSMutableString *string = [NSMutableString stringWithString:@"{\"custom_data\":{"];
+    NSUInteger index = 0;
+    
+    while ([string length] < length) { [string appendFormat:@"\"key%lu\":\"value %lu\",", (unsigned long)index, (unsigned long)(index * 7919 % 1000)]; index++; }
+    
+    return [[string substringToIndex:length] dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+static BOOL post_data(MTWebhookStandIn *standIn, MTWebhookOptions *options, NSData *data)
+{
+    __block NSError *postError = nil;
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    
+    MTWebhook *webhook = [[MTWebhook alloc] initWithURL:[standIn url]];
+    [webhook setOptions:options];
+    [webhook postData:data completionHandler:^(NSError *error) {
+        
+        postError = error;
+        dispatch_semaphore_signal(semaphore);
+    }];
+    
+    BOOL completed = (dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)) == 0);
+    if (postError) { fprintf(stderr, "Failed to post data: %s\n", [[postError description] UTF8String]); }
+    
+    return (completed && !postError);
+}
+
+static MTWebhookOptions *webhook_options(NSString *encoding, NSUInteger threshold)
+{
+    NSDictionary *dict = [NSDictionary dictionaryWithObjectsAndKeys:
+                          encoding, kMTDefaultsRemoteLoggingWebhookEncodingKey,
+                          [NSNumber numberWithUnsignedInteger:threshold], kMTDefaultsRemoteLoggingWebhookThresholdKey,
+                          nil
+    ];
+    
+    return [[MTWebhookOptions alloc] initWithDictionary:dict];
+}
+
+#pragma mark - Tests
+
+static MTWebhookStandIn *standIn = nil;
+
+static void test_compressed_data_round_trip(void)
+{
+    NSData *data = webhook_test_data(64 * 1024);
+    
+    for (NSInteger level = 1; level <= 9; level++) {
+        
+        NSData *gzipData = [MTWebhook compressedData:data encoding:MTWebhookContentEncodingGzip level:level];
+        NSData *deflateData = [MTWebhook compressedData:data encoding:MTWebhookContentEncodingDeflate level:level];
+        
+        MT_CHECK([gzipData length] > 0 && [gzipData length] < [data length]);
+        MT_CHECK([[MTWebhookStandIn inflatedData:gzipData windowBits:15 + 16] isEqualToData:data]);
+        MT_CHECK([[MTWebhookStandIn inflatedData:deflateData windowBits:15] isEqualToData:data]);
+        
+        // gzip data starts with the gzip magic number, zlib data must not be mistaken for it
+        MT_CHECK(((const unsigned char*)[gzipData bytes])[0] == 0x1f && ((const unsigned char*)[gzipData bytes])[1] == 0x8b);
+        MT_CHECK(((const unsigned char*)[deflateData bytes])[0] == 0x78);
+    }
+    
+    MT_CHECK([MTWebhook compressedData:data encoding:MTWebhookContentEncodingNone level:6] == nil);
+}
+
+static void test_post_encodings(void)
+{
+    NSData *data = webhook_test_data(8 * 1024);
+    NSArray *encodings = [NSArray arrayWithObjects:@"gzip", @"deflate", @"GZIP", nil];
+    
+    for (NSString *encoding in encodings) {
+        
+        MT_CHECK(post_data(standIn, webhook_options(encoding, 1024), data));
+        
+        @synchronized (standIn) {
+            
+            MT_CHECK([[standIn contentEncoding] isEqualToString:[encoding lowercaseString]]);
+            MT_CHECK([standIn bodyLength] < [data length]);
+            MT_CHECK([[standIn decodedBody] isEqualToData:data]);
+        }
+    }
+}
+
+static void test_post_below_threshold(void)
+{
+    NSData *data = webhook_test_data(512);
+    
+    MT_CHECK(post_data(standIn, webhook_options(@"gzip", 1024), data));
+    
+    @synchronized (standIn) {
+        
+        MT_CHECK([standIn contentEncoding] == nil);
+        MT_CHECK([[standIn decodedBody] isEqualToData:data]);
+    }
+}
+
+static void test_post_incompressible(void)
+{
+    // random data does not get smaller, so it must be sent as is
+    NSMutableData *data = [NSMutableData dataWithLength:4096];
+    arc4random_buf([data mutableBytes], [data length]);
+    
+    MT_CHECK(post_data(standIn, webhook_options(@"deflate", 0), data));
+    
+    @synchronized (standIn) {
+        
+        MT_CHECK([standIn contentEncoding] == nil);
+        MT_CHECK([[standIn decodedBody] isEqualToData:data]);
+    }
+}
+
+static void test_post_without_options(void)
+{
+    NSData *data = webhook_test_data(8 * 1024);
+    
+    MT_CHECK(post_data(standIn, nil, data));
+    
+    @synchronized (standIn) {
+        
+        MT_CHECK([standIn contentEncoding] == nil);
+        MT_CHECK([[standIn decodedBody] isEqualToData:data]);
+    }
+}
+
+int main(int argc, const char * argv[])
+{
+#pragma unused(argc)
+#pragma unused(argv)
+    
+    @autoreleasepool {
+        
+        standIn = [[MTWebhookStandIn alloc] init];
+        
+        if (!standIn) {
+            
+            fprintf(stderr, "Failed to start the webhook stand-in\n");
+            return EXIT_FAILURE;
+        }
+        
+        MT_RUN_TEST(test_compressed_data_round_trip);
+        MT_RUN_TEST(test_post_encodings);
+        MT_RUN_TEST(test_post_below_threshold);
+        MT_RUN_TEST(test_post_incompressible);
+        MT_RUN_TEST(test_post_without_options);
+        
+        [standIn stop];
+    }
+    
+    return mt_test_result();
+}
@@ -0,0 +1,392 @@
+/*
+    main.c
+    Copyright 2016-2026 SAP SE
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+    Tests the xar archive reader with installer package fixtures (see Fixtures/make_fixtures.py)
+    and fuzzes it with damaged packages. Besides flipping bytes of the package, the fuzzer edits
+    the uncompressed table of contents and compresses it again, so the damaged XML actually
+    reaches the scanner instead of being rejected by zlib.
+    
+    mt-xar-test <fixtures directory> [iterations]
+*/
+
+#include <zlib.h>
+#include "MTXarArchive.h"
+#include "MTTestSupport.h"
+
+typedef struct {
+    uint8_t *data;
+    size_t length;
+} fixture_t;
+
+static const char *fixturesPath = NULL;
+static unsigned long fuzzIterations = 20000;
+
+#pragma mark - Helpers
+
+static fixture_t load_fixture(const char *name)
+{
+    fixture_t fixture = { NULL, 0 };
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", fixturesPath, name);
+    
+    FILE *file = fopen(path, "rb");
+    
+    if (file) {
+        
+        fseek(file, 0, SEEK_END);
+        long length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        
+        fixture.data = (length > 0) ? malloc((size_t)length) : NULL;
+        
+        if (fixture.data && fread(fixture.data, 1, (size_t)length, file) == (size_t)length) {
+            fixture.length = (size_t)length;
+        } else {
+            free(fixture.data);
+            fixture.data = NULL;
+        }
+        
+        fclose(file);
+    }
+    
+    if (!fixture.data) { fprintf(stderr, "Failed to load fixture %s\n", path); }
+    
+    return fixture;
+}
+
+static uint64_t read_be(const uint8_t *data, size_t length)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < length; i++) { value = (value << 8) | data[i]; }
+    
+    return value;
+}
+
+static void write_be(uint8_t *data, size_t length, uint64_t value)
+{
+    for (size_t i = length; i > 0; i--, value >>= 8) { data[i - 1] = (uint8_t)value; }
+}
+
+static int data_within(mt_xar_data_t data, const uint8_t *begin, size_t length)
+{
+    return (data.data >= begin && data.length <= length && data.data - begin <= (ptrdiff_t)(length - data.length));
+}
+
+// checks that everything the reader returned lies within the archive or the certificate data
+static void check_signature(const mt_xar_signature_t *signature, const uint8_t *archive, size_t length)
+{
+    MT_CHECK(data_within(signature->toc, archive, length));
+    MT_CHECK(data_within(signature->checksum, archive, length));
+    MT_CHECK(data_within(signature->signature, archive, length));
+    MT_CHECK(signature->certificateCount > 0 && signature->certificateCount <= MT_XAR_MAX_CERTIFICATES);
+    MT_CHECK(signature->certificateData != NULL);
+    
+    // the certificates are decoded one after the other into the certificate data
+    const uint8_t *certificate = signature->certificateData;
+    
+    for (size_t i = 0; i < signature->certificateCount; i++) {
+        
+        MT_CHECK(signature->certificates[i].data == certificate && signature->certificates[i].length > 0);
+        certificate += signature->certificates[i].length;
+    }
+}
+
+static MTXarResult read_copy(const uint8_t *data, size_t length)
+{
+    // an exact-size copy, so the sanitizers catch reads past the end
+    uint8_t *copy = malloc((length > 0) ? length : 1);
+    memcpy(copy, data, length);
+    
+    mt_xar_signature_t signature;
+    MTXarResult result = mt_xar_read_signature(copy, length, &signature);
+    
+    if (result == MTXarResultSuccess) {
+        
+        check_signature(&signature, copy, length);
+        mt_xar_signature_free(&signature);
+    }
+    
+    free(copy);
+    
+    return result;
+}
+
+#pragma mark - Tests
+
+static void test_signed_packages(void)
+{
+    static const struct { const char *name; MTXarChecksum checksumType; size_t checksumLength; } packages[] = {
+        { "package-sha1.pkg", MTXarChecksumSHA1, 20 },
+        { "package-sha256.pkg", MTXarChecksumSHA256, 32 },
+        { "package-sha512.pkg", MTXarChecksumSHA512, 64 }
+    };
+    
+    fixture_t certificates[2] = { load_fixture("package-certificate-0.der"), load_fixture("package-certificate-1.der") };
+    MT_CHECK(certificates[0].data && certificates[1].data);
+    
+    for (size_t i = 0; i < sizeof(packages) / sizeof(packages[0]); i++) {
+        
+        fixture_t fixture = load_fixture(packages[i].name);
+        if (!fixture.data) { MT_CHECK(0); continue; }
+        
+        mt_xar_data_t toc;
+        mt_xar_signature_t signature;
+        MT_CHECK_EQUAL(mt_xar_read_toc(fixture.data, fixture.length, &toc), MTXarResultSuccess);
+        MT_CHECK_EQUAL(mt_xar_read_signature(fixture.data, fixture.length, &signature), MTXarResultSuccess);
+        
+        MT_CHECK_EQUAL(signature.checksumType, packages[i].checksumType);
+        MT_CHECK(signature.toc.data == toc.data && signature.toc.length == toc.length);
+        MT_CHECK_EQUAL(read_be(fixture.data + 8, 8), toc.length);
+        
+        // the checksum is at the start of the heap, followed by the signature
+        MT_CHECK(signature.checksum.data == toc.data + toc.length);
+        MT_CHECK_EQUAL(signature.checksum.length, packages[i].checksumLength);
+        MT_CHECK(signature.signature.data == signature.checksum.data + signature.checksum.length);
+        MT_CHECK_EQUAL(signature.signature.length, 256);
+        MT_CHECK_EQUAL(signature.signature.data[255], 255 % 251);
+        
+        MT_CHECK_EQUAL(signature.certificateCount, 2);
+        
+        for (size_t j = 0; j < 2 && certificates[j].data; j++) {
+            
+            MT_CHECK_EQUAL(signature.certificates[j].length, certificates[j].length);
+            MT_CHECK(signature.certificates[j].length == certificates[j].length && memcmp(signature.certificates[j].data, certificates[j].data, certificates[j].length) == 0);
+        }
+        
+        mt_xar_signature_free(&signature);
+        MT_CHECK(signature.certificateData == NULL);
+        mt_xar_signature_free(&signature);
+        
+        free(fixture.data);
+    }
+    
+    free(certificates[0].data);
+    free(certificates[1].data);
+}
+
+static void test_other_packages(void)
+{
+    static const struct { const char *name; MTXarResult result; } packages[] = {
+        { "package-unsigned.pkg", MTXarResultNotSigned },
+        { "package-cms.pkg", MTXarResultUnsupported },
+        { "package-dsa.pkg", MTXarResultUnsupported },
+        { "admin.plist", MTXarResultInvalidArchive }
+    };
+    
+    for (size_t i = 0; i < sizeof(packages) / sizeof(packages[0]); i++) {
+        
+        fixture_t fixture = load_fixture(packages[i].name);
+        if (!fixture.data) { MT_CHECK(0); continue; }
+        
+        MT_CHECK_EQUAL(read_copy(fixture.data, fixture.length), packages[i].result);
+        free(fixture.data);
+    }
+}
+
+static void test_invalid_headers(void)
+{
+    fixture_t fixture = load_fixture("package-sha256.pkg");
+    if (!fixture.data) { MT_CHECK(0); return; }
+    
+    uint8_t *copy = malloc(fixture.length);
+    size_t headerLength = (size_t)read_be(fixture.data + 4, 2);
+    size_t tocLength = (size_t)read_be(fixture.data + 8, 8);
+    
+    // the table of contents does not fit into the archive
+    memcpy(copy, fixture.data, fixture.length);
+    write_be(copy + 8, 8, fixture.length - headerLength + 1);
+    MT_CHECK_EQUAL(read_copy(copy, fixture.length), MTXarResultInvalidArchive);
+    
+    write_be(copy + 8, 8, UINT64_MAX);
+    MT_CHECK_EQUAL(read_copy(copy, fixture.length), MTXarResultInvalidArchive);
+    
+    // the header is longer than the archive or shorter than its fixed part
+    memcpy(copy, fixture.data, fixture.length);
+    write_be(copy + 4, 2, 0xffff);
+    MT_CHECK_EQUAL(read_copy(copy, fixture.length), MTXarResultInvalidArchive);
+    write_be(copy + 4, 2, 27);
+    MT_CHECK_EQUAL(read_copy(copy, fixture.length), MTXarResultInvalidArchive);
+    
+    // the uncompressed length does not match or is too large
+    memcpy(copy, fixture.data, fixture.length);
+    write_be(copy + 16, 8, read_be(fixture.data + 16, 8) + 1);
+    MT_CHECK_EQUAL(read_copy(copy, fixture.length), MTXarResultInvalidArchive);
+    write_be(copy + 16, 8, 0);
+    MT_CHECK_EQUAL(read_copy(copy, fixture.length), MTXarResultInvalidArchive);
+    write_be(copy + 16, 8, (uint64_t)MT_XAR_MAX_TOC_LENGTH + 1);
+    MT_CHECK_EQUAL(read_copy(copy, fixture.length), MTXarResultUnsupported);
+    
+    // no checksum, an unknown checksum and a checksum name without terminating null byte
+    memcpy(copy, fixture.data, fixture.length);
+    write_be(copy + 24, 4, 0);
+    MT_CHECK_EQUAL(read_copy(copy, fixture.length), MTXarResultNotSigned);
+    write_be(copy + 24, 4, 2);
+    MT_CHECK_EQUAL(read_copy(copy, fixture.length), MTXarResultUnsupported);
+    
+    memcpy(copy, fixture.data, fixture.length);
+    memcpy(copy + 28, "md5\0", 4);
+    MT_CHECK_EQUAL(read_copy(copy, fixture.length), MTXarResultUnsupported);
+    memset(copy + 28, 's', headerLength - 28);
+    MT_CHECK_EQUAL(read_copy(copy, fixture.length), MTXarResultUnsupported);
+    
+    // the checksum in the header does not match the one in the table of contents
+    memcpy(copy, fixture.data, fixture.length);
+    memcpy(copy + 28, "sha512", 6);
+    MT_CHECK_EQUAL(read_copy(copy, fixture.length), MTXarResultInvalidArchive);
+    
+    // the package ends within the table of contents or right after it
+    MT_CHECK_EQUAL(read_copy(fixture.data, headerLength + tocLength - 1), MTXarResultInvalidArchive);
+    MT_CHECK_EQUAL(read_copy(fixture.data, headerLength + tocLength), MTXarResultInvalidArchive);
+    MT_CHECK_EQUAL(read_copy(fixture.data, 0), MTXarResultInvalidArchive);
+    
+    free(copy);
+    free(fixture.data);
+}
+
+static void test_fuzz_package(void)
+{
+    fixture_t fixture = load_fixture("package-sha256.pkg");
+    if (!fixture.data) { MT_CHECK(0); return; }
+    
+    // every truncation of the heap must be handled
+    for (size_t length = 0; length < fixture.length; length++) { read_copy(fixture.data, length); }
+    
+    uint8_t *copy = malloc(fixture.length);
+    
+    for (unsigned long iteration = 0; iteration < fuzzIterations / 10; iteration++) {
+        
+        memcpy(copy, fixture.data, fixture.length);
+        
+        uint32_t mutations = 1 + mt_test_random_below(3);
+        
+        for (uint32_t m = 0; m < mutations; m++) {
+            
+            size_t position = mt_test_random_below((uint32_t)fixture.length);
+            copy[position] ^= (uint8_t)(1 << mt_test_random_below(8));
+        }
+        
+        read_copy(copy, fixture.length);
+    }
+    
+    free(copy);
+    free(fixture.data);
+}
+
+static void test_fuzz_toc(void)
+{
+    static const char interesting[] = "<>/=\"' \n0123456789";
+    
+    fixture_t fixture = load_fixture("package-sha256.pkg");
+    if (!fixture.data) { MT_CHECK(0); return; }
+    
+    size_t headerLength = (size_t)read_be(fixture.data + 4, 2);
+    size_t tocLength = (size_t)read_be(fixture.data + 8, 8);
+    size_t xmlLength = (size_t)read_be(fixture.data + 16, 8);
+    const uint8_t *heap = fixture.data + headerLength + tocLength;
+    size_t heapLength = fixture.length - headerLength - tocLength;
+    
+    uint8_t *xml = malloc(xmlLength);
+    uLongf decompressedLength = (uLongf)xmlLength;
+    MT_CHECK(uncompress(xml, &decompressedLength, fixture.data + headerLength, (uLong)tocLength) == Z_OK);
+    
+    // edits never make the document more than twice as long
+    uint8_t *mutated = malloc(2 * xmlLength);
+    uLong maxCompressedLength = compressBound((uLong)(2 * xmlLength));
+    uint8_t *package = malloc(headerLength + maxCompressedLength + heapLength);
+    unsigned long readSignatures = 0;
+    
+    for (unsigned long iteration = 0; iteration < fuzzIterations; iteration++) {
+        
+        size_t length = xmlLength;
+        memcpy(mutated, xml, xmlLength);
+        
+        uint32_t mutations = 1 + mt_test_random_below(3);
+        
+        for (uint32_t m = 0; m < mutations && length > 0; m++) {
+            
+            size_t position = mt_test_random_below((uint32_t)length);
+            size_t rangeLength = 1 + mt_test_random_below(16);
+            if (rangeLength > length - position) { rangeLength = length - position; }
+            
+            switch (mt_test_random_below(3)) {
+                
+                case 0:
+                    // replace a character with one that means something to the scanner
+                    mutated[position] = (uint8_t)interesting[mt_test_random_below(sizeof(interesting) - 1)];
+                    break;
+                
+                case 1:
+                    // remove a range (e.g. a closing tag or the end of the document)
+                    memmove(mutated + position, mutated + position + rangeLength, length - position - rangeLength);
+                    length -= rangeLength;
+                    break;
+                
+                default:
+                    // duplicate a range (e.g. an opening tag)
+                    if (length + rangeLength <= 2 * xmlLength) {
+                        
+                        memmove(mutated + position + rangeLength, mutated + position, length - position);
+                        length += rangeLength;
+                    }
+                    break;
+            }
+        }
+        
+        // rebuild the package with the mutated table of contents
+        uLongf compressedLength = maxCompressedLength;
+        if (compress(package + headerLength, &compressedLength, mutated, (uLong)length) != Z_OK) { MT_CHECK(0); break; }
+        
+        memcpy(package, fixture.data, headerLength);
+        write_be(package + 8, 8, compressedLength);
+        write_be(package + 16, 8, length);
+        memcpy(package + headerLength + compressedLength, heap, heapLength);
+        
+        if (read_copy(package, headerLength + compressedLength + heapLength) == MTXarResultSuccess) { readSignatures++; }
+    }
+    
+    // a single edit rarely hits one of the few elements the reader depends on
+    MT_CHECK(readSignatures > fuzzIterations / 4);
+    fprintf(stderr, "table of contents: %lu of %lu mutations read\n", readSignatures, fuzzIterations);
+    
+    free(package);
+    free(mutated);
+    free(xml);
+    free(fixture.data);
+}
+
+int main(int argc, const char * argv[])
+{
+    if (argc < 2) {
+        
+        fprintf(stderr, "Usage: mt-xar-test <fixtures directory> [iterations]\n");
+        return EXIT_FAILURE;
+    }
+    
+    fixturesPath = argv[1];
+    if (argc > 2) { fuzzIterations = strtoul(argv[2], NULL, 10); }
+    
+    mt_test_seed();
+    
+    MT_RUN_TEST(test_signed_packages);
+    MT_RUN_TEST(test_other_packages);
+    MT_RUN_TEST(test_invalid_headers);
+    MT_RUN_TEST(test_fuzz_package);
+    MT_RUN_TEST(test_fuzz_toc);
+    
+    return mt_test_result();
+}